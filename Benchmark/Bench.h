@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Bench.h
+// func: 微基准测试框架，测量每个数学内核的 ns/op 与 ops/s
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_Bench_h
+#define Wander_Bench_h
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "WanderMath.h"
+
+///////////////////////////////////////////////////////////////////
+//
+// 防止编译器把被测代码优化掉
+//
+///////////////////////////////////////////////////////////////////
+
+template <class T>
+inline void DoNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	const volatile char *p = reinterpret_cast<const volatile char *>(&value);
+	(void)*p;
+#endif
+}
+
+inline void ClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : : "memory");
+#endif
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// BenchContext
+//
+///////////////////////////////////////////////////////////////////
+
+class BenchContext
+{
+public:
+	BenchContext()
+		: filter(NULL)
+		, minSeconds(0.2)
+		, failures(0)
+	{
+	}
+
+	// 用例名是否匹配命令行给出的过滤串
+
+	bool Enabled(const char *name) const
+	{
+		return filter == NULL || strstr(name, filter) != NULL;
+	}
+
+	// 反复调用fn直到总时间超过minSeconds
+	// fn每次调用完成opsPerCall次操作
+
+	template <class Fn>
+	void Measure(const char *name, size_t opsPerCall, Fn fn)
+	{
+		if (!Enabled(name))
+		{
+			return;
+		}
+
+		typedef std::chrono::steady_clock Clock;
+
+		// 预热，同时让数据进入缓存
+
+		fn();
+
+		size_t iters = 1;
+		double seconds = 0.0;
+
+		for (;;)
+		{
+			Clock::time_point begin = Clock::now();
+
+			for (size_t i = 0; i < iters; i++)
+			{
+				fn();
+			}
+
+			ClobberMemory();
+			seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+			if (seconds >= minSeconds || iters >= (size_t(1) << 40))
+			{
+				break;
+			}
+
+			// 按已测时间估计所需次数，最多放大10倍
+
+			double scale = seconds > 0.0 ? minSeconds * 1.2 / seconds : 10.0;
+			scale = scale > 10.0 ? 10.0 : (scale < 2.0 ? 2.0 : scale);
+			iters = (size_t)(iters * scale);
+		}
+
+		double ops = (double)iters * (double)opsPerCall;
+		double nsPerOp = seconds * 1e9 / ops;
+
+		printf("%-44s %12.3f ns/op %14.1f Mops/s\n", name, nsPerOp, ops / seconds * 1e-6);
+		fflush(stdout);
+	}
+
+	// 输出附加指标（精度、比率等）
+
+	void Report(const char *name, const char *metric, double value)
+	{
+		if (!Enabled(name))
+		{
+			return;
+		}
+
+		printf("%-44s %12.6g %s\n", name, value, metric);
+		fflush(stdout);
+	}
+
+	// 校验精度界限或逐位一致等要求，不满足时输出并计数，
+	// 全部用例结束后 main 以非零值退出
+
+	void Check(const char *name, bool passed)
+	{
+		if (passed)
+		{
+			return;
+		}
+
+		printf("FAILED %s\n", name);
+		fflush(stdout);
+		failures++;
+	}
+
+public:
+	const char *filter;
+	double minSeconds;
+	int failures;
+};
+
+///////////////////////////////////////////////////////////////////
+//
+// 用例注册
+//
+///////////////////////////////////////////////////////////////////
+
+typedef void (*BenchFunc)(BenchContext &ctx);
+
+struct BenchEntry
+{
+	const char *suite;
+	BenchFunc func;
+};
+
+inline std::vector<BenchEntry> &BenchRegistry()
+{
+	static std::vector<BenchEntry> registry;
+	return registry;
+}
+
+struct BenchRegistrar
+{
+	BenchRegistrar(const char *suite, BenchFunc func)
+	{
+		BenchEntry entry = {suite, func};
+		BenchRegistry().push_back(entry);
+	}
+};
+
+#define WANDER_BENCH(suite) \
+	static void Bench_##suite(BenchContext &ctx); \
+	static BenchRegistrar s_benchRegistrar_##suite(#suite, Bench_##suite); \
+	static void Bench_##suite(BenchContext &ctx)
+
+///////////////////////////////////////////////////////////////////
+//
+// 测试数据
+//
+///////////////////////////////////////////////////////////////////
+
+// 每次调用处理的元素个数，足够摊薄计时开销又能留在L1/L2中
+
+const size_t KBENCHBATCH = 1024;
+
+inline float RandRange(float lo, float hi)
+{
+	return lo + (hi - lo) * RandFloat();
+}
+
+inline Vector3D RandVector3D(float range)
+{
+	return Vector3D(RandRange(-range, range), RandRange(-range, range), RandRange(-range, range));
+}
+
+inline EulerAngles RandEulerAngles()
+{
+	return EulerAngles(RandRange(-KPI, KPI), RandRange(-KPIOVER2, KPIOVER2), RandRange(-KPI, KPI));
+}
+
+inline Quaternion RandUnitQuaternion()
+{
+	Quaternion q;
+	q.SetRotateObjectToInertial(RandEulerAngles());
+	q.Normalize();
+	return q;
+}
+
+// 刚体变换：旋转加平移
+
+inline Matrix4X3 RandRigidMatrix()
+{
+	Matrix4X3 m;
+	m.SetupLocalToParent(RandVector3D(100.0f), RandEulerAngles());
+	return m;
+}
+
+// 两个四元数所表示旋转之间的夹角（弧度），用于报告精度
+// 用弦长求角度，避免acos在1附近丢失精度
+
+inline double QuaternionAngleError(const Quaternion &a, const Quaternion &b)
+{
+	double la = sqrt((double)DotProduct(a, a));
+	double lb = sqrt((double)DotProduct(b, b));
+	double sign = DotProduct(a, b) < 0.0f ? -1.0 : 1.0;
+
+	double dw = a.w / la - sign * b.w / lb;
+	double dx = a.x / la - sign * b.x / lb;
+	double dy = a.y / la - sign * b.y / lb;
+	double dz = a.z / la - sign * b.z / lb;
+
+	double chord = sqrt(dw*dw + dx*dx + dy*dy + dz*dz);
+	return 4.0 * asin(chord * 0.5 > 1.0 ? 1.0 : chord * 0.5);
+}
+
+#endif
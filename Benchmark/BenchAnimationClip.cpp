@@ -0,0 +1,186 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchAnimationClip.cpp
+// func: 关键帧轨道采样：1000个角色 x 60根骨骼的吞吐量与精度报告
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <thread>
+
+#include "Bench.h"
+
+const size_t KCHARACTERS = 1000;
+const size_t KCHARACTERBONES = 60;
+
+// 10秒的片段，大部分骨骼30帧每秒，每三根骨骼中有一根只有3帧每秒
+
+const float KCLIPDURATION = 10.0f;
+const float KFRAMESTEP = 1.0f / 60.0f;
+
+// 相邻关键帧之间转过的角度不超过0.1弧度，接近实际的动画数据
+
+static void BuildClip(AnimationClip &clip)
+{
+	std::vector<float> times;
+	std::vector<Quaternion> rotations;
+	std::vector<Vector3D> translations;
+
+	for (size_t bone = 0; bone < KCHARACTERBONES; bone++)
+	{
+		size_t keys = (bone % 3 == 2) ? 31 : 301;
+
+		times.resize(keys);
+		rotations.resize(keys);
+		translations.resize(keys);
+
+		Quaternion q = RandUnitQuaternion();
+		Vector3D p = RandVector3D(1.0f);
+
+		for (size_t k = 0; k < keys; k++)
+		{
+			times[k] = KCLIPDURATION * k / (keys - 1);
+
+			Vector3D axis = RandVector3D(1.0f);
+			axis.Normalize();
+
+			Quaternion delta;
+			delta.SetRotateAxis(axis, RandRange(0.0f, 0.1f));
+			q = q * delta;
+			q.Normalize();
+
+			rotations[k] = q;
+			translations[k] = p + RandVector3D(0.05f);
+			p = translations[k];
+		}
+
+		clip.AddTrack(&times[0], &rotations[0], &translations[0], keys);
+	}
+}
+
+// 现有做法：每根骨骼二分查找后调用 Slerp
+
+static void SampleReference(const AnimationClip &clip, const float *time, Quaternion *rotation, Vector3D *translation,
+							size_t instances)
+{
+	size_t bones = clip.BoneCount();
+
+	for (size_t i = 0; i < instances; i++)
+	{
+		for (size_t bone = 0; bone < bones; bone++)
+		{
+			clip.SampleBone(bone, time[i], rotation[i * bones + bone], translation[i * bones + bone]);
+		}
+	}
+}
+
+WANDER_BENCH(AnimationClip)
+{
+	AnimationClip clip;
+	BuildClip(clip);
+
+	const size_t total = KCHARACTERS * KCHARACTERBONES;
+
+	std::vector<float> offset(KCHARACTERS), time(KCHARACTERS);
+	std::vector<AnimationCursor> cursors(KCHARACTERS);
+	std::vector<Quaternion> rotation(total), reference(total);
+	std::vector<Vector3D> translation(total), referenceTranslation(total);
+
+	for (size_t i = 0; i < KCHARACTERS; i++)
+	{
+		offset[i] = RandRange(0.0f, KCLIPDURATION);
+	}
+
+	// 每次调用播放一帧，各角色从不同时刻开始循环播放
+
+	size_t frame = 0;
+
+	auto advance = [&]()
+	{
+		frame++;
+
+		for (size_t i = 0; i < KCHARACTERS; i++)
+		{
+			time[i] = fmodf(offset[i] + frame * KFRAMESTEP, KCLIPDURATION);
+		}
+	};
+
+	ctx.Measure("Sample 1000x60 bones binary search + Slerp", total, [&]()
+	{
+		advance();
+		SampleReference(clip, &time[0], &rotation[0], &translation[0], KCHARACTERS);
+		DoNotOptimize(rotation[0]);
+	});
+
+	ctx.Measure("Sample 1000x60 bones cursor + SlerpN", total, [&]()
+	{
+		advance();
+		SampleN(clip, &time[0], &cursors[0], &rotation[0], &translation[0], KCHARACTERS);
+		DoNotOptimize(rotation[0]);
+	});
+
+	ctx.Measure("Sample 1000x60 bones cursor + nlerp", total, [&]()
+	{
+		advance();
+		SampleN(clip, &time[0], &cursors[0], &rotation[0], &translation[0], KCHARACTERS, AnimationClip::KNLERP);
+		DoNotOptimize(rotation[0]);
+	});
+
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		JobPool pool(hardwareThreads > 0 ? hardwareThreads : 1);
+
+		ctx.Measure("Sample 1000x60 bones cursor + nlerp pooled", total, [&]()
+		{
+			advance();
+			SampleN(clip, &time[0], &cursors[0], &rotation[0], &translation[0], KCHARACTERS, AnimationClip::KNLERP,
+					&pool);
+			DoNotOptimize(rotation[0]);
+		});
+	}
+
+	// 精度：与逐根骨骼二分查找加 Slerp 的结果比较
+	// 先单调播放，再随机跳转，覆盖游标推进与退回二分查找两条路径
+
+	if (ctx.Enabled("AnimationClip max error"))
+	{
+		JobPool pool(4);
+		double slerpError = 0.0, nlerpError = 0.0, translationError = 0.0;
+
+		for (int pass = 0; pass < 200; pass++)
+		{
+			if (pass < 100)
+			{
+				advance();
+			}
+			else
+			{
+				for (size_t i = 0; i < KCHARACTERS; i++)
+				{
+					time[i] = RandRange(-1.0f, KCLIPDURATION + 1.0f);
+				}
+			}
+
+			SampleReference(clip, &time[0], &reference[0], &referenceTranslation[0], KCHARACTERS);
+
+			SampleN(clip, &time[0], &cursors[0], &rotation[0], &translation[0], KCHARACTERS, AnimationClip::KSLERP, &pool);
+
+			for (size_t i = 0; i < total; i++)
+			{
+				slerpError = MAX(slerpError, QuaternionAngleError(rotation[i], reference[i]));
+				translationError = MAX(translationError, (double)GetMag(translation[i] - referenceTranslation[i]));
+			}
+
+			SampleN(clip, &time[0], &cursors[0], &rotation[0], &translation[0], KCHARACTERS, AnimationClip::KNLERP, &pool);
+
+			for (size_t i = 0; i < total; i++)
+			{
+				nlerpError = MAX(nlerpError, QuaternionAngleError(rotation[i], reference[i]));
+			}
+		}
+
+		ctx.Report("AnimationClip max error cursor + SlerpN", "rad", slerpError);
+		ctx.Report("AnimationClip max error cursor + nlerp", "rad", nlerpError);
+		ctx.Report("AnimationClip max error translation", "abs", translationError);
+	}
+}
@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchBatch.cpp
+// func: Matrix4X3 批量变换内核的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+// 在缓存内(1K点)与超出缓存(4M点)两种规模下测试
+
+static void BenchTransformPoints(BenchContext &ctx, size_t n, const char *scalarName,
+								 const char *soaName, const char *inPlaceName,
+								 const char *dirName, const char *bandwidthName)
+{
+	Matrix4X3 m = RandRigidMatrix();
+
+	std::vector<Point3D> aos(n), aosOut(n);
+	Point3DSoA in(n), out(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		aos[i] = RandVector3D(100.0f);
+		in.Set(i, aos[i]);
+	}
+
+	ctx.Measure(scalarName, n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			aosOut[i] = aos[i] * m;
+		}
+		DoNotOptimize(aosOut[0]);
+	});
+
+	ctx.Measure(soaName, n, [&]()
+	{
+		TransformPoints(m, in, out, n);
+		DoNotOptimize(out.x[0]);
+	});
+
+	ctx.Measure(inPlaceName, n, [&]()
+	{
+		TransformPointsInPlace(m, out, n);
+		DoNotOptimize(out.x[0]);
+	});
+
+	ctx.Measure(dirName, n, [&]()
+	{
+		TransformDirections(m, in, out, n);
+		DoNotOptimize(out.x[0]);
+	});
+
+	// 报告带宽：每点读12字节写12字节
+
+	if (ctx.Enabled(bandwidthName))
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		int reps = n > 100000 ? 8 : 20000;
+		Clock::time_point begin = Clock::now();
+
+		for (int r = 0; r < reps; r++)
+		{
+			TransformPoints(m, in, out, n);
+		}
+
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		ctx.Report(bandwidthName, "GB/s", 24.0 * n * reps / seconds * 1e-9);
+	}
+}
+
+WANDER_BENCH(Matrix4X3Batch)
+{
+	BenchTransformPoints(ctx, KBENCHBATCH,
+						 "TransformPoints scalar loop (1K)",
+						 "TransformPoints SoA (1K)",
+						 "TransformPointsInPlace SoA (1K)",
+						 "TransformDirections SoA (1K)",
+						 "TransformPoints SoA bandwidth (1K)");
+
+	BenchTransformPoints(ctx, 1 << 22,
+						 "TransformPoints scalar loop (4M)",
+						 "TransformPoints SoA (4M)",
+						 "TransformPointsInPlace SoA (4M)",
+						 "TransformDirections SoA (4M)",
+						 "TransformPoints SoA bandwidth (4M)");
+
+	// 与标量 operator * 的最大误差
+
+	if (ctx.Enabled("TransformPoints max error"))
+	{
+		Matrix4X3 m = RandRigidMatrix();
+		Point3DSoA in(KBENCHBATCH + 3), out;
+
+		for (size_t i = 0; i < in.Size(); i++)
+		{
+			in.Set(i, RandVector3D(100.0f));
+		}
+
+		TransformPoints(m, in, out, in.Size());
+
+		float maxError = 0.0f;
+
+		for (size_t i = 0; i < in.Size(); i++)
+		{
+			Vector3D d = out.Get(i) - in.Get(i) * m;
+			maxError = MAX(maxError, GetMag(d));
+		}
+
+		ctx.Report("TransformPoints max error", "abs", maxError);
+	}
+}
+
+// 随机的缩放加切变矩阵，走一般求逆路径
+
+static Matrix4X3 RandAffineMatrix()
+{
+	Matrix4X3 m = RandRigidMatrix();
+
+	m.m11 *= RandRange(0.5f, 2.0f);
+	m.m22 *= RandRange(0.5f, 2.0f);
+	m.m33 *= RandRange(0.5f, 2.0f);
+	m.m12 += RandRange(-0.3f, 0.3f);
+
+	return m;
+}
+
+// 与单位矩阵的最大偏差
+
+static float IdentityError(const Matrix4X3 &m)
+{
+	Matrix4X3 identity;
+	identity.Reset();
+
+	const float *a = &m.m11;
+	const float *b = &identity.m11;
+	float maxError = 0.0f;
+
+	for (int i = 0; i < 12; i++)
+	{
+		maxError = MAX(maxError, fabs(a[i] - b[i]));
+	}
+
+	return maxError;
+}
+
+WANDER_BENCH(Matrix4X3Inverse)
+{
+	const size_t n = KBENCHBATCH;
+
+	std::vector<Matrix4X3> rigid(n), affine(n), out(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		rigid[i] = RandRigidMatrix();
+		affine[i] = RandAffineMatrix();
+	}
+
+	ctx.Measure("InverseAffine (rigid input)", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = InverseAffine(rigid[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("InverseRigid", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = InverseRigid(rigid[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("InverseRigidN", n, [&]()
+	{
+		InverseRigidN(&rigid[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("InverseN (rigid input)", n, [&]()
+	{
+		InverseN(&rigid[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Inverse scalar loop (affine input)", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Inverse(affine[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("InverseN (affine input)", n, [&]()
+	{
+		InverseN(&affine[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	// m * Inverse(m) 与单位矩阵的偏差，以及奇异矩阵的处理
+
+	if (ctx.Enabled("InverseN max error"))
+	{
+		size_t count = n + 3;
+		std::vector<Matrix4X3> in(count), inv(count);
+		std::vector<bool> expected(count);
+		bool singular[KBENCHBATCH + 3];
+
+		for (size_t i = 0; i < count; i++)
+		{
+			in[i] = (i & 1) ? RandAffineMatrix() : RandRigidMatrix();
+			expected[i] = (i % 97) == 5;
+
+			if (expected[i])
+			{
+				in[i].m31 = in[i].m11;
+				in[i].m32 = in[i].m12;
+				in[i].m33 = in[i].m13;
+			}
+		}
+
+		size_t singularCount = InverseN(&in[0], &inv[0], count, singular);
+
+		float maxError = 0.0f;
+		size_t mismatches = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (singular[i] != expected[i])
+			{
+				mismatches++;
+			}
+
+			if (!singular[i])
+			{
+				maxError = MAX(maxError, IdentityError(in[i] * inv[i]));
+			}
+		}
+
+		ctx.Report("InverseN max error", "abs", maxError);
+		ctx.Report("InverseN singular detected", "matrices", (double)singularCount);
+		ctx.Report("InverseN singular mismatches", "matrices", (double)mismatches);
+	}
+}
@@ -0,0 +1,310 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchBvh.cpp
+// func: BVH构建、更新与射线/包围盒查询的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <thread>
+
+#include "Bench.h"
+
+// 256x256 格的起伏地形加上散落的小三角形
+
+const int KBVHTERRAIN = 256;
+const size_t KBVHCLUTTER = 100000;
+const size_t KBVHRAYS = 65536;
+
+static float TerrainHeight(float x, float z, float phase)
+{
+	return 6.0f * sin(x * 0.05f + phase) * cos(z * 0.04f) + 2.0f * sin(x * 0.17f + z * 0.13f);
+}
+
+static void BuildScene(std::vector<Point3D> &vertices, float phase)
+{
+	vertices.clear();
+
+	const float cell = 2.0f;
+	const float origin = -KBVHTERRAIN * cell * 0.5f;
+
+	for (int j = 0; j < KBVHTERRAIN; j++)
+	{
+		for (int i = 0; i < KBVHTERRAIN; i++)
+		{
+			float x0 = origin + i * cell, x1 = x0 + cell;
+			float z0 = origin + j * cell, z1 = z0 + cell;
+
+			Point3D p00(x0, TerrainHeight(x0, z0, phase), z0);
+			Point3D p10(x1, TerrainHeight(x1, z0, phase), z0);
+			Point3D p01(x0, TerrainHeight(x0, z1, phase), z1);
+			Point3D p11(x1, TerrainHeight(x1, z1, phase), z1);
+
+			vertices.push_back(p00);
+			vertices.push_back(p01);
+			vertices.push_back(p10);
+
+			vertices.push_back(p10);
+			vertices.push_back(p01);
+			vertices.push_back(p11);
+		}
+	}
+
+	// 散落物每次用相同的种子生成，phase 只让它们上下浮动
+
+	srand(7);
+
+	for (size_t i = 0; i < KBVHCLUTTER; i++)
+	{
+		Point3D c(RandRange(origin, -origin), RandRange(0.0f, 30.0f), RandRange(origin, -origin));
+		c.y += phase * 2.0f;
+
+		vertices.push_back(c + RandVector3D(1.5f));
+		vertices.push_back(c + RandVector3D(1.5f));
+		vertices.push_back(c + RandVector3D(1.5f));
+	}
+}
+
+// 从地形上方的相机射向下方的随机方向
+
+static void BuildRays(std::vector<BvhRay> &rays, size_t n)
+{
+	rays.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		rays[i].origin.Init(RandRange(-50.0f, 50.0f), 60.0f, RandRange(-50.0f, 50.0f));
+		rays[i].dir.Init(RandRange(-1.0f, 1.0f), RandRange(-1.0f, -0.2f), RandRange(-1.0f, 1.0f));
+		rays[i].tMax = 1e30f;
+	}
+}
+
+// 暴力求最近交点，用于校验
+
+static float BruteForceHit(const std::vector<Point3D> &v, const BvhRay &ray)
+{
+	float best = ray.tMax;
+
+	for (size_t i = 0; i + 2 < v.size(); i += 3)
+	{
+		Vector3D e1 = v[i + 1] - v[i];
+		Vector3D e2 = v[i + 2] - v[i];
+		Vector3D pvec = CrossProduct(ray.dir, e2);
+		float det = e1 * pvec;
+
+		if (fabs(det) < 1e-20f)
+		{
+			continue;
+		}
+
+		Vector3D tvec = ray.origin - v[i];
+		float u = (tvec * pvec) / det;
+		Vector3D qvec = CrossProduct(tvec, e1);
+		float w = (ray.dir * qvec) / det;
+		float t = (e2 * qvec) / det;
+
+		if (u >= 0.0f && w >= 0.0f && u + w <= 1.0f && t > 0.0f && t < best)
+		{
+			best = t;
+		}
+	}
+
+	return best;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point begin)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// 校验一组射线与包围盒查询，返回不一致的个数
+
+static size_t CheckBvh(const Bvh &bvh, const std::vector<Point3D> &vertices, const std::vector<BvhRay> &rays)
+{
+	size_t mismatches = 0;
+
+	for (size_t i = 0; i < 256; i++)
+	{
+		BvhHit hit;
+		bool found = bvh.Intersect(rays[i], hit);
+		float expect = BruteForceHit(vertices, rays[i]);
+
+		if (found != (expect < rays[i].tMax) || (found && fabs(hit.t - expect) > 1e-3f * expect))
+		{
+			mismatches++;
+		}
+
+		if (bvh.Occluded(rays[i]) != found)
+		{
+			mismatches++;
+		}
+	}
+
+	std::vector<int> result;
+
+	for (size_t i = 0; i < 64; i++)
+	{
+		Point3D c(RandRange(-200.0f, 200.0f), RandRange(0.0f, 30.0f), RandRange(-200.0f, 200.0f));
+		AABB3D box(c - Vector3D(4.0f, 4.0f, 4.0f), c + Vector3D(4.0f, 4.0f, 4.0f));
+
+		result.clear();
+		size_t count = bvh.Overlap(box, result);
+		size_t expect = 0;
+
+		for (size_t t = 0; t < vertices.size() / 3; t++)
+		{
+			AABB3D tri;
+			tri.Empty();
+			tri.Add(vertices[t * 3]);
+			tri.Add(vertices[t * 3 + 1]);
+			tri.Add(vertices[t * 3 + 2]);
+			expect += IntersectAABBs(box, tri) ? 1 : 0;
+		}
+
+		mismatches += count != expect ? 1 : 0;
+	}
+
+	return mismatches;
+}
+
+WANDER_BENCH(Bvh)
+{
+	std::vector<Point3D> vertices;
+	BuildScene(vertices, 0.0f);
+
+	size_t triCount = vertices.size() / 3;
+
+	std::vector<BvhRay> rays;
+	BuildRays(rays, KBVHRAYS);
+
+	std::vector<BvhHit> hits(KBVHRAYS);
+
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+	hardwareThreads = hardwareThreads > 0 ? hardwareThreads : 1;
+
+	Bvh bvh;
+
+	ctx.Measure("Bvh build 1 thread (231K tris)", triCount, [&]()
+	{
+		bvh.BuildTriangles(&vertices[0], triCount);
+		DoNotOptimize(bvh.NodeCount());
+	});
+
+	if (hardwareThreads > 1)
+	{
+		JobPool pool(hardwareThreads);
+
+		char name[64];
+		snprintf(name, sizeof(name), "Bvh build %u threads (231K tris)", hardwareThreads);
+
+		ctx.Measure(name, triCount, [&]()
+		{
+			bvh.BuildTriangles(&vertices[0], triCount, &pool);
+			DoNotOptimize(bvh.NodeCount());
+		});
+	}
+
+	if (ctx.Enabled("Bvh build time"))
+	{
+		JobPool pool(hardwareThreads);
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		bvh.BuildTriangles(&vertices[0], triCount, &pool);
+		ctx.Report("Bvh build time", "ms", Seconds(begin) * 1e3);
+	}
+
+	bvh.BuildTriangles(&vertices[0], triCount);
+	ctx.Report("Bvh nodes", "nodes", (double)bvh.NodeCount());
+
+	// 对照：逐个三角形测试，只测少量射线
+
+	ctx.Measure("Bvh brute force closest hit", 16, [&]()
+	{
+		float t = 0.0f;
+
+		for (size_t i = 0; i < 16; i++)
+		{
+			t += BruteForceHit(vertices, rays[i]);
+		}
+
+		DoNotOptimize(t);
+	});
+
+	ctx.Measure("Bvh closest hit (64K rays)", KBVHRAYS, [&]()
+	{
+		bvh.IntersectN(&rays[0], &hits[0], KBVHRAYS);
+		DoNotOptimize(hits[0]);
+	});
+
+	ctx.Measure("Bvh any hit (64K rays)", KBVHRAYS, [&]()
+	{
+		size_t occluded = 0;
+
+		for (size_t i = 0; i < KBVHRAYS; i++)
+		{
+			occluded += bvh.Occluded(rays[i]) ? 1 : 0;
+		}
+
+		DoNotOptimize(occluded);
+	});
+
+	if (hardwareThreads > 1)
+	{
+		JobPool pool(hardwareThreads);
+
+		char name[64];
+		snprintf(name, sizeof(name), "Bvh closest hit %u threads (64K rays)", hardwareThreads);
+
+		ctx.Measure(name, KBVHRAYS, [&]()
+		{
+			bvh.IntersectN(&rays[0], &hits[0], KBVHRAYS, &pool);
+			DoNotOptimize(hits[0]);
+		});
+	}
+
+	std::vector<int> overlaps;
+
+	ctx.Measure("Bvh AABB overlap (8x8x8 box)", 1024, [&]()
+	{
+		overlaps.clear();
+
+		for (size_t i = 0; i < 1024; i++)
+		{
+			const Point3D &c = rays[i].origin;
+			Point3D p(c.x * 4.0f, 10.0f, c.z * 4.0f);
+			bvh.Overlap(AABB3D(p - Vector3D(4.0f, 4.0f, 4.0f), p + Vector3D(4.0f, 4.0f, 4.0f)), overlaps);
+		}
+
+		DoNotOptimize(overlaps.size());
+	});
+
+	// 地形起伏变化后只更新包围盒
+
+	std::vector<Point3D> moved;
+	BuildScene(moved, 0.5f);
+
+	ctx.Measure("Bvh refit (231K tris)", triCount, [&]()
+	{
+		bvh.RefitTriangles(&moved[0]);
+		DoNotOptimize(bvh.NodeCount());
+	});
+
+	ctx.Measure("Bvh closest hit after refit (64K rays)", KBVHRAYS, [&]()
+	{
+		bvh.IntersectN(&rays[0], &hits[0], KBVHRAYS);
+		DoNotOptimize(hits[0]);
+	});
+
+	if (ctx.Enabled("Bvh mismatches"))
+	{
+		JobPool pool(4);
+		size_t mismatches = 0;
+
+		bvh.BuildTriangles(&vertices[0], triCount, &pool);
+		mismatches += CheckBvh(bvh, vertices, rays);
+
+		bvh.RefitTriangles(&moved[0], &pool);
+		mismatches += CheckBvh(bvh, moved, rays);
+
+		ctx.Report("Bvh mismatches", "queries", (double)mismatches);
+	}
+}
@@ -0,0 +1,215 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchCore.cpp
+// func: 现有标量内核的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+WANDER_BENCH(Matrix4X3)
+{
+	std::vector<Matrix4X3> a(KBENCHBATCH), b(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<Point3D> p(KBENCHBATCH), pout(KBENCHBATCH);
+	std::vector<Quaternion> q(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		a[i] = RandRigidMatrix();
+		b[i] = RandRigidMatrix();
+		p[i] = RandVector3D(100.0f);
+		q[i] = RandUnitQuaternion();
+	}
+
+	ctx.Measure("Matrix4X3 * Matrix4X3", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = a[i] * b[i];
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Vector3D * Matrix4X3", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			pout[i] = p[i] * a[i];
+		}
+		DoNotOptimize(pout[0]);
+	});
+
+	ctx.Measure("Inverse(Matrix4X3)", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Inverse(a[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Matrix4X3::FromQuaternion", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i].FromQuaternion(q[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+}
+
+WANDER_BENCH(Quaternion)
+{
+	std::vector<Quaternion> q0(KBENCHBATCH), q1(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<float> t(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		q0[i] = RandUnitQuaternion();
+		q1[i] = RandUnitQuaternion();
+		t[i] = RandFloat();
+	}
+
+	ctx.Measure("Slerp", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Slerp(q0[i], q1[i], t[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Pow(Quaternion)", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Pow(q0[i], t[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+}
+
+WANDER_BENCH(EulerAngles)
+{
+	std::vector<Matrix4X3> m(KBENCHBATCH);
+	std::vector<EulerAngles> out(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		m[i] = RandRigidMatrix();
+	}
+
+	ctx.Measure("EulerAngles::FromObjectToWorldMatrix", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i].FromObjectToWorldMatrix(m[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+}
+
+WANDER_BENCH(CommonMath)
+{
+	std::vector<float> ang(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<Vector3D> v(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		ang[i] = RandRange(-720.0f, 720.0f);
+		v[i] = RandVector3D(100.0f);
+	}
+
+	ctx.Measure("FastSin", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = FastSin(ang[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("FastCos", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = FastCos(ang[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	std::vector<float> rad(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		rad[i] = AngToRad(ang[i]);
+	}
+
+	ctx.Measure("FastSinRad", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = FastSinRad(rad[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("SinCosTable<100>::Sin", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = gSinCosTable<100>.Sin(ang[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	// 各精度查询表与libm的最大误差
+
+	double err1 = 0.0, err4 = 0.0, err100 = 0.0, errRad = 0.0;
+
+	for (int i = 0; i < 100000; i++)
+	{
+		float a = RandRange(-720.0f, 720.0f);
+		double ref = sin(a * 3.14159265358979323846 / 180.0);
+
+		err1 = MAX(err1, fabs(FastSin(a) - ref));
+		err4 = MAX(err4, fabs(gSinCosTable<4>.Sin(a) - ref));
+		err100 = MAX(err100, fabs(gSinCosTable<100>.Sin(a) - ref));
+		errRad = MAX(errRad, fabs(FastSinRad(AngToRad(a)) - ref));
+	}
+
+	ctx.Report("FastSin max error", "abs", err1);
+	ctx.Report("FastSinRad max error", "abs", errRad);
+	ctx.Report("SinCosTable<4> max error", "abs", err4);
+	ctx.Report("SinCosTable<100> max error", "abs", err100);
+
+	ctx.Measure("FastDistance3D", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = FastDistance3D(v[i].x, v[i].y, v[i].z);
+		}
+		DoNotOptimize(out[0]);
+	});
+}
+
+WANDER_BENCH(MathUtils)
+{
+	std::vector<Point2D> p(KBENCHBATCH * 4);
+	std::vector<unsigned char> out(KBENCHBATCH);
+
+	for (size_t i = 0; i < p.size(); i++)
+	{
+		p[i] = Point2D(RandRange(-100.0f, 100.0f), RandRange(-100.0f, 100.0f));
+	}
+
+	ctx.Measure("IsLineInsert", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			const Point2D *s = &p[i * 4];
+			out[i] = IsLineInsert(s[0], s[1], s[2], s[3]);
+		}
+		DoNotOptimize(out[0]);
+	});
+}
@@ -0,0 +1,278 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchDualQuaternion.cpp
+// func: 对偶四元数与 Matrix4X3 在连接、混合和蒙皮上的对比
+//
+///////////////////////////////////////////////////////////////////
+
+#include <thread>
+
+#include "Bench.h"
+
+// 64根骨骼，每个顶点受4根骨骼影响
+
+const size_t KSKINBONES = 64;
+const size_t KSKININFLUENCES = 4;
+const size_t KSKINVERTICES = 1 << 16;
+
+static DualQuaternion RandRigidDualQuaternion()
+{
+	return DualQuaternion(RandUnitQuaternion(), RandVector3D(100.0f));
+}
+
+// 现有做法：每根骨骼用 FromQuaternion 转成矩阵，按权重把矩阵相加后变换顶点
+
+static void SkinMatrixBlend(const Matrix4X3 *bones, const int *boneIndex, const float *boneWeight,
+							const Point3D *in, Point3D *out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		const int *index = boneIndex + i * KSKININFLUENCES;
+		const float *weight = boneWeight + i * KSKININFLUENCES;
+
+		Matrix4X3 m = bones[index[0]] * weight[0];
+
+		for (size_t k = 1; k < KSKININFLUENCES; k++)
+		{
+			m = m + bones[index[k]] * weight[k];
+		}
+
+		out[i] = in[i] * m;
+	}
+}
+
+// 逐个顶点调用 Blend 的标量对照
+
+static void SkinBlendScalar(const DualQuaternion *bones, const int *boneIndex, const float *boneWeight,
+							const Point3D *in, Point3D *out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		DualQuaternion local[KSKININFLUENCES];
+
+		for (size_t k = 0; k < KSKININFLUENCES; k++)
+		{
+			local[k] = bones[boneIndex[i * KSKININFLUENCES + k]];
+		}
+
+		out[i] = in[i] * Blend(local, boneWeight + i * KSKININFLUENCES, KSKININFLUENCES);
+	}
+}
+
+static float MaxElementError(const Matrix4X3 &a, const Matrix4X3 &b)
+{
+	const float *pa = &a.m11;
+	const float *pb = &b.m11;
+	float maxError = 0.0f;
+
+	for (int k = 0; k < 12; k++)
+	{
+		maxError = MAX(maxError, fabsf(pa[k] - pb[k]));
+	}
+
+	return maxError;
+}
+
+WANDER_BENCH(DualQuaternion)
+{
+	std::vector<DualQuaternion> a(KBENCHBATCH), b(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<Matrix4X3> ma(KBENCHBATCH), mb(KBENCHBATCH), mout(KBENCHBATCH);
+	std::vector<Quaternion> q(KBENCHBATCH);
+	std::vector<Vector3D> t(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		a[i] = RandRigidDualQuaternion();
+		b[i] = RandRigidDualQuaternion();
+		ma[i] = a[i].ToMatrix4X3();
+		mb[i] = b[i].ToMatrix4X3();
+		q[i] = a[i].real;
+		t[i] = a[i].GetTranslation();
+	}
+
+	ctx.Measure("DualQuaternion * DualQuaternion", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = a[i] * b[i];
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("DualQuaternion ConcatenateN", KBENCHBATCH, [&]()
+	{
+		ConcatenateN(&a[0], &b[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Matrix4X3 ConcatenateN", KBENCHBATCH, [&]()
+	{
+		ConcatenateN(&ma[0], &mb[0], &mout[0], KBENCHBATCH);
+		DoNotOptimize(mout[0]);
+	});
+
+	ctx.Measure("DualQuaternion::Setup", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i].Setup(q[i], t[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("DualQuaternion::Normalize", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = a[i];
+			out[i].Normalize();
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	// 两个变换各半混合
+
+	ctx.Measure("Blend 2 DualQuaternion", KBENCHBATCH, [&]()
+	{
+		const float weights[2] = { 0.5f, 0.5f };
+
+		for (size_t i = 0; i + 1 < KBENCHBATCH; i++)
+		{
+			out[i] = Blend(&a[i], weights, 2);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Blend 2 FromQuaternion + Matrix4X3", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i + 1 < KBENCHBATCH; i++)
+		{
+			Matrix4X3 m0, m1;
+			m0.FromQuaternion(q[i]);
+			m0.SetTranslation(t[i]);
+			m1.FromQuaternion(q[i + 1]);
+			m1.SetTranslation(t[i + 1]);
+
+			mout[i] = m0 * 0.5f + m1 * 0.5f;
+		}
+		DoNotOptimize(mout[0]);
+	});
+
+	// 蒙皮：骨骼变换在绑定姿势附近，各影响的权重之和为1
+
+	std::vector<DualQuaternion> bones(KSKINBONES);
+	std::vector<Matrix4X3> boneMatrices(KSKINBONES);
+
+	for (size_t i = 0; i < KSKINBONES; i++)
+	{
+		bones[i] = RandRigidDualQuaternion();
+		boneMatrices[i] = bones[i].ToMatrix4X3();
+	}
+
+	std::vector<int> boneIndex(KSKINVERTICES * KSKININFLUENCES);
+	std::vector<float> boneWeight(KSKINVERTICES * KSKININFLUENCES);
+	std::vector<Point3D> pos(KSKINVERTICES), skinned(KSKINVERTICES), reference(KSKINVERTICES);
+	std::vector<Vector3D> normal(KSKINVERTICES), skinnedNormal(KSKINVERTICES);
+
+	for (size_t i = 0; i < KSKINVERTICES; i++)
+	{
+		float sum = 0.0f;
+
+		for (size_t k = 0; k < KSKININFLUENCES; k++)
+		{
+			boneIndex[i * KSKININFLUENCES + k] = (int)(RandFloat() * KSKINBONES) % KSKINBONES;
+			boneWeight[i * KSKININFLUENCES + k] = RandRange(0.05f, 1.0f);
+			sum += boneWeight[i * KSKININFLUENCES + k];
+		}
+
+		for (size_t k = 0; k < KSKININFLUENCES; k++)
+		{
+			boneWeight[i * KSKININFLUENCES + k] /= sum;
+		}
+
+		pos[i] = RandVector3D(2.0f);
+		normal[i] = RandVector3D(1.0f);
+		normal[i].Normalize();
+	}
+
+	ctx.Measure("Skin 4 bones Matrix4X3 blend (64K)", KSKINVERTICES, [&]()
+	{
+		SkinMatrixBlend(&boneMatrices[0], &boneIndex[0], &boneWeight[0], &pos[0], &reference[0], KSKINVERTICES);
+		DoNotOptimize(reference[0]);
+	});
+
+	ctx.Measure("Skin 4 bones Blend scalar (64K)", KSKINVERTICES, [&]()
+	{
+		SkinBlendScalar(&bones[0], &boneIndex[0], &boneWeight[0], &pos[0], &reference[0], KSKINVERTICES);
+		DoNotOptimize(reference[0]);
+	});
+
+	ctx.Measure("Skin 4 bones SkinPointsN (64K)", KSKINVERTICES, [&]()
+	{
+		SkinPointsN(&bones[0], &boneIndex[0], &boneWeight[0], KSKININFLUENCES,
+					&pos[0], NULL, &skinned[0], NULL, KSKINVERTICES);
+		DoNotOptimize(skinned[0]);
+	});
+
+	ctx.Measure("Skin 4 bones SkinPointsN + normals (64K)", KSKINVERTICES, [&]()
+	{
+		SkinPointsN(&bones[0], &boneIndex[0], &boneWeight[0], KSKININFLUENCES,
+					&pos[0], &normal[0], &skinned[0], &skinnedNormal[0], KSKINVERTICES);
+		DoNotOptimize(skinned[0]);
+	});
+
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		JobPool pool(hardwareThreads > 0 ? hardwareThreads : 1);
+
+		ctx.Measure("Skin 4 bones SkinPointsN pooled (64K)", KSKINVERTICES, [&]()
+		{
+			SkinPointsN(&bones[0], &boneIndex[0], &boneWeight[0], KSKININFLUENCES,
+						&pos[0], &normal[0], &skinned[0], &skinnedNormal[0], KSKINVERTICES, &pool);
+			DoNotOptimize(skinned[0]);
+		});
+	}
+
+	if (ctx.Enabled("DualQuaternion max error"))
+	{
+		// 连接与矩阵连接一致，与矩阵互相转换后不变
+
+		float maxError = 0.0f;
+
+		ConcatenateN(&a[0], &b[0], &out[0], KBENCHBATCH);
+
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			DualQuaternion back;
+			back.FromMatrix4X3(ma[i]);
+
+			maxError = MAX(maxError, MaxElementError(out[i].ToMatrix4X3(), ma[i] * mb[i]));
+			maxError = MAX(maxError, MaxElementError((a[i] * b[i]).ToMatrix4X3(), ma[i] * mb[i]));
+			maxError = MAX(maxError, MaxElementError(back.ToMatrix4X3(), ma[i]));
+		}
+
+		ctx.Report("DualQuaternion max error", "abs", (double)maxError);
+	}
+
+	// 批量蒙皮与逐个调用 Blend 一致，法线保持单位长度
+
+	if (ctx.Enabled("SkinPointsN max error"))
+	{
+		JobPool pool(4);
+		SkinBlendScalar(&bones[0], &boneIndex[0], &boneWeight[0], &pos[0], &reference[0], KSKINVERTICES);
+		SkinPointsN(&bones[0], &boneIndex[0], &boneWeight[0], KSKININFLUENCES,
+					&pos[0], &normal[0], &skinned[0], &skinnedNormal[0], KSKINVERTICES, &pool);
+
+		float skinError = 0.0f;
+		float normalError = 0.0f;
+
+		for (size_t i = 0; i < KSKINVERTICES; i++)
+		{
+			skinError = MAX(skinError, GetMag(skinned[i] - reference[i]));
+			normalError = MAX(normalError, fabsf(GetMag(skinnedNormal[i]) - 1.0f));
+		}
+
+		ctx.Report("SkinPointsN max error", "abs", (double)skinError);
+		ctx.Report("SkinPointsN normal length error", "abs", (double)normalError);
+	}
+}
@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchEulerBatch.cpp
+// func: 欧拉角批量建立矩阵的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+// 两个矩阵各元素差的最大值
+
+static float MaxDiff(const float *a, const float *b, size_t count)
+{
+	float d = 0.0f;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		d = MAX(d, fabs(a[i] - b[i]));
+	}
+
+	return d;
+}
+
+WANDER_BENCH(EulerAnglesBatch)
+{
+	// 数量故意不是SIMD宽度的整数倍，覆盖尾部处理
+
+	const size_t n = KBENCHBATCH + 3;
+
+	std::vector<Point3D> pos(n);
+	std::vector<EulerAngles> angles(n);
+	std::vector<Matrix4X3> out(n), ref(n);
+	std::vector<RotationMatrix> rot(n), rotRef(n);
+	std::vector<float> heading(n), pitch(n), bank(n);
+	Point3DSoA posSoA(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		pos[i] = RandVector3D(100.0f);
+		angles[i] = RandEulerAngles();
+		posSoA.Set(i, pos[i]);
+		heading[i] = angles[i].heading;
+		pitch[i] = angles[i].pitch;
+		bank[i] = angles[i].bank;
+	}
+
+	ctx.Measure("SetupLocalToParent scalar loop", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i].SetupLocalToParent(pos[i], angles[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("BuildLocalToParentN AoS", n, [&]()
+	{
+		BuildLocalToParentN(&pos[0], &angles[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("BuildLocalToParentN SoA", n, [&]()
+	{
+		BuildLocalToParentN(posSoA, &heading[0], &pitch[0], &bank[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("SetupParentToLocal scalar loop", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i].SetupParentToLocal(pos[i], angles[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("BuildParentToLocalN SoA", n, [&]()
+	{
+		BuildParentToLocalN(posSoA, &heading[0], &pitch[0], &bank[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("RotationMatrix::Setup scalar loop", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			rot[i].Setup(angles[i]);
+		}
+		DoNotOptimize(rot[0]);
+	});
+
+	ctx.Measure("BuildRotationMatrixN SoA", n, [&]()
+	{
+		BuildRotationMatrixN(&heading[0], &pitch[0], &bank[0], &rot[0], n);
+		DoNotOptimize(rot[0]);
+	});
+
+	// 与标量版本的最大误差
+
+	float errL2P = 0.0f, errP2L = 0.0f, errRot = 0.0f;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		ref[i].SetupLocalToParent(pos[i], angles[i]);
+	}
+	BuildLocalToParentN(&pos[0], &angles[0], &out[0], n);
+	errL2P = MAX(errL2P, MaxDiff(&out[0].m11, &ref[0].m11, n * 12));
+	BuildLocalToParentN(posSoA, &heading[0], &pitch[0], &bank[0], &out[0], n);
+	errL2P = MAX(errL2P, MaxDiff(&out[0].m11, &ref[0].m11, n * 12));
+
+	for (size_t i = 0; i < n; i++)
+	{
+		ref[i].SetupParentToLocal(pos[i], angles[i]);
+	}
+	BuildParentToLocalN(&pos[0], &angles[0], &out[0], n);
+	errP2L = MAX(errP2L, MaxDiff(&out[0].m11, &ref[0].m11, n * 12));
+	BuildParentToLocalN(posSoA, &heading[0], &pitch[0], &bank[0], &out[0], n);
+	errP2L = MAX(errP2L, MaxDiff(&out[0].m11, &ref[0].m11, n * 12));
+
+	for (size_t i = 0; i < n; i++)
+	{
+		rotRef[i].Setup(angles[i]);
+	}
+	BuildRotationMatrixN(&angles[0], &rot[0], n);
+	errRot = MAX(errRot, MaxDiff(&rot[0].m11, &rotRef[0].m11, n * 9));
+	BuildRotationMatrixN(&heading[0], &pitch[0], &bank[0], &rot[0], n);
+	errRot = MAX(errRot, MaxDiff(&rot[0].m11, &rotRef[0].m11, n * 9));
+
+	ctx.Report("BuildLocalToParentN max error", "abs", errL2P);
+	ctx.Report("BuildParentToLocalN max error", "abs", errP2L);
+	ctx.Report("BuildRotationMatrixN max error", "abs", errRot);
+}
@@ -0,0 +1,138 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchFrustum.cpp
+// func: 视锥体剔除的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "Bench.h"
+
+// 每个视图的对象数
+
+const size_t KCULLOBJECTS = 500000;
+
+WANDER_BENCH(Frustum)
+{
+	const size_t n = KCULLOBJECTS;
+
+	// 相机在原点附近，对象散布在周围的立方体中，约1/6在视锥体内
+
+	Frustum frustum;
+	frustum.FromCamera(Vector3D(0.0f, 0.0f, 0.0f), EulerAngles(0.3f, 0.1f, 0.0f),
+					   KPIOVER2, 16.0f / 9.0f, 0.1f, 500.0f);
+
+	Point3DSoA centers(n);
+	Vector3DSoA extents(n);
+	std::vector<float> radius(n);
+
+	// 场景中的对象通常按空间位置分块存放，按40单位的网格排序模拟这种相关性，
+	// 同一组的对象多在前几个平面就被整组剔除
+
+	std::vector<Vector3D> positions(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		positions[i] = RandVector3D(600.0f);
+	}
+
+	std::sort(positions.begin(), positions.end(), [](const Vector3D &p, const Vector3D &q)
+	{
+		int pk[3] = {(int)floor(p.x / 40.0f), (int)floor(p.z / 40.0f), (int)floor(p.y / 40.0f)};
+		int qk[3] = {(int)floor(q.x / 40.0f), (int)floor(q.z / 40.0f), (int)floor(q.y / 40.0f)};
+		return std::lexicographical_compare(pk, pk + 3, qk, qk + 3);
+	});
+
+	for (size_t i = 0; i < n; i++)
+	{
+		Vector3D e(RandRange(0.5f, 4.0f), RandRange(0.5f, 4.0f), RandRange(0.5f, 4.0f));
+
+		centers.Set(i, positions[i]);
+		extents.Set(i, e);
+		radius[i] = GetMag(e);
+	}
+
+	std::vector<unsigned char> visible(n);
+	size_t visibleCount = 0;
+
+	ctx.Measure("Frustum sphere scalar loop (500K)", n, [&]()
+	{
+		size_t count = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			count += frustum.IsSphereVisible(centers.Get(i), radius[i]) ? 1 : 0;
+		}
+		DoNotOptimize(count);
+	});
+
+	ctx.Measure("Frustum CullSpheres (500K)", n, [&]()
+	{
+		visibleCount = frustum.CullSpheres(centers, &radius[0], &visible[0]);
+		DoNotOptimize(visible[0]);
+	});
+
+	ctx.Report("Frustum visible spheres", "objects", (double)visibleCount);
+
+	ctx.Measure("Frustum AABB scalar loop (500K)", n, [&]()
+	{
+		size_t count = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			count += frustum.IsAabbVisible(centers.Get(i), extents.Get(i)) ? 1 : 0;
+		}
+		DoNotOptimize(count);
+	});
+
+	ctx.Measure("Frustum CullAabbs (500K)", n, [&]()
+	{
+		frustum.CullAabbs(centers, extents, &visible[0]);
+		DoNotOptimize(visible[0]);
+	});
+
+	// 批量结果与逐个测试的结果应完全一致
+
+	if (ctx.Enabled("Frustum mismatches"))
+	{
+		size_t mismatches = 0;
+
+		frustum.CullSpheres(centers, &radius[0], &visible[0]);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			mismatches += (visible[i] != 0) != frustum.IsSphereVisible(centers.Get(i), radius[i]) ? 1 : 0;
+		}
+
+		frustum.CullAabbs(centers, extents, &visible[0]);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			mismatches += (visible[i] != 0) != frustum.IsAabbVisible(centers.Get(i), extents.Get(i)) ? 1 : 0;
+		}
+
+		// 对象个数不是SIMD宽度的整数倍时，尾部一组同样要与逐个测试一致
+
+		Point3DSoA tailCenters(centers);
+		tailCenters.Resize(n - 3);
+
+		frustum.CullSpheres(tailCenters, &radius[0], &visible[0]);
+
+		for (size_t i = 0; i < n - 3; i++)
+		{
+			mismatches += (visible[i] != 0) != frustum.IsSphereVisible(centers.Get(i), radius[i]) ? 1 : 0;
+		}
+
+		// 相机正前方的点可见，正后方的不可见
+
+		Matrix4X3 cameraToWorld;
+		cameraToWorld.SetupLocalToParent(Vector3D(0.0f, 0.0f, 0.0f), EulerAngles(0.3f, 0.1f, 0.0f));
+
+		mismatches += frustum.IsSphereVisible(Vector3D(0.0f, 0.0f, 10.0f) * cameraToWorld, 0.0f) ? 0 : 1;
+		mismatches += frustum.IsSphereVisible(Vector3D(0.0f, 0.0f, -10.0f) * cameraToWorld, 0.0f) ? 1 : 0;
+		mismatches += frustum.IsSphereVisible(Vector3D(0.0f, 0.0f, 600.0f) * cameraToWorld, 0.0f) ? 1 : 0;
+
+		ctx.Report("Frustum mismatches", "objects", (double)mismatches);
+	}
+}
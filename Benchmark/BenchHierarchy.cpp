@@ -0,0 +1,341 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchHierarchy.cpp
+// func: 变换层次结构世界矩阵计算的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "Bench.h"
+
+const size_t KHIERARCHYNODES = 200000;
+
+// 逐个分配、用指针相连的传统场景节点，作为对照
+
+struct SceneNode
+{
+	Matrix4X3 local;
+	Matrix4X3 world;
+	std::vector<SceneNode *> children;
+};
+
+static void UpdateSceneNode(SceneNode *node, const Matrix4X3 &parentWorld)
+{
+	node->world = node->local * parentWorld;
+
+	for (size_t i = 0; i < node->children.size(); i++)
+	{
+		UpdateSceneNode(node->children[i], node->world);
+	}
+}
+
+// 按广度优先顺序生成随机层次：每个节点有0到7个子节点，直到节点数足够
+
+static void BuildRandomHierarchy(TransformHierarchy &h, size_t count)
+{
+	h.Clear();
+	h.Reserve(count);
+
+	for (int i = 0; i < 16; i++)
+	{
+		h.AddNode(TransformHierarchy::KNOPARENT, RandRigidMatrix());
+	}
+
+	for (size_t i = 0; h.Size() < count; i++)
+	{
+		int children = rand() % 8;
+
+		for (int k = 0; k < children && h.Size() < count; k++)
+		{
+			h.AddNode((int)i, RandRigidMatrix());
+		}
+	}
+}
+
+WANDER_BENCH(TransformHierarchy)
+{
+	const size_t n = KHIERARCHYNODES;
+
+	TransformHierarchy h;
+	BuildRandomHierarchy(h, n);
+
+	// 同样的层次用指针节点再建一份
+
+	std::vector<std::unique_ptr<SceneNode> > nodes(n);
+	std::vector<SceneNode *> roots;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		nodes[i].reset(new SceneNode);
+		nodes[i]->local = h.Local(i);
+
+		if (h.Parent(i) == TransformHierarchy::KNOPARENT)
+		{
+			roots.push_back(nodes[i].get());
+		}
+		else
+		{
+			nodes[h.Parent(i)]->children.push_back(nodes[i].get());
+		}
+	}
+
+	Matrix4X3 identity;
+
+	ctx.Measure("Hierarchy pointer nodes (200K)", n, [&]()
+	{
+		for (size_t i = 0; i < roots.size(); i++)
+		{
+			UpdateSceneNode(roots[i], identity);
+		}
+		DoNotOptimize(roots[0]->world);
+	});
+
+	std::vector<Matrix4X3> world(n);
+
+	ctx.Measure("Hierarchy flat scalar loop (200K)", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			int parent = h.Parent(i);
+			world[i] = parent == TransformHierarchy::KNOPARENT ? h.Local(i) : h.Local(i) * world[parent];
+		}
+		DoNotOptimize(world[0]);
+	});
+
+	ctx.Measure("Hierarchy UpdateWorld 1 thread (200K)", n, [&]()
+	{
+		h.UpdateWorld();
+		DoNotOptimize(h.World(0));
+	});
+
+	// 线程数逐次加倍直到硬件线程数
+
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+	hardwareThreads = hardwareThreads > 0 ? hardwareThreads : 1;
+
+	for (unsigned threads = 2; ; threads *= 2)
+	{
+		threads = threads > hardwareThreads ? hardwareThreads : threads;
+
+		char name[64];
+		snprintf(name, sizeof(name), "Hierarchy UpdateWorld %u threads (200K)", threads);
+
+		if (threads > 1 && ctx.Enabled(name))
+		{
+			JobPool pool(threads);
+
+			ctx.Measure(name, n, [&]()
+			{
+				h.UpdateWorld(&pool);
+				DoNotOptimize(h.World(0));
+			});
+		}
+
+		if (threads >= hardwareThreads)
+		{
+			break;
+		}
+	}
+
+	ctx.Report("Hierarchy levels", "levels", (double)h.LevelCount());
+
+	// 与逐节点 operator * 的结果比较
+
+	if (ctx.Enabled("Hierarchy max error"))
+	{
+		JobPool pool(4);
+		h.UpdateWorld(&pool);
+
+		float maxError = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			const float *a = &h.World(i).m11;
+			const float *b = &world[i].m11;
+
+			for (int k = 0; k < 12; k++)
+			{
+				maxError = MAX(maxError, fabs(a[k] - b[k]));
+			}
+		}
+
+		ctx.Report("Hierarchy max error", "abs", maxError);
+	}
+
+	// 不按广度优先顺序或父节点不存在的 AddNode 被拒绝，且不改变已有的层
+
+	if (ctx.Enabled("Hierarchy rejected adds"))
+	{
+		TransformHierarchy small;
+		int root = small.AddNode(TransformHierarchy::KNOPARENT, RandRigidMatrix());
+		small.AddNode(root, RandRigidMatrix());
+
+		size_t size = small.Size();
+		size_t levels = small.LevelCount();
+		size_t wrong = 0;
+
+		wrong += small.AddNode(TransformHierarchy::KNOPARENT, RandRigidMatrix()) != -1 ? 1 : 0;
+		wrong += small.AddNode(5, RandRigidMatrix()) != -1 ? 1 : 0;
+		wrong += small.AddNode(-3, RandRigidMatrix()) != -1 ? 1 : 0;
+		wrong += small.Size() != size || small.LevelCount() != levels || small.LevelBegin(1) != 1 ? 1 : 0;
+
+		small.UpdateWorld();
+
+		ctx.Report("Hierarchy rejected adds", "failures", (double)wrong);
+		ctx.Check("Hierarchy rejected adds", wrong == 0);
+	}
+}
+
+// 每帧只有1%的节点移动
+
+WANDER_BENCH(IncrementalTransformHierarchy)
+{
+	const size_t n = KHIERARCHYNODES;
+	const size_t moving = n / 100;
+
+	TransformHierarchy shape;
+	BuildRandomHierarchy(shape, n);
+
+	IncrementalTransformHierarchy h;
+	h.Reserve(n);
+
+	std::vector<Point3D> pos(n);
+	std::vector<EulerAngles> angles(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		pos[i] = RandVector3D(100.0f);
+		angles[i] = RandEulerAngles();
+		h.AddNode(shape.Parent(i), pos[i], angles[i], Vector3D(RandRange(0.5f, 2.0f), 1.0f, 1.0f));
+	}
+
+	h.Update();
+
+	std::vector<size_t> movers(moving);
+
+	for (size_t i = 0; i < moving; i++)
+	{
+		movers[i] = (size_t)rand() % n;
+	}
+
+	// 对照：每帧重建所有矩阵并重新连接
+
+	std::vector<Matrix4X3> toParent(n), toLocal(n), world(n);
+
+	ctx.Measure("Hierarchy full rebuild per frame (200K)", n, [&]()
+	{
+		for (size_t i = 0; i < moving; i++)
+		{
+			angles[movers[i]].heading += 0.01f;
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			toParent[i].SetupLocalToParent(pos[i], angles[i]);
+			toLocal[i].SetupParentToLocal(pos[i], angles[i]);
+
+			int parent = shape.Parent(i);
+			world[i] = parent == TransformHierarchy::KNOPARENT ? toParent[i] : toParent[i] * world[parent];
+		}
+		DoNotOptimize(world[0]);
+	});
+
+	size_t recomputed = 0;
+
+	ctx.Measure("Hierarchy incremental 1% moving (200K)", n, [&]()
+	{
+		for (size_t i = 0; i < moving; i++)
+		{
+			size_t node = movers[i];
+			EulerAngles a = h.Orientation(node);
+			a.heading += 0.01f;
+			h.SetOrientation(node, a);
+		}
+
+		recomputed = h.Update();
+		DoNotOptimize(h.LocalToWorld(0));
+	});
+
+	ctx.Report("Hierarchy incremental local rebuilds", "nodes/frame", (double)h.LocalRebuildCount());
+	ctx.Report("Hierarchy incremental world rebuilds", "nodes/frame", (double)recomputed);
+
+	ctx.Measure("Hierarchy incremental no change (200K)", n, [&]()
+	{
+		DoNotOptimize(h.Update());
+	});
+
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		JobPool pool(hardwareThreads > 0 ? hardwareThreads : 1);
+
+		ctx.Measure("Hierarchy incremental 1% moving pooled (200K)", n, [&]()
+		{
+			for (size_t i = 0; i < moving; i++)
+			{
+				size_t node = movers[i];
+				EulerAngles a = h.Orientation(node);
+				a.heading += 0.01f;
+				h.SetOrientation(node, a);
+			}
+
+			DoNotOptimize(h.Update(&pool));
+		});
+	}
+
+	// 并行更新与单线程更新的结果应逐位一致
+
+	if (ctx.Enabled("Hierarchy incremental pooled mismatches"))
+	{
+		JobPool pool(4);
+		IncrementalTransformHierarchy pooled(h);
+		size_t mismatches = 0;
+
+		for (int frame = 0; frame < 4; frame++)
+		{
+			for (size_t i = 0; i < moving * (frame + 1); i++)
+			{
+				size_t node = (size_t)rand() % n;
+				EulerAngles a = h.Orientation(node);
+				a.heading += 0.01f;
+				h.SetOrientation(node, a);
+				pooled.SetOrientation(node, a);
+			}
+
+			mismatches += h.Update() != pooled.Update(&pool) ? 1 : 0;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				mismatches += memcmp(&h.LocalToWorld(i), &pooled.LocalToWorld(i), sizeof(Matrix4X3)) != 0 ? 1 : 0;
+				mismatches += memcmp(&h.ParentToLocal(i), &pooled.ParentToLocal(i), sizeof(Matrix4X3)) != 0 ? 1 : 0;
+			}
+		}
+
+		ctx.Report("Hierarchy incremental pooled mismatches", "nodes", (double)mismatches);
+	}
+
+	// 带缩放时 本地->父 与 父->本地 互逆
+
+	if (ctx.Enabled("Hierarchy ParentToLocal max error"))
+	{
+		float maxError = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			Matrix4X3 m = h.LocalToParent(i) * h.ParentToLocal(i);
+			Matrix4X3 identity;
+
+			const float *a = &m.m11;
+			const float *b = &identity.m11;
+
+			for (int k = 0; k < 12; k++)
+			{
+				maxError = MAX(maxError, fabs(a[k] - b[k]));
+			}
+		}
+
+		ctx.Report("Hierarchy ParentToLocal max error", "abs", maxError);
+	}
+}
@@ -0,0 +1,224 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchJobPool.cpp
+// func: 工作窃取线程池的调度开销与批量内核的并行扩展
+//
+///////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <thread>
+
+#include "Bench.h"
+
+const size_t KJOBPOINTS = 1 << 20;
+const size_t KJOBMATRICES = 1 << 18;
+
+// 每个元素的耗时与下标成正比，前面的块很快、后面的块很慢，
+// 平均分配时最后一个线程拖慢整体，用来观察窃取的效果
+
+static float SkewedWork(size_t i, size_t n)
+{
+	float x = (float)i;
+	size_t steps = 1 + i * 64 / n;
+
+	for (size_t k = 0; k < steps; k++)
+	{
+		x = x * 0.999f + 1.0f;
+	}
+
+	return x;
+}
+
+// 池上运行的批量内核与串行结果逐位比较，返回不一致的内核个数
+
+static size_t CheckPooledKernels(JobPool &pool)
+{
+	size_t mismatches = 0;
+	size_t n = KJOBBATCHGRAIN * 5 + 13;
+
+	Point3DSoA in(n), serial(n), pooled(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		in.Set(i, RandVector3D(100.0f));
+	}
+
+	Matrix4X3 m = RandRigidMatrix();
+
+	TransformPoints(m, in, serial, n);
+	TransformPoints(m, in, pooled, n, &pool);
+	mismatches += memcmp(serial.x, pooled.x, n * sizeof(float)) != 0 ? 1 : 0;
+
+	std::vector<Matrix4X3> a(n), b(n), r0(n), r1(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i] = RandRigidMatrix();
+		b[i] = RandRigidMatrix();
+	}
+
+	ConcatenateN(&a[0], &b[0], &r0[0], n);
+	ConcatenateN(&a[0], &b[0], &r1[0], n, &pool);
+	mismatches += memcmp(&r0[0], &r1[0], n * sizeof(Matrix4X3)) != 0 ? 1 : 0;
+
+	size_t s0 = InverseN(&a[0], &r0[0], n);
+	size_t s1 = InverseN(&a[0], &r1[0], n, NULL, &pool);
+	mismatches += s0 != s1 || memcmp(&r0[0], &r1[0], n * sizeof(Matrix4X3)) != 0 ? 1 : 0;
+
+	std::vector<Quaternion> q0(n), q1(n), o0(n), o1(n);
+	std::vector<float> t(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		q0[i] = RandUnitQuaternion();
+		q1[i] = RandUnitQuaternion();
+		t[i] = RandFloat();
+	}
+
+	SlerpN(&q0[0], &q1[0], &t[0], &o0[0], n);
+	SlerpN(&q0[0], &q1[0], &t[0], &o1[0], n, &pool);
+	mismatches += memcmp(&o0[0], &o1[0], n * sizeof(Quaternion)) != 0 ? 1 : 0;
+
+	std::vector<Point3D> pos(n);
+	std::vector<EulerAngles> angles(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		pos[i] = RandVector3D(100.0f);
+		angles[i] = RandEulerAngles();
+	}
+
+	BuildLocalToParentN(&pos[0], &angles[0], &r0[0], n);
+	BuildLocalToParentN(&pos[0], &angles[0], &r1[0], n, &pool);
+	mismatches += memcmp(&r0[0], &r1[0], n * sizeof(Matrix4X3)) != 0 ? 1 : 0;
+
+	// 每个块都完整执行一次，且只执行一次；每次调用恰好是按 grain 对齐的一块
+
+	std::vector<std::atomic<int> > hits(n);
+	std::atomic<int> badBlocks(0);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		hits[i].store(0);
+	}
+
+	pool.ParallelFor(0, n, 97, [&](size_t begin, size_t end)
+	{
+		if (begin % 97 != 0 || end - begin != MIN((size_t)97, n - begin))
+		{
+			badBlocks.fetch_add(1);
+		}
+
+		float *scratch = pool.Arena().AllocateArray<float>(end - begin);
+
+		for (size_t i = begin; i < end; i++)
+		{
+			scratch[i - begin] = (float)i;
+			hits[i].fetch_add(1);
+		}
+	});
+
+	size_t wrong = 0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		wrong += hits[i].load() != 1 ? 1 : 0;
+	}
+
+	mismatches += wrong != 0 || badBlocks.load() != 0 ? 1 : 0;
+
+	return mismatches;
+}
+
+WANDER_BENCH(JobPool)
+{
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+	hardwareThreads = hardwareThreads > 0 ? hardwareThreads : 1;
+
+	// 空任务：只有唤醒、分块与等待的开销
+
+	{
+		JobPool pool(hardwareThreads);
+
+		ctx.Measure("JobPool empty ParallelFor (64 blocks)", 1, [&]()
+		{
+			pool.ParallelFor(0, 64, 1, [](size_t, size_t) {});
+		});
+	}
+
+	std::vector<float> skewed(KJOBPOINTS / 4);
+
+	Point3DSoA in(KJOBPOINTS), out(KJOBPOINTS);
+
+	for (size_t i = 0; i < KJOBPOINTS; i++)
+	{
+		in.Set(i, RandVector3D(100.0f));
+	}
+
+	Matrix4X3 m = RandRigidMatrix();
+
+	std::vector<Matrix4X3> a(KJOBMATRICES), b(KJOBMATRICES), r(KJOBMATRICES);
+
+	for (size_t i = 0; i < KJOBMATRICES; i++)
+	{
+		a[i] = RandRigidMatrix();
+		b[i] = RandRigidMatrix();
+	}
+
+	// 线程数逐次加倍直到硬件线程数，1个线程时与不传 pool 相同
+
+	for (unsigned threads = 1; ; threads *= 2)
+	{
+		threads = threads > hardwareThreads ? hardwareThreads : threads;
+
+		JobPool pool(threads);
+		char name[80];
+
+		snprintf(name, sizeof(name), "JobPool skewed work %u threads (256K)", threads);
+
+		ctx.Measure(name, skewed.size(), [&]()
+		{
+			pool.ParallelFor(0, skewed.size(), 1024, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					skewed[i] = SkewedWork(i, skewed.size());
+				}
+			});
+
+			DoNotOptimize(skewed[0]);
+		});
+
+		snprintf(name, sizeof(name), "JobPool TransformPoints %u threads (1M)", threads);
+
+		ctx.Measure(name, KJOBPOINTS, [&]()
+		{
+			TransformPoints(m, in, out, KJOBPOINTS, &pool);
+			DoNotOptimize(out.x[0]);
+		});
+
+		snprintf(name, sizeof(name), "JobPool ConcatenateN %u threads (256K)", threads);
+
+		ctx.Measure(name, KJOBMATRICES, [&]()
+		{
+			ConcatenateN(&a[0], &b[0], &r[0], KJOBMATRICES, &pool);
+			DoNotOptimize(r[0]);
+		});
+
+		if (threads >= hardwareThreads)
+		{
+			break;
+		}
+	}
+
+	if (ctx.Enabled("JobPool kernel mismatches"))
+	{
+		JobPool pool(4);
+		JobPool pinned(4, true);
+		JobPool single(1);
+
+		size_t mismatches = CheckPooledKernels(pool) + CheckPooledKernels(pinned) + CheckPooledKernels(single);
+		ctx.Report("JobPool kernel mismatches", "kernels", (double)mismatches);
+		ctx.Check("JobPool kernel mismatches", mismatches == 0);
+	}
+}
@@ -0,0 +1,309 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchKdTree.cpp
+// func: 隐式k-d树与线性扫描最近邻的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "Bench.h"
+
+// 点散布在 1000x50x1000 的场景中，类似地面上的导航点与出生点
+
+const size_t KKDSMALL = 10000;
+const size_t KKDLARGE = 100000;
+const size_t KKDQUERIES = 65536;
+const size_t KKDKNN = 8;
+const float KKDRADIUS = 12.0f;
+
+static void RandomScenePoints(std::vector<Point3D> &points, size_t n)
+{
+	points.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		points[i].Init(RandRange(-500.0f, 500.0f), RandRange(0.0f, 50.0f), RandRange(-500.0f, 500.0f));
+	}
+}
+
+// 原来的做法：用 GetDistance 逐个比较
+
+static int LinearNearest(const std::vector<Point3D> &points, const Point3D &p)
+{
+	int best = KKDNOPOINT;
+	float bestDist = 3.4e38f;
+
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		float d = GetDistance(points[i], p);
+
+		if (d < bestDist)
+		{
+			bestDist = d;
+			best = (int)i;
+		}
+	}
+
+	return best;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point begin)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// 校验查询结果，返回不一致的查询个数
+
+static size_t CheckKdTree(const KdTree3D &tree, const std::vector<Point3D> &points, const std::vector<Point3D> &queries)
+{
+	size_t mismatches = 0;
+	std::vector<float> all(points.size());
+	std::vector<int> a, b;
+
+	for (size_t q = 0; q < 100; q++)
+	{
+		const Point3D &c = queries[q];
+
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			Vector3D d = points[i] - c;
+			all[i] = d * d;
+		}
+
+		// k近邻比较第k个距离，避免距离相等时编号不同
+
+		int ids[KKDKNN];
+		float dist[KKDKNN];
+		size_t found = tree.QueryKNearest(c, KKDKNN, ids, dist);
+
+		std::vector<float> sorted(all);
+		std::nth_element(sorted.begin(), sorted.begin() + (KKDKNN - 1), sorted.end());
+		mismatches += found != KKDKNN || dist[KKDKNN - 1] != sorted[KKDKNN - 1] ? 1 : 0;
+
+		float nearestSq;
+		int nearest = tree.QueryNearest(c, &nearestSq);
+		mismatches += nearest < 0 || all[nearest] != nearestSq || nearestSq != dist[0] ? 1 : 0;
+
+		a.clear();
+		b.clear();
+		tree.QueryRadius(c, KKDRADIUS, a);
+
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			if (all[i] <= KKDRADIUS * KKDRADIUS)
+			{
+				b.push_back((int)i);
+			}
+		}
+
+		std::sort(a.begin(), a.end());
+		mismatches += a != b ? 1 : 0;
+	}
+
+	// 批量查询与逐个查询的结果一致
+
+	JobPool pool(4);
+	size_t n = 4096;
+	std::vector<int> ids(n * KKDKNN);
+	std::vector<float> dist(n * KKDKNN);
+	tree.QueryKNearestN(&queries[0], n, KKDKNN, &ids[0], &dist[0], &pool);
+
+	std::vector<int> neighbours;
+	std::vector<uint32_t> start, count;
+	tree.QueryRadiusN(&queries[0], n, KKDRADIUS, neighbours, start, count, &pool);
+
+	for (size_t i = 0; i < n; i += 7)
+	{
+		int one[KKDKNN];
+		float oneDist[KKDKNN];
+		tree.QueryKNearest(queries[i], KKDKNN, one, oneDist);
+		mismatches += memcmp(oneDist, &dist[i * KKDKNN], sizeof(oneDist)) != 0 ? 1 : 0;
+
+		a.clear();
+		tree.QueryRadius(queries[i], KKDRADIUS, a);
+		mismatches += a != std::vector<int>(neighbours.begin() + start[i], neighbours.begin() + start[i] + count[i]) ? 1 : 0;
+	}
+
+	// 不用线程池、只有调用者一个线程与多个线程时半径查询的结果逐项相同，
+	// 且每个查询的结果都在 neighbours 之内
+
+	n = MIN(queries.size(), (size_t)20000);
+
+	std::vector<int> serial;
+	std::vector<uint32_t> serialStart, serialCount;
+	tree.QueryRadiusN(&queries[0], n, KKDRADIUS, serial, serialStart, serialCount);
+
+	for (unsigned threads = 1; threads <= 4; threads += 3)
+	{
+		JobPool sized(threads);
+		tree.QueryRadiusN(&queries[0], n, KKDRADIUS, neighbours, start, count, &sized);
+
+		mismatches += neighbours != serial ? 1 : 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			bool inside = (size_t)start[i] + count[i] <= neighbours.size();
+			mismatches += !inside || start[i] != serialStart[i] || count[i] != serialCount[i] ? 1 : 0;
+		}
+	}
+
+	return mismatches;
+}
+
+WANDER_BENCH(KdTree3D)
+{
+	std::vector<Point3D> small, large, queries;
+	RandomScenePoints(small, KKDSMALL);
+	RandomScenePoints(large, KKDLARGE);
+	RandomScenePoints(queries, KKDQUERIES);
+
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+	hardwareThreads = hardwareThreads > 0 ? hardwareThreads : 1;
+
+	KdTree3D smallTree, tree;
+	smallTree.Build(&small[0], small.size());
+
+	ctx.Measure("KdTree build 1 thread (100K)", KKDLARGE, [&]()
+	{
+		tree.Build(&large[0], large.size());
+		DoNotOptimize(tree.Size());
+	});
+
+	if (hardwareThreads > 1)
+	{
+		JobPool pool(hardwareThreads);
+
+		char name[64];
+		snprintf(name, sizeof(name), "KdTree build %u threads (100K)", hardwareThreads);
+
+		ctx.Measure(name, KKDLARGE, [&]()
+		{
+			tree.Build(&large[0], large.size(), &pool);
+			DoNotOptimize(tree.Size());
+		});
+	}
+
+	tree.Build(&large[0], large.size());
+
+	ctx.Measure("KdTree linear scan nearest (10K)", 64, [&]()
+	{
+		int sum = 0;
+
+		for (size_t i = 0; i < 64; i++)
+		{
+			sum += LinearNearest(small, queries[i]);
+		}
+
+		DoNotOptimize(sum);
+	});
+
+	ctx.Measure("KdTree nearest (10K)", KKDQUERIES, [&]()
+	{
+		int sum = 0;
+
+		for (size_t i = 0; i < KKDQUERIES; i++)
+		{
+			sum += smallTree.QueryNearest(queries[i]);
+		}
+
+		DoNotOptimize(sum);
+	});
+
+	ctx.Measure("KdTree linear scan nearest (100K)", 16, [&]()
+	{
+		int sum = 0;
+
+		for (size_t i = 0; i < 16; i++)
+		{
+			sum += LinearNearest(large, queries[i]);
+		}
+
+		DoNotOptimize(sum);
+	});
+
+	ctx.Measure("KdTree nearest (100K)", KKDQUERIES, [&]()
+	{
+		int sum = 0;
+
+		for (size_t i = 0; i < KKDQUERIES; i++)
+		{
+			sum += tree.QueryNearest(queries[i]);
+		}
+
+		DoNotOptimize(sum);
+	});
+
+	if (ctx.Enabled("KdTree speedup over linear scan (100K)"))
+	{
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		int sum = 0;
+
+		for (size_t i = 0; i < 64; i++)
+		{
+			sum += LinearNearest(large, queries[i]);
+		}
+
+		double linear = Seconds(begin) / 64;
+
+		begin = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < KKDQUERIES; i++)
+		{
+			sum += tree.QueryNearest(queries[i]);
+		}
+
+		double kd = Seconds(begin) / KKDQUERIES;
+		DoNotOptimize(sum);
+
+		ctx.Report("KdTree speedup over linear scan (100K)", "x", linear / kd);
+	}
+
+	std::vector<int> ids(KKDQUERIES * KKDKNN);
+
+	ctx.Measure("KdTree kNN k=8 batch (100K)", KKDQUERIES, [&]()
+	{
+		tree.QueryKNearestN(&queries[0], KKDQUERIES, KKDKNN, &ids[0]);
+		DoNotOptimize(ids[0]);
+	});
+
+	std::vector<int> neighbours;
+	std::vector<uint32_t> start, count;
+
+	ctx.Measure("KdTree radius 12 batch (100K)", KKDQUERIES, [&]()
+	{
+		tree.QueryRadiusN(&queries[0], KKDQUERIES, KKDRADIUS, neighbours, start, count);
+		DoNotOptimize(neighbours.size());
+	});
+
+	ctx.Report("KdTree neighbours per query", "avg", (double)neighbours.size() / KKDQUERIES);
+
+	if (hardwareThreads > 1)
+	{
+		JobPool pool(hardwareThreads);
+
+		char name[64];
+		snprintf(name, sizeof(name), "KdTree kNN k=8 batch %u threads (100K)", hardwareThreads);
+
+		ctx.Measure(name, KKDQUERIES, [&]()
+		{
+			tree.QueryKNearestN(&queries[0], KKDQUERIES, KKDKNN, &ids[0], NULL, &pool);
+			DoNotOptimize(ids[0]);
+		});
+	}
+
+	if (ctx.Enabled("KdTree mismatches"))
+	{
+		JobPool pool(4);
+		size_t mismatches = 0;
+
+		tree.Build(&large[0], large.size(), &pool);
+		mismatches += CheckKdTree(tree, large, queries);
+		mismatches += CheckKdTree(smallTree, small, queries);
+
+		ctx.Report("KdTree mismatches", "queries", (double)mismatches);
+		ctx.Check("KdTree mismatches", mismatches == 0);
+	}
+}
@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchMain.cpp
+// func: wandermath_bench 入口
+// 用法: wandermath_bench [过滤串] [--min-time 秒]
+//       有校验失败时返回1
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <cstdlib>
+
+int main(int argc, char **argv)
+{
+	BenchContext ctx;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+		{
+			ctx.minSeconds = atof(argv[++i]);
+		}
+		else
+		{
+			ctx.filter = argv[i];
+		}
+	}
+
+	std::vector<BenchEntry> &registry = BenchRegistry();
+
+	for (size_t i = 0; i < registry.size(); i++)
+	{
+		// 每个用例使用相同的随机序列，结果可重复
+
+		srand(12345);
+		registry[i].func(ctx);
+	}
+
+	if (ctx.failures > 0)
+	{
+		printf("%d check(s) failed\n", ctx.failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchMatrix4X4.cpp
+// func: Matrix4X4 运算与批量投影的基准测试
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+// 模型到裁剪空间的矩阵：刚体变换乘以透视投影
+
+static Matrix4X4 RandModelViewProjection()
+{
+	Matrix4X4 model, projection;
+	model.FromMatrix4X3(RandRigidMatrix());
+	projection.SetupPerspectiveFov(RandRange(0.5f, 1.5f), RandRange(1.0f, 2.0f), 0.1f, 1000.0f);
+	return model * projection;
+}
+
+// 逐元素写出的标量乘法，作为对照
+
+static void MultiplyScalar(const Matrix4X4 &a, const Matrix4X4 &b, Matrix4X4 &r)
+{
+	const float *pa = &a.m11;
+	const float *pb = &b.m11;
+	float *pr = &r.m11;
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			pr[i*4 + j] = pa[i*4]*pb[j] + pa[i*4 + 1]*pb[4 + j] + pa[i*4 + 2]*pb[8 + j] + pa[i*4 + 3]*pb[12 + j];
+		}
+	}
+}
+
+// 与单位矩阵的最大偏差
+
+static float IdentityError4X4(const Matrix4X4 &m)
+{
+	Matrix4X4 identity;
+
+	const float *a = &m.m11;
+	const float *b = &identity.m11;
+	float maxError = 0.0f;
+
+	for (int i = 0; i < 16; i++)
+	{
+		maxError = MAX(maxError, fabs(a[i] - b[i]));
+	}
+
+	return maxError;
+}
+
+WANDER_BENCH(Matrix4X4)
+{
+	const size_t n = KBENCHBATCH;
+
+	std::vector<Matrix4X4> a(n), b(n), out(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i] = RandModelViewProjection();
+		b[i].FromMatrix4X3(RandRigidMatrix());
+	}
+
+	ctx.Measure("Matrix4X4 multiply scalar loop", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			MultiplyScalar(a[i], b[i], out[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Matrix4X4 * Matrix4X4", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = a[i] * b[i];
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Transpose(Matrix4X4)", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Transpose(a[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Inverse(Matrix4X4)", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Inverse(a[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	if (ctx.Enabled("Matrix4X4 max error"))
+	{
+		float maxError = 0.0f;
+		float maxProductError = 0.0f;
+		float maxDeterminantError = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			Matrix4X4 reference;
+			MultiplyScalar(a[i], b[i], reference);
+
+			Matrix4X4 product = a[i] * b[i];
+
+			for (int k = 0; k < 16; k++)
+			{
+				float r = (&reference.m11)[k];
+				maxProductError = MAX(maxProductError, fabs((&product.m11)[k] - r) / MAX(1.0f, fabs(r)));
+			}
+
+			// 逆乘以自身应为单位矩阵，刚体矩阵的行列式为1
+			// 透视矩阵的条件数很大，只用刚体矩阵检查
+
+			maxError = MAX(maxError, IdentityError4X4(Transpose(Transpose(b[i])) * Inverse(b[i])));
+
+			maxDeterminantError = MAX(maxDeterminantError, fabs(Determinant(b[i]) - 1.0f));
+		}
+
+		ctx.Report("Matrix4X4 max error", "abs", maxError);
+		ctx.Report("Matrix4X4 multiply max error", "rel", maxProductError);
+		ctx.Report("Matrix4X4 determinant max error", "abs", maxDeterminantError);
+	}
+}
+
+WANDER_BENCH(ProjectPoints)
+{
+	const size_t n = KBENCHBATCH + 3;
+
+	Matrix4X4 m = RandModelViewProjection();
+
+	std::vector<Point3D> in(n);
+	std::vector<Vector4D> out(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		in[i] = RandVector3D(100.0f);
+	}
+
+	ctx.Measure("ProjectPoints scalar loop", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			Vector4D clip = Vector4D(in[i].x, in[i].y, in[i].z, 1.0f) * m;
+			float oneOverW = 1.0f / clip.w;
+			out[i].Init(clip.x * oneOverW, clip.y * oneOverW, clip.z * oneOverW, oneOverW);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("TransformToClipN", n, [&]()
+	{
+		TransformToClipN(m, &in[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("ProjectPointsN", n, [&]()
+	{
+		ProjectPointsN(m, &in[0], &out[0], n);
+		DoNotOptimize(out[0]);
+	});
+
+	// 与双精度参考结果的相对误差
+
+	if (ctx.Enabled("ProjectPointsN max error"))
+	{
+		ProjectPointsN(m, &in[0], &out[0], n);
+
+		const float *pm = &m.m11;
+		double maxError = 0.0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			double p[4] = {in[i].x, in[i].y, in[i].z, 1.0};
+			double clip[4];
+
+			for (int j = 0; j < 4; j++)
+			{
+				clip[j] = p[0]*pm[j] + p[1]*pm[4 + j] + p[2]*pm[8 + j] + p[3]*pm[12 + j];
+			}
+
+			double ndc[3] = {clip[0] / clip[3], clip[1] / clip[3], clip[2] / clip[3]};
+
+			maxError = MAX(maxError, fabs(out[i].x - ndc[0]) / MAX(1.0, fabs(ndc[0])));
+			maxError = MAX(maxError, fabs(out[i].y - ndc[1]) / MAX(1.0, fabs(ndc[1])));
+			maxError = MAX(maxError, fabs(out[i].z - ndc[2]) / MAX(1.0, fabs(ndc[2])));
+			maxError = MAX(maxError, fabs(out[i].w * clip[3] - 1.0));
+		}
+
+		ctx.Report("ProjectPointsN max error", "rel", maxError);
+	}
+}
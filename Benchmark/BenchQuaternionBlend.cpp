@@ -0,0 +1,254 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchQuaternionBlend.cpp
+// func: 多个姿势的加权混合：串联 Slerp 与一次累加的对比
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "Bench.h"
+
+// 混合树中4个姿势，每个姿势 KBENCHBATCH 根骨骼
+
+const size_t KBLENDINPUTS = 4;
+
+// 现有做法：按累计权重两两串联 Slerp，结果与输入顺序有关
+
+static Quaternion SlerpChain(const Quaternion *q, const float *weights, size_t n)
+{
+	Quaternion ret = q[0];
+	float total = weights[0];
+
+	for (size_t k = 1; k < n; k++)
+	{
+		total += weights[k];
+		ret = Slerp(ret, q[k], total > 0.0f ? weights[k] / total : 0.0f);
+	}
+
+	return ret;
+}
+
+// 双精度的参考结果：对 M = sum(w * q * q^T) 做幂迭代，
+// 输入彼此接近时最大特征值远大于其余特征值，收敛很快
+
+static Quaternion ReferenceAverage(const Quaternion *q, const float *weights, size_t n)
+{
+	double m[4][4] = {};
+
+	for (size_t k = 0; k < n; k++)
+	{
+		double v[4] = { q[k].w, q[k].x, q[k].y, q[k].z };
+
+		for (int r = 0; r < 4; r++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				m[r][c] += weights[k] * v[r] * v[c];
+			}
+		}
+	}
+
+	double v[4] = { q[0].w, q[0].x, q[0].y, q[0].z };
+
+	for (int iter = 0; iter < 200; iter++)
+	{
+		double next[4] = {};
+
+		for (int r = 0; r < 4; r++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				next[r] += m[r][c] * v[c];
+			}
+		}
+
+		double mag = sqrt(next[0]*next[0] + next[1]*next[1] + next[2]*next[2] + next[3]*next[3]);
+
+		for (int r = 0; r < 4; r++)
+		{
+			v[r] = next[r] / mag;
+		}
+	}
+
+	Quaternion ret = { (float)v[0], (float)v[1], (float)v[2], (float)v[3] };
+	return ret;
+}
+
+// 每根骨骼一个基准朝向，各姿势在其上随机转动不超过 spread 弧度，
+// 一半的输入翻转符号，覆盖对齐半球的情况
+
+static void BuildPoses(std::vector<Quaternion> *poses, size_t bones, float spread)
+{
+	for (size_t i = 0; i < bones; i++)
+	{
+		Quaternion base = RandUnitQuaternion();
+
+		for (size_t k = 0; k < KBLENDINPUTS; k++)
+		{
+			Vector3D axis = RandVector3D(1.0f);
+			axis.Normalize();
+
+			Quaternion delta;
+			delta.SetRotateAxis(axis, RandRange(0.0f, spread));
+
+			Quaternion q = base * delta;
+
+			if (RandFloat() < 0.5f)
+			{
+				q.w = -q.w;
+				q.x = -q.x;
+				q.y = -q.y;
+				q.z = -q.z;
+			}
+
+			poses[k][i] = q;
+		}
+	}
+}
+
+// AoS 姿势转成 BlendQuaternionsSoA 的布局
+
+static void ToSoA(const std::vector<Quaternion> &pose, std::vector<float> &soa)
+{
+	size_t bones = pose.size();
+	soa.resize(4 * bones);
+
+	for (size_t i = 0; i < bones; i++)
+	{
+		soa[i] = pose[i].w;
+		soa[bones + i] = pose[i].x;
+		soa[2 * bones + i] = pose[i].y;
+		soa[3 * bones + i] = pose[i].z;
+	}
+}
+
+WANDER_BENCH(QuaternionBlend)
+{
+	const size_t bones = KBENCHBATCH;
+
+	std::vector<Quaternion> poses[KBLENDINPUTS];
+	std::vector<float> soa[KBLENDINPUTS];
+	const float *soaPtr[KBLENDINPUTS];
+
+	for (size_t k = 0; k < KBLENDINPUTS; k++)
+	{
+		poses[k].resize(bones);
+	}
+
+	BuildPoses(poses, bones, 1.0f);
+
+	for (size_t k = 0; k < KBLENDINPUTS; k++)
+	{
+		ToSoA(poses[k], soa[k]);
+		soaPtr[k] = &soa[k][0];
+	}
+
+	float weights[KBLENDINPUTS], reversedWeights[KBLENDINPUTS];
+	float total = 0.0f;
+
+	for (size_t k = 0; k < KBLENDINPUTS; k++)
+	{
+		weights[k] = RandRange(0.1f, 1.0f);
+		total += weights[k];
+	}
+
+	for (size_t k = 0; k < KBLENDINPUTS; k++)
+	{
+		weights[k] /= total;
+		reversedWeights[KBLENDINPUTS - 1 - k] = weights[k];
+	}
+
+	std::vector<Quaternion> out(bones);
+	std::vector<float> soaOut(4 * bones);
+
+	// 取出一根骨骼的全部输入，reversed 为 true 时倒序
+
+	auto gather = [&](size_t i, Quaternion *q, bool reversed)
+	{
+		for (size_t k = 0; k < KBLENDINPUTS; k++)
+		{
+			q[reversed ? KBLENDINPUTS - 1 - k : k] = poses[k][i];
+		}
+	};
+
+	ctx.Measure("Slerp chain 4 poses", bones, [&]()
+	{
+		for (size_t i = 0; i < bones; i++)
+		{
+			Quaternion q[KBLENDINPUTS];
+			gather(i, q, false);
+			out[i] = SlerpChain(q, weights, KBLENDINPUTS);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("BlendQuaternions 4 poses", bones, [&]()
+	{
+		for (size_t i = 0; i < bones; i++)
+		{
+			Quaternion q[KBLENDINPUTS];
+			gather(i, q, false);
+			out[i] = BlendQuaternions(q, weights, KBLENDINPUTS);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("BlendQuaternions exact 4 poses", bones, [&]()
+	{
+		for (size_t i = 0; i < bones; i++)
+		{
+			Quaternion q[KBLENDINPUTS];
+			gather(i, q, false);
+			out[i] = BlendQuaternions(q, weights, KBLENDINPUTS, true);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("BlendQuaternionsSoA 4 poses", bones, [&]()
+	{
+		BlendQuaternionsSoA(soaPtr, weights, KBLENDINPUTS, &soaOut[0], bones);
+		DoNotOptimize(soaOut[0]);
+	});
+
+	// 精度：与双精度加权平均的最大夹角，以及倒序输入前后结果的最大夹角
+
+	if (ctx.Enabled("QuaternionBlend max angular error"))
+	{
+		double chainError = 0.0, nlerpError = 0.0, exactError = 0.0, soaError = 0.0;
+		double chainOrder = 0.0, nlerpOrder = 0.0, exactOrder = 0.0;
+
+		BlendQuaternionsSoA(soaPtr, weights, KBLENDINPUTS, &soaOut[0], bones);
+
+		for (size_t i = 0; i < bones; i++)
+		{
+			Quaternion q[KBLENDINPUTS], r[KBLENDINPUTS];
+			gather(i, q, false);
+			gather(i, r, true);
+
+			Quaternion ref = ReferenceAverage(q, weights, KBLENDINPUTS);
+			Quaternion chain = SlerpChain(q, weights, KBLENDINPUTS);
+			Quaternion nlerp = BlendQuaternions(q, weights, KBLENDINPUTS);
+			Quaternion exact = BlendQuaternions(q, weights, KBLENDINPUTS, true);
+			Quaternion batch = { soaOut[i], soaOut[bones + i], soaOut[2 * bones + i], soaOut[3 * bones + i] };
+
+			chainError = MAX(chainError, QuaternionAngleError(chain, ref));
+			nlerpError = MAX(nlerpError, QuaternionAngleError(nlerp, ref));
+			exactError = MAX(exactError, QuaternionAngleError(exact, ref));
+			soaError = MAX(soaError, QuaternionAngleError(batch, nlerp));
+
+			chainOrder = MAX(chainOrder, QuaternionAngleError(chain, SlerpChain(r, reversedWeights, KBLENDINPUTS)));
+			nlerpOrder = MAX(nlerpOrder, QuaternionAngleError(nlerp, BlendQuaternions(r, reversedWeights, KBLENDINPUTS)));
+			exactOrder = MAX(exactOrder,
+							 QuaternionAngleError(exact, BlendQuaternions(r, reversedWeights, KBLENDINPUTS, true)));
+		}
+
+		ctx.Report("QuaternionBlend max angular error Slerp chain", "rad", chainError);
+		ctx.Report("QuaternionBlend max angular error nlerp", "rad", nlerpError);
+		ctx.Report("QuaternionBlend max angular error exact", "rad", exactError);
+		ctx.Report("QuaternionBlend max angular error SoA vs scalar", "rad", soaError);
+		ctx.Report("QuaternionBlend order dependence Slerp chain", "rad", chainOrder);
+		ctx.Report("QuaternionBlend order dependence nlerp", "rad", nlerpOrder);
+		ctx.Report("QuaternionBlend order dependence exact", "rad", exactOrder);
+	}
+}
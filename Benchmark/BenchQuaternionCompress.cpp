@@ -0,0 +1,319 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchQuaternionCompress.cpp
+// func: 四元数压缩编码的吞吐量、动画片段的采样带宽与精度报告
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "Bench.h"
+
+// 动画片段：256根骨骼 x 1024帧，未压缩时 4MB，超出一般的L2
+
+const size_t KCLIPBONES = 256;
+const size_t KCLIPFRAMES = 1024;
+const size_t KCLIPKEYS = KCLIPBONES * KCLIPFRAMES;
+
+// 精度统计的样本数
+
+const size_t KERRORSAMPLES = 1 << 18;
+
+// 归一化线性插值，只用于测量带宽，不处理两帧不在同一半球的情况
+
+static Quaternion Nlerp(const Quaternion &a, const Quaternion &b, float t)
+{
+	Quaternion q;
+	q.w = a.w + (b.w - a.w) * t;
+	q.x = a.x + (b.x - a.x) * t;
+	q.y = a.y + (b.y - a.y) * t;
+	q.z = a.z + (b.z - a.z) * t;
+	q.Normalize();
+	return q;
+}
+
+// 相邻两帧按骨骼取出并混合，frame 帧的所有骨骼连续存放
+
+static void SampleClip(const Quaternion *keys, size_t frame, float t, Quaternion *out)
+{
+	const Quaternion *k0 = keys + frame * KCLIPBONES;
+	const Quaternion *k1 = k0 + KCLIPBONES;
+
+	for (size_t i = 0; i < KCLIPBONES; i++)
+	{
+		out[i] = Nlerp(k0[i], k1[i], t);
+	}
+}
+
+// 先把两帧批量解码到缓冲区，再按上面的方式混合
+
+template <class T>
+static void SamplePackedClip(const T *keys, size_t frame, float t, Quaternion *k0, Quaternion *k1, Quaternion *out)
+{
+	UnpackN(keys + frame * KCLIPBONES, k0, KCLIPBONES);
+	UnpackN(keys + (frame + 1) * KCLIPBONES, k1, KCLIPBONES);
+
+	for (size_t i = 0; i < KCLIPBONES; i++)
+	{
+		out[i] = Nlerp(k0[i], k1[i], t);
+	}
+}
+
+// 每次采样一帧的全部骨骼，帧号按大步长跳跃，避免命中缓存中的上一帧
+
+template <class Sample>
+static void MeasureClip(BenchContext &ctx, const char *name, Sample sample)
+{
+	size_t frame = 0;
+
+	ctx.Measure(name, KCLIPBONES, [&]()
+	{
+		frame = (frame + 337) % (KCLIPFRAMES - 1);
+		sample(frame, 0.25f);
+	});
+}
+
+// 编码再解码后的最大夹角，以及批量与逐个结果不一致的个数
+// 夹角超过 bound 或批量与逐个编码不逐位一致时校验失败
+
+template <class T, class Pack>
+static void ReportError(BenchContext &ctx, const char *name, const std::vector<Quaternion> &q, Pack pack,
+						float bound)
+{
+	std::string errorName = std::string(name) + " max angular error";
+	std::string boundName = std::string(name) + " error bound";
+	std::string mismatchName = std::string(name) + " batch/scalar mismatches";
+
+	if (!ctx.Enabled(errorName.c_str()) && !ctx.Enabled(boundName.c_str()) && !ctx.Enabled(mismatchName.c_str()))
+	{
+		return;
+	}
+
+	size_t n = q.size();
+	std::vector<T> packed(n);
+	std::vector<Quaternion> unpacked(n);
+
+	JobPool pool(4);
+	PackN(&q[0], &packed[0], n, &pool);
+	UnpackN(&packed[0], &unpacked[0], n, &pool);
+
+	double maxError = 0.0;
+	size_t mismatch = 0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		T single = pack(q[i]);
+		mismatch += memcmp(&single, &packed[i], sizeof(T)) != 0 ? 1 : 0;
+
+		maxError = MAX(maxError, QuaternionAngleError(unpacked[i], q[i]));
+		maxError = MAX(maxError, QuaternionAngleError(Unpack(single), q[i]));
+	}
+
+	ctx.Report(errorName.c_str(), "rad", maxError);
+	ctx.Report(boundName.c_str(), "rad", (double)bound);
+	ctx.Report(mismatchName.c_str(), "count", (double)mismatch);
+
+	ctx.Check(errorName.c_str(), maxError <= bound);
+	ctx.Check(mismatchName.c_str(), mismatch == 0);
+}
+
+WANDER_BENCH(QuaternionCompress)
+{
+	std::vector<Quaternion> q(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<PackedQuaternion48> p48(KBENCHBATCH);
+	std::vector<PackedQuaternion32> p32(KBENCHBATCH);
+	std::vector<LogQuaternion48> log48(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		q[i] = RandUnitQuaternion();
+	}
+
+	PackN(&q[0], &p48[0], KBENCHBATCH);
+	PackN(&q[0], &p32[0], KBENCHBATCH);
+	PackN(&q[0], &log48[0], KBENCHBATCH);
+
+	ctx.Measure("PackQuaternion48 scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			p48[i] = PackQuaternion48(q[i]);
+		}
+		DoNotOptimize(p48[0]);
+	});
+
+	ctx.Measure("PackN 48", KBENCHBATCH, [&]()
+	{
+		PackN(&q[0], &p48[0], KBENCHBATCH);
+		DoNotOptimize(p48[0]);
+	});
+
+	ctx.Measure("PackQuaternion32 scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			p32[i] = PackQuaternion32(q[i]);
+		}
+		DoNotOptimize(p32[0]);
+	});
+
+	ctx.Measure("PackN 32", KBENCHBATCH, [&]()
+	{
+		PackN(&q[0], &p32[0], KBENCHBATCH);
+		DoNotOptimize(p32[0]);
+	});
+
+	ctx.Measure("PackLogQuaternion48 scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			log48[i] = PackLogQuaternion48(q[i]);
+		}
+		DoNotOptimize(log48[0]);
+	});
+
+	ctx.Measure("PackN log48", KBENCHBATCH, [&]()
+	{
+		PackN(&q[0], &log48[0], KBENCHBATCH);
+		DoNotOptimize(log48[0]);
+	});
+
+	ctx.Measure("Unpack 48 scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Unpack(p48[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN 48", KBENCHBATCH, [&]()
+	{
+		UnpackN(&p48[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Unpack 32 scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Unpack(p32[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN 32", KBENCHBATCH, [&]()
+	{
+		UnpackN(&p32[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Unpack log48 scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Unpack(log48[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN log48", KBENCHBATCH, [&]()
+	{
+		UnpackN(&log48[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	// 采样带宽：同一片段分别以未压缩和三种压缩格式存放
+
+	if (ctx.Enabled("Clip sample"))
+	{
+		std::vector<Quaternion> clip(KCLIPKEYS);
+
+		for (size_t i = 0; i < KCLIPKEYS; i++)
+		{
+			clip[i] = RandUnitQuaternion();
+		}
+
+		std::vector<PackedQuaternion48> clip48(KCLIPKEYS);
+		std::vector<PackedQuaternion32> clip32(KCLIPKEYS);
+		std::vector<LogQuaternion48> clipLog48(KCLIPKEYS);
+
+		PackN(&clip[0], &clip48[0], KCLIPKEYS);
+		PackN(&clip[0], &clip32[0], KCLIPKEYS);
+		PackN(&clip[0], &clipLog48[0], KCLIPKEYS);
+
+		std::vector<Quaternion> k0(KCLIPBONES), k1(KCLIPBONES), pose(KCLIPBONES);
+
+		MeasureClip(ctx, "Clip sample Quaternion (4MB)", [&](size_t frame, float t)
+		{
+			SampleClip(&clip[0], frame, t, &pose[0]);
+			DoNotOptimize(pose[0]);
+		});
+
+		MeasureClip(ctx, "Clip sample UnpackN 48 (1.5MB)", [&](size_t frame, float t)
+		{
+			SamplePackedClip(&clip48[0], frame, t, &k0[0], &k1[0], &pose[0]);
+			DoNotOptimize(pose[0]);
+		});
+
+		MeasureClip(ctx, "Clip sample UnpackN 32 (1MB)", [&](size_t frame, float t)
+		{
+			SamplePackedClip(&clip32[0], frame, t, &k0[0], &k1[0], &pose[0]);
+			DoNotOptimize(pose[0]);
+		});
+
+		MeasureClip(ctx, "Clip sample UnpackN log48 (1.5MB)", [&](size_t frame, float t)
+		{
+			SamplePackedClip(&clipLog48[0], frame, t, &k0[0], &k1[0], &pose[0]);
+			DoNotOptimize(pose[0]);
+		});
+	}
+
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		JobPool pool(hardwareThreads > 0 ? hardwareThreads : 1);
+
+		std::vector<Quaternion> big(KCLIPKEYS);
+		std::vector<PackedQuaternion48> big48(KCLIPKEYS);
+
+		for (size_t i = 0; i < KCLIPKEYS; i++)
+		{
+			big[i] = RandUnitQuaternion();
+		}
+
+		ctx.Measure("PackN 48 pooled (256K)", KCLIPKEYS, [&]()
+		{
+			PackN(&big[0], &big48[0], KCLIPKEYS, &pool);
+			DoNotOptimize(big48[0]);
+		});
+
+		ctx.Measure("UnpackN 48 pooled (256K)", KCLIPKEYS, [&]()
+		{
+			UnpackN(&big48[0], &big[0], KCLIPKEYS, &pool);
+			DoNotOptimize(big[0]);
+		});
+	}
+
+	// 精度：随机单位四元数，外加单位四元数与分量绝对值相同的边界情况
+
+	{
+		std::vector<Quaternion> samples(KERRORSAMPLES);
+
+		for (size_t i = 0; i < KERRORSAMPLES; i++)
+		{
+			samples[i] = RandUnitQuaternion();
+		}
+
+		samples[0] = gQuaternionIdentity;
+		samples[1] = { -1.0f, 0.0f, 0.0f, 0.0f };
+		samples[2] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		samples[3] = { 0.5f, -0.5f, 0.5f, -0.5f };
+		samples[4] = { 0.70710678f, 0.0f, 0.70710678f, 0.0f };
+
+		ReportError<PackedQuaternion48>(ctx, "Packed48", samples, PackQuaternion48, KPACKED48MAXERROR);
+		ReportError<PackedQuaternion32>(ctx, "Packed32", samples, PackQuaternion32, KPACKED32MAXERROR);
+		ReportError<LogQuaternion48>(ctx, "Log48", samples, PackLogQuaternion48, KLOG48MAXERROR);
+	}
+}
@@ -0,0 +1,240 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchQuaternionSimd.cpp
+// func: QuaternionSimd / Vector4DSimd 与标量版本的对比
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+WANDER_BENCH(QuaternionSimd)
+{
+	const size_t n = KBENCHBATCH;
+
+	std::vector<Quaternion> a(n), b(n), out(n);
+	std::vector<QuaternionSimd> sa(n), sb(n), sout(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i] = RandUnitQuaternion();
+		b[i] = RandUnitQuaternion();
+		sa[i] = QuaternionSimd(a[i]);
+		sb[i] = QuaternionSimd(b[i]);
+	}
+
+	ctx.Measure("Quaternion * Quaternion", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = a[i] * b[i];
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("QuaternionSimd * QuaternionSimd", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			sout[i] = sa[i] * sb[i];
+		}
+		DoNotOptimize(sout[0]);
+	});
+
+	// 连乘：每次乘法依赖上一次的结果，如IK链与相机的逐级旋转
+
+	ctx.Measure("Quaternion multiply chain", n, [&]()
+	{
+		Quaternion q = a[0];
+
+		for (size_t i = 0; i < n; i++)
+		{
+			q *= b[i];
+		}
+		DoNotOptimize(q);
+	});
+
+	ctx.Measure("QuaternionSimd multiply chain", n, [&]()
+	{
+		QuaternionSimd q = sa[0];
+
+		for (size_t i = 0; i < n; i++)
+		{
+			q *= sb[i];
+		}
+		DoNotOptimize(q);
+	});
+
+	ctx.Measure("Quaternion::Normalize", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = a[i];
+			out[i].Normalize();
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("QuaternionSimd::Normalize", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			sout[i] = sa[i];
+			sout[i].Normalize();
+		}
+		DoNotOptimize(sout[0]);
+	});
+
+	ctx.Measure("DotProduct(Quaternion)", n, [&]()
+	{
+		float sum = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			sum += DotProduct(a[i], b[i]);
+		}
+		DoNotOptimize(sum);
+	});
+
+	ctx.Measure("DotProduct(QuaternionSimd)", n, [&]()
+	{
+		float sum = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			sum += DotProduct(sa[i], sb[i]);
+		}
+		DoNotOptimize(sum);
+	});
+
+	// 与标量叉乘、标准化、点积结果的最大差异
+
+	if (ctx.Enabled("QuaternionSimd max error"))
+	{
+		double maxError = 0.0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			Quaternion ref = a[i] * b[i];
+			Quaternion got = (sa[i] * sb[i]).ToQuaternion();
+
+			maxError = MAX(maxError, fabs(ref.w - got.w));
+			maxError = MAX(maxError, fabs(ref.x - got.x));
+			maxError = MAX(maxError, fabs(ref.y - got.y));
+			maxError = MAX(maxError, fabs(ref.z - got.z));
+
+			maxError = MAX(maxError, fabs(DotProduct(a[i], b[i]) - DotProduct(sa[i], sb[i])));
+
+			Quaternion c = Conjugate(a[i]);
+			Quaternion sc = Conjugate(sa[i]).ToQuaternion();
+			maxError = MAX(maxError, fabs(c.x - sc.x) + fabs(c.w - sc.w));
+
+			QuaternionSimd s = sa[i] * QuaternionSimd(2.0f * b[i].w, 2.0f * b[i].x, 2.0f * b[i].y, 2.0f * b[i].z);
+			Quaternion r = s.ToQuaternion();
+			s.Normalize();
+			r.Normalize();
+			maxError = MAX(maxError, QuaternionAngleError(r, s.ToQuaternion()));
+		}
+
+		ctx.Report("QuaternionSimd max error", "abs", maxError);
+	}
+}
+
+WANDER_BENCH(Vector4DSimd)
+{
+	const size_t n = KBENCHBATCH;
+
+	std::vector<Vector4D> a(n), b(n);
+	std::vector<Vector4DSimd> sa(n), sb(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i] = Vector4D(RandRange(-1, 1), RandRange(-1, 1), RandRange(-1, 1), RandRange(-1, 1));
+		b[i] = Vector4D(RandRange(-1, 1), RandRange(-1, 1), RandRange(-1, 1), RandRange(-1, 1));
+		sa[i] = Vector4DSimd(a[i]);
+		sb[i] = Vector4DSimd(b[i]);
+	}
+
+	std::vector<Vector4D> out(n);
+	std::vector<Vector4DSimd> sout(n);
+
+	ctx.Measure("Vector4D a + b * k", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = a[i] + b[i] * 0.5f;
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("Vector4DSimd a + b * k", n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			sout[i] = sa[i] + sb[i] * 0.5f;
+		}
+		DoNotOptimize(sout[0]);
+	});
+
+	ctx.Measure("Vector4D dot", n, [&]()
+	{
+		float sum = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			sum += a[i] * b[i];
+		}
+		DoNotOptimize(sum);
+	});
+
+	ctx.Measure("Vector4DSimd dot", n, [&]()
+	{
+		float sum = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			sum += sa[i] * sb[i];
+		}
+		DoNotOptimize(sum);
+	});
+
+	if (ctx.Enabled("Vector4DSimd max error"))
+	{
+		float maxError = 0.0f;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			Vector4D v = (sa[i] + sb[i] * 0.5f).ToVector4D();
+			Vector4D r = a[i] + b[i] * 0.5f;
+			maxError = MAX(maxError, fabs(r.x - v.x) + fabs(r.y - v.y) + fabs(r.z - v.z) + fabs(r.w - v.w));
+			maxError = MAX(maxError, fabs(a[i] * b[i] - sa[i] * sb[i]));
+		}
+
+		ctx.Report("Vector4DSimd max error", "abs", maxError);
+	}
+
+	// 复合赋值与 Vector4D 逐位一致，-=、*=、/= 不改变 w
+
+	if (ctx.Enabled("Vector4DSimd compound mismatches"))
+	{
+		size_t mismatches = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			Vector4D r[4] = { a[i], a[i], a[i], a[i] };
+			Vector4DSimd v[4] = { sa[i], sa[i], sa[i], sa[i] };
+
+			r[0] += b[i];	v[0] += sb[i];
+			r[1] -= b[i];	v[1] -= sb[i];
+			r[2] *= 0.37f;	v[2] *= 0.37f;
+			r[3] /= 1.7f;	v[3] /= 1.7f;
+
+			for (int k = 0; k < 4; k++)
+			{
+				mismatches += v[k].ToVector4D() != r[k] ? 1 : 0;
+			}
+		}
+
+		ctx.Report("Vector4DSimd compound mismatches", "ops", (double)mismatches);
+		ctx.Check("Vector4DSimd compound mismatches", mismatches == 0);
+	}
+}
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchSinCos.cpp
+// func: 批量sin/cos的基准测试与误差报告
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+// 以float结果的ULP为单位的误差
+
+static double UlpError(float approx, double ref)
+{
+	float r = fabsf((float)ref);
+	double ulp = (double)nextafterf(r, 1e30f) - r;
+	return fabs(approx - ref) / ulp;
+}
+
+WANDER_BENCH(SinCosN)
+{
+	std::vector<float> theta(KBENCHBATCH), s(KBENCHBATCH), c(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		theta[i] = RandRange(-KPI * 4.0f, KPI * 4.0f);
+	}
+
+	ctx.Measure("SinCos scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			SinCos(s[i], c[i], theta[i]);
+		}
+		DoNotOptimize(s[0]);
+		DoNotOptimize(c[0]);
+	});
+
+	ctx.Measure("SinCosN", KBENCHBATCH, [&]()
+	{
+		SinCosN(&theta[0], &s[0], &c[0], KBENCHBATCH);
+		DoNotOptimize(s[0]);
+		DoNotOptimize(c[0]);
+	});
+
+	// 误差统计，范围取文档保证的 [-8192, 8192]
+
+	const size_t count = 1 << 20;
+	std::vector<float> t(count), ts(count), tc(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		t[i] = RandRange(-8192.0f, 8192.0f);
+	}
+
+	SinCosN(&t[0], &ts[0], &tc[0], count);
+
+	double maxAbs = 0.0, maxUlp = 0.0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		double rs = sin((double)t[i]);
+		double rc = cos((double)t[i]);
+
+		maxAbs = MAX(maxAbs, MAX(fabs(ts[i] - rs), fabs(tc[i] - rc)));
+
+		if (fabs(rs) >= 1e-3) maxUlp = MAX(maxUlp, UlpError(ts[i], rs));
+		if (fabs(rc) >= 1e-3) maxUlp = MAX(maxUlp, UlpError(tc[i], rc));
+	}
+
+	ctx.Report("SinCosN max abs error", "abs", maxAbs);
+	ctx.Report("SinCosN max ulp error", "ulp", maxUlp);
+}
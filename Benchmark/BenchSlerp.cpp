@@ -0,0 +1,255 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchSlerp.cpp
+// func: 四元数插值的基准测试与精度报告
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+// 双精度的参考插值
+
+static Quaternion ReferenceSlerp(const Quaternion &q0, const Quaternion &q1, double t)
+{
+	double a[4] = {q0.w, q0.x, q0.y, q0.z};
+	double b[4] = {q1.w, q1.x, q1.y, q1.z};
+
+	double c = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+
+	if (c < 0.0)
+	{
+		c = -c;
+		for (int k = 0; k < 4; k++) b[k] = -b[k];
+	}
+
+	double k0 = 1.0 - t, k1 = t;
+
+	if (c < 1.0 - 1e-12)
+	{
+		double omega = acos(c);
+		k0 = sin((1.0 - t) * omega) / sin(omega);
+		k1 = sin(t * omega) / sin(omega);
+	}
+
+	Quaternion r;
+	r.w = (float)(k0*a[0] + k1*b[0]);
+	r.x = (float)(k0*a[1] + k1*b[1]);
+	r.y = (float)(k0*a[2] + k1*b[2]);
+	r.z = (float)(k0*a[3] + k1*b[3]);
+	return r;
+}
+
+WANDER_BENCH(SlerpN)
+{
+	std::vector<Quaternion> q0(KBENCHBATCH), q1(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<float> t(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		q0[i] = RandUnitQuaternion();
+		q1[i] = RandUnitQuaternion();
+		t[i] = RandFloat();
+	}
+
+	ctx.Measure("Slerp scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Slerp(q0[i], q1[i], t[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("SlerpN", KBENCHBATCH, [&]()
+	{
+		SlerpN(&q0[0], &q1[0], &t[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("FastSlerp scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = FastSlerp(q0[i], q1[i], t[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("FastSlerpN", KBENCHBATCH, [&]()
+	{
+		FastSlerpN(&q0[0], &q1[0], &t[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	// 精度：与双精度参考结果的最大夹角
+
+	double scalarError = 0.0, batchError = 0.0;
+
+	SlerpN(&q0[0], &q1[0], &t[0], &out[0], KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		Quaternion ref = ReferenceSlerp(q0[i], q1[i], t[i]);
+		scalarError = MAX(scalarError, QuaternionAngleError(Slerp(q0[i], q1[i], t[i]), ref));
+		batchError = MAX(batchError, QuaternionAngleError(out[i], ref));
+	}
+
+	ctx.Report("Slerp scalar loop max angular error", "rad", scalarError);
+	ctx.Report("SlerpN max angular error", "rad", batchError);
+
+	// FastSlerp 的误差集中在夹角大的时候，随机样本不容易碰到最坏情况，
+	// 另外按夹角与 t 均匀扫描
+
+	if (ctx.Enabled("FastSlerp max angular error"))
+	{
+		double fastError = 0.0, fastBatchError = 0.0;
+
+		for (int pass = 0; pass < 64; pass++)
+		{
+			for (size_t i = 0; i < KBENCHBATCH; i++)
+			{
+				Vector3D axis = RandVector3D(1.0f);
+				axis.Normalize();
+
+				Quaternion delta;
+				delta.SetRotateAxis(axis, KPI * (pass * KBENCHBATCH + i) / (64 * KBENCHBATCH - 1));
+
+				q0[i] = RandUnitQuaternion();
+				q1[i] = q0[i] * delta;
+				t[i] = (float)(i % 101) / 100.0f;
+
+				// 一半的样本翻转 q1，覆盖取短弧的情况
+
+				if (i & 1)
+				{
+					q1[i].w = -q1[i].w;
+					q1[i].x = -q1[i].x;
+					q1[i].y = -q1[i].y;
+					q1[i].z = -q1[i].z;
+				}
+			}
+
+			FastSlerpN(&q0[0], &q1[0], &t[0], &out[0], KBENCHBATCH);
+
+			for (size_t i = 0; i < KBENCHBATCH; i++)
+			{
+				Quaternion ref = ReferenceSlerp(q0[i], q1[i], t[i]);
+				fastError = MAX(fastError, QuaternionAngleError(FastSlerp(q0[i], q1[i], t[i]), ref));
+				fastBatchError = MAX(fastBatchError, QuaternionAngleError(out[i], ref));
+			}
+		}
+
+		ctx.Report("FastSlerp max angular error", "rad", fastError);
+		ctx.Report("FastSlerpN max angular error", "rad", fastBatchError);
+	}
+}
+
+// 固定步长：同一对四元数从 t = 0 走到 t = 1
+
+const size_t KSTEPPERSTEPS = 1000;
+
+WANDER_BENCH(SlerpStepper)
+{
+	Quaternion q0 = RandUnitQuaternion();
+	Quaternion q1 = RandUnitQuaternion();
+	float dt = 1.0f / KSTEPPERSTEPS;
+
+	std::vector<Quaternion> out(KSTEPPERSTEPS + 1);
+
+	ctx.Measure("Slerp fixed step loop", KSTEPPERSTEPS + 1, [&]()
+	{
+		for (size_t i = 0; i <= KSTEPPERSTEPS; i++)
+		{
+			out[i] = Slerp(q0, q1, i * dt);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("SlerpStepper::Next", KSTEPPERSTEPS + 1, [&]()
+	{
+		SlerpStepper stepper(q0, q1, 0.0f, dt);
+		out[0] = stepper.Current();
+
+		for (size_t i = 1; i <= KSTEPPERSTEPS; i++)
+		{
+			out[i] = stepper.Next();
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("SlerpStepper::Fill", KSTEPPERSTEPS + 1, [&]()
+	{
+		SlerpStepper stepper(q0, q1, 0.0f, dt);
+		stepper.Fill(&out[0], KSTEPPERSTEPS + 1);
+		DoNotOptimize(out[0]);
+	});
+
+	// 精度：随机的四元数对，与双精度参考结果的最大夹角
+	// 另外从 t = -4 走到 t = 5，共 9000 步，观察相位误差的增长
+
+	if (ctx.Enabled("SlerpStepper max angular error"))
+	{
+		double maxError = 0.0, shortError = 0.0, longError = 0.0;
+
+		for (int pair = 0; pair < 256; pair++)
+		{
+			q0 = RandUnitQuaternion();
+			q1 = RandUnitQuaternion();
+
+			// 每隔几对取一对非常接近的四元数，覆盖线性插值的退化情况，
+			// 以及夹角在 1e-5 到 1e-3 弧度之间的短弧
+
+			if (pair % 4 == 3)
+			{
+				q1 = q0;
+				q1.w += 1e-5f;
+				q1.Normalize();
+			}
+			else if (pair % 4 == 2)
+			{
+				Vector3D axis = RandVector3D(1.0f);
+				axis.Normalize();
+
+				Quaternion delta;
+				delta.SetRotateAxis(axis, 1e-5f * powf(100.0f, RandFloat()));
+				q1 = q0 * delta;
+			}
+
+			SlerpStepper stepper(q0, q1, 0.0f, dt);
+			stepper.Fill(&out[0], KSTEPPERSTEPS + 1);
+
+			for (size_t i = 0; i <= KSTEPPERSTEPS; i++)
+			{
+				double error = QuaternionAngleError(out[i], ReferenceSlerp(q0, q1, i * (double)dt));
+				maxError = MAX(maxError, error);
+
+				if (pair % 4 >= 2)
+				{
+					shortError = MAX(shortError, error);
+				}
+			}
+
+			stepper.Setup(q0, q1, -4.0f, dt);
+
+			for (size_t i = 1; i <= 9 * KSTEPPERSTEPS; i++)
+			{
+				const Quaternion &q = stepper.Next();
+
+				if (i % 100 == 0)
+				{
+					longError = MAX(longError, QuaternionAngleError(q, ReferenceSlerp(q0, q1, -4.0 + i * (double)dt)));
+				}
+			}
+		}
+
+		ctx.Report("SlerpStepper max angular error (1000 steps)", "rad", maxError);
+		ctx.Report("SlerpStepper max angular error short arc (1000 steps)", "rad", shortError);
+		ctx.Report("SlerpStepper max angular error (9000 steps)", "rad", longError);
+
+		// SlerpStepper.h 中给出的误差，留出余量
+
+		ctx.Check("SlerpStepper max angular error (1000 steps)", maxError <= 1e-5);
+		ctx.Check("SlerpStepper max angular error short arc (1000 steps)", shortError <= 1e-6);
+		ctx.Check("SlerpStepper max angular error (9000 steps)", longError <= 5e-5);
+	}
+}
@@ -0,0 +1,281 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchSpatialHash.cpp
+// func: 二维空间哈希的基准测试，模拟大量移动的个体每帧查找邻居
+//
+///////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <thread>
+
+#include "Bench.h"
+
+// 10万个个体分布在 1000x1000 的区域中，邻居半径4，平均每次查询约5个邻居
+
+const size_t KSPATIALAGENTS = 100000;
+const float KSPATIALWORLD = 1000.0f;
+const float KSPATIALRADIUS = 4.0f;
+const size_t KSPATIALKNN = 8;
+
+static void MoveAgents(std::vector<Point2D> &pos, const std::vector<Vector2D> &vel)
+{
+	for (size_t i = 0; i < pos.size(); i++)
+	{
+		pos[i] += vel[i];
+
+		// 出界后从另一侧进入
+
+		if (pos[i].x < 0.0f) pos[i].x += KSPATIALWORLD;
+		if (pos[i].x >= KSPATIALWORLD) pos[i].x -= KSPATIALWORLD;
+		if (pos[i].y < 0.0f) pos[i].y += KSPATIALWORLD;
+		if (pos[i].y >= KSPATIALWORLD) pos[i].y -= KSPATIALWORLD;
+	}
+}
+
+// 暴力查询，作为对照与校验
+
+static size_t BruteForceRadius(const std::vector<Point2D> &pos, const Point2D &center, float radius, std::vector<int> &out)
+{
+	float radiusSq = radius * radius;
+	size_t before = out.size();
+
+	for (size_t i = 0; i < pos.size(); i++)
+	{
+		if (Vec2DistanceSq(pos[i], center) <= radiusSq)
+		{
+			out.push_back((int)i);
+		}
+	}
+
+	return out.size() - before;
+}
+
+// 校验查询结果，返回不一致的查询个数
+
+static size_t CheckSpatialHash(const SpatialHash2D &grid, const std::vector<Point2D> &pos)
+{
+	size_t mismatches = 0;
+	std::vector<int> a, b;
+	std::vector<float> all(pos.size());
+
+	for (size_t q = 0; q < 200; q++)
+	{
+		Point2D c = q % 2 == 0 ? pos[(q * 7919) % pos.size()] : Point2D(RandRange(-50.0f, 1050.0f), RandRange(-50.0f, 1050.0f));
+
+		a.clear();
+		b.clear();
+		grid.QueryRadius(c, KSPATIALRADIUS * 1.5f, a);
+		BruteForceRadius(pos, c, KSPATIALRADIUS * 1.5f, b);
+		std::sort(a.begin(), a.end());
+		mismatches += a != b ? 1 : 0;
+
+		// k近邻比较第k个距离，避免距离相等时编号不同
+
+		int ids[KSPATIALKNN];
+		float dist[KSPATIALKNN];
+		size_t found = grid.QueryKNearest(c, KSPATIALKNN, ids, dist);
+
+		for (size_t i = 0; i < pos.size(); i++)
+		{
+			all[i] = Vec2DistanceSq(pos[i], c);
+		}
+
+		std::nth_element(all.begin(), all.begin() + (KSPATIALKNN - 1), all.end());
+		mismatches += found != KSPATIALKNN || dist[KSPATIALKNN - 1] != all[KSPATIALKNN - 1] ? 1 : 0;
+	}
+
+	return mismatches;
+}
+
+WANDER_BENCH(SpatialHash2D)
+{
+	const size_t n = KSPATIALAGENTS;
+
+	std::vector<Point2D> pos(n);
+	std::vector<Vector2D> vel(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		pos[i].Init(RandRange(0.0f, KSPATIALWORLD), RandRange(0.0f, KSPATIALWORLD));
+		vel[i].Init(RandRange(-0.5f, 0.5f), RandRange(-0.5f, 0.5f));
+	}
+
+	SpatialHash2D grid(KSPATIALRADIUS);
+	grid.Build(&pos[0], n);
+
+	std::vector<int> neighbours;
+	neighbours.reserve(n * 8);
+
+	ctx.Measure("SpatialHash brute force radius (100K)", 64, [&]()
+	{
+		neighbours.clear();
+
+		for (size_t i = 0; i < 64; i++)
+		{
+			BruteForceRadius(pos, pos[i], KSPATIALRADIUS, neighbours);
+		}
+
+		DoNotOptimize(neighbours.size());
+	});
+
+	ctx.Measure("SpatialHash Build (100K)", n, [&]()
+	{
+		grid.Build(&pos[0], n);
+		DoNotOptimize(grid.Size());
+	});
+
+	ctx.Measure("SpatialHash QueryRadius (100K)", n, [&]()
+	{
+		neighbours.clear();
+
+		for (size_t i = 0; i < n; i++)
+		{
+			grid.QueryRadius(pos[i], KSPATIALRADIUS, neighbours, (int)i);
+		}
+
+		DoNotOptimize(neighbours.size());
+	});
+
+	ctx.Report("SpatialHash neighbours per agent", "avg", (double)neighbours.size() / n);
+
+	ctx.Measure("SpatialHash QueryKNearest k=8 (100K)", n, [&]()
+	{
+		int ids[KSPATIALKNN];
+		int sum = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			grid.QueryKNearest(pos[i], KSPATIALKNN, ids, NULL, (int)i);
+			sum += ids[0];
+		}
+
+		DoNotOptimize(sum);
+	});
+
+	// 每帧：所有个体移动，计数排序重建，再为每个个体查找邻居；60Hz 下一帧约16.7ms
+
+	ctx.Measure("SpatialHash frame move+build+radius (100K)", n, [&]()
+	{
+		MoveAgents(pos, vel);
+		grid.Build(&pos[0], n);
+		neighbours.clear();
+
+		for (size_t i = 0; i < n; i++)
+		{
+			grid.QueryRadius(pos[i], KSPATIALRADIUS, neighbours, (int)i);
+		}
+
+		DoNotOptimize(neighbours.size());
+	});
+
+	std::vector<uint32_t> start, count;
+
+	ctx.Measure("SpatialHash frame move+build+radius all (100K)", n, [&]()
+	{
+		MoveAgents(pos, vel);
+		grid.Build(&pos[0], n);
+		grid.QueryRadiusAll(KSPATIALRADIUS, neighbours, start, count);
+		DoNotOptimize(neighbours.size());
+	});
+
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+
+	if (hardwareThreads > 1)
+	{
+		JobPool pool(hardwareThreads);
+
+		char name[64];
+		snprintf(name, sizeof(name), "SpatialHash frame radius all %u threads (100K)", hardwareThreads);
+
+		ctx.Measure(name, n, [&]()
+		{
+			MoveAgents(pos, vel);
+			grid.Build(&pos[0], n);
+			grid.QueryRadiusAll(KSPATIALRADIUS, neighbours, start, count, &pool);
+			DoNotOptimize(neighbours.size());
+		});
+	}
+
+	// 只有1%的个体移动时用 Move 增量更新，不重建
+
+	std::vector<int> movers(n / 100);
+
+	for (size_t i = 0; i < movers.size(); i++)
+	{
+		movers[i] = rand() % (int)n;
+	}
+
+	grid.Build(&pos[0], n);
+
+	ctx.Measure("SpatialHash Move 1% (1K moves)", movers.size(), [&]()
+	{
+		for (size_t i = 0; i < movers.size(); i++)
+		{
+			int id = movers[i];
+			pos[id] += vel[id];
+			grid.Move(id, pos[id]);
+		}
+
+		DoNotOptimize(grid.MovedCount());
+	});
+
+	if (ctx.Enabled("SpatialHash mismatches"))
+	{
+		size_t mismatches = 0;
+
+		grid.Build(&pos[0], n);
+		mismatches += CheckSpatialHash(grid, pos);
+
+		// 增量移动后不重建直接校验
+
+		for (size_t i = 0; i < n; i += 37)
+		{
+			pos[i].Init(RandRange(0.0f, KSPATIALWORLD), RandRange(0.0f, KSPATIALWORLD));
+			grid.Move((int)i, pos[i]);
+		}
+
+		mismatches += CheckSpatialHash(grid, pos);
+
+		// 整体查询与逐个查询的结果一致
+
+		std::vector<int> all, one;
+		std::vector<uint32_t> start, count;
+		JobPool pool(4);
+		grid.QueryRadiusAll(KSPATIALRADIUS, all, start, count, &pool);
+
+		for (size_t i = 0; i < n; i += 101)
+		{
+			one.clear();
+			grid.QueryRadius(pos[i], KSPATIALRADIUS, one, (int)i);
+
+			std::vector<int> a(all.begin() + start[i], all.begin() + start[i] + count[i]);
+			std::sort(a.begin(), a.end());
+			std::sort(one.begin(), one.end());
+			mismatches += a != one ? 1 : 0;
+		}
+
+		// 不用线程池、只有调用者一个线程与多个线程时结果逐项相同，
+		// 且每个查询的结果都在 neighbours 之内
+
+		std::vector<int> serial;
+		std::vector<uint32_t> serialStart, serialCount;
+		grid.QueryRadiusAll(KSPATIALRADIUS, serial, serialStart, serialCount);
+
+		for (unsigned threads = 1; threads <= 4; threads += 3)
+		{
+			JobPool sized(threads);
+			grid.QueryRadiusAll(KSPATIALRADIUS, all, start, count, &sized);
+
+			mismatches += all != serial ? 1 : 0;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				bool inside = (size_t)start[i] + count[i] <= all.size();
+				mismatches += !inside || start[i] != serialStart[i] || count[i] != serialCount[i] ? 1 : 0;
+			}
+		}
+
+		ctx.Report("SpatialHash mismatches", "queries", (double)mismatches);
+		ctx.Check("SpatialHash mismatches", mismatches == 0);
+	}
+}
@@ -0,0 +1,367 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchVector3DCompress.cpp
+// func: 三维向量压缩编码的吞吐量、直接变换与精度报告
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <thread>
+
+#include "Bench.h"
+
+// 大批量：1M个点，未压缩时 12MB，压缩后 6MB 或 4MB，都超出一般的L2
+
+const size_t KLARGEBATCH = 1 << 20;
+
+static Vector3D RandUnitVector3D()
+{
+	Vector3D n;
+
+	do
+	{
+		n = RandVector3D(1.0f);
+	} while (GetMag(n) < 1e-3f);
+
+	n.Normalize();
+	return n;
+}
+
+WANDER_BENCH(Vector3DCompress)
+{
+	AABB3D bounds(Vector3D(-100.0f, -100.0f, -100.0f), Vector3D(100.0f, 100.0f, 100.0f));
+
+	std::vector<Vector3D> v(KBENCHBATCH), normal(KBENCHBATCH), out(KBENCHBATCH);
+	std::vector<HalfVector3D> half(KBENCHBATCH);
+	std::vector<QuantizedVector3D> quantized(KBENCHBATCH);
+	std::vector<OctNormal32> oct(KBENCHBATCH);
+
+	for (size_t i = 0; i < KBENCHBATCH; i++)
+	{
+		v[i] = RandVector3D(100.0f);
+		normal[i] = RandUnitVector3D();
+	}
+
+	Vector3DSoA soa(KBENCHBATCH), soaOut(KBENCHBATCH);
+	soa.FromAoS(&v[0], KBENCHBATCH);
+
+	PackN(&v[0], &half[0], KBENCHBATCH);
+	PackN(&v[0], bounds, &quantized[0], KBENCHBATCH);
+	PackN(&normal[0], &oct[0], KBENCHBATCH);
+
+	ctx.Measure("PackHalf scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			half[i] = PackHalf(v[i]);
+		}
+		DoNotOptimize(half[0]);
+	});
+
+	ctx.Measure("PackN half", KBENCHBATCH, [&]()
+	{
+		PackN(&v[0], &half[0], KBENCHBATCH);
+		DoNotOptimize(half[0]);
+	});
+
+	ctx.Measure("PackN half SoA", KBENCHBATCH, [&]()
+	{
+		PackN(soa, &half[0], KBENCHBATCH);
+		DoNotOptimize(half[0]);
+	});
+
+	ctx.Measure("Unpack half scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Unpack(half[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN half", KBENCHBATCH, [&]()
+	{
+		UnpackN(&half[0], &out[0], KBENCHBATCH);
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN half SoA", KBENCHBATCH, [&]()
+	{
+		UnpackN(&half[0], soaOut, KBENCHBATCH);
+		DoNotOptimize(soaOut.x[0]);
+	});
+
+	ctx.Measure("PackQuantized scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			quantized[i] = PackQuantized(v[i], bounds);
+		}
+		DoNotOptimize(quantized[0]);
+	});
+
+	ctx.Measure("PackN quantized", KBENCHBATCH, [&]()
+	{
+		PackN(&v[0], bounds, &quantized[0], KBENCHBATCH);
+		DoNotOptimize(quantized[0]);
+	});
+
+	ctx.Measure("Unpack quantized scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Unpack(quantized[i], bounds);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN quantized SoA", KBENCHBATCH, [&]()
+	{
+		UnpackN(&quantized[0], bounds, soaOut, KBENCHBATCH);
+		DoNotOptimize(soaOut.x[0]);
+	});
+
+	ctx.Measure("PackOctahedral scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			oct[i] = PackOctahedral(normal[i]);
+		}
+		DoNotOptimize(oct[0]);
+	});
+
+	ctx.Measure("PackN octahedral", KBENCHBATCH, [&]()
+	{
+		PackN(&normal[0], &oct[0], KBENCHBATCH);
+		DoNotOptimize(oct[0]);
+	});
+
+	ctx.Measure("Unpack octahedral scalar loop", KBENCHBATCH, [&]()
+	{
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			out[i] = Unpack(oct[i]);
+		}
+		DoNotOptimize(out[0]);
+	});
+
+	ctx.Measure("UnpackN octahedral SoA", KBENCHBATCH, [&]()
+	{
+		UnpackN(&oct[0], soaOut, KBENCHBATCH);
+		DoNotOptimize(soaOut.x[0]);
+	});
+
+	// 大批量变换：带宽受限时压缩数据的读取量更少
+
+	if (ctx.Enabled("Transform 1M"))
+	{
+		Matrix4X3 m = RandRigidMatrix();
+
+		std::vector<Vector3D> large(KLARGEBATCH), largeNormal(KLARGEBATCH);
+
+		for (size_t i = 0; i < KLARGEBATCH; i++)
+		{
+			large[i] = RandVector3D(100.0f);
+			largeNormal[i] = RandUnitVector3D();
+		}
+
+		Vector3DSoA largeSoA, largeOut(KLARGEBATCH);
+		largeSoA.FromAoS(&large[0], KLARGEBATCH);
+
+		std::vector<HalfVector3D> largeHalf(KLARGEBATCH);
+		std::vector<QuantizedVector3D> largeQuantized(KLARGEBATCH);
+		std::vector<OctNormal32> largeOct(KLARGEBATCH);
+
+		PackN(&large[0], &largeHalf[0], KLARGEBATCH);
+		PackN(&large[0], bounds, &largeQuantized[0], KLARGEBATCH);
+		PackN(&largeNormal[0], &largeOct[0], KLARGEBATCH);
+
+		Vector3DSoA largeNormalSoA;
+		largeNormalSoA.FromAoS(&largeNormal[0], KLARGEBATCH);
+
+		ctx.Measure("Transform 1M points Vector3DSoA (12MB)", KLARGEBATCH, [&]()
+		{
+			TransformPoints(m, largeSoA, largeOut, KLARGEBATCH);
+			DoNotOptimize(largeOut.x[0]);
+		});
+
+		ctx.Measure("Transform 1M points half (6MB)", KLARGEBATCH, [&]()
+		{
+			TransformPoints(m, &largeHalf[0], largeOut, KLARGEBATCH);
+			DoNotOptimize(largeOut.x[0]);
+		});
+
+		ctx.Measure("Transform 1M points quantized (6MB)", KLARGEBATCH, [&]()
+		{
+			TransformPoints(m, &largeQuantized[0], bounds, largeOut, KLARGEBATCH);
+			DoNotOptimize(largeOut.x[0]);
+		});
+
+		ctx.Measure("Transform 1M directions Vector3DSoA (12MB)", KLARGEBATCH, [&]()
+		{
+			TransformDirections(m, largeNormalSoA, largeOut, KLARGEBATCH);
+			DoNotOptimize(largeOut.x[0]);
+		});
+
+		ctx.Measure("Transform 1M directions octahedral (4MB)", KLARGEBATCH, [&]()
+		{
+			TransformDirections(m, &largeOct[0], largeOut, KLARGEBATCH);
+			DoNotOptimize(largeOut.x[0]);
+		});
+
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		JobPool pool(hardwareThreads > 0 ? hardwareThreads : 1);
+
+		ctx.Measure("Transform 1M points quantized pooled", KLARGEBATCH, [&]()
+		{
+			TransformPoints(m, &largeQuantized[0], bounds, largeOut, KLARGEBATCH, &pool);
+			DoNotOptimize(largeOut.x[0]);
+		});
+	}
+
+	// 精度：编码再解码的误差与各自的上界，以及批量与逐个结果不一致的个数
+	// 半精度的样本覆盖非规格化数到超出范围的各个数量级
+
+	if (ctx.Enabled("Half max relative error") || ctx.Enabled("Half batch/scalar mismatches"))
+	{
+		JobPool pool(4);
+		std::vector<Vector3D> samples(KBENCHBATCH * 16);
+
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			samples[i] = RandVector3D(1.0f) * powf(10.0f, RandRange(-9.0f, 5.0f));
+		}
+
+		std::vector<HalfVector3D> packed(samples.size());
+		std::vector<Vector3D> unpacked(samples.size());
+		PackN(&samples[0], &packed[0], samples.size(), &pool);
+		UnpackN(&packed[0], &unpacked[0], samples.size(), &pool);
+
+		double maxError = 0.0;
+		size_t mismatch = 0;
+
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			HalfVector3D single = PackHalf(samples[i]);
+			mismatch += memcmp(&single, &packed[i], sizeof(single)) != 0 ? 1 : 0;
+
+			const float *a = &samples[i].x;
+			const float *b = &unpacked[i].x;
+
+			// 非规格化数按最小规格化数折算成相对误差，截断的部分不计
+
+			for (int k = 0; k < 3; k++)
+			{
+				double expected = MIN(fabs((double)a[k]), (double)KHALFMAX) * (a[k] < 0.0f ? -1.0 : 1.0);
+				double scale = MAX(fabs(expected), 1.0 / 16384.0);
+				maxError = MAX(maxError, fabs((double)b[k] - expected) / scale);
+			}
+		}
+
+		ctx.Report("Half max relative error", "rel", maxError);
+		ctx.Report("Half relative error bound", "rel", (double)KHALFMAXRELERROR);
+		ctx.Report("Half batch/scalar mismatches", "count", (double)mismatch);
+	}
+
+	if (ctx.Enabled("Quantized max error") || ctx.Enabled("Quantized batch/scalar mismatches"))
+	{
+		JobPool pool(4);
+		std::vector<QuantizedVector3D> packed(KBENCHBATCH);
+
+		PackN(soa, bounds, &packed[0], KBENCHBATCH, &pool);
+		UnpackN(&packed[0], bounds, &out[0], KBENCHBATCH, &pool);
+
+		Vector3D bound = GetQuantizationError(bounds);
+		double maxError = 0.0;
+		size_t mismatch = 0;
+
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			QuantizedVector3D single = PackQuantized(v[i], bounds);
+			mismatch += memcmp(&single, &packed[i], sizeof(single)) != 0 ? 1 : 0;
+
+			maxError = MAX(maxError, (double)fabsf(out[i].x - v[i].x));
+			maxError = MAX(maxError, (double)fabsf(out[i].y - v[i].y));
+			maxError = MAX(maxError, (double)fabsf(out[i].z - v[i].z));
+		}
+
+		ctx.Report("Quantized max error (200 box)", "abs", maxError);
+		ctx.Report("Quantized error bound (200 box)", "abs", (double)MAX(bound.x, MAX(bound.y, bound.z)));
+		ctx.Report("Quantized batch/scalar mismatches", "count", (double)mismatch);
+	}
+
+	if (ctx.Enabled("Octahedral max angular error") || ctx.Enabled("Octahedral batch/scalar mismatches"))
+	{
+		JobPool pool(4);
+		std::vector<Vector3D> samples(KBENCHBATCH * 64);
+
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			samples[i] = RandUnitVector3D();
+		}
+
+		samples[0] = Vector3D(0.0f, 0.0f, 1.0f);
+		samples[1] = Vector3D(0.0f, 0.0f, -1.0f);
+		samples[2] = Vector3D(-1.0f, 0.0f, 0.0f);
+
+		std::vector<OctNormal32> packed(samples.size());
+		std::vector<Vector3D> unpacked(samples.size());
+		PackN(&samples[0], &packed[0], samples.size(), &pool);
+		UnpackN(&packed[0], &unpacked[0], samples.size(), &pool);
+
+		double maxError = 0.0;
+		size_t mismatch = 0;
+
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			OctNormal32 single = PackOctahedral(samples[i]);
+			mismatch += memcmp(&single, &packed[i], sizeof(single)) != 0 ? 1 : 0;
+
+			const Vector3D &a = samples[i];
+			const Vector3D &b = unpacked[i];
+			maxError = MAX(maxError, atan2((double)GetMag(CrossProduct(a, b)), (double)(a * b)));
+		}
+
+		ctx.Report("Octahedral max angular error", "rad", maxError);
+		ctx.Report("Octahedral error bound", "rad", (double)KOCTNORMALMAXERROR);
+		ctx.Report("Octahedral batch/scalar mismatches", "count", (double)mismatch);
+	}
+
+	// 直接变换与先解码再变换一致
+
+	if (ctx.Enabled("Compressed transform max error"))
+	{
+		Matrix4X3 m = RandRigidMatrix();
+		std::vector<Vector3D> direct(KBENCHBATCH), reference(KBENCHBATCH);
+		double maxError = 0.0;
+
+		TransformPoints(m, &half[0], &direct[0], KBENCHBATCH);
+		UnpackN(&half[0], &out[0], KBENCHBATCH);
+		TransformPoints(m, &out[0], &reference[0], KBENCHBATCH);
+
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			maxError = MAX(maxError, (double)GetMag(direct[i] - reference[i]));
+		}
+
+		TransformPoints(m, &quantized[0], bounds, &direct[0], KBENCHBATCH);
+		UnpackN(&quantized[0], bounds, &out[0], KBENCHBATCH);
+		TransformPoints(m, &out[0], &reference[0], KBENCHBATCH);
+
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			maxError = MAX(maxError, (double)GetMag(direct[i] - reference[i]));
+		}
+
+		TransformDirections(m, &oct[0], &direct[0], KBENCHBATCH);
+		UnpackN(&oct[0], &out[0], KBENCHBATCH);
+		TransformDirections(m, &out[0], &reference[0], KBENCHBATCH);
+
+		for (size_t i = 0; i < KBENCHBATCH; i++)
+		{
+			maxError = MAX(maxError, (double)GetMag(direct[i] - reference[i]));
+		}
+
+		ctx.Report("Compressed transform max error", "abs", maxError);
+	}
+}
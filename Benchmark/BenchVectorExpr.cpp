@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: BenchVectorExpr.cpp
+// func: 表达式模板与普通运算符的对比，模拟逐帧的位置积分与转向力计算
+//
+///////////////////////////////////////////////////////////////////
+
+#include <thread>
+
+#include "Bench.h"
+#include "VectorExpr.h"
+
+const size_t KEXPRAGENTS = 1 << 18;
+
+// 转向力 desired + velocity * damping - target，逐个向量计算
+
+static void SteerClassic(const std::vector<Vector3D> &desired, const std::vector<Vector3D> &vel, const std::vector<Vector3D> &target, float damping, std::vector<Vector3D> &out)
+{
+	for (size_t i = 0; i < out.size(); i++)
+	{
+		out[i] = desired[i] + vel[i] * damping - target[i];
+	}
+}
+
+static void SteerExpr(const std::vector<Vector3D> &desired, const std::vector<Vector3D> &vel, const std::vector<Vector3D> &target, float damping, std::vector<Vector3D> &out)
+{
+	for (size_t i = 0; i < out.size(); i++)
+	{
+		out[i] = MakeExpr(desired[i]) + MakeExpr(vel[i]) * damping - target[i];
+	}
+}
+
+WANDER_BENCH(VectorExpr)
+{
+	std::vector<Vector3D> desired(KEXPRAGENTS), vel(KEXPRAGENTS), target(KEXPRAGENTS);
+	std::vector<Vector3D> out0(KEXPRAGENTS), out1(KEXPRAGENTS);
+	std::vector<float> dt(KEXPRAGENTS);
+
+	Vector3DSoA pos(KEXPRAGENTS), velSoA(KEXPRAGENTS), posOut(KEXPRAGENTS);
+	Vector3D gravity(0.0f, -9.8f, 0.0f);
+
+	for (size_t i = 0; i < KEXPRAGENTS; i++)
+	{
+		desired[i] = RandVector3D(10.0f);
+		vel[i] = RandVector3D(10.0f);
+		target[i] = RandVector3D(10.0f);
+		dt[i] = RandRange(0.001f, 0.033f);
+
+		pos.Set(i, RandVector3D(100.0f));
+		velSoA.Set(i, vel[i]);
+	}
+
+	float damping = 0.9f;
+
+	// 单个向量：逐个元素组成表达式，与普通运算符比较
+
+	ctx.Measure("Vector3D a + b * s - c operators (256K)", KEXPRAGENTS, [&]()
+	{
+		SteerClassic(desired, vel, target, damping, out0);
+		DoNotOptimize(out0[0]);
+	});
+
+	ctx.Measure("Vector3D a + b * s - c MakeExpr (256K)", KEXPRAGENTS, [&]()
+	{
+		SteerExpr(desired, vel, target, damping, out1);
+		DoNotOptimize(out1[0]);
+	});
+
+	// 数组：位置积分 p + v * dt + g * (dt * 0.5)，每个元素有自己的时间步长
+
+	ctx.Measure("Integrate AoS Vector3D loop (256K)", KEXPRAGENTS, [&]()
+	{
+		for (size_t i = 0; i < KEXPRAGENTS; i++)
+		{
+			Vector3D p = pos.Get(i);
+			posOut.Set(i, p + velSoA.Get(i) * dt[i] + gravity * (dt[i] * 0.5f));
+		}
+
+		DoNotOptimize(posOut.x[0]);
+	});
+
+	ctx.Measure("Integrate SoA Assign (256K)", KEXPRAGENTS, [&]()
+	{
+		Assign(posOut, MakeExpr(pos) + MakeExpr(velSoA) * MakeExpr(&dt[0]) + MakeExpr(gravity) * 0.5f * MakeExpr(&dt[0]), KEXPRAGENTS);
+		DoNotOptimize(posOut.x[0]);
+	});
+
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		JobPool pool(hardwareThreads > 0 ? hardwareThreads : 1);
+
+		ctx.Measure("Integrate SoA Assign pooled (256K)", KEXPRAGENTS, [&]()
+		{
+			Assign(posOut, MakeExpr(pos) + MakeExpr(velSoA) * MakeExpr(&dt[0]) + MakeExpr(gravity) * 0.5f * MakeExpr(&dt[0]), KEXPRAGENTS, &pool);
+			DoNotOptimize(posOut.x[0]);
+		});
+	}
+
+	// 单个向量的表达式与普通运算符逐位一致；数组表达式的乘法顺序不同，
+	// 允许舍入误差
+
+	if (ctx.Enabled("VectorExpr max error"))
+	{
+		SteerClassic(desired, vel, target, damping, out0);
+		SteerExpr(desired, vel, target, damping, out1);
+
+		size_t mismatches = 0;
+
+		for (size_t i = 0; i < KEXPRAGENTS; i++)
+		{
+			mismatches += out0[i] != out1[i] ? 1 : 0;
+		}
+
+		ctx.Report("VectorExpr operator mismatches", "vectors", (double)mismatches);
+
+		JobPool pool(4);
+		Assign(posOut, MakeExpr(pos) + MakeExpr(velSoA) * MakeExpr(&dt[0]) + MakeExpr(gravity) * 0.5f * MakeExpr(&dt[0]), KEXPRAGENTS, &pool);
+
+		float maxError = 0.0f;
+
+		for (size_t i = 0; i < KEXPRAGENTS; i++)
+		{
+			Vector3D expect = pos.Get(i) + velSoA.Get(i) * dt[i] + gravity * (dt[i] * 0.5f);
+			Vector3D d = posOut.Get(i) - expect;
+
+			maxError = MAX(maxError, MAX(fabsf(d.x), MAX(fabsf(d.y), fabsf(d.z))));
+		}
+
+		ctx.Report("VectorExpr max error", "abs", (double)maxError);
+	}
+}
@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: AABB3D.h
+// func: 轴对齐包围盒
+// disc: 来源于3D Math Primer for Graphics and Game Development 中的
+//		 AABB3，用 min/max 两个角点表示，Empty 之后 min > max
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_AABB3D_h
+#define Wander_AABB3D_h
+
+#include <cfloat>
+
+#include "Vector3D.h"
+
+class AABB3D
+{
+public:
+	AABB3D()
+	{
+	}
+
+	AABB3D(const Point3D &nmin, const Point3D &nmax)
+		: min(nmin)
+		, max(nmax)
+	{
+	}
+
+	// 置为空盒，之后可以用 Add 逐个加入点或盒
+
+	void Empty()
+	{
+		min.Init(FLT_MAX, FLT_MAX, FLT_MAX);
+		max.Init(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	}
+
+	bool IsEmpty() const
+	{
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	void Add(const Point3D &p)
+	{
+		min.Init(MIN(min.x, p.x), MIN(min.y, p.y), MIN(min.z, p.z));
+		max.Init(MAX(max.x, p.x), MAX(max.y, p.y), MAX(max.z, p.z));
+	}
+
+	void Add(const AABB3D &box)
+	{
+		min.Init(MIN(min.x, box.min.x), MIN(min.y, box.min.y), MIN(min.z, box.min.z));
+		max.Init(MAX(max.x, box.max.x), MAX(max.y, box.max.y), MAX(max.z, box.max.z));
+	}
+
+	Vector3D Size() const
+	{
+		return max - min;
+	}
+
+	Point3D Center() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	// 表面积，用于SAH代价估计；空盒返回0
+
+	float SurfaceArea() const
+	{
+		if (IsEmpty())
+		{
+			return 0.0f;
+		}
+
+		Vector3D d = max - min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	bool Contains(const Point3D &p) const
+	{
+		return p.x >= min.x && p.x <= max.x &&
+			p.y >= min.y && p.y <= max.y &&
+			p.z >= min.z && p.z <= max.z;
+	}
+
+public:
+	Point3D min;
+	Point3D max;
+};
+
+// 两个盒是否相交，只接触边界也算相交
+
+inline bool IntersectAABBs(const AABB3D &a, const AABB3D &b)
+{
+	return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+		a.min.y <= b.max.y && a.max.y >= b.min.y &&
+		a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+#endif
@@ -0,0 +1,291 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: AnimationClip.cpp
+// func: 骨骼动画片段的关键帧轨道与采样
+//
+///////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+
+#include "AnimationClip.h"
+#include "JobPool.h"
+#include "QuaternionBatch.h"
+#include "CommonMath.h"
+#include "Simd.h"
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be four packed floats");
+static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D must be three packed floats");
+
+// 每次插值的骨骼数，暂存的关键帧放在栈上
+
+static const size_t KSAMPLECHUNK = 64;
+
+// 游标向后逐个推进的最大步数，超过时改用二分查找
+
+static const unsigned KCURSORMAXSTEPS = 4;
+
+/////////////////////////////////////////////////
+//
+// 内部实现
+//
+/////////////////////////////////////////////////
+
+// NlerpRange
+//
+// out[i] = normalize(q0[i] + (q1[i] - q0[i]) * t[i])，点积为负时先翻转 q1 取短弧
+
+static void NlerpRange(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat aw, ax, ay, az;
+		SimdFloat bw, bx, by, bz;
+
+		SimdLoadAoS4(&q0[i].w, aw, ax, ay, az);
+		SimdLoadAoS4(&q1[i].w, bw, bx, by, bz);
+
+		SimdFloat tt = SimdLoad(t + i);
+
+		SimdFloat dot = SimdMulAdd(az, bz, SimdMulAdd(ay, by, SimdMulAdd(ax, bx, SimdMul(aw, bw))));
+		SimdFloat sign = SimdSignBit(dot);
+
+		SimdFloat rw = SimdMulAdd(SimdSub(SimdXor(bw, sign), aw), tt, aw);
+		SimdFloat rx = SimdMulAdd(SimdSub(SimdXor(bx, sign), ax), tt, ax);
+		SimdFloat ry = SimdMulAdd(SimdSub(SimdXor(by, sign), ay), tt, ay);
+		SimdFloat rz = SimdMulAdd(SimdSub(SimdXor(bz, sign), az), tt, az);
+
+		SimdFloat magSq = SimdMulAdd(rz, rz, SimdMulAdd(ry, ry, SimdMulAdd(rx, rx, SimdMul(rw, rw))));
+		SimdFloat inv = SimdDiv(SimdSet1(1.0f), SimdSqrt(magSq));
+
+		SimdStoreAoS4(&out[i].w, SimdMul(rw, inv), SimdMul(rx, inv), SimdMul(ry, inv), SimdMul(rz, inv));
+	}
+
+	for (; i < n; i++)
+	{
+		const Quaternion &a = q0[i];
+		float sign = DotProduct(a, q1[i]) < 0.0f ? -1.0f : 1.0f;
+
+		Quaternion r;
+		r.w = a.w + (q1[i].w * sign - a.w) * t[i];
+		r.x = a.x + (q1[i].x * sign - a.x) * t[i];
+		r.y = a.y + (q1[i].y * sign - a.y) * t[i];
+		r.z = a.z + (q1[i].z * sign - a.z) * t[i];
+		r.Normalize();
+		out[i] = r;
+	}
+}
+
+// 三个连续float一组的线性插值 out = a + (b - a) * t，t 已按分量展开
+
+static void LerpFloats(const float *a, const float *b, const float *t, float *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat va = SimdLoad(a + i);
+		SimdStore(out + i, SimdMulAdd(SimdSub(SimdLoad(b + i), va), SimdLoad(t + i), va));
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = a[i] + (b[i] - a[i]) * t[i];
+	}
+}
+
+/////////////////////////////////////////////////
+//
+// AnimationClip
+//
+/////////////////////////////////////////////////
+
+AnimationClip::AnimationClip()
+	: m_duration(0.0f)
+{
+}
+
+void AnimationClip::Clear()
+{
+	m_times.clear();
+	m_rotations.clear();
+	m_translations.clear();
+	m_trackStart.clear();
+	m_trackCount.clear();
+	m_duration = 0.0f;
+}
+
+int AnimationClip::AddTrack(const float *times, const Quaternion *rotations, const Vector3D *translations, size_t n)
+{
+	assert(n > 0);
+
+	for (size_t i = 1; i < n; i++)
+	{
+		assert(times[i] > times[i - 1]);
+	}
+
+	m_trackStart.push_back((unsigned)m_times.size());
+	m_trackCount.push_back((unsigned)n);
+
+	m_times.insert(m_times.end(), times, times + n);
+	m_rotations.insert(m_rotations.end(), rotations, rotations + n);
+	m_translations.insert(m_translations.end(), translations, translations + n);
+
+	m_duration = MAX(m_duration, times[n - 1]);
+
+	return (int)m_trackStart.size() - 1;
+}
+
+// FindKey
+//
+// 二分查找 time 所在区间的左端关键帧，结果限制在 [0, 关键帧数 - 2]，
+// 只有一个关键帧时返回0
+
+unsigned AnimationClip::FindKey(size_t bone, float time) const
+{
+	unsigned count = m_trackCount[bone];
+
+	if (count < 2)
+	{
+		return 0;
+	}
+
+	const float *times = &m_times[m_trackStart[bone]];
+	unsigned upper = (unsigned)(std::upper_bound(times, times + count, time) - times);
+
+	return upper == 0 ? 0 : MIN(upper - 1, count - 2);
+}
+
+// AdvanceKey
+//
+// 从上一次的位置向后推进，时间后退或跳得太远时改用二分查找
+
+unsigned AnimationClip::AdvanceKey(size_t bone, unsigned key, float time) const
+{
+	unsigned count = m_trackCount[bone];
+
+	if (count < 2)
+	{
+		return 0;
+	}
+
+	const float *times = &m_times[m_trackStart[bone]];
+
+	if (key + 1 >= count || time < times[key])
+	{
+		return FindKey(bone, time);
+	}
+
+	for (unsigned step = 0; key + 2 < count && times[key + 1] <= time; step++)
+	{
+		if (step == KCURSORMAXSTEPS)
+		{
+			return FindKey(bone, time);
+		}
+
+		key++;
+	}
+
+	return key;
+}
+
+// Sample
+//
+// 每 KSAMPLECHUNK 根骨骼一组：先逐根推进游标，把两侧的关键帧与
+// 区间内的插值参数取到栈上，再整组插值旋转与平移
+
+void AnimationClip::Sample(float time, AnimationCursor &cursor, Quaternion *rotation, Vector3D *translation,
+						   int interpolation) const
+{
+	size_t bones = m_trackStart.size();
+
+	if (cursor.m_key.size() != bones)
+	{
+		cursor.m_key.assign(bones, 0);
+	}
+
+	Quaternion q0[KSAMPLECHUNK], q1[KSAMPLECHUNK];
+	float p0[KSAMPLECHUNK * 3], p1[KSAMPLECHUNK * 3];
+	float u[KSAMPLECHUNK], u3[KSAMPLECHUNK * 3];
+
+	for (size_t begin = 0; begin < bones; begin += KSAMPLECHUNK)
+	{
+		size_t count = MIN(KSAMPLECHUNK, bones - begin);
+
+		for (size_t j = 0; j < count; j++)
+		{
+			size_t bone = begin + j;
+			unsigned key = AdvanceKey(bone, cursor.m_key[bone], time);
+			cursor.m_key[bone] = key;
+
+			unsigned start = m_trackStart[bone];
+			unsigned next = key + 1 < m_trackCount[bone] ? key + 1 : key;
+
+			const float *times = &m_times[start];
+			float span = times[next] - times[key];
+			float t = span > 0.0f ? (time - times[key]) / span : 0.0f;
+
+			u[j] = MIN(MAX(t, 0.0f), 1.0f);
+			u3[j * 3] = u3[j * 3 + 1] = u3[j * 3 + 2] = u[j];
+
+			q0[j] = m_rotations[start + key];
+			q1[j] = m_rotations[start + next];
+			memcpy(p0 + j * 3, &m_translations[start + key], sizeof(Vector3D));
+			memcpy(p1 + j * 3, &m_translations[start + next], sizeof(Vector3D));
+		}
+
+		if (interpolation == KNLERP)
+		{
+			NlerpRange(q0, q1, u, rotation + begin, count);
+		}
+		else
+		{
+			SlerpN(q0, q1, u, rotation + begin, count);
+		}
+
+		LerpFloats(p0, p1, u3, &translation[begin].x, count * 3);
+	}
+}
+
+void AnimationClip::SampleBone(size_t bone, float time, Quaternion &rotation, Vector3D &translation) const
+{
+	assert(bone < m_trackStart.size());
+
+	unsigned key = FindKey(bone, time);
+	unsigned start = m_trackStart[bone];
+	unsigned next = key + 1 < m_trackCount[bone] ? key + 1 : key;
+
+	const float *times = &m_times[start];
+	float span = times[next] - times[key];
+	float t = span > 0.0f ? (time - times[key]) / span : 0.0f;
+	t = MIN(MAX(t, 0.0f), 1.0f);
+
+	const Vector3D &a = m_translations[start + key];
+	const Vector3D &b = m_translations[start + next];
+
+	rotation = Slerp(m_rotations[start + key], m_rotations[start + next], t);
+	translation = Vector3D(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+}
+
+/////////////////////////////////////////////////
+//
+// 非成员函数
+//
+/////////////////////////////////////////////////
+
+void SampleN(const AnimationClip &clip, const float *time, AnimationCursor *cursors,
+			 Quaternion *rotation, Vector3D *translation, size_t instances, int interpolation, JobPool *pool)
+{
+	size_t bones = clip.BoneCount();
+	size_t grain = MAX(KJOBBATCHGRAIN / MAX(bones, (size_t)1), (size_t)1);
+
+	ParallelFor(pool, 0, instances, grain, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			clip.Sample(time[i], cursors[i], rotation + i * bones, translation + i * bones, interpolation);
+		}
+	});
+}
@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: AnimationClip.h
+// func: 骨骼动画片段的关键帧轨道与采样
+// disc: 每根骨骼一条轨道，旋转与平移共用一组关键帧时刻；
+//		 关键帧按属性分开存放（时刻、旋转、平移各一个数组），查找时
+//		 只访问紧凑的时刻数组，找到位置后才读取两侧的关键帧
+//		 每个实例持有一个 AnimationCursor，记住各骨骼上一次所在的关键帧，
+//		 时间单调前进时每根骨骼只需向后比较一两次，后退或跳转时
+//		 退回二分查找
+//		 采样按 KSIMDWIDTH 根骨骼一组插值，旋转可选 Slerp 或更快的
+//		 归一化线性插值（nlerp）
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_AnimationClip_h
+#define Wander_AnimationClip_h
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "Quaternion.h"
+#include "Vector3D.h"
+
+class JobPool;
+
+// 采样游标，每个播放实例一个，由 AnimationClip::Sample 维护
+// 第一次使用或换用骨骼数不同的片段时自动重置
+
+class AnimationCursor
+{
+public:
+	AnimationCursor()
+	{
+	}
+
+	void Reset()
+	{
+		m_key.clear();
+	}
+
+private:
+	friend class AnimationClip;
+
+	// 各骨骼所在区间的左端关键帧
+
+	std::vector<unsigned> m_key;
+};
+
+class AnimationClip
+{
+public:
+
+	// 旋转的插值方式
+
+	enum
+	{
+		KSLERP = 0,		// 与 Slerp 一致
+		KNLERP			// 线性插值后归一化，关键帧间夹角小时误差很小
+	};
+
+	AnimationClip();
+
+	void Clear();
+
+	// AddTrack
+	//
+	// 加入一根骨骼的轨道，返回骨骼下标
+	// times 严格递增，至少一个关键帧，rotations 为单位四元数
+
+	int AddTrack(const float *times, const Quaternion *rotations, const Vector3D *translations, size_t n);
+
+	size_t BoneCount() const
+	{
+		return m_trackStart.size();
+	}
+
+	size_t KeyCount(size_t bone) const
+	{
+		assert(bone < m_trackStart.size());
+		return m_trackCount[bone];
+	}
+
+	// 所有轨道中最后一个关键帧的时刻
+
+	float Duration() const
+	{
+		return m_duration;
+	}
+
+	// Sample
+	//
+	// 在 time 时刻采样全部骨骼，写入 rotation[bone] 与 translation[bone]
+	// 超出轨道时间范围时取首尾关键帧，循环播放由调用者折算时间
+
+	void Sample(float time, AnimationCursor &cursor, Quaternion *rotation, Vector3D *translation,
+				int interpolation = KSLERP) const;
+
+	// 不使用游标，二分查找后逐个调用 Slerp，作为参考结果
+
+	void SampleBone(size_t bone, float time, Quaternion &rotation, Vector3D &translation) const;
+
+private:
+	unsigned FindKey(size_t bone, float time) const;
+	unsigned AdvanceKey(size_t bone, unsigned key, float time) const;
+
+private:
+	std::vector<float> m_times;
+	std::vector<Quaternion> m_rotations;
+	std::vector<Vector3D> m_translations;
+
+	// 各轨道在上面三个数组中的起点与关键帧数
+
+	std::vector<unsigned> m_trackStart;
+	std::vector<unsigned> m_trackCount;
+
+	float m_duration;
+};
+
+// SampleN
+//
+// 同一片段的多个实例，第 i 个实例在 time[i] 时刻采样，使用 cursors[i]，
+// 结果写入 rotation/translation 的 [i * BoneCount(), (i + 1) * BoneCount())
+// pool 不为NULL时按实例分块并行
+
+extern void SampleN(const AnimationClip &clip, const float *time, AnimationCursor *cursors,
+					Quaternion *rotation, Vector3D *translation, size_t instances,
+					int interpolation = AnimationClip::KSLERP, JobPool *pool = NULL);
+
+#endif
@@ -0,0 +1,1019 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Bvh.cpp
+// func: 包围体层次结构的构建、更新与遍历
+//
+///////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+
+#include "Bvh.h"
+#include "JobPool.h"
+#include "Simd.h"
+
+static_assert(sizeof(BvhNode) == 32, "two sibling nodes must fill one cache line");
+
+// 每个轴上的分桶数
+
+static const int KBVHBINS = 16;
+
+// 叶子最多容纳的图元数，超过时即使SAH认为不划算也继续切分
+
+static const uint32_t KBVHMAXLEAF = 8;
+
+// SAH中遍历一个节点相对于与一个图元求交的代价
+
+static const float KBVHTRAVERSALCOST = 1.0f;
+
+// 超过此深度后改为按个数对半切分，保证整棵树不超过 KBVHSTACKSIZE 层
+
+static const int KBVHMEDIANDEPTH = 32;
+static const int KBVHSTACKSIZE = 64;
+
+// 图元数不少于此值的节点由线程池并行分桶
+
+static const size_t KBVHPARALLELBINNING = 65536;
+static const size_t KBVHBINGRAIN = 16384;
+
+// 子树任务的最小图元数，再小时分任务的开销超过构建本身
+
+static const size_t KBVHMINTASK = 2048;
+
+// 批量射线查询每块的射线数
+
+static const size_t KBVHRAYGRAIN = 64;
+
+///////////////////////////////////////////////////////////////////
+//
+// 包围盒辅助函数
+//
+///////////////////////////////////////////////////////////////////
+
+static void EmptyBox(BvhBox &box)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		box.min[k] = FLT_MAX;
+		box.max[k] = -FLT_MAX;
+	}
+}
+
+static inline void GrowBox(BvhBox &box, const BvhBox &other)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		box.min[k] = MIN(box.min[k], other.min[k]);
+		box.max[k] = MAX(box.max[k], other.max[k]);
+	}
+}
+
+static inline void GrowBox(BvhBox &box, const float *p)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		box.min[k] = MIN(box.min[k], p[k]);
+		box.max[k] = MAX(box.max[k], p[k]);
+	}
+}
+
+static void GrowBox(BvhBox &box, const Point3D &p)
+{
+	float v[3] = {p.x, p.y, p.z};
+	GrowBox(box, v);
+}
+
+static float BoxArea(const BvhBox &box)
+{
+	float dx = box.max[0] - box.min[0];
+	float dy = box.max[1] - box.min[1];
+	float dz = box.max[2] - box.min[2];
+
+	if (dx < 0.0f || dy < 0.0f || dz < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static BvhBox ToBox(const AABB3D &aabb)
+{
+	BvhBox box = {{aabb.min.x, aabb.min.y, aabb.min.z}, {aabb.max.x, aabb.max.y, aabb.max.z}};
+	return box;
+}
+
+static inline bool BoxesOverlap(const BvhBox &a, const BvhBox &b)
+{
+	return a.min[0] <= b.max[0] && a.max[0] >= b.min[0] &&
+		a.min[1] <= b.max[1] && a.max[1] >= b.min[1] &&
+		a.min[2] <= b.max[2] && a.max[2] >= b.min[2];
+}
+
+static void SetNodeBounds(BvhNode &node, const BvhBox &box)
+{
+	node.minX = box.min[0];
+	node.minY = box.min[1];
+	node.minZ = box.min[2];
+	node.maxX = box.max[0];
+	node.maxY = box.max[1];
+	node.maxZ = box.max[2];
+}
+
+static BvhBox GetNodeBounds(const BvhNode &node)
+{
+	BvhBox box = {{node.minX, node.minY, node.minZ}, {node.maxX, node.maxY, node.maxZ}};
+	return box;
+}
+
+// 射线与包围盒的入口距离，未相交时返回 FLT_MAX
+// invDir 为方向的倒数，分量为0时是无穷大，IEEE运算仍然给出正确的区间
+
+static inline float RayBoxEntry(float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+	const Point3D &origin, const Vector3D &invDir, float tMax)
+{
+	float tx1 = (minX - origin.x) * invDir.x;
+	float tx2 = (maxX - origin.x) * invDir.x;
+	float tNear = MIN(tx1, tx2);
+	float tFar = MAX(tx1, tx2);
+
+	float ty1 = (minY - origin.y) * invDir.y;
+	float ty2 = (maxY - origin.y) * invDir.y;
+	tNear = MAX(tNear, MIN(ty1, ty2));
+	tFar = MIN(tFar, MAX(ty1, ty2));
+
+	float tz1 = (minZ - origin.z) * invDir.z;
+	float tz2 = (maxZ - origin.z) * invDir.z;
+	tNear = MAX(tNear, MIN(tz1, tz2));
+	tFar = MIN(tFar, MAX(tz1, tz2));
+
+	tNear = MAX(tNear, 0.0f);
+	tFar = MIN(tFar, tMax);
+
+	return tNear <= tFar ? tNear : FLT_MAX;
+}
+
+static inline float RayBoxEntry(const BvhNode &node, const Point3D &origin, const Vector3D &invDir, float tMax)
+{
+	return RayBoxEntry(node.minX, node.minY, node.minZ, node.maxX, node.maxY, node.maxZ, origin, invDir, tMax);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// 分桶SAH
+//
+///////////////////////////////////////////////////////////////////
+
+struct BvhBins
+{
+	BvhBox bounds[3][KBVHBINS];
+	uint32_t count[3][KBVHBINS];
+};
+
+// 构建时的图元，包围盒、中心与原始下标放在一起，划分时整体移动，
+// 各层扫描都是顺序访问
+
+struct BvhBuildPrim
+{
+	BvhBox box;
+	float centroid[3];
+	int index;
+};
+
+// 构建时共享的数据，prims 按节点区间划分，各任务互不重叠
+
+struct BvhBuilder
+{
+	BvhBuildPrim *prims;
+	JobPool *pool;
+};
+
+// 节点的包围盒与图元中心的包围盒
+
+static void ComputeRangeBounds(const BvhBuilder &b, size_t first, size_t count, BvhBox &bounds, BvhBox &centroidBounds)
+{
+	EmptyBox(bounds);
+	EmptyBox(centroidBounds);
+
+	for (size_t i = first; i < first + count; i++)
+	{
+		GrowBox(bounds, b.prims[i].box);
+		GrowBox(centroidBounds, b.prims[i].centroid);
+	}
+}
+
+static inline int BinIndex(float c, float cmin, float scale, int binCount)
+{
+	int bin = (int)((c - cmin) * scale);
+	return bin < 0 ? 0 : (bin >= binCount ? binCount - 1 : bin);
+}
+
+static void ClearBins(BvhBins &bins, int binCount)
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int k = 0; k < binCount; k++)
+		{
+			EmptyBox(bins.bounds[axis][k]);
+			bins.count[axis][k] = 0;
+		}
+	}
+}
+
+static void FillBins(const BvhBuilder &b, size_t first, size_t end, const BvhBox &centroidBounds, const float *scale, int binCount, BvhBins &bins)
+{
+	for (size_t i = first; i < end; i++)
+	{
+		const float *c = b.prims[i].centroid;
+		const BvhBox &box = b.prims[i].box;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			int bin = BinIndex(c[axis], centroidBounds.min[axis], scale[axis], binCount);
+			GrowBox(bins.bounds[axis][bin], box);
+			bins.count[axis][bin]++;
+		}
+	}
+}
+
+// 节点区间的分桶统计，图元多时按块交给线程池，每块写入自己的分桶后合并
+
+static void ComputeBins(const BvhBuilder &b, size_t first, size_t count, const BvhBox &centroidBounds, const float *scale, int binCount, BvhBins &bins)
+{
+	ClearBins(bins, binCount);
+
+	if (b.pool == NULL || count < KBVHPARALLELBINNING)
+	{
+		FillBins(b, first, first + count, centroidBounds, scale, binCount, bins);
+		return;
+	}
+
+	std::vector<BvhBins> partial((count + KBVHBINGRAIN - 1) / KBVHBINGRAIN);
+
+	b.pool->ParallelFor(first, first + count, KBVHBINGRAIN, [&](size_t blockBegin, size_t blockEnd)
+	{
+		BvhBins &local = partial[(blockBegin - first) / KBVHBINGRAIN];
+		ClearBins(local, binCount);
+		FillBins(b, blockBegin, blockEnd, centroidBounds, scale, binCount, local);
+	});
+
+	for (size_t p = 0; p < partial.size(); p++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (int k = 0; k < binCount; k++)
+			{
+				GrowBox(bins.bounds[axis][k], partial[p].bounds[axis][k]);
+				bins.count[axis][k] += partial[p].count[axis][k];
+			}
+		}
+	}
+}
+
+// SplitNode
+//
+// 为节点选择切分平面并就地划分图元，返回左半部分的图元数
+// 返回0表示应作为叶子
+
+static uint32_t SplitNode(const BvhBuilder &b, BvhNode &node, int depth)
+{
+	size_t first = node.leftFirst;
+	size_t count = node.count;
+
+	BvhBox bounds, centroidBounds;
+	ComputeRangeBounds(b, first, count, bounds, centroidBounds);
+	SetNodeBounds(node, bounds);
+
+	if (count <= 1)
+	{
+		return 0;
+	}
+
+	// 图元少的节点用较少的桶，SAH扫描的开销与桶数成正比
+
+	int binCount = count < (size_t)KBVHBINS ? (int)count : KBVHBINS;
+	float extent[3];
+	float scale[3];
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		extent[axis] = centroidBounds.max[axis] - centroidBounds.min[axis];
+		scale[axis] = extent[axis] > 0.0f ? binCount / extent[axis] : 0.0f;
+	}
+
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = FLT_MAX;
+
+	if (depth < KBVHMEDIANDEPTH)
+	{
+		BvhBins bins;
+		ComputeBins(b, first, count, centroidBounds, scale, binCount, bins);
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (scale[axis] == 0.0f)
+			{
+				continue;
+			}
+
+			// 从右向左累计右侧的面积与个数，再从左向右扫描
+
+			float rightArea[KBVHBINS];
+			uint32_t rightCount[KBVHBINS];
+			BvhBox acc;
+			EmptyBox(acc);
+			uint32_t n = 0;
+
+			for (int k = binCount - 1; k > 0; k--)
+			{
+				GrowBox(acc, bins.bounds[axis][k]);
+				n += bins.count[axis][k];
+				rightArea[k] = BoxArea(acc);
+				rightCount[k] = n;
+			}
+
+			EmptyBox(acc);
+			n = 0;
+
+			for (int k = 1; k < binCount; k++)
+			{
+				GrowBox(acc, bins.bounds[axis][k - 1]);
+				n += bins.count[axis][k - 1];
+
+				if (n == 0 || rightCount[k] == 0)
+				{
+					continue;
+				}
+
+				float cost = BoxArea(acc) * n + rightArea[k] * rightCount[k];
+
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = k;
+				}
+			}
+		}
+	}
+
+	// 与作为叶子的代价比较，代价都除以节点的表面积
+
+	float area = BoxArea(bounds);
+	bool splitWins = bestAxis >= 0 && (area <= 0.0f || KBVHTRAVERSALCOST + bestCost / area < (float)count);
+
+	if (!splitWins && count <= KBVHMAXLEAF)
+	{
+		return 0;
+	}
+
+	BvhBuildPrim *begin = b.prims + first;
+	BvhBuildPrim *end = begin + count;
+
+	if (bestAxis >= 0)
+	{
+		float cmin = centroidBounds.min[bestAxis];
+		float s = scale[bestAxis];
+		int axis = bestAxis;
+		int split = bestSplit;
+
+		BvhBuildPrim *mid = std::partition(begin, end, [&](const BvhBuildPrim &prim)
+		{
+			return BinIndex(prim.centroid[axis], cmin, s, binCount) < split;
+		});
+
+		return (uint32_t)(mid - begin);
+	}
+
+	// 中心重合或深度过大时按最长轴的中位数对半切分
+
+	int axis = extent[0] >= extent[1] ? (extent[0] >= extent[2] ? 0 : 2) : (extent[1] >= extent[2] ? 1 : 2);
+	std::nth_element(begin, begin + count / 2, end, [&](const BvhBuildPrim &p, const BvhBuildPrim &q)
+	{
+		return p.centroid[axis] < q.centroid[axis];
+	});
+
+	return (uint32_t)(count / 2);
+}
+
+// 在 nodes 中切分下标为 index 的节点，子节点成对追加到末尾
+
+static bool SplitAndAppend(const BvhBuilder &b, std::vector<BvhNode> &nodes, size_t index, int depth)
+{
+	uint32_t leftCount = SplitNode(b, nodes[index], depth);
+
+	if (leftCount == 0)
+	{
+		return false;
+	}
+
+	uint32_t first = nodes[index].leftFirst;
+	uint32_t count = nodes[index].count;
+	uint32_t left = (uint32_t)nodes.size();
+
+	BvhNode child;
+	memset(&child, 0, sizeof(child));
+
+	child.leftFirst = first;
+	child.count = leftCount;
+	nodes.push_back(child);
+
+	child.leftFirst = first + leftCount;
+	child.count = count - leftCount;
+	nodes.push_back(child);
+
+	nodes[index].leftFirst = left;
+	nodes[index].count = 0;
+	return true;
+}
+
+// 在当前线程构建以 nodes[root] 为根的整棵子树
+
+static void BuildSubtree(const BvhBuilder &b, std::vector<BvhNode> &nodes, size_t root, int rootDepth)
+{
+	size_t stack[KBVHSTACKSIZE * 2];
+	int depthStack[KBVHSTACKSIZE * 2];
+	int top = 0;
+
+	stack[top] = root;
+	depthStack[top] = rootDepth;
+	top++;
+
+	while (top > 0)
+	{
+		top--;
+		size_t index = stack[top];
+		int depth = depthStack[top];
+
+		if (SplitAndAppend(b, nodes, index, depth))
+		{
+			uint32_t left = nodes[index].leftFirst;
+
+			stack[top] = left + 1;
+			depthStack[top] = depth + 1;
+			top++;
+			stack[top] = left;
+			depthStack[top] = depth + 1;
+			top++;
+		}
+	}
+}
+
+// 交给工作线程的子树，节点先放在自己的数组里，0号是根，1号空着以保持对齐
+
+struct BvhSubtree
+{
+	size_t node;
+	int depth;
+	std::vector<BvhNode> nodes;
+};
+
+///////////////////////////////////////////////////////////////////
+//
+// Bvh
+//
+///////////////////////////////////////////////////////////////////
+
+Bvh::Bvh()
+	: m_nodes(NULL)
+	, m_nodeCount(0)
+	, m_isTriangles(false)
+{
+}
+
+Bvh::~Bvh()
+{
+	AlignedFree(m_nodes);
+}
+
+void Bvh::Clear()
+{
+	AlignedFree(m_nodes);
+	m_nodes = NULL;
+	m_nodeCount = 0;
+	m_primIndex.clear();
+	m_primBounds.clear();
+	m_triangles.clear();
+}
+
+void Bvh::BuildTriangles(const Point3D *vertices, size_t triCount, JobPool *pool)
+{
+	Clear();
+	m_isTriangles = true;
+	m_primBounds.resize(triCount);
+
+	for (size_t i = 0; i < triCount; i++)
+	{
+		BvhBox &box = m_primBounds[i];
+		EmptyBox(box);
+		GrowBox(box, vertices[i * 3]);
+		GrowBox(box, vertices[i * 3 + 1]);
+		GrowBox(box, vertices[i * 3 + 2]);
+	}
+
+	Build(pool);
+
+	// 三角形按叶子顺序重排，遍历叶子时顺序读取
+
+	m_triangles.resize(triCount);
+
+	for (size_t i = 0; i < triCount; i++)
+	{
+		const Point3D *v = vertices + (size_t)m_primIndex[i] * 3;
+		m_triangles[i].v0 = v[0];
+		m_triangles[i].e1 = v[1] - v[0];
+		m_triangles[i].e2 = v[2] - v[0];
+	}
+}
+
+void Bvh::BuildAabbs(const AABB3D *boxes, size_t count, JobPool *pool)
+{
+	Clear();
+	m_isTriangles = false;
+	m_primBounds.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		m_primBounds[i] = ToBox(boxes[i]);
+	}
+
+	Build(pool);
+}
+
+void Bvh::Build(JobPool *pool)
+{
+	size_t n = m_primBounds.size();
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	assert(n <= 0x7fffffff);
+
+	std::vector<BvhBuildPrim> prims(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		prims[i].box = m_primBounds[i];
+
+		for (int k = 0; k < 3; k++)
+		{
+			prims[i].centroid[k] = (m_primBounds[i].min[k] + m_primBounds[i].max[k]) * 0.5f;
+		}
+
+		prims[i].index = (int)i;
+	}
+
+	BvhBuilder b;
+	b.prims = &prims[0];
+	b.pool = pool;
+
+	std::vector<BvhNode> nodes;
+	nodes.reserve(n * 2);
+
+	BvhNode root;
+	memset(&root, 0, sizeof(root));
+	root.count = (uint32_t)n;
+	nodes.push_back(root);
+
+	// 1号节点空着，使后面的兄弟节点对都从偶数下标开始
+
+	BvhNode pad;
+	memset(&pad, 0, sizeof(pad));
+	nodes.push_back(pad);
+
+	if (pool == NULL || pool->ThreadCount() == 1)
+	{
+		b.pool = NULL;
+		BuildSubtree(b, nodes, 0, 0);
+	}
+	else
+	{
+		// 顶部几层在当前线程切分，分桶统计并行；
+		// 图元数降到任务大小以下的节点留给工作线程
+
+		size_t taskSize = n / (pool->ThreadCount() * 8);
+		taskSize = taskSize < KBVHMINTASK ? KBVHMINTASK : taskSize;
+
+		std::vector<BvhSubtree> subtrees;
+		std::vector<size_t> open(1, 0);
+		std::vector<int> openDepth(1, 0);
+
+		while (!open.empty())
+		{
+			size_t index = open.back();
+			int depth = openDepth.back();
+			open.pop_back();
+			openDepth.pop_back();
+
+			if (nodes[index].count <= taskSize)
+			{
+				BvhSubtree task;
+				task.node = index;
+				task.depth = depth;
+				subtrees.push_back(task);
+				continue;
+			}
+
+			if (SplitAndAppend(b, nodes, index, depth))
+			{
+				open.push_back(nodes[index].leftFirst);
+				open.push_back(nodes[index].leftFirst + 1);
+				openDepth.push_back(depth + 1);
+				openDepth.push_back(depth + 1);
+			}
+		}
+
+		BvhBuilder taskBuilder = b;
+		taskBuilder.pool = NULL;
+
+		pool->ParallelFor(0, subtrees.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t t = begin; t < end; t++)
+			{
+				BvhSubtree &task = subtrees[t];
+				task.nodes.push_back(nodes[task.node]);
+				task.nodes.push_back(pad);
+				BuildSubtree(taskBuilder, task.nodes, 0, task.depth);
+			}
+		});
+
+		// 把各子树接到顶部节点之后，子节点下标加上偏移
+
+		for (size_t t = 0; t < subtrees.size(); t++)
+		{
+			std::vector<BvhNode> &local = subtrees[t].nodes;
+			uint32_t offset = (uint32_t)nodes.size();
+
+			for (size_t k = 0; k < local.size(); k++)
+			{
+				if (local[k].count == 0 && k != 1)
+				{
+					local[k].leftFirst = local[k].leftFirst - 2 + offset;
+				}
+			}
+
+			nodes[subtrees[t].node] = local[0];
+			nodes.insert(nodes.end(), local.begin() + 2, local.end());
+		}
+	}
+
+	m_primIndex.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		m_primIndex[i] = prims[i].index;
+	}
+
+	m_nodeCount = nodes.size();
+	m_nodes = (BvhNode *)AlignedMalloc(m_nodeCount * sizeof(BvhNode));
+	memcpy(m_nodes, &nodes[0], m_nodeCount * sizeof(BvhNode));
+}
+
+AABB3D Bvh::Bounds() const
+{
+	AABB3D box;
+
+	if (m_nodeCount == 0)
+	{
+		box.Empty();
+		return box;
+	}
+
+	const BvhNode &root = m_nodes[0];
+	box.min.Init(root.minX, root.minY, root.minZ);
+	box.max.Init(root.maxX, root.maxY, root.maxZ);
+	return box;
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// Refit
+//
+///////////////////////////////////////////////////////////////////
+
+void Bvh::RefitTriangles(const Point3D *vertices, JobPool *pool)
+{
+	assert(m_isTriangles);
+
+	size_t n = m_primIndex.size();
+
+	auto refitPrims = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			int prim = m_primIndex[i];
+			const Point3D *v = vertices + (size_t)prim * 3;
+
+			m_triangles[i].v0 = v[0];
+			m_triangles[i].e1 = v[1] - v[0];
+			m_triangles[i].e2 = v[2] - v[0];
+
+			BvhBox &box = m_primBounds[prim];
+			EmptyBox(box);
+			GrowBox(box, v[0]);
+			GrowBox(box, v[1]);
+			GrowBox(box, v[2]);
+		}
+	};
+
+	ParallelFor(pool, 0, n, KBVHBINGRAIN, refitPrims);
+
+	RefitNodes(pool);
+}
+
+void Bvh::RefitAabbs(const AABB3D *boxes, JobPool *pool)
+{
+	assert(!m_isTriangles);
+
+	for (size_t i = 0; i < m_primBounds.size(); i++)
+	{
+		m_primBounds[i] = ToBox(boxes[i]);
+	}
+
+	RefitNodes(pool);
+}
+
+void Bvh::RefitNodes(JobPool *pool)
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	// 叶子互不依赖，可以并行
+
+	auto refitLeaves = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			BvhNode &node = m_nodes[i];
+
+			if (node.count == 0)
+			{
+				continue;
+			}
+
+			BvhBox box;
+			EmptyBox(box);
+
+			for (uint32_t k = 0; k < node.count; k++)
+			{
+				GrowBox(box, m_primBounds[m_primIndex[node.leftFirst + k]]);
+			}
+
+			SetNodeBounds(node, box);
+		}
+	};
+
+	ParallelFor(pool, 0, m_nodeCount, KBVHBINGRAIN, refitLeaves);
+
+	// 子节点的下标总是大于父节点，倒序合并即可自底向上；1号是空位
+
+	for (size_t i = m_nodeCount; i-- > 0;)
+	{
+		BvhNode &node = m_nodes[i];
+
+		if (node.count != 0 || i == 1)
+		{
+			continue;
+		}
+
+		BvhBox box = GetNodeBounds(m_nodes[node.leftFirst]);
+		GrowBox(box, GetNodeBounds(m_nodes[node.leftFirst + 1]));
+		SetNodeBounds(node, box);
+	}
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// 遍历
+//
+///////////////////////////////////////////////////////////////////
+
+// Traverse
+//
+// 先进入较近的子节点，较远的子节点连同入口距离压栈，出栈时
+// 入口距离已超过当前最近命中的直接跳过
+// anyHit 为true时找到任意交点就返回
+
+template <bool anyHit>
+bool Bvh::Traverse(const BvhRay &ray, BvhHit &hit) const
+{
+	hit.t = ray.tMax;
+	hit.u = 0.0f;
+	hit.v = 0.0f;
+	hit.prim = KBVHNOHIT;
+
+	if (m_nodeCount == 0)
+	{
+		return false;
+	}
+
+	Vector3D invDir(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z);
+
+	if (RayBoxEntry(m_nodes[0], ray.origin, invDir, hit.t) == FLT_MAX)
+	{
+		return false;
+	}
+
+	uint32_t stack[KBVHSTACKSIZE];
+	float stackDist[KBVHSTACKSIZE];
+	int top = 0;
+	uint32_t index = 0;
+
+	for (;;)
+	{
+		const BvhNode &node = m_nodes[index];
+
+		if (node.count != 0)
+		{
+			for (uint32_t k = node.leftFirst; k < node.leftFirst + node.count; k++)
+			{
+				if (m_isTriangles)
+				{
+					// Moller-Trumbore
+
+					const Triangle &tri = m_triangles[k];
+					Vector3D pvec = CrossProduct(ray.dir, tri.e2);
+					float det = tri.e1 * pvec;
+
+					if (fabs(det) < 1e-20f)
+					{
+						continue;
+					}
+
+					float invDet = 1.0f / det;
+					Vector3D tvec = ray.origin - tri.v0;
+					float u = (tvec * pvec) * invDet;
+
+					if (u < 0.0f || u > 1.0f)
+					{
+						continue;
+					}
+
+					Vector3D qvec = CrossProduct(tvec, tri.e1);
+					float v = (ray.dir * qvec) * invDet;
+
+					if (v < 0.0f || u + v > 1.0f)
+					{
+						continue;
+					}
+
+					float t = (tri.e2 * qvec) * invDet;
+
+					if (t > 0.0f && t < hit.t)
+					{
+						hit.t = t;
+						hit.u = u;
+						hit.v = v;
+						hit.prim = m_primIndex[k];
+
+						if (anyHit)
+						{
+							return true;
+						}
+					}
+				}
+				else
+				{
+					int prim = m_primIndex[k];
+					const BvhBox &box = m_primBounds[prim];
+					float t = RayBoxEntry(box.min[0], box.min[1], box.min[2], box.max[0], box.max[1], box.max[2],
+						ray.origin, invDir, hit.t);
+
+					if (t != FLT_MAX && t < hit.t)
+					{
+						hit.t = t;
+						hit.prim = prim;
+
+						if (anyHit)
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			// 两个子节点在同一缓存行
+
+			uint32_t nearChild = node.leftFirst;
+			uint32_t farChild = nearChild + 1;
+			float dNear = RayBoxEntry(m_nodes[nearChild], ray.origin, invDir, hit.t);
+			float dFar = RayBoxEntry(m_nodes[farChild], ray.origin, invDir, hit.t);
+
+			if (dFar < dNear)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(dNear, dFar);
+			}
+
+			if (dNear != FLT_MAX)
+			{
+				if (dFar != FLT_MAX)
+				{
+					assert(top < KBVHSTACKSIZE);
+					stack[top] = farChild;
+					stackDist[top] = dFar;
+					top++;
+				}
+
+				index = nearChild;
+				continue;
+			}
+		}
+
+		// 出栈，跳过已经比最近命中更远的节点
+
+		for (;;)
+		{
+			if (top == 0)
+			{
+				return hit.prim != KBVHNOHIT;
+			}
+
+			top--;
+
+			if (stackDist[top] < hit.t)
+			{
+				index = stack[top];
+				break;
+			}
+		}
+	}
+}
+
+bool Bvh::Intersect(const BvhRay &ray, BvhHit &hit) const
+{
+	return Traverse<false>(ray, hit);
+}
+
+bool Bvh::Occluded(const BvhRay &ray) const
+{
+	BvhHit hit;
+	return Traverse<true>(ray, hit);
+}
+
+void Bvh::IntersectN(const BvhRay *rays, BvhHit *hits, size_t n, JobPool *pool) const
+{
+	auto intersectRange = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			Traverse<false>(rays[i], hits[i]);
+		}
+	};
+
+	ParallelFor(pool, 0, n, KBVHRAYGRAIN, intersectRange);
+}
+
+size_t Bvh::Overlap(const AABB3D &query, std::vector<int> &out) const
+{
+	BvhBox box = ToBox(query);
+
+	if (m_nodeCount == 0 || !BoxesOverlap(box, GetNodeBounds(m_nodes[0])))
+	{
+		return 0;
+	}
+
+	size_t before = out.size();
+	uint32_t stack[KBVHSTACKSIZE * 2];
+	int top = 0;
+
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const BvhNode &node = m_nodes[stack[--top]];
+
+		if (node.count != 0)
+		{
+			for (uint32_t k = node.leftFirst; k < node.leftFirst + node.count; k++)
+			{
+				int prim = m_primIndex[k];
+
+				if (BoxesOverlap(box, m_primBounds[prim]))
+				{
+					out.push_back(prim);
+				}
+			}
+
+			continue;
+		}
+
+		for (uint32_t child = node.leftFirst; child < node.leftFirst + 2; child++)
+		{
+			if (BoxesOverlap(box, GetNodeBounds(m_nodes[child])))
+			{
+				assert(top < KBVHSTACKSIZE * 2);
+				stack[top++] = child;
+			}
+		}
+	}
+
+	return out.size() - before;
+}
@@ -0,0 +1,180 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Bvh.h
+// func: 包围体层次结构(BVH)，用于射线与包围盒查询
+// disc: 用分桶SAH自顶向下构建，顶部几层在当前线程切分并把分桶
+//		 统计交给 JobPool，剩下的子树整棵分给各线程独立构建
+//		 节点32字节，两个兄弟节点相邻存放并按缓存行对齐，遍历时
+//		 一次读入一整行；图元在构建后按叶子顺序重排
+//		 几何体变形但拓扑不变时可以用 Refit 只更新包围盒
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_Bvh_h
+#define Wander_Bvh_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AABB3D.h"
+#include "Vector3D.h"
+
+class JobPool;
+
+// 射线，dir 不要求是单位向量，命中距离 t 以 dir 的长度为单位
+
+struct BvhRay
+{
+	Point3D origin;
+	Vector3D dir;
+	float tMax;
+};
+
+// 最近命中的结果，prim 为构建时传入的图元下标，未命中时为 KBVHNOHIT
+// 三角形的重心坐标为 (1-u-v, u, v)，包围盒图元的 u, v 为0
+
+struct BvhHit
+{
+	float t;
+	float u;
+	float v;
+	int prim;
+};
+
+const int KBVHNOHIT = -1;
+
+// 32字节的节点：内部节点 count 为0，leftFirst 为左子节点下标，右子节点
+// 紧随其后；叶子节点 leftFirst 为第一个图元在重排后的位置
+
+struct BvhNode
+{
+	float minX, minY, minZ;
+	uint32_t leftFirst;
+	float maxX, maxY, maxZ;
+	uint32_t count;
+};
+
+// 构建与更新时使用的包围盒，没有构造函数，可以整块复制
+
+struct BvhBox
+{
+	float min[3];
+	float max[3];
+};
+
+class Bvh
+{
+public:
+	Bvh();
+	~Bvh();
+
+	// BuildTriangles
+	//
+	// vertices 中每三个点组成一个三角形，共 triCount 个
+	// pool 为NULL时在当前线程构建
+
+	void BuildTriangles(const Point3D *vertices, size_t triCount, JobPool *pool = NULL);
+
+	// BuildAabbs
+	//
+	// 以包围盒作为图元，射线查询返回与盒相交的入口距离
+
+	void BuildAabbs(const AABB3D *boxes, size_t count, JobPool *pool = NULL);
+
+	void Clear();
+
+	// 图元与节点的个数，节点数包括根节点之后用于对齐的一个空位
+
+	size_t PrimCount() const
+	{
+		return m_primIndex.size();
+	}
+
+	size_t NodeCount() const
+	{
+		return m_nodeCount;
+	}
+
+	const BvhNode *Nodes() const
+	{
+		return m_nodes;
+	}
+
+	// 整个场景的包围盒
+
+	AABB3D Bounds() const;
+
+	// Refit
+	//
+	// 图元的位置改变但个数和顺序不变时，保留树的结构只更新包围盒
+	// 参数与构建时的类型和个数必须相同；形变较大时树的质量会下降，应重新构建
+
+	void RefitTriangles(const Point3D *vertices, JobPool *pool = NULL);
+	void RefitAabbs(const AABB3D *boxes, JobPool *pool = NULL);
+
+	// Intersect
+	//
+	// 最近命中，未命中时返回false，hit.prim 为 KBVHNOHIT
+
+	bool Intersect(const BvhRay &ray, BvhHit &hit) const;
+
+	// Occluded
+	//
+	// 任意命中，找到第一个 t < ray.tMax 的交点就返回，用于阴影与可见性
+
+	bool Occluded(const BvhRay &ray) const;
+
+	// Overlap
+	//
+	// 把包围盒与 box 相交的图元下标追加到 out，返回追加的个数
+
+	size_t Overlap(const AABB3D &box, std::vector<int> &out) const;
+
+	// 批量最近命中，pool 不为NULL时分块并行
+
+	void IntersectN(const BvhRay *rays, BvhHit *hits, size_t n, JobPool *pool = NULL) const;
+
+private:
+
+	// 重排后的三角形，保存 v0 与两条边，省去求交时的减法
+
+	struct Triangle
+	{
+		Point3D v0;
+		Vector3D e1;
+		Vector3D e2;
+	};
+
+	Bvh(const Bvh &);
+	Bvh &operator = (const Bvh &);
+
+	void Build(JobPool *pool);
+	void RefitNodes(JobPool *pool);
+
+	template <bool anyHit>
+	bool Traverse(const BvhRay &ray, BvhHit &hit) const;
+
+private:
+
+	// 按 KSIMDALIGN 对齐分配，兄弟节点对从偶数下标开始，正好占一个缓存行
+
+	BvhNode *m_nodes;
+	size_t m_nodeCount;
+
+	// 叶子中第 i 个图元对应的原始下标
+
+	std::vector<int> m_primIndex;
+
+	// 每个图元的包围盒，按原始顺序；包围盒模式下就是图元本身
+
+	std::vector<BvhBox> m_primBounds;
+
+	// 三角形模式下按叶子顺序重排的三角形
+
+	std::vector<Triangle> m_triangles;
+
+	bool m_isTriangles;
+};
+
+#endif
@@ -7,64 +7,96 @@
 ///////////////////////////////////////////////////////////////////
 
 #include "CommonMath.h"
+#include "SinCosTable.h"
+#include "JobPool.h"
+#include "SimdMath.h"
 #include <cmath>
 
 using namespace std;
 
 
 
-float g_sinTable[361];
-float g_cosTable[361];
+const float (&g_sinTable)[361] = gSinCosTable<1>.sinTable;
+const float (&g_cosTable)[361] = gSinCosTable<1>.cosTable;
 
 void BuildSinCosTable()
 {
-	for (int ang=0; ang<=360; ang++)
-	{
-		float theta = AngToRad((float)(ang));
-        
-		g_sinTable[ang] = sin(theta);
-		g_cosTable[ang] = cos(theta);
-	}
+	// 表已在编译期生成，无事可做
 }
 //--------------------------------------------------/
 
 float FastSin(float angle)
 {
-	// 将角度转化到0-359范围之内
-    
-	angle = fmodf(angle, 360.0f);
-    
-	if (angle < 0)
-	{
-		angle += 360.0f;
-	}
-    
-	// 将角度分解为整数部分和小数部分
-    
-	int angleInt = (int)angle;
-	float angleFra = angle - angleInt;
+	// 整数部分对360取模，小数部分线性插值
     
-	// 采用线性插值原理
-    
-	return (g_sinTable[angleInt] + angleFra * (g_sinTable[angleInt+1] - g_sinTable[angleInt]));
+	return gSinCosTable<1>.Sin(angle);
 }
 //-----------------------------------------------------------------------------------------/
 
 float FastCos(float angle)
 {
-	// 原理同FastSin
-    
-	angle = fmodf(angle, 360.0f);
-    
-	if (angle < 0)
+	return gSinCosTable<1>.Cos(angle);
+}
+
+//-------------------------------------------------------------------------------------------------/
+
+float FastSinRad(float rad)
+{
+	return gSinCosTable<1>.SinRad(rad);
+}
+
+//-------------------------------------------------------------------------------------------------/
+
+float FastCosRad(float rad)
+{
+	return gSinCosTable<1>.CosRad(rad);
+}
+
+//-------------------------------------------------------------------------------------------------/
+
+static void SinCosRange(const float *theta, float *outSin, float *outCos, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
 	{
-		angle += 360.0f;
+		SimdFloat s, c;
+		SimdSinCos(SimdLoad(theta + i), s, c);
+		SimdStore(outSin + i, s);
+		SimdStore(outCos + i, c);
 	}
-    
-	int angleInt = (int)angle;
-	float angleFra = angle - angleInt;
-    
-	return (g_cosTable[angleInt] + angleFra * (g_cosTable[angleInt+1] - g_cosTable[angleInt]));
+
+	// 尾部拷到补齐的缓冲区里再算一次，结果与整组计算的完全一致
+
+	if (i < n)
+	{
+		float in[KSIMDWIDTH] = {0}, s[KSIMDWIDTH], c[KSIMDWIDTH];
+		size_t rest = n - i;
+
+		for (size_t k = 0; k < rest; k++)
+		{
+			in[k] = theta[i + k];
+		}
+
+		SimdFloat vs, vc;
+		SimdSinCos(SimdLoad(in), vs, vc);
+		SimdStore(s, vs);
+		SimdStore(c, vc);
+
+		for (size_t k = 0; k < rest; k++)
+		{
+			outSin[i + k] = s[k];
+			outCos[i + k] = c[k];
+		}
+	}
+}
+
+void SinCosN(const float *theta, float *outSin, float *outCos, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		SinCosRange(theta + begin, outSin + begin, outCos + begin, end - begin);
+	});
 }
 
 //-------------------------------------------------------------------------------------------------/
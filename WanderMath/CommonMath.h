@@ -16,7 +16,10 @@
 ///////////////////////////////////////////////////////////////////
 
 #include <cmath>
+#include <cstddef>
 #include <stdlib.h>
+
+class JobPool;
 using namespace std;
 
 const float KPI       = 3.14159265f;
@@ -33,10 +36,11 @@ const float FZERO     = 0.0001f;
 //
 ///////////////////////////////////////////////////////////////////
 
-// 游戏开始时用BuildSinCosTable()初始化
+// 1度精度的sin cos查询表，编译期生成，只读
+// 其他精度见SinCosTable.h中的gSinCosTable
 
-extern float g_sinTable[361];
-extern float g_cosTable[361];
+extern const float (&g_sinTable)[361];
+extern const float (&g_cosTable)[361];
 
 ///////////////////////////////////////////////////////////////////
 //
@@ -115,6 +119,14 @@ inline void SinCos(float &outSin, float &outCos, float theta)
 	outSin = sin(theta);
 }
 
+// 批量计算sin和cos，outSin与outCos可以与theta相同
+// 使用多项式近似，|theta| <= 8192 时绝对误差不超过 1e-7，
+// 结果绝对值不小于1e-3时不超过 2 ULP
+// 实现见 SimdMath.h 中的 SimdSinCos
+// pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+
+extern void SinCosN(const float *theta, float *outSin, float *outCos, size_t n, JobPool *pool = NULL);
+
 // 返回0-1
 inline float RandFloat()
 {
@@ -133,15 +145,20 @@ inline float RandClamped()
 //
 ///////////////////////////////////////////////////////////////////
 
-// 建立sin cos查询表
+// 查询表已在编译期生成，此函数不再需要调用，只为兼容旧代码而保留
 
 extern void BuildSinCosTable();
 
-// 快速查询sin,cos值,使用前必须先初始化表
+// 快速查询sin,cos值，输入为角度
 
 extern float FastSin(float angle);
 extern float FastCos(float angle);
 
+// 快速查询sin,cos值，输入为弧度
+
+extern float FastSinRad(float rad);
+extern float FastCosRad(float rad);
+
 // 快速计算2D和3D中点到原点的距离，2D的误差有3.5%，3D有8%
 // 此公式推导原理不明白
 
@@ -0,0 +1,181 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: DualQuaternion.cpp
+// func: 对偶四元数的建立、与矩阵的转换以及混合
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+
+#include "DualQuaternion.h"
+#include "Matrix4X3.h"
+
+/////////////////////////////////////////////////////////////////////
+//
+// 成员函数
+//
+/////////////////////////////////////////////////////////////////////
+
+// DualQuaternion::Setup
+//
+// dual = 0.5 * (0, t) * rotation，按 Hamilton 乘法展开
+
+void DualQuaternion::Setup(const Quaternion &rotation, const Vector3D &t)
+{
+	const Quaternion &r = rotation;
+
+	real = r;
+
+	dual.w = -0.5f * (t.x*r.x + t.y*r.y + t.z*r.z);
+	dual.x = 0.5f * (t.x*r.w + t.y*r.z - t.z*r.y);
+	dual.y = 0.5f * (t.y*r.w + t.z*r.x - t.x*r.z);
+	dual.z = 0.5f * (t.z*r.w + t.x*r.y - t.y*r.x);
+}
+
+// DualQuaternion::FromMatrix4X3
+//
+// 从旋转部分取出四元数（Matrix4X3::FromQuaternion 的逆），
+// 先找出 w, x, y, z 中绝对值最大的一个，用它做除数以保证精度
+
+void DualQuaternion::FromMatrix4X3(const Matrix4X3 &m)
+{
+	float fourWSqMinus1 = m.m11 + m.m22 + m.m33;
+	float fourXSqMinus1 = m.m11 - m.m22 - m.m33;
+	float fourYSqMinus1 = m.m22 - m.m11 - m.m33;
+	float fourZSqMinus1 = m.m33 - m.m11 - m.m22;
+
+	int biggestIndex = 0;
+	float fourBiggestSqMinus1 = fourWSqMinus1;
+
+	if (fourXSqMinus1 > fourBiggestSqMinus1)
+	{
+		fourBiggestSqMinus1 = fourXSqMinus1;
+		biggestIndex = 1;
+	}
+
+	if (fourYSqMinus1 > fourBiggestSqMinus1)
+	{
+		fourBiggestSqMinus1 = fourYSqMinus1;
+		biggestIndex = 2;
+	}
+
+	if (fourZSqMinus1 > fourBiggestSqMinus1)
+	{
+		fourBiggestSqMinus1 = fourZSqMinus1;
+		biggestIndex = 3;
+	}
+
+	float biggestVal = sqrt(fourBiggestSqMinus1 + 1.0f) * 0.5f;
+	float mult = 0.25f / biggestVal;
+
+	Quaternion r;
+
+	switch (biggestIndex)
+	{
+	case 0:
+		r.w = biggestVal;
+		r.x = (m.m23 - m.m32) * mult;
+		r.y = (m.m31 - m.m13) * mult;
+		r.z = (m.m12 - m.m21) * mult;
+		break;
+
+	case 1:
+		r.x = biggestVal;
+		r.w = (m.m23 - m.m32) * mult;
+		r.y = (m.m12 + m.m21) * mult;
+		r.z = (m.m31 + m.m13) * mult;
+		break;
+
+	case 2:
+		r.y = biggestVal;
+		r.w = (m.m31 - m.m13) * mult;
+		r.x = (m.m12 + m.m21) * mult;
+		r.z = (m.m23 + m.m32) * mult;
+		break;
+
+	default:
+		r.z = biggestVal;
+		r.w = (m.m12 - m.m21) * mult;
+		r.x = (m.m31 + m.m13) * mult;
+		r.y = (m.m23 + m.m32) * mult;
+		break;
+	}
+
+	Setup(r, Vector3D(m.tx, m.ty, m.tz));
+}
+
+// DualQuaternion::ToMatrix4X3
+//
+// 旋转部分同 Matrix4X3::FromQuaternion，平移部分取 GetTranslation
+
+Matrix4X3 DualQuaternion::ToMatrix4X3() const
+{
+	Matrix4X3 m;
+	m.FromQuaternion(real);
+
+	Vector3D t = GetTranslation();
+	m.tx = t.x;
+	m.ty = t.y;
+	m.tz = t.z;
+
+	return m;
+}
+
+/////////////////////////////////////////////////////////////////
+//
+// 非成员函数
+//
+/////////////////////////////////////////////////////////////////
+
+// Blend
+//
+// 累加在两个 __m128 中完成，符号由与第一项的点积决定
+
+DualQuaternion Blend(const DualQuaternion *dq, const float *weights, size_t n)
+{
+	assert(n > 0);
+
+	DualQuaternion ret;
+
+#if defined(WANDER_SIMD_SSE)
+	__m128 pivot = _mm_loadu_ps(&dq[0].real.w);
+	__m128 sumR = _mm_setzero_ps();
+	__m128 sumD = _mm_setzero_ps();
+
+	for (size_t i = 0; i < n; i++)
+	{
+		__m128 r = _mm_loadu_ps(&dq[i].real.w);
+		__m128 d = _mm_loadu_ps(&dq[i].dual.w);
+		__m128 w = _mm_set1_ps(weights[i]);
+
+		// 点积为负时权重取反
+
+		__m128 negative = _mm_cmplt_ps(QuaternionSimdDot(pivot, r), _mm_setzero_ps());
+		w = _mm_xor_ps(w, _mm_and_ps(negative, _mm_set1_ps(-0.0f)));
+
+		sumR = _mm_add_ps(sumR, _mm_mul_ps(r, w));
+		sumD = _mm_add_ps(sumD, _mm_mul_ps(d, w));
+	}
+
+	_mm_storeu_ps(&ret.real.w, sumR);
+	_mm_storeu_ps(&ret.dual.w, sumD);
+#else
+	ret.real.w = ret.real.x = ret.real.y = ret.real.z = 0.0f;
+	ret.dual.w = ret.dual.x = ret.dual.y = ret.dual.z = 0.0f;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		const Quaternion &r = dq[i].real;
+		const Quaternion &d = dq[i].dual;
+
+		float w = DotProduct(dq[0].real, r) < 0.0f ? -weights[i] : weights[i];
+
+		ret.real.w += r.w * w; ret.real.x += r.x * w; ret.real.y += r.y * w; ret.real.z += r.z * w;
+		ret.dual.w += d.w * w; ret.dual.x += d.x * w; ret.dual.y += d.y * w; ret.dual.z += d.z * w;
+	}
+#endif
+
+	ret.Normalize();
+	return ret;
+}
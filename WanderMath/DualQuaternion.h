@@ -0,0 +1,201 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: DualQuaternion.h
+// func: 用对偶四元数表示刚体变换（旋转+平移）
+// disc: real 为旋转四元数，dual = 0.5 * t * real（按 Hamilton 乘法），
+//		 共8个float，比 Matrix4X3 少4个；几个变换按权重相加再标准化
+//		 即得到混合后的刚体变换，不会像矩阵混合那样产生剪切和缩放
+//		 乘法的顺序与 Matrix4X3 相同：a * b 表示先做a再做b
+//		 乘法与标准化用 QuaternionSimd 在寄存器中完成
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_DualQuaternion_h
+#define Wander_DualQuaternion_h
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "Quaternion.h"
+#include "QuaternionSimd.h"
+#include "Vector3D.h"
+
+class Matrix4X3;
+
+class DualQuaternion
+{
+public:
+	DualQuaternion() = default;
+
+	constexpr DualQuaternion(const Quaternion &r, const Quaternion &d)
+		: real(r)
+		, dual(d)
+	{
+	}
+
+	// 由旋转和平移建立，先旋转后平移
+
+	DualQuaternion(const Quaternion &rotation, const Vector3D &translation)
+	{
+		Setup(rotation, translation);
+	}
+
+	// 置为不做任何变换
+
+	void Identity()
+	{
+		real = gQuaternionIdentity;
+		dual.w = dual.x = dual.y = dual.z = 0.0f;
+	}
+
+	void Setup(const Quaternion &rotation, const Vector3D &translation);
+
+	// 与 Matrix4X3 的相互转换，矩阵的旋转部分必须正交且不含缩放
+
+	void FromMatrix4X3(const Matrix4X3 &m);
+	Matrix4X3 ToMatrix4X3() const;
+
+	// 取出旋转和平移
+
+	const Quaternion &GetRotation() const
+	{
+		return real;
+	}
+
+	Vector3D GetTranslation() const
+	{
+		return Vector3D(2.0f * (real.w*dual.x - dual.w*real.x + real.y*dual.z - real.z*dual.y),
+						2.0f * (real.w*dual.y - dual.w*real.y + real.z*dual.x - real.x*dual.z),
+						2.0f * (real.w*dual.z - dual.w*real.z + real.x*dual.y - real.y*dual.x));
+	}
+
+	// 连接两个变换
+
+	DualQuaternion operator *(const DualQuaternion &b) const;
+	DualQuaternion &operator *=(const DualQuaternion &b)
+	{
+		*this = (*this) * b;
+		return *this;
+	}
+
+	// 标准化：real 的模置为1，并去掉 dual 中与 real 平行的部分
+	// 混合之后必须调用
+
+	void Normalize();
+
+public:
+	Quaternion real;
+	Quaternion dual;
+};
+
+static_assert(std::is_trivially_copyable<DualQuaternion>::value, "DualQuaternion must stay trivially copyable");
+static_assert(sizeof(DualQuaternion) == 8 * sizeof(float), "DualQuaternion must be eight packed floats");
+
+// DualQuaternion::operator *
+//
+// (ra + e da)(rb + e db) = ra*rb + e (ra*db + da*rb)，e*e = 0
+// 三次四元数乘法都在 QuaternionSimd 中完成
+
+inline DualQuaternion DualQuaternion::operator *(const DualQuaternion &b) const
+{
+	QuaternionSimd ra(real), da(dual);
+	QuaternionSimd rb(b.real), db(b.dual);
+
+	QuaternionSimd r = ra * rb;
+	QuaternionSimd d0 = ra * db;
+	QuaternionSimd d1 = da * rb;
+
+	DualQuaternion ret;
+	ret.real = r.ToQuaternion();
+
+#if defined(WANDER_SIMD_SSE)
+	_mm_storeu_ps(&ret.dual.w, _mm_add_ps(d0.Load(), d1.Load()));
+#else
+	ret.dual.w = d0.w + d1.w;
+	ret.dual.x = d0.x + d1.x;
+	ret.dual.y = d0.y + d1.y;
+	ret.dual.z = d0.z + d1.z;
+#endif
+
+	return ret;
+}
+
+// DualQuaternion::Normalize
+//
+// 两部分除以 |real|，再令 dual -= real * (real . dual)
+
+inline void DualQuaternion::Normalize()
+{
+#if defined(WANDER_SIMD_SSE)
+	__m128 r = _mm_loadu_ps(&real.w);
+	__m128 d = _mm_loadu_ps(&dual.w);
+	__m128 magSq = QuaternionSimdDot(r, r);
+
+	assert(_mm_cvtss_f32(magSq) > 0.0f);
+
+	__m128 mag = _mm_sqrt_ps(magSq);
+	r = _mm_div_ps(r, mag);
+	d = _mm_div_ps(d, mag);
+	d = _mm_sub_ps(d, _mm_mul_ps(r, QuaternionSimdDot(r, d)));
+
+	_mm_storeu_ps(&real.w, r);
+	_mm_storeu_ps(&dual.w, d);
+#else
+	float magSq = DotProduct(real, real);
+	assert(magSq > 0.0f);
+
+	float oneOverMag = 1.0f / std::sqrt(magSq);
+
+	real.w *= oneOverMag; real.x *= oneOverMag; real.y *= oneOverMag; real.z *= oneOverMag;
+	dual.w *= oneOverMag; dual.x *= oneOverMag; dual.y *= oneOverMag; dual.z *= oneOverMag;
+
+	float rd = DotProduct(real, dual);
+
+	dual.w -= real.w * rd;
+	dual.x -= real.x * rd;
+	dual.y -= real.y * rd;
+	dual.z -= real.z * rd;
+#endif
+}
+
+// 单位对偶四元数的逆，两部分各取共轭
+
+inline DualQuaternion Inverse(const DualQuaternion &dq)
+{
+	return DualQuaternion(Conjugate(dq.real), Conjugate(dq.dual));
+}
+
+// 只旋转方向向量，忽略平移
+// v' = v + 2u x (u x v + w v)，其中 (w, u) 为 real
+
+inline Vector3D RotateDirection(const Vector3D &v, const DualQuaternion &dq)
+{
+	const Quaternion &r = dq.real;
+
+	float cx = r.y*v.z - r.z*v.y + r.w*v.x;
+	float cy = r.z*v.x - r.x*v.z + r.w*v.y;
+	float cz = r.x*v.y - r.y*v.x + r.w*v.z;
+
+	return Vector3D(v.x + 2.0f * (r.y*cz - r.z*cy),
+					v.y + 2.0f * (r.z*cx - r.x*cz),
+					v.z + 2.0f * (r.x*cy - r.y*cx));
+}
+
+// 变换点 p' = p * dq，与 Matrix4X3 的 p * m 同义
+
+inline Point3D operator *(const Point3D &p, const DualQuaternion &dq)
+{
+	return RotateDirection(p, dq) + dq.GetTranslation();
+}
+
+// Blend
+//
+// 按权重混合n个变换并标准化（对偶四元数线性混合）
+// 与第一个变换的 real 点积为负的项翻转符号后再累加，使它们取同一半球
+// 权重之和不必为1，但混合结果的 real 不能为零
+
+extern DualQuaternion Blend(const DualQuaternion *dq, const float *weights, size_t n);
+
+#endif
@@ -0,0 +1,299 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: DualQuaternionBatch.cpp
+// func: 基于DualQuaternion的批量内核
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cstring>
+
+#include "JobPool.h"
+#include "DualQuaternionBatch.h"
+#include "DualQuaternion.h"
+#include "Vector3D.h"
+#include "Simd.h"
+
+/////////////////////////////////////////////////
+//
+// 内部实现
+//
+/////////////////////////////////////////////////
+
+// 一组对偶四元数按分量拆成通道
+
+struct DualLanes
+{
+	SimdFloat rw, rx, ry, rz;
+	SimdFloat dw, dx, dy, dz;
+};
+
+static void LoadDualLanes(const float *p, DualLanes &l)
+{
+	SimdLoadStrided4(p, 8, l.rw, l.rx, l.ry, l.rz);
+	SimdLoadStrided4(p + 4, 8, l.dw, l.dx, l.dy, l.dz);
+}
+
+static void StoreDualLanes(float *p, const DualLanes &l)
+{
+	SimdStoreStrided4(p, 8, l.rw, l.rx, l.ry, l.rz);
+	SimdStoreStrided4(p + 4, 8, l.dw, l.dx, l.dy, l.dz);
+}
+
+// 与 Quaternion::operator * 相同的展开
+
+static void QuaternionLanesMul(SimdFloat aw, SimdFloat ax, SimdFloat ay, SimdFloat az,
+							   SimdFloat bw, SimdFloat bx, SimdFloat by, SimdFloat bz,
+							   SimdFloat &rw, SimdFloat &rx, SimdFloat &ry, SimdFloat &rz)
+{
+	rw = SimdNegMulAdd(az, bz, SimdNegMulAdd(ay, by, SimdNegMulAdd(ax, bx, SimdMul(aw, bw))));
+	rx = SimdNegMulAdd(ay, bz, SimdMulAdd(az, by, SimdMulAdd(ax, bw, SimdMul(aw, bx))));
+	ry = SimdNegMulAdd(az, bx, SimdMulAdd(ax, bz, SimdMulAdd(ay, bw, SimdMul(aw, by))));
+	rz = SimdNegMulAdd(ax, by, SimdMulAdd(ay, bx, SimdMulAdd(az, bw, SimdMul(aw, bz))));
+}
+
+static void ConcatenateLanes(const DualLanes &a, const DualLanes &b, DualLanes &r)
+{
+	SimdFloat w0, x0, y0, z0;
+	SimdFloat w1, x1, y1, z1;
+
+	QuaternionLanesMul(a.rw, a.rx, a.ry, a.rz, b.rw, b.rx, b.ry, b.rz, r.rw, r.rx, r.ry, r.rz);
+	QuaternionLanesMul(a.rw, a.rx, a.ry, a.rz, b.dw, b.dx, b.dy, b.dz, w0, x0, y0, z0);
+	QuaternionLanesMul(a.dw, a.dx, a.dy, a.dz, b.rw, b.rx, b.ry, b.rz, w1, x1, y1, z1);
+
+	r.dw = SimdAdd(w0, w1);
+	r.dx = SimdAdd(x0, x1);
+	r.dy = SimdAdd(y0, y1);
+	r.dz = SimdAdd(z0, z1);
+}
+
+static void ConcatenateRange(const DualQuaternion *a, const DualQuaternion *b, DualQuaternion *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		DualLanes la, lb, r;
+		LoadDualLanes(&a[i].real.w, la);
+		LoadDualLanes(&b[i].real.w, lb);
+		ConcatenateLanes(la, lb, r);
+		StoreDualLanes(&out[i].real.w, r);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = a[i] * b[i];
+	}
+}
+
+// 单个顶点的混合与变换，用于不足一组的尾部
+
+static void SkinVertex(const DualQuaternion *bones, const int *index, const float *weight, size_t influences,
+					   const Point3D *inPos, const Vector3D *inNormal, Point3D *outPos, Vector3D *outNormal)
+{
+	const Quaternion &pivot = bones[index[0]].real;
+
+	DualQuaternion b;
+	b.real.w = b.real.x = b.real.y = b.real.z = 0.0f;
+	b.dual.w = b.dual.x = b.dual.y = b.dual.z = 0.0f;
+
+	for (size_t k = 0; k < influences; k++)
+	{
+		const DualQuaternion &dq = bones[index[k]];
+		float w = DotProduct(pivot, dq.real) < 0.0f ? -weight[k] : weight[k];
+
+		b.real.w += dq.real.w * w; b.real.x += dq.real.x * w; b.real.y += dq.real.y * w; b.real.z += dq.real.z * w;
+		b.dual.w += dq.dual.w * w; b.dual.x += dq.dual.x * w; b.dual.y += dq.dual.y * w; b.dual.z += dq.dual.z * w;
+	}
+
+	float oneOverMag = 1.0f / sqrt(DotProduct(b.real, b.real));
+
+	b.real.w *= oneOverMag; b.real.x *= oneOverMag; b.real.y *= oneOverMag; b.real.z *= oneOverMag;
+	b.dual.w *= oneOverMag; b.dual.x *= oneOverMag; b.dual.y *= oneOverMag; b.dual.z *= oneOverMag;
+
+	*outPos = *inPos * b;
+
+	if (inNormal != NULL)
+	{
+		*outNormal = RotateDirection(*inNormal, b);
+	}
+}
+
+// v' = v + 2u x (u x v + w v)，同 RotateDirection
+
+static void RotateLanes(const DualLanes &b, SimdFloat &x, SimdFloat &y, SimdFloat &z)
+{
+	SimdFloat cx = SimdMulAdd(b.rw, x, SimdNegMulAdd(b.rz, y, SimdMul(b.ry, z)));
+	SimdFloat cy = SimdMulAdd(b.rw, y, SimdNegMulAdd(b.rx, z, SimdMul(b.rz, x)));
+	SimdFloat cz = SimdMulAdd(b.rw, z, SimdNegMulAdd(b.ry, x, SimdMul(b.rx, y)));
+
+	SimdFloat two = SimdSet1(2.0f);
+
+	x = SimdMulAdd(two, SimdNegMulAdd(b.rz, cy, SimdMul(b.ry, cz)), x);
+	y = SimdMulAdd(two, SimdNegMulAdd(b.rx, cz, SimdMul(b.rz, cx)), y);
+	z = SimdMulAdd(two, SimdNegMulAdd(b.ry, cx, SimdMul(b.rx, cy)), z);
+}
+
+// GatherInfluence
+//
+// 从第 i 个顶点起一组顶点的第 k 个影响：骨骼分散在整个数组中，
+// 先把各顶点用到的骨骼拷到连续的缓冲区再按通道载入，返回对应的权重；
+// 骨骼数组通常不大，读取多半命中L1
+
+static SimdFloat GatherInfluence(const DualQuaternion *bones, const int *boneIndex, const float *boneWeight, size_t influences,
+								 size_t i, size_t k, DualLanes &l)
+{
+	float gathered[KSIMDWIDTH * 8];
+	float weights[KSIMDWIDTH];
+
+	for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+	{
+		size_t slot = (i + lane) * influences + k;
+
+		memcpy(gathered + lane * 8, &bones[boneIndex[slot]], sizeof(DualQuaternion));
+		weights[lane] = boneWeight[slot];
+	}
+
+	LoadDualLanes(gathered, l);
+	return SimdLoad(weights);
+}
+
+static void SkinRange(const DualQuaternion *bones, const int *boneIndex, const float *boneWeight, size_t influences,
+					  const Point3D *inPos, const Vector3D *inNormal, Point3D *outPos, Vector3D *outNormal,
+					  size_t begin, size_t end)
+{
+	size_t i = begin;
+
+	// 没有SIMD时拷贝到缓冲区并不划算，全部交给下面的逐个处理
+
+	for (; KSIMDWIDTH > 1 && i + KSIMDWIDTH <= end; i += KSIMDWIDTH)
+	{
+		// 第一个影响作为半球的基准，直接初始化累加值
+
+		DualLanes pivot, sum;
+		SimdFloat w0 = GatherInfluence(bones, boneIndex, boneWeight, influences, i, 0, pivot);
+
+		sum.rw = SimdMul(pivot.rw, w0); sum.rx = SimdMul(pivot.rx, w0); sum.ry = SimdMul(pivot.ry, w0); sum.rz = SimdMul(pivot.rz, w0);
+		sum.dw = SimdMul(pivot.dw, w0); sum.dx = SimdMul(pivot.dx, w0); sum.dy = SimdMul(pivot.dy, w0); sum.dz = SimdMul(pivot.dz, w0);
+
+		for (size_t k = 1; k < influences; k++)
+		{
+			DualLanes l;
+			SimdFloat w = GatherInfluence(bones, boneIndex, boneWeight, influences, i, k, l);
+
+			// 与第一根骨骼不在同一半球时权重取反
+
+			SimdFloat dot = SimdMulAdd(pivot.rz, l.rz, SimdMulAdd(pivot.ry, l.ry, SimdMulAdd(pivot.rx, l.rx, SimdMul(pivot.rw, l.rw))));
+			w = SimdSelect(SimdCmpLt(dot, SimdZero()), SimdSub(SimdZero(), w), w);
+
+			sum.rw = SimdMulAdd(l.rw, w, sum.rw); sum.rx = SimdMulAdd(l.rx, w, sum.rx);
+			sum.ry = SimdMulAdd(l.ry, w, sum.ry); sum.rz = SimdMulAdd(l.rz, w, sum.rz);
+			sum.dw = SimdMulAdd(l.dw, w, sum.dw); sum.dx = SimdMulAdd(l.dx, w, sum.dx);
+			sum.dy = SimdMulAdd(l.dy, w, sum.dy); sum.dz = SimdMulAdd(l.dz, w, sum.dz);
+		}
+
+		// 除以 real 的模；变换只用到 dual 与 real 垂直的部分，不必再正交化
+
+		SimdFloat magSq = SimdMulAdd(sum.rz, sum.rz, SimdMulAdd(sum.ry, sum.ry, SimdMulAdd(sum.rx, sum.rx, SimdMul(sum.rw, sum.rw))));
+		SimdFloat oneOverMag = SimdDiv(SimdSet1(1.0f), SimdSqrt(magSq));
+
+		sum.rw = SimdMul(sum.rw, oneOverMag); sum.rx = SimdMul(sum.rx, oneOverMag);
+		sum.ry = SimdMul(sum.ry, oneOverMag); sum.rz = SimdMul(sum.rz, oneOverMag);
+		sum.dw = SimdMul(sum.dw, oneOverMag); sum.dx = SimdMul(sum.dx, oneOverMag);
+		sum.dy = SimdMul(sum.dy, oneOverMag); sum.dz = SimdMul(sum.dz, oneOverMag);
+
+		// t = 2 (w d - dw u + u x d)，同 DualQuaternion::GetTranslation
+
+		SimdFloat two = SimdSet1(2.0f);
+
+		SimdFloat tx = SimdMul(two, SimdNegMulAdd(sum.rz, sum.dy, SimdMulAdd(sum.ry, sum.dz, SimdNegMulAdd(sum.dw, sum.rx, SimdMul(sum.rw, sum.dx)))));
+		SimdFloat ty = SimdMul(two, SimdNegMulAdd(sum.rx, sum.dz, SimdMulAdd(sum.rz, sum.dx, SimdNegMulAdd(sum.dw, sum.ry, SimdMul(sum.rw, sum.dy)))));
+		SimdFloat tz = SimdMul(two, SimdNegMulAdd(sum.ry, sum.dx, SimdMulAdd(sum.rx, sum.dy, SimdNegMulAdd(sum.dw, sum.rz, SimdMul(sum.rw, sum.dz)))));
+
+		// 点与法线都是三个float的结构，经缓冲区转成通道
+
+		float px[KSIMDWIDTH], py[KSIMDWIDTH], pz[KSIMDWIDTH];
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			px[lane] = inPos[i + lane].x;
+			py[lane] = inPos[i + lane].y;
+			pz[lane] = inPos[i + lane].z;
+		}
+
+		SimdFloat x = SimdLoad(px);
+		SimdFloat y = SimdLoad(py);
+		SimdFloat z = SimdLoad(pz);
+		RotateLanes(sum, x, y, z);
+
+		SimdStore(px, SimdAdd(x, tx));
+		SimdStore(py, SimdAdd(y, ty));
+		SimdStore(pz, SimdAdd(z, tz));
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			outPos[i + lane].Init(px[lane], py[lane], pz[lane]);
+		}
+
+		if (inNormal == NULL)
+		{
+			continue;
+		}
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			px[lane] = inNormal[i + lane].x;
+			py[lane] = inNormal[i + lane].y;
+			pz[lane] = inNormal[i + lane].z;
+		}
+
+		x = SimdLoad(px);
+		y = SimdLoad(py);
+		z = SimdLoad(pz);
+		RotateLanes(sum, x, y, z);
+
+		SimdStore(px, x);
+		SimdStore(py, y);
+		SimdStore(pz, z);
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			outNormal[i + lane].Init(px[lane], py[lane], pz[lane]);
+		}
+	}
+
+	for (; i < end; i++)
+	{
+		SkinVertex(bones, boneIndex + i * influences, boneWeight + i * influences, influences,
+				   inPos + i, inNormal != NULL ? inNormal + i : NULL, outPos + i, outNormal != NULL ? outNormal + i : NULL);
+	}
+}
+
+/////////////////////////////////////////////////
+//
+// 对外接口
+//
+/////////////////////////////////////////////////
+
+static_assert(sizeof(DualQuaternion) == 8 * sizeof(float), "DualQuaternion must be eight packed floats");
+
+void ConcatenateN(const DualQuaternion *a, const DualQuaternion *b, DualQuaternion *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		ConcatenateRange(a + begin, b + begin, out + begin, end - begin);
+	});
+}
+
+void SkinPointsN(const DualQuaternion *bones, const int *boneIndex, const float *boneWeight, size_t influences,
+				 const Point3D *inPos, const Vector3D *inNormal, Point3D *outPos, Vector3D *outNormal,
+				 size_t n, JobPool *pool)
+{
+	assert(influences > 0);
+	assert(inNormal == NULL || outNormal != NULL);
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		SkinRange(bones, boneIndex, boneWeight, influences, inPos, inNormal, outPos, outNormal, begin, end);
+	});
+}
@@ -0,0 +1,35 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: DualQuaternionBatch.h
+// func: 基于DualQuaternion的批量内核：连接与顶点蒙皮
+// disc: 每次处理 KSIMDWIDTH 个元素，各对偶四元数按8个float的步长
+//		 拆成通道；pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class Vector3D;
+class DualQuaternion;
+class JobPool;
+
+typedef Vector3D Point3D;
+
+// 批量连接 out[i] = a[i] * b[i]，out 可以与 a 或 b 相同
+// 例如由绑定姿势的逆与当前姿势得到每根骨骼的蒙皮变换
+
+extern void ConcatenateN(const DualQuaternion *a, const DualQuaternion *b, DualQuaternion *out, size_t n,
+						 JobPool *pool = NULL);
+
+// SkinPointsN
+//
+// 对偶四元数线性混合蒙皮，第 i 个顶点受 influences 根骨骼影响：
+//		bones[boneIndex[i * influences + k]]，权重 boneWeight[i * influences + k]
+// 混合方式同 Blend，混合结果变换 inPos[i] 写入 outPos[i]
+// inNormal 不为NULL时同时旋转法线写入 outNormal，输入输出不能重叠
+
+extern void SkinPointsN(const DualQuaternion *bones, const int *boneIndex, const float *boneWeight, size_t influences,
+						const Point3D *inPos, const Vector3D *inNormal, Point3D *outPos, Vector3D *outNormal,
+						size_t n, JobPool *pool = NULL);
@@ -12,10 +12,6 @@
 #include "Matrix4X3.h"
 #include "RotationMatrix.h"
 
-EulerAngles::EulerAngles()
-{
-	heading = pitch = bank = 0.0f;
-}
 // EulerAngles::canonize
 //	
 // 用于标准化一组欧拉角，结果为将 pitch 控制在 -PI/2 到 PI/2 之间
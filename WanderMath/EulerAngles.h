@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 // 声明
 
 class Quaternion;
@@ -20,8 +22,8 @@ class EulerAngles
 {
 public:
     
-	EulerAngles();
-	EulerAngles(float h, float p, float b):heading(h),pitch(p),bank(b){}
+	constexpr EulerAngles():heading(0.0f),pitch(0.0f),bank(0.0f){}
+	constexpr EulerAngles(float h, float p, float b):heading(h),pitch(p),bank(b){}
 	
 	void Init(float h, float p, float b)
 	{
@@ -69,4 +71,7 @@ public:
 	// 左右倾斜	
     
 	float bank;
-};
\ No newline at end of file
+};
+
+static_assert(std::is_trivially_copyable<EulerAngles>::value, "EulerAngles must stay trivially copyable");
+static_assert(std::is_standard_layout<EulerAngles>::value, "EulerAngles must stay standard layout");
\ No newline at end of file
@@ -0,0 +1,292 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: EulerAnglesBatch.cpp
+// func: 用欧拉角批量建立矩阵
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cstring>
+
+#include "EulerAnglesBatch.h"
+#include "JobPool.h"
+#include "EulerAngles.h"
+#include "Matrix4X3.h"
+#include "RotationMatrix.h"
+#include "Vector3D.h"
+#include "Vector3DSoA.h"
+#include "SimdMath.h"
+
+static_assert(sizeof(Matrix4X3) == 12 * sizeof(float), "Matrix4X3 must be twelve packed floats");
+static_assert(sizeof(RotationMatrix) == 9 * sizeof(float), "RotationMatrix must be nine packed floats");
+static_assert(sizeof(EulerAngles) == 3 * sizeof(float), "EulerAngles must be three packed floats");
+
+/////////////////////////////////////////////////
+//
+// 内部实现
+//
+/////////////////////////////////////////////////
+
+// 输出的矩阵类型
+
+enum BuildMode
+{
+	KBUILDLOCALTOPARENT,
+	KBUILDPARENTTOLOCAL,
+	KBUILDROTATIONMATRIX
+};
+
+// 每组 KSIMDWIDTH 个元素的SoA输入
+
+struct BuildLanes
+{
+	const float *x, *y, *z;
+	const float *heading, *pitch, *bank;
+};
+
+// BuildGroup
+//
+// 计算一组矩阵并写到 out 开始、间隔为 stride 个float的位置
+// 公式与 Matrix4X3::SetupLocalToParent 相同，
+// ParentToLocal 与 RotationMatrix 使用其转置
+
+template <int mode>
+static void BuildGroup(const BuildLanes &in, float *out, size_t stride)
+{
+	SimdFloat sh, ch, sp, cp, sb, cb;
+
+	SimdSinCos(SimdLoad(in.heading), sh, ch);
+	SimdSinCos(SimdLoad(in.pitch), sp, cp);
+	SimdSinCos(SimdLoad(in.bank), sb, cb);
+
+	SimdFloat spsb = SimdMul(sp, sb);
+	SimdFloat spcb = SimdMul(sp, cb);
+
+	// object->inertial 方向的旋转
+
+	SimdFloat r11 = SimdMulAdd(sh, spsb, SimdMul(ch, cb));
+	SimdFloat r12 = SimdMul(sb, cp);
+	SimdFloat r13 = SimdNegMulAdd(sh, cb, SimdMul(ch, spsb));
+
+	SimdFloat r21 = SimdNegMulAdd(ch, sb, SimdMul(sh, spcb));
+	SimdFloat r22 = SimdMul(cb, cp);
+	SimdFloat r23 = SimdMulAdd(sb, sh, SimdMul(ch, spcb));
+
+	SimdFloat r31 = SimdMul(sh, cp);
+	SimdFloat r32 = SimdXor(sp, SimdSet1(-0.0f));
+	SimdFloat r33 = SimdMul(ch, cp);
+
+	if (mode == KBUILDLOCALTOPARENT)
+	{
+		SimdStoreStrided4(out, stride, r11, r12, r13, r21);
+		SimdStoreStrided4(out + 4, stride, r22, r23, r31, r32);
+		SimdStoreStrided4(out + 8, stride, r33, SimdLoad(in.x), SimdLoad(in.y), SimdLoad(in.z));
+		return;
+	}
+
+	// 其余两种为转置 m11 = r11, m12 = r21, m13 = r31 ...
+
+	if (mode == KBUILDROTATIONMATRIX)
+	{
+		WANDER_ALIGN(32) float m33[KSIMDWIDTH];
+
+		SimdStoreStrided4(out, stride, r11, r21, r31, r12);
+		SimdStoreStrided4(out + 4, stride, r22, r32, r13, r23);
+		SimdStore(m33, r33);
+
+		for (size_t k = 0; k < KSIMDWIDTH; k++)
+		{
+			out[k * stride + 8] = m33[k];
+		}
+		return;
+	}
+
+	// 平移部分 t = -(pos * R)，R 为转置后的旋转
+
+	SimdFloat px = SimdLoad(in.x);
+	SimdFloat py = SimdLoad(in.y);
+	SimdFloat pz = SimdLoad(in.z);
+	SimdFloat neg = SimdSet1(-0.0f);
+
+	SimdFloat tx = SimdXor(SimdMulAdd(pz, r13, SimdMulAdd(py, r12, SimdMul(px, r11))), neg);
+	SimdFloat ty = SimdXor(SimdMulAdd(pz, r23, SimdMulAdd(py, r22, SimdMul(px, r21))), neg);
+	SimdFloat tz = SimdXor(SimdMulAdd(pz, r33, SimdMulAdd(py, r32, SimdMul(px, r31))), neg);
+
+	SimdStoreStrided4(out, stride, r11, r21, r31, r12);
+	SimdStoreStrided4(out + 4, stride, r22, r32, r13, r23);
+	SimdStoreStrided4(out + 8, stride, r33, tx, ty, tz);
+}
+
+// 不足一组的尾部：拷到补零的缓冲区中计算，再拷出有效部分
+
+template <int mode>
+static void BuildTail(const BuildLanes &in, size_t count, float *out, size_t stride)
+{
+	WANDER_ALIGN(32) float buf[6][KSIMDWIDTH];
+	float tmp[KSIMDWIDTH * 12];
+
+	memset(buf, 0, sizeof(buf));
+
+	const float *src[6] = {in.x, in.y, in.z, in.heading, in.pitch, in.bank};
+
+	for (int s = 0; s < 6; s++)
+	{
+		if (src[s] != NULL)
+		{
+			memcpy(buf[s], src[s], count * sizeof(float));
+		}
+	}
+
+	BuildLanes lanes = {buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]};
+	BuildGroup<mode>(lanes, tmp, stride);
+
+	memcpy(out, tmp, count * stride * sizeof(float));
+}
+
+// BuildSoA
+//
+// 位置流为NULL时视为原点（RotationMatrix不需要位置）
+
+template <int mode>
+static void BuildSoA(const float *x, const float *y, const float *z,
+					 const float *heading, const float *pitch, const float *bank,
+					 float *out, size_t stride, size_t n)
+{
+	static const float zeros[KSIMDWIDTH] = {0};
+
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		BuildLanes lanes =
+		{
+			x ? x + i : zeros, y ? y + i : zeros, z ? z + i : zeros,
+			heading + i, pitch + i, bank + i
+		};
+
+		BuildGroup<mode>(lanes, out + i * stride, stride);
+	}
+
+	if (i < n)
+	{
+		BuildLanes lanes =
+		{
+			x ? x + i : NULL, y ? y + i : NULL, z ? z + i : NULL,
+			heading + i, pitch + i, bank + i
+		};
+
+		BuildTail<mode>(lanes, n - i, out + i * stride, stride);
+	}
+}
+
+// BuildAoS
+//
+// 每次把一组AoS输入拆到栈上的SoA缓冲区，再走SoA内核
+
+template <int mode>
+static void BuildAoS(const Point3D *pos, const EulerAngles *angles, float *out, size_t stride, size_t n)
+{
+	WANDER_ALIGN(32) float buf[6][KSIMDWIDTH];
+
+	memset(buf, 0, sizeof(buf));
+
+	for (size_t i = 0; i < n; i += KSIMDWIDTH)
+	{
+		size_t count = n - i < KSIMDWIDTH ? n - i : KSIMDWIDTH;
+
+		for (size_t k = 0; k < count; k++)
+		{
+			if (pos != NULL)
+			{
+				buf[0][k] = pos[i + k].x;
+				buf[1][k] = pos[i + k].y;
+				buf[2][k] = pos[i + k].z;
+			}
+
+			buf[3][k] = angles[i + k].heading;
+			buf[4][k] = angles[i + k].pitch;
+			buf[5][k] = angles[i + k].bank;
+		}
+
+		BuildLanes lanes = {buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]};
+
+		if (count == KSIMDWIDTH)
+		{
+			BuildGroup<mode>(lanes, out + i * stride, stride);
+		}
+		else
+		{
+			BuildTail<mode>(lanes, count, out + i * stride, stride);
+		}
+	}
+}
+
+// BuildAoSBlocks / BuildSoABlocks
+//
+// 按 KJOBBATCHGRAIN 分块，pool 为NULL时整批在当前线程完成
+
+template <int mode>
+static void BuildAoSBlocks(const Point3D *pos, const EulerAngles *angles, float *out, size_t stride, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		BuildAoS<mode>(pos != NULL ? pos + begin : NULL, angles + begin, out + begin * stride, stride, end - begin);
+	});
+}
+
+template <int mode>
+static void BuildSoABlocks(const float *x, const float *y, const float *z,
+						   const float *heading, const float *pitch, const float *bank,
+						   float *out, size_t stride, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		BuildSoA<mode>(x != NULL ? x + begin : NULL, y != NULL ? y + begin : NULL, z != NULL ? z + begin : NULL,
+					   heading + begin, pitch + begin, bank + begin, out + begin * stride, stride, end - begin);
+	});
+}
+
+/////////////////////////////////////////////////
+//
+// 非成员函数
+//
+/////////////////////////////////////////////////
+
+void BuildLocalToParentN(const Point3D *pos, const EulerAngles *angles, Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	BuildAoSBlocks<KBUILDLOCALTOPARENT>(pos, angles, &out->m11, 12, n, pool);
+}
+
+void BuildParentToLocalN(const Point3D *pos, const EulerAngles *angles, Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	BuildAoSBlocks<KBUILDPARENTTOLOCAL>(pos, angles, &out->m11, 12, n, pool);
+}
+
+void BuildRotationMatrixN(const EulerAngles *angles, RotationMatrix *out, size_t n, JobPool *pool)
+{
+	BuildAoSBlocks<KBUILDROTATIONMATRIX>(NULL, angles, &out->m11, 9, n, pool);
+}
+
+void BuildLocalToParentN(const Point3DSoA &pos,
+						 const float *heading, const float *pitch, const float *bank,
+						 Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	assert(n <= pos.Size());
+
+	BuildSoABlocks<KBUILDLOCALTOPARENT>(pos.x, pos.y, pos.z, heading, pitch, bank, &out->m11, 12, n, pool);
+}
+
+void BuildParentToLocalN(const Point3DSoA &pos,
+						 const float *heading, const float *pitch, const float *bank,
+						 Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	assert(n <= pos.Size());
+
+	BuildSoABlocks<KBUILDPARENTTOLOCAL>(pos.x, pos.y, pos.z, heading, pitch, bank, &out->m11, 12, n, pool);
+}
+
+void BuildRotationMatrixN(const float *heading, const float *pitch, const float *bank,
+						  RotationMatrix *out, size_t n, JobPool *pool)
+{
+	BuildSoABlocks<KBUILDROTATIONMATRIX>(NULL, NULL, NULL, heading, pitch, bank, &out->m11, 9, n, pool);
+}
@@ -0,0 +1,41 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: EulerAnglesBatch.h
+// func: 用欧拉角批量建立矩阵
+// disc: 与逐个调用 Matrix4X3::SetupLocalToParent、
+//		 Matrix4X3::SetupParentToLocal、RotationMatrix::Setup 结果相同，
+//		 sin/cos 与矩阵组装都按SIMD宽度处理，输出矩阵连续写入
+//		 pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class Vector3D;
+class Vector3DSoA;
+class EulerAngles;
+class Matrix4X3;
+class RotationMatrix;
+class JobPool;
+
+typedef Vector3D Point3D;
+typedef Vector3DSoA Point3DSoA;
+
+// 数组结构(AoS)输入
+
+extern void BuildLocalToParentN(const Point3D *pos, const EulerAngles *angles, Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+extern void BuildParentToLocalN(const Point3D *pos, const EulerAngles *angles, Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+extern void BuildRotationMatrixN(const EulerAngles *angles, RotationMatrix *out, size_t n, JobPool *pool = NULL);
+
+// 结构数组(SoA)输入，欧拉角以 heading/pitch/bank 三条float流给出
+
+extern void BuildLocalToParentN(const Point3DSoA &pos,
+								const float *heading, const float *pitch, const float *bank,
+								Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+extern void BuildParentToLocalN(const Point3DSoA &pos,
+								const float *heading, const float *pitch, const float *bank,
+								Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+extern void BuildRotationMatrixN(const float *heading, const float *pitch, const float *bank,
+								 RotationMatrix *out, size_t n, JobPool *pool = NULL);
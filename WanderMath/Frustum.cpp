@@ -0,0 +1,303 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Frustum.cpp
+// func: 由六个平面组成的视锥体及批量剔除
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Frustum.h"
+#include "EulerAngles.h"
+#include "JobPool.h"
+#include "Matrix4X3.h"
+#include "Matrix4X4.h"
+#include "Vector3DSoA.h"
+#include "Simd.h"
+
+#include <atomic>
+#include <cstring>
+
+/////////////////////////////////////////////////
+//
+// 建立视锥体
+//
+/////////////////////////////////////////////////
+
+// Frustum::FromMatrix
+//
+// 裁剪空间中可见的点满足 -w <= x <= w，-w <= y <= w，0 <= z <= w，
+// 行向量约定下 x = p * 第一列，依此类推，每个不等式即为一个平面
+
+void Frustum::FromMatrix(const Matrix4X4 &m)
+{
+	planes[KLEFT].InitFromEquation(m.m14 + m.m11, m.m24 + m.m21, m.m34 + m.m31, m.tw + m.tx);
+	planes[KRIGHT].InitFromEquation(m.m14 - m.m11, m.m24 - m.m21, m.m34 - m.m31, m.tw - m.tx);
+	planes[KBOTTOM].InitFromEquation(m.m14 + m.m12, m.m24 + m.m22, m.m34 + m.m32, m.tw + m.ty);
+	planes[KTOP].InitFromEquation(m.m14 - m.m12, m.m24 - m.m22, m.m34 - m.m32, m.tw - m.ty);
+	planes[KNEAR].InitFromEquation(m.m13, m.m23, m.m33, m.tz);
+	planes[KFAR].InitFromEquation(m.m14 - m.m13, m.m24 - m.m23, m.m34 - m.m33, m.tw - m.tz);
+
+	UpdateEquations();
+}
+
+void Frustum::FromCamera(const Point3D &pos, const EulerAngles &orientation,
+						 float fovY, float aspect, float zNear, float zFar)
+{
+	Matrix4X3 worldToCamera;
+	worldToCamera.SetupParentToLocal(pos, orientation);
+
+	Matrix4X4 view, projection;
+	view.FromMatrix4X3(worldToCamera);
+	projection.SetupPerspectiveFov(fovY, aspect, zNear, zFar);
+
+	FromMatrix(view * projection);
+}
+
+void Frustum::UpdateEquations()
+{
+	for (int i = 0; i < KPLANECOUNT; i++)
+	{
+		a[i] = planes[i].v.x;
+		b[i] = planes[i].v.y;
+		c[i] = planes[i].v.z;
+		d[i] = planes[i].Distance();
+	}
+}
+
+/////////////////////////////////////////////////
+//
+// 单个对象的测试
+//
+/////////////////////////////////////////////////
+
+bool Frustum::IsSphereVisible(const Point3D &center, float radius) const
+{
+	for (int i = 0; i < KPLANECOUNT; i++)
+	{
+		if (a[i]*center.x + b[i]*center.y + c[i]*center.z + d[i] + radius < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// 包围盒在法向量上的投影半径为 |a|*ex + |b|*ey + |c|*ez
+
+bool Frustum::IsAabbVisible(const Point3D &center, const Vector3D &extent) const
+{
+	for (int i = 0; i < KPLANECOUNT; i++)
+	{
+		float reach = fabs(a[i])*extent.x + fabs(b[i])*extent.y + fabs(c[i])*extent.z;
+
+		if (a[i]*center.x + b[i]*center.y + c[i]*center.z + d[i] + reach < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/////////////////////////////////////////////////
+//
+// 批量测试
+//
+/////////////////////////////////////////////////
+
+// 广播后的平面方程，批量测试开始时准备一次
+
+struct FrustumLanes
+{
+	SimdFloat a[Frustum::KPLANECOUNT];
+	SimdFloat b[Frustum::KPLANECOUNT];
+	SimdFloat c[Frustum::KPLANECOUNT];
+	SimdFloat d[Frustum::KPLANECOUNT];
+
+	// 法向量各分量的绝对值，用于包围盒
+
+	SimdFloat absA[Frustum::KPLANECOUNT];
+	SimdFloat absB[Frustum::KPLANECOUNT];
+	SimdFloat absC[Frustum::KPLANECOUNT];
+};
+
+static void LoadFrustumLanes(const Frustum &f, FrustumLanes &l)
+{
+	for (int i = 0; i < Frustum::KPLANECOUNT; i++)
+	{
+		l.a[i] = SimdSet1(f.a[i]);
+		l.b[i] = SimdSet1(f.b[i]);
+		l.c[i] = SimdSet1(f.c[i]);
+		l.d[i] = SimdSet1(f.d[i]);
+
+		l.absA[i] = SimdSet1(fabs(f.a[i]));
+		l.absB[i] = SimdSet1(fabs(f.b[i]));
+		l.absC[i] = SimdSet1(fabs(f.c[i]));
+	}
+}
+
+// 各通道可见标记对应的字节与个数，把比较掩码直接展开成 visible 数组
+
+struct LaneBytesTable
+{
+	unsigned char bytes[1 << KSIMDWIDTH][KSIMDWIDTH];
+	unsigned char count[1 << KSIMDWIDTH];
+
+	constexpr LaneBytesTable()
+		: bytes()
+		, count()
+	{
+		for (int bits = 0; bits < (1 << KSIMDWIDTH); bits++)
+		{
+			for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+			{
+				bytes[bits][lane] = (unsigned char)((bits >> lane) & 1);
+				count[bits] += bytes[bits][lane];
+			}
+		}
+	}
+};
+
+static constexpr LaneBytesTable gLaneBytes{};
+
+// 整组时用定长拷贝，编译器可以直接生成一次读写而不调用memcpy
+
+static inline void CopyLanes(void *dst, const void *src, size_t count)
+{
+	if (count == KSIMDWIDTH)
+	{
+		memcpy(dst, src, KSIMDWIDTH);
+	}
+	else
+	{
+		memcpy(dst, src, count);
+	}
+}
+
+// 对象是否在第p个平面内侧（或与之相交）
+
+template <bool aabb>
+static inline SimdMask InsidePlane(const FrustumLanes &l, int p, SimdFloat x, SimdFloat y, SimdFloat z,
+								   SimdFloat e0, SimdFloat e1, SimdFloat e2)
+{
+	SimdFloat dist = SimdMulAdd(z, l.c[p], SimdMulAdd(y, l.b[p], SimdMulAdd(x, l.a[p], l.d[p])));
+	SimdFloat reach = aabb ? SimdMulAdd(e2, l.absC[p], SimdMulAdd(e1, l.absB[p], SimdMul(e0, l.absA[p]))) : e0;
+
+	return SimdCmpGe(SimdAdd(dist, reach), SimdZero());
+}
+
+// CullGroup
+//
+// 测试一组 KSIMDWIDTH 个对象，只写出前 count 个的结果，返回其中可见的个数
+// aabb 为false时 ex 为球的半径，ey/ez 不使用
+// 按顺序测试每个平面一次，前 count 个对象都已被剔除时提前退出
+
+template <bool aabb>
+static size_t CullGroup(const FrustumLanes &l, const float *cx, const float *cy, const float *cz,
+						const float *ex, const float *ey, const float *ez, size_t count,
+						unsigned char *visible)
+{
+	SimdFloat x = SimdLoad(cx);
+	SimdFloat y = SimdLoad(cy);
+	SimdFloat z = SimdLoad(cz);
+	SimdFloat e0 = SimdLoad(ex);
+	SimdFloat e1 = aabb ? SimdLoad(ey) : SimdZero();
+	SimdFloat e2 = aabb ? SimdLoad(ez) : SimdZero();
+
+	// 尾部一组中补齐的通道不参与提前退出的判断
+
+	int alive = (1 << count) - 1;
+
+	for (int p = 0; p < Frustum::KPLANECOUNT && alive != 0; p++)
+	{
+		alive &= SimdMaskBits(InsidePlane<aabb>(l, p, x, y, z, e0, e1, e2));
+	}
+
+	CopyLanes(visible, gLaneBytes.bytes[alive], count);
+
+	return gLaneBytes.count[alive];
+}
+
+// 按组处理，尾部拷贝到补零的缓冲区
+
+template <bool aabb>
+static size_t CullSoA(const Frustum &f, const float *cx, const float *cy, const float *cz,
+					  const float *ex, const float *ey, const float *ez, size_t n,
+					  unsigned char *visible)
+{
+	FrustumLanes l;
+	LoadFrustumLanes(f, l);
+
+	size_t visibleCount = 0;
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		visibleCount += CullGroup<aabb>(l, cx + i, cy + i, cz + i, ex + i,
+										aabb ? ey + i : NULL, aabb ? ez + i : NULL, KSIMDWIDTH,
+										visible + i);
+	}
+
+	if (i < n)
+	{
+		size_t count = n - i;
+
+		float tx[KSIMDWIDTH] = {0}, ty[KSIMDWIDTH] = {0}, tz[KSIMDWIDTH] = {0};
+		float t0[KSIMDWIDTH] = {0}, t1[KSIMDWIDTH] = {0}, t2[KSIMDWIDTH] = {0};
+
+		for (size_t k = 0; k < count; k++)
+		{
+			tx[k] = cx[i + k];
+			ty[k] = cy[i + k];
+			tz[k] = cz[i + k];
+			t0[k] = ex[i + k];
+
+			if (aabb)
+			{
+				t1[k] = ey[i + k];
+				t2[k] = ez[i + k];
+			}
+		}
+
+		visibleCount += CullGroup<aabb>(l, tx, ty, tz, t0, t1, t2, count,
+										visible + i);
+	}
+
+	return visibleCount;
+}
+
+// 按 KJOBBATCHGRAIN 分块，各块的可见数累加
+
+template <bool aabb>
+static size_t CullBlocks(const Frustum &f, const float *cx, const float *cy, const float *cz,
+						 const float *ex, const float *ey, const float *ez, size_t n,
+						 unsigned char *visible, JobPool *pool)
+{
+	std::atomic<size_t> visibleCount(0);
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		size_t count = CullSoA<aabb>(f, cx + begin, cy + begin, cz + begin, ex + begin,
+											aabb ? ey + begin : NULL, aabb ? ez + begin : NULL, end - begin,
+											visible + begin);
+		visibleCount.fetch_add(count, std::memory_order_relaxed);
+	});
+
+	return visibleCount.load();
+}
+
+size_t Frustum::CullSpheres(const Point3DSoA &centers, const float *radius,
+							unsigned char *visible, JobPool *pool) const
+{
+	return CullBlocks<false>(*this, centers.x, centers.y, centers.z, radius, NULL, NULL,
+							 centers.Size(), visible, pool);
+}
+
+size_t Frustum::CullAabbs(const Point3DSoA &centers, const Vector3DSoA &extents,
+						  unsigned char *visible, JobPool *pool) const
+{
+	assert(extents.Size() >= centers.Size());
+
+	return CullBlocks<true>(*this, centers.x, centers.y, centers.z, extents.x, extents.y, extents.z,
+							centers.Size(), visible, pool);
+}
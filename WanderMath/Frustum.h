@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Frustum.h
+// func: 由六个平面组成的视锥体及批量剔除
+// disc: 平面法向量指向视锥体内部，点 p 在平面内侧时 n * p + d >= 0；
+//		 批量测试的输入为SoA形式，按SIMD宽度一组处理，按固定顺序
+//		 逐个测试平面，一组中所有对象都已被剔除时不再测试剩余的平面
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_Frustum_h
+#define Wander_Frustum_h
+
+#include <cassert>
+#include <cstddef>
+
+#include "Plane3D.h"
+
+class Matrix4X4;
+class EulerAngles;
+class Vector3DSoA;
+class JobPool;
+
+typedef Vector3DSoA Point3DSoA;
+
+class Frustum
+{
+public:
+
+	// 平面的顺序
+
+	enum
+	{
+		KLEFT = 0,
+		KRIGHT,
+		KBOTTOM,
+		KTOP,
+		KNEAR,
+		KFAR,
+		KPLANECOUNT
+	};
+
+	// FromMatrix
+	//
+	// 从 世界->裁剪空间 的矩阵提取六个平面（行向量约定，裁剪空间 z 在 [0, w]）
+	// 传入投影矩阵时得到相机空间的视锥体
+
+	void FromMatrix(const Matrix4X4 &worldToClip);
+
+	// FromCamera
+	//
+	// 由相机位置、朝向与透视参数建立视锥体，参数含义同 Matrix4X4::SetupPerspectiveFov
+
+	void FromCamera(const Point3D &pos, const EulerAngles &orientation,
+					float fovY, float aspect, float zNear, float zFar);
+
+	const Plane3D &GetPlane(int i) const
+	{
+		assert(i >= 0 && i < KPLANECOUNT);
+		return planes[i];
+	}
+
+	// 单个对象的测试，与视锥体相交或在其内部时返回true
+	// 与批量测试相同，位于两个平面外侧交界处附近的对象可能被保守地判为可见
+
+	bool IsSphereVisible(const Point3D &center, float radius) const;
+	bool IsAabbVisible(const Point3D &center, const Vector3D &extent) const;
+
+	// CullSpheres
+	//
+	// 批量测试球体，visible[i] 置为1或0，返回可见的个数
+	// pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+
+	size_t CullSpheres(const Point3DSoA &centers, const float *radius,
+					   unsigned char *visible, JobPool *pool = NULL) const;
+
+	// CullAabbs
+	//
+	// 批量测试轴对齐包围盒，包围盒以中心与半边长表示
+
+	size_t CullAabbs(const Point3DSoA &centers, const Vector3DSoA &extents,
+					 unsigned char *visible, JobPool *pool = NULL) const;
+
+private:
+	void UpdateEquations();
+
+public:
+	Plane3D planes[KPLANECOUNT];
+
+	// 法线-距离形式的平面方程，按分量分开存放供批量测试使用
+
+	float a[KPLANECOUNT];
+	float b[KPLANECOUNT];
+	float c[KPLANECOUNT];
+	float d[KPLANECOUNT];
+};
+
+#endif
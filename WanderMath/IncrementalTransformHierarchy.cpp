@@ -0,0 +1,298 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: IncrementalTransformHierarchy.cpp
+// func: 带脏标记的增量变换层次结构
+//
+///////////////////////////////////////////////////////////////////
+
+#include "IncrementalTransformHierarchy.h"
+#include "JobPool.h"
+
+IncrementalTransformHierarchy::IncrementalTransformHierarchy()
+	: m_firstDirty((size_t)-1)
+	, m_localRebuildCount(0)
+	, m_worldRebuildCount(0)
+{
+}
+
+void IncrementalTransformHierarchy::Reserve(size_t n)
+{
+	m_nodes.reserve(n);
+	m_parent.reserve(n);
+	m_flags.reserve(n);
+	m_depth.reserve(n);
+	m_localToParent.reserve(n);
+	m_parentToLocal.reserve(n);
+	m_localToWorld.reserve(n);
+}
+
+void IncrementalTransformHierarchy::Clear()
+{
+	m_nodes.clear();
+	m_parent.clear();
+	m_flags.clear();
+	m_depth.clear();
+	m_localToParent.clear();
+	m_parentToLocal.clear();
+	m_localToWorld.clear();
+
+	m_firstDirty = (size_t)-1;
+	m_localRebuildCount = 0;
+	m_worldRebuildCount = 0;
+}
+
+int IncrementalTransformHierarchy::AddNode(int parent, const Point3D &pos, const EulerAngles &angles,
+										   const Vector3D &scale)
+{
+	assert(parent == KNOPARENT || (parent >= 0 && (size_t)parent < m_parent.size()));
+
+	LocalTransform node;
+	node.pos = pos;
+	node.angles = angles;
+	node.scale = scale;
+
+	int index = (int)m_parent.size();
+
+	m_nodes.push_back(node);
+	m_parent.push_back(parent);
+	m_flags.push_back(0);
+	m_depth.push_back(parent == KNOPARENT ? 0 : m_depth[parent] + 1);
+	m_localToParent.push_back(Matrix4X3());
+	m_parentToLocal.push_back(Matrix4X3());
+	m_localToWorld.push_back(Matrix4X3());
+
+	MarkDirty(index);
+
+	return index;
+}
+
+void IncrementalTransformHierarchy::MarkDirty(size_t i)
+{
+	assert(i < m_flags.size());
+
+	m_flags[i] |= KLOCALDIRTY | KWORLDDIRTY;
+	m_firstDirty = i < m_firstDirty ? i : m_firstDirty;
+}
+
+void IncrementalTransformHierarchy::SetPosition(size_t i, const Point3D &pos)
+{
+	assert(i < m_nodes.size());
+	m_nodes[i].pos = pos;
+	MarkDirty(i);
+}
+
+void IncrementalTransformHierarchy::SetOrientation(size_t i, const EulerAngles &angles)
+{
+	assert(i < m_nodes.size());
+	m_nodes[i].angles = angles;
+	MarkDirty(i);
+}
+
+void IncrementalTransformHierarchy::SetScale(size_t i, const Vector3D &scale)
+{
+	assert(i < m_nodes.size());
+	m_nodes[i].scale = scale;
+	MarkDirty(i);
+}
+
+void IncrementalTransformHierarchy::SetLocal(size_t i, const Point3D &pos, const EulerAngles &angles,
+											 const Vector3D &scale)
+{
+	assert(i < m_nodes.size());
+	m_nodes[i].pos = pos;
+	m_nodes[i].angles = angles;
+	m_nodes[i].scale = scale;
+	MarkDirty(i);
+}
+
+// RebuildLocal
+//
+// 行向量约定下 本地->父 = 缩放 * 旋转 * 平移，缩放作用于旋转部分的各行；
+// 父->本地 是它的逆，缩放的倒数作用于各列（包括平移）
+
+void IncrementalTransformHierarchy::RebuildLocal(size_t i)
+{
+	const LocalTransform &node = m_nodes[i];
+	const Vector3D &s = node.scale;
+
+	assert(s.x != 0.0f && s.y != 0.0f && s.z != 0.0f);
+
+	Matrix4X3 &toParent = m_localToParent[i];
+	toParent.SetupLocalToParent(node.pos, node.angles);
+
+	toParent.m11 *= s.x; toParent.m12 *= s.x; toParent.m13 *= s.x;
+	toParent.m21 *= s.y; toParent.m22 *= s.y; toParent.m23 *= s.y;
+	toParent.m31 *= s.z; toParent.m32 *= s.z; toParent.m33 *= s.z;
+
+	float ix = 1.0f / s.x;
+	float iy = 1.0f / s.y;
+	float iz = 1.0f / s.z;
+
+	Matrix4X3 &toLocal = m_parentToLocal[i];
+	toLocal.SetupParentToLocal(node.pos, node.angles);
+
+	toLocal.m11 *= ix; toLocal.m21 *= ix; toLocal.m31 *= ix; toLocal.tx *= ix;
+	toLocal.m12 *= iy; toLocal.m22 *= iy; toLocal.m32 *= iy; toLocal.ty *= iy;
+	toLocal.m13 *= iz; toLocal.m23 *= iz; toLocal.m33 *= iz; toLocal.tz *= iz;
+}
+
+size_t IncrementalTransformHierarchy::Update(JobPool *pool)
+{
+	m_localRebuildCount = 0;
+	m_worldRebuildCount = 0;
+
+	size_t n = m_parent.size();
+
+	if (m_firstDirty >= n)
+	{
+		return 0;
+	}
+
+	if (pool != NULL)
+	{
+		UpdateParallel(pool);
+		return m_worldRebuildCount;
+	}
+
+	// 父节点的下标总小于子节点，按下标顺序一遍即可把脏标记传给整棵子树
+
+	for (size_t i = m_firstDirty; i < n; i++)
+	{
+		int parent = m_parent[i];
+		unsigned char flags = m_flags[i];
+
+		if (parent != KNOPARENT && (m_flags[parent] & KWORLDDIRTY) != 0)
+		{
+			flags |= KWORLDDIRTY;
+		}
+
+		if (flags == 0)
+		{
+			continue;
+		}
+
+		if ((flags & KLOCALDIRTY) != 0)
+		{
+			RebuildLocal(i);
+			m_localRebuildCount++;
+		}
+
+		m_localToWorld[i] = parent == KNOPARENT ? m_localToParent[i] : m_localToParent[i] * m_localToWorld[parent];
+		m_worldRebuildCount++;
+
+		// 暂时保留世界标记供子节点判断，本地标记可以清除
+
+		m_flags[i] = KWORLDDIRTY;
+	}
+
+	for (size_t i = m_firstDirty; i < n; i++)
+	{
+		m_flags[i] = 0;
+	}
+
+	m_firstDirty = (size_t)-1;
+
+	return m_worldRebuildCount;
+}
+
+// UpdateParallel
+//
+// 1. 按下标顺序传递脏标记，收集受影响的节点，只读写标记字节
+// 2. 重建本地矩阵，各节点互不相关，按 KJOBBATCHGRAIN 分块并行
+// 3. 受影响的节点按深度计数排序，逐层连接世界矩阵，同层节点只读取
+//    上一层及之前的结果，各块可以并行
+
+void IncrementalTransformHierarchy::UpdateParallel(JobPool *pool)
+{
+	size_t n = m_parent.size();
+
+	m_dirtyNodes.clear();
+
+	unsigned maxDepth = 0;
+
+	for (size_t i = m_firstDirty; i < n; i++)
+	{
+		int parent = m_parent[i];
+
+		if (parent != KNOPARENT && (m_flags[parent] & KWORLDDIRTY) != 0)
+		{
+			m_flags[i] |= KWORLDDIRTY;
+		}
+
+		if (m_flags[i] == 0)
+		{
+			continue;
+		}
+
+		if ((m_flags[i] & KLOCALDIRTY) != 0)
+		{
+			m_localRebuildCount++;
+		}
+
+		m_dirtyNodes.push_back((unsigned)i);
+		maxDepth = m_depth[i] > maxDepth ? m_depth[i] : maxDepth;
+	}
+
+	size_t dirtyCount = m_dirtyNodes.size();
+	m_worldRebuildCount = dirtyCount;
+
+	const unsigned *dirty = &m_dirtyNodes[0];
+
+	ParallelFor(pool, 0, dirtyCount, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+		{
+			if ((m_flags[dirty[k]] & KLOCALDIRTY) != 0)
+			{
+				RebuildLocal(dirty[k]);
+			}
+		}
+	});
+
+	// 计数排序，同一层内保持下标顺序
+	// 分发时 m_depthStart[depth] 从本层起点推进到本层终点
+
+	m_depthStart.assign(maxDepth + 2, 0);
+
+	for (size_t k = 0; k < dirtyCount; k++)
+	{
+		m_depthStart[m_depth[dirty[k]] + 1]++;
+	}
+
+	for (unsigned depth = 1; depth <= maxDepth + 1; depth++)
+	{
+		m_depthStart[depth] += m_depthStart[depth - 1];
+	}
+
+	m_dirtyByDepth.resize(dirtyCount);
+
+	for (size_t k = 0; k < dirtyCount; k++)
+	{
+		m_dirtyByDepth[m_depthStart[m_depth[dirty[k]]]++] = dirty[k];
+	}
+
+	const unsigned *sorted = &m_dirtyByDepth[0];
+
+	for (unsigned depth = 0; depth <= maxDepth; depth++)
+	{
+		size_t begin = depth == 0 ? 0 : m_depthStart[depth - 1];
+
+		ParallelFor(pool, begin, m_depthStart[depth], KJOBBATCHGRAIN, [&](size_t blockBegin, size_t blockEnd)
+		{
+			for (size_t k = blockBegin; k < blockEnd; k++)
+			{
+				unsigned i = sorted[k];
+				int parent = m_parent[i];
+
+				m_localToWorld[i] = parent == KNOPARENT ? m_localToParent[i] : m_localToParent[i] * m_localToWorld[parent];
+			}
+		});
+	}
+
+	for (size_t i = m_firstDirty; i < n; i++)
+	{
+		m_flags[i] = 0;
+	}
+
+	m_firstDirty = (size_t)-1;
+}
@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: IncrementalTransformHierarchy.h
+// func: 带脏标记的增量变换层次结构
+// disc: 每个节点保存本地的位置、欧拉角与缩放，修改时只做标记；
+//		 Update 只重建被修改节点的本地矩阵，并只重新连接它们的子树，
+//		 没有变化的节点沿用上一帧的结果
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_IncrementalTransformHierarchy_h
+#define Wander_IncrementalTransformHierarchy_h
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "EulerAngles.h"
+#include "Matrix4X3.h"
+#include "Vector3D.h"
+
+class JobPool;
+
+class IncrementalTransformHierarchy
+{
+public:
+
+	// 根节点的父节点下标
+
+	static const int KNOPARENT = -1;
+
+	IncrementalTransformHierarchy();
+
+	void Reserve(size_t n);
+	void Clear();
+
+	// AddNode
+	//
+	// 加入一个节点，返回它的下标，父节点必须先于子节点加入
+	// 缩放沿本地坐标轴，各分量不能为零
+
+	int AddNode(int parent, const Point3D &pos, const EulerAngles &angles,
+				const Vector3D &scale = Vector3D(1.0f, 1.0f, 1.0f));
+
+	size_t Size() const
+	{
+		return m_parent.size();
+	}
+
+	int Parent(size_t i) const
+	{
+		assert(i < m_parent.size());
+		return m_parent[i];
+	}
+
+	// 修改本地变换，只做标记，下一次 Update 时生效
+
+	void SetPosition(size_t i, const Point3D &pos);
+	void SetOrientation(size_t i, const EulerAngles &angles);
+	void SetScale(size_t i, const Vector3D &scale);
+	void SetLocal(size_t i, const Point3D &pos, const EulerAngles &angles, const Vector3D &scale);
+
+	const Point3D &Position(size_t i) const
+	{
+		assert(i < m_nodes.size());
+		return m_nodes[i].pos;
+	}
+
+	const EulerAngles &Orientation(size_t i) const
+	{
+		assert(i < m_nodes.size());
+		return m_nodes[i].angles;
+	}
+
+	const Vector3D &Scale(size_t i) const
+	{
+		assert(i < m_nodes.size());
+		return m_nodes[i].scale;
+	}
+
+	// 缓存的矩阵，上一次 Update 的结果
+
+	const Matrix4X3 &LocalToParent(size_t i) const
+	{
+		assert(i < m_localToParent.size());
+		return m_localToParent[i];
+	}
+
+	const Matrix4X3 &ParentToLocal(size_t i) const
+	{
+		assert(i < m_parentToLocal.size());
+		return m_parentToLocal[i];
+	}
+
+	const Matrix4X3 &LocalToWorld(size_t i) const
+	{
+		assert(i < m_localToWorld.size());
+		return m_localToWorld[i];
+	}
+
+	// Update
+	//
+	// 重建被修改节点的本地矩阵，再按下标顺序重新计算受影响的世界矩阵
+	// 返回重新计算世界矩阵的节点数，没有修改时直接返回0
+	// pool 为NULL时在当前线程按下标一遍完成；否则先收集受影响的节点，
+	// 本地矩阵按 KJOBBATCHGRAIN 分块并行重建，世界矩阵按深度逐层分块并行连接
+
+	size_t Update(JobPool *pool = NULL);
+
+	// 上一次 Update 中重建本地矩阵的节点数
+
+	size_t LocalRebuildCount() const
+	{
+		return m_localRebuildCount;
+	}
+
+	// 上一次 Update 中重新计算世界矩阵的节点数
+
+	size_t WorldRebuildCount() const
+	{
+		return m_worldRebuildCount;
+	}
+
+private:
+	struct LocalTransform
+	{
+		Point3D pos;
+		EulerAngles angles;
+		Vector3D scale;
+	};
+
+	// 标记位
+
+	enum
+	{
+		KLOCALDIRTY = 1,		// 本地矩阵需要重建
+		KWORLDDIRTY = 2			// 世界矩阵需要重新连接
+	};
+
+	void MarkDirty(size_t i);
+	void RebuildLocal(size_t i);
+	void UpdateParallel(JobPool *pool);
+
+private:
+	std::vector<LocalTransform> m_nodes;
+	std::vector<int> m_parent;
+	std::vector<unsigned char> m_flags;
+
+	// 节点深度，根节点为0
+
+	std::vector<unsigned> m_depth;
+
+	std::vector<Matrix4X3> m_localToParent;
+	std::vector<Matrix4X3> m_parentToLocal;
+	std::vector<Matrix4X3> m_localToWorld;
+
+	// 被修改的节点中下标最小的一个，之前的节点都不受影响
+
+	size_t m_firstDirty;
+
+	// 并行更新时的临时数组：受影响的节点按深度排序，以及各层的起点
+
+	std::vector<unsigned> m_dirtyNodes;
+	std::vector<unsigned> m_dirtyByDepth;
+	std::vector<size_t> m_depthStart;
+
+	size_t m_localRebuildCount;
+	size_t m_worldRebuildCount;
+};
+
+#endif
@@ -0,0 +1,381 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: JobPool.cpp
+// func: 工作窃取线程池与线程暂存区
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+
+#include "JobPool.h"
+#include "Simd.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 当前线程正在为哪个池的哪个位置执行块，块外为NULL
+// 工作线程在执行别的池的块时也能正确找到自己的位置
+
+static thread_local JobPool *tJobPool = NULL;
+static thread_local unsigned tJobSlot = 0;
+
+static inline uint64_t PackRange(uint32_t next, uint32_t end)
+{
+	return ((uint64_t)next << 32) | end;
+}
+
+static void PinCurrentThread(unsigned cpu)
+{
+#if defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (cpu % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void)cpu;
+#endif
+}
+
+/////////////////////////////////////////////////
+//
+// JobArena
+//
+/////////////////////////////////////////////////
+
+JobArena::JobArena()
+	: m_base(NULL)
+	, m_capacity(0)
+	, m_offset(0)
+	, m_overflowBytes(0)
+{
+}
+
+JobArena::~JobArena()
+{
+	for (size_t i = 0; i < m_overflow.size(); i++)
+	{
+		AlignedFree(m_overflow[i]);
+	}
+
+	AlignedFree(m_base);
+}
+
+void *JobArena::Allocate(size_t bytes, size_t align)
+{
+	assert(align != 0 && (align & (align - 1)) == 0);
+
+	size_t base = (size_t)m_base;
+	size_t offset = ((base + m_offset + align - 1) & ~(align - 1)) - base;
+
+	if (m_base != NULL && offset + bytes <= m_capacity)
+	{
+		m_offset = offset + bytes;
+		return m_base + offset;
+	}
+
+	void *p = AlignedMalloc(bytes > 0 ? bytes : 1, align > KSIMDALIGN ? align : KSIMDALIGN);
+	assert(p != NULL);
+
+	m_overflow.push_back(p);
+	m_overflowBytes += bytes + align;
+	return p;
+}
+
+void JobArena::Reset()
+{
+	m_offset = 0;
+
+	if (m_overflow.empty())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_overflow.size(); i++)
+	{
+		AlignedFree(m_overflow[i]);
+	}
+
+	m_overflow.clear();
+
+	// 把追加的块并入主内存块，下次同样的用量不再溢出
+
+	AlignedFree(m_base);
+	m_capacity += m_overflowBytes;
+	m_overflowBytes = 0;
+	m_base = (char *)AlignedMalloc(m_capacity);
+	assert(m_base != NULL);
+}
+
+/////////////////////////////////////////////////
+//
+// JobPool
+//
+/////////////////////////////////////////////////
+
+JobPool::JobPool(unsigned threadCount, bool pinThreads)
+	: m_slots(NULL)
+	, m_func(NULL)
+	, m_context(NULL)
+	, m_begin(0)
+	, m_end(0)
+	, m_grain(1)
+	, m_generation(0)
+	, m_busy(0)
+	, m_quit(false)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+		threadCount = threadCount > 0 ? threadCount : 1;
+	}
+
+	m_slots = new Slot[threadCount];
+
+	for (unsigned i = 0; i < threadCount; i++)
+	{
+		m_slots[i].range.store(0, std::memory_order_relaxed);
+	}
+
+	for (unsigned i = 1; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&JobPool::WorkerMain, this, i, pinThreads));
+	}
+}
+
+JobPool::~JobPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+
+	m_wake.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	delete [] m_slots;
+}
+
+unsigned JobPool::WorkerIndex() const
+{
+	assert(tJobPool == this);
+	return tJobSlot;
+}
+
+JobArena &JobPool::Arena()
+{
+	return m_slots[WorkerIndex()].arena;
+}
+
+void JobPool::Run(size_t begin, size_t end, size_t grain, RangeFunc func, const void *context)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	if (grain == 0)
+	{
+		grain = 1;
+	}
+
+	size_t blockCount = (end - begin + grain - 1) / grain;
+	assert(blockCount <= 0xffffffff);
+
+	// 没有工作线程时在当前线程依次处理各块，与多线程时的切分相同，
+	// 按块索引暂存结果的调用者不必区分两种情况
+
+	if (m_workers.empty() || blockCount <= 1)
+	{
+		JobPool *outerPool = tJobPool;
+		unsigned outerSlot = tJobSlot;
+
+		tJobPool = this;
+		tJobSlot = 0;
+
+		for (size_t blockBegin = begin; blockBegin < end; blockBegin += grain)
+		{
+			m_slots[0].arena.Reset();
+			func(context, blockBegin, end - blockBegin > grain ? blockBegin + grain : end);
+		}
+
+		tJobPool = outerPool;
+		tJobSlot = outerSlot;
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		// 迟到的工作线程可能还持有上一个任务，等它们退出后再改写
+
+		m_done.wait(lock, [this]() { return m_busy == 0; });
+
+		m_func = func;
+		m_context = context;
+		m_begin = begin;
+		m_end = end;
+		m_grain = grain;
+
+		// 先按线程平均分配连续的块，之后由窃取来平衡
+
+		unsigned threads = ThreadCount();
+
+		for (unsigned t = 0; t < threads; t++)
+		{
+			uint32_t first = (uint32_t)(blockCount * t / threads);
+			uint32_t last = (uint32_t)(blockCount * (t + 1) / threads);
+			m_slots[t].range.store(PackRange(first, last), std::memory_order_relaxed);
+		}
+
+		m_generation++;
+	}
+
+	m_wake.notify_all();
+
+	RunBlocks(0, func, context);
+
+	// 自己已取不到块，剩下的块都在忙碌的工作线程手上，等它们完成
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this]() { return m_busy == 0; });
+}
+
+bool JobPool::PopBlock(unsigned self, uint32_t &block)
+{
+	std::atomic<uint64_t> &range = m_slots[self].range;
+	uint64_t r = range.load(std::memory_order_acquire);
+
+	for (;;)
+	{
+		uint32_t next = (uint32_t)(r >> 32);
+		uint32_t end = (uint32_t)r;
+
+		if (next >= end)
+		{
+			return false;
+		}
+
+		if (range.compare_exchange_weak(r, PackRange(next + 1, end), std::memory_order_acq_rel))
+		{
+			block = next;
+			return true;
+		}
+	}
+}
+
+// StealBlock
+//
+// 从其他线程剩余的块中偷走后一半，执行其中第一块，其余放进自己的位置
+
+bool JobPool::StealBlock(unsigned self, uint32_t &block)
+{
+	unsigned threads = ThreadCount();
+
+	for (unsigned k = 1; k < threads; k++)
+	{
+		unsigned victim = (self + k) % threads;
+		std::atomic<uint64_t> &range = m_slots[victim].range;
+		uint64_t r = range.load(std::memory_order_acquire);
+
+		for (;;)
+		{
+			uint32_t next = (uint32_t)(r >> 32);
+			uint32_t end = (uint32_t)r;
+
+			if (next >= end)
+			{
+				break;
+			}
+
+			uint32_t take = (end - next + 1) / 2;
+			uint32_t split = end - take;
+
+			if (range.compare_exchange_weak(r, PackRange(next, split), std::memory_order_acq_rel))
+			{
+				// 自己的位置此时为空，其他线程不会改写它
+
+				m_slots[self].range.store(PackRange(split + 1, end), std::memory_order_release);
+				block = split;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void JobPool::RunBlocks(unsigned self, RangeFunc func, const void *context)
+{
+	JobPool *outerPool = tJobPool;
+	unsigned outerSlot = tJobSlot;
+
+	tJobPool = this;
+	tJobSlot = self;
+
+	JobArena &arena = m_slots[self].arena;
+	uint32_t block;
+
+	while (PopBlock(self, block) || StealBlock(self, block))
+	{
+		size_t blockBegin = m_begin + (size_t)block * m_grain;
+		size_t blockEnd = m_end - blockBegin > m_grain ? blockBegin + m_grain : m_end;
+
+		arena.Reset();
+		func(context, blockBegin, blockEnd);
+	}
+
+	tJobPool = outerPool;
+	tJobSlot = outerSlot;
+}
+
+void JobPool::WorkerMain(unsigned self, bool pin)
+{
+	if (pin)
+	{
+		PinCurrentThread(self);
+	}
+
+	unsigned seen = 0;
+
+	for (;;)
+	{
+		RangeFunc func;
+		const void *context;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&]() { return m_quit || m_generation != seen; });
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			seen = m_generation;
+			func = m_func;
+			context = m_context;
+			m_busy++;
+		}
+
+		RunBlocks(self, func, context);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			assert(m_busy > 0);
+			m_busy--;
+		}
+
+		m_done.notify_all();
+	}
+}
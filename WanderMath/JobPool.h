@@ -0,0 +1,183 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: JobPool.h
+// func: 工作窃取线程池，把区间切块后分给各线程
+// disc: 由调用者创建并持有，不使用全局单例，同一进程中的多个引擎实例
+//		 可以各自持有一个池；调用 ParallelFor 的线程也参与计算，返回时
+//		 整个区间都已完成
+//		 每次 ParallelFor 先把块平均分给各线程，线程从自己那份的前端取块，
+//		 取完后从其他线程那份的后端偷走一半，各块耗时不均时也能负载均衡
+//		 每个线程有一个暂存区(JobArena)，块内的临时缓冲从中分配，
+//		 不必每次向系统申请
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_JobPool_h
+#define Wander_JobPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 批量内核在线程池上运行时每块的元素个数，是SIMD宽度的整数倍，
+// 使每块的起点保持输出数组的对齐
+
+const size_t KJOBBATCHGRAIN = 4096;
+
+// 线性分配的暂存区，Reset 后全部释放；容量不够时追加新的内存块，
+// 下一次 Reset 时合并成一整块，稳定后不再申请内存
+
+class JobArena
+{
+public:
+	JobArena();
+	~JobArena();
+
+	// Allocate
+	//
+	// 分配 bytes 字节，align 必须是2的幂，内存不清零
+
+	void *Allocate(size_t bytes, size_t align = 64);
+
+	template <class T>
+	T *AllocateArray(size_t n)
+	{
+		return static_cast<T *>(Allocate(n * sizeof(T), alignof(T) > 64 ? alignof(T) : 64));
+	}
+
+	void Reset();
+
+	size_t Capacity() const
+	{
+		return m_capacity;
+	}
+
+private:
+	JobArena(const JobArena &);
+	JobArena &operator = (const JobArena &);
+
+private:
+	char *m_base;
+	size_t m_capacity;
+	size_t m_offset;
+
+	// 主内存块放不下时追加的块，以及它们的总大小
+
+	std::vector<void *> m_overflow;
+	size_t m_overflowBytes;
+};
+
+class JobPool
+{
+public:
+
+	// threadCount 为参与计算的线程总数（包括调用者），为0时取硬件线程数
+	// pinThreads 为true时把第 i 个工作线程绑定到第 i 个逻辑处理器上，
+	// 调用者的线程不绑定；平台不支持时忽略
+
+	explicit JobPool(unsigned threadCount = 0, bool pinThreads = false);
+	~JobPool();
+
+	unsigned ThreadCount() const
+	{
+		return (unsigned)m_workers.size() + 1;
+	}
+
+	// ParallelFor
+	//
+	// 把 [begin, end) 按 grain 切块，fn(blockBegin, blockEnd) 在各线程上执行
+	// 每次调用恰好是一块：blockBegin = begin + k * grain，只有最后一块可能不足 grain
+	// 区间不超过一块或池中只有一个线程时在当前线程依次处理各块
+	// 不支持在 fn 中再调用同一个池的 ParallelFor，也不支持多个线程
+	// 同时调用同一个池的 ParallelFor
+
+	template <class Fn>
+	void ParallelFor(size_t begin, size_t end, size_t grain, const Fn &fn)
+	{
+		Run(begin, end, grain, &InvokeRange<Fn>, &fn);
+	}
+
+	// WorkerIndex
+	//
+	// 在 fn 中调用，返回当前线程在池中的编号，调用者为0，工作线程从1开始
+
+	unsigned WorkerIndex() const;
+
+	// Arena
+	//
+	// 在 fn 中调用，返回当前线程的暂存区；每块开始前暂存区会被清空，
+	// 分配的内存只在本块内有效
+
+	JobArena &Arena();
+
+private:
+	typedef void (*RangeFunc)(const void *context, size_t begin, size_t end);
+
+	template <class Fn>
+	static void InvokeRange(const void *context, size_t begin, size_t end)
+	{
+		(*static_cast<const Fn *>(context))(begin, end);
+	}
+
+	// 每个线程一份的状态，按缓存行隔开避免伪共享
+	// range 的高32位为下一个要取的块，低32位为结束的块
+
+	struct alignas(64) Slot
+	{
+		std::atomic<uint64_t> range;
+		JobArena arena;
+	};
+
+	JobPool(const JobPool &);
+	JobPool &operator = (const JobPool &);
+
+	void Run(size_t begin, size_t end, size_t grain, RangeFunc func, const void *context);
+	void RunBlocks(unsigned self, RangeFunc func, const void *context);
+	bool PopBlock(unsigned self, uint32_t &block);
+	bool StealBlock(unsigned self, uint32_t &block);
+	void WorkerMain(unsigned self, bool pin);
+
+private:
+	std::vector<std::thread> m_workers;
+	Slot *m_slots;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	// 当前任务，只在没有工作线程持有旧任务时改写
+
+	RangeFunc m_func;
+	const void *m_context;
+	size_t m_begin;
+	size_t m_end;
+	size_t m_grain;
+
+	unsigned m_generation;
+	unsigned m_busy;
+	bool m_quit;
+};
+
+// ParallelFor
+//
+// pool 为NULL时在当前线程一次处理整个区间，批量内核用它统一串行与并行两种调用
+// 因此 fn 收到的区间可能包含多块，按块暂存结果的内核要自己按 grain 切开
+
+template <class Fn>
+inline void ParallelFor(JobPool *pool, size_t begin, size_t end, size_t grain, const Fn &fn)
+{
+	if (pool != NULL)
+	{
+		pool->ParallelFor(begin, end, grain, fn);
+	}
+	else if (begin < end)
+	{
+		fn(begin, end);
+	}
+}
+
+#endif
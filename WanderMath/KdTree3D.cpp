@@ -0,0 +1,487 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: KdTree3D.cpp
+// func: 隐式k-d树的构建与查询
+//
+///////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "JobPool.h"
+#include "KdTree3D.h"
+
+// 叶子最多容纳的点数，按中位数切分后叶子大小在它的一半到它之间
+
+static const size_t KKDLEAFSIZE = 8;
+
+// 遍历栈的深度，每层最多压入一个远侧子树，32位下标下树高不超过32
+
+static const int KKDSTACKSIZE = 64;
+
+// 少于此点数时不值得并行构建
+
+static const size_t KKDPARALLELBUILD = 16384;
+
+// 并行构建时顶部切出的子树数相对于线程数的倍数
+
+static const size_t KKDTASKSPERTHREAD = 8;
+
+// 批量查询每块的查询数
+
+static const size_t KKDQUERYGRAIN = 1024;
+
+struct KdStackEntry
+{
+	uint32_t begin;
+	uint32_t end;
+
+	// 区间中的点到查询点距离平方的下界
+
+	float boundSq;
+};
+
+KdTree3D::KdTree3D()
+{
+}
+
+void KdTree3D::Clear()
+{
+	m_points.clear();
+	m_split.clear();
+	m_axis.clear();
+}
+
+void KdTree3D::Build(const Point3D *points, size_t n, JobPool *pool)
+{
+	assert(n <= 0x7fffffff);
+
+	m_points.resize(n);
+	m_split.assign(n, 0.0f);
+	m_axis.assign(n, 0);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		m_points[i].p[0] = points[i].x;
+		m_points[i].p[1] = points[i].y;
+		m_points[i].p[2] = points[i].z;
+		m_points[i].id = (int)i;
+	}
+
+	if (pool == NULL || pool->ThreadCount() == 1 || n < KKDPARALLELBUILD)
+	{
+		BuildRange(0, n);
+		return;
+	}
+
+	// 顶部逐层切分：同一层的区间互不相交，整层交给线程池
+	// cuts 中相邻两项为一个区间，每层在每个区间的中点处插入新的切口
+
+	size_t taskCount = pool->ThreadCount() * KKDTASKSPERTHREAD;
+	std::vector<size_t> cuts;
+	cuts.push_back(0);
+	cuts.push_back(n);
+
+	while (cuts.size() - 1 < taskCount && cuts[1] - cuts[0] > KKDLEAFSIZE)
+	{
+		pool->ParallelFor(0, cuts.size() - 1, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				SplitRange(cuts[i], cuts[i + 1]);
+			}
+		});
+
+		std::vector<size_t> next;
+		next.reserve(cuts.size() * 2);
+
+		for (size_t i = 0; i + 1 < cuts.size(); i++)
+		{
+			next.push_back(cuts[i]);
+
+			if (cuts[i + 1] - cuts[i] > KKDLEAFSIZE)
+			{
+				next.push_back(cuts[i] + (cuts[i + 1] - cuts[i]) / 2);
+			}
+		}
+
+		next.push_back(n);
+		cuts.swap(next);
+	}
+
+	pool->ParallelFor(0, cuts.size() - 1, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			BuildRange(cuts[i], cuts[i + 1]);
+		}
+	});
+}
+
+// SplitRange
+//
+// 沿包围盒最长的轴把 [begin, end) 在中点处分开，中点左侧不大于切分点，右侧不小于切分点
+
+void KdTree3D::SplitRange(size_t begin, size_t end)
+{
+	if (end - begin <= KKDLEAFSIZE)
+	{
+		return;
+	}
+
+	float lo[3], hi[3];
+
+	for (int k = 0; k < 3; k++)
+	{
+		lo[k] = hi[k] = m_points[begin].p[k];
+	}
+
+	for (size_t i = begin + 1; i < end; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			lo[k] = MIN(lo[k], m_points[i].p[k]);
+			hi[k] = MAX(hi[k], m_points[i].p[k]);
+		}
+	}
+
+	int axis = 0;
+
+	for (int k = 1; k < 3; k++)
+	{
+		if (hi[k] - lo[k] > hi[axis] - lo[axis])
+		{
+			axis = k;
+		}
+	}
+
+	size_t mid = begin + (end - begin) / 2;
+
+	std::nth_element(m_points.begin() + begin, m_points.begin() + mid, m_points.begin() + end,
+		[axis](const KdPoint &a, const KdPoint &b) { return a.p[axis] < b.p[axis]; });
+
+	m_split[mid] = m_points[mid].p[axis];
+	m_axis[mid] = (uint8_t)axis;
+}
+
+void KdTree3D::BuildRange(size_t begin, size_t end)
+{
+	if (end - begin <= KKDLEAFSIZE)
+	{
+		return;
+	}
+
+	SplitRange(begin, end);
+
+	size_t mid = begin + (end - begin) / 2;
+	BuildRange(begin, mid);
+	BuildRange(mid, end);
+}
+
+size_t KdTree3D::KNearest(const float *center, size_t k, int *outIds, float *outDistSq, float limitSq) const
+{
+	size_t found = 0;
+
+	if (k == 0 || m_points.empty())
+	{
+		return 0;
+	}
+
+	KdStackEntry stack[KKDSTACKSIZE];
+	int top = 0;
+
+	stack[top].begin = 0;
+	stack[top].end = (uint32_t)m_points.size();
+	stack[top].boundSq = 0.0f;
+	top++;
+
+	while (top > 0)
+	{
+		const KdStackEntry entry = stack[--top];
+		float worst = found == k ? outDistSq[k - 1] : limitSq;
+
+		if (entry.boundSq > worst)
+		{
+			continue;
+		}
+
+		// 沿近侧一直下降到叶子，远侧连同下界压栈
+
+		uint32_t begin = entry.begin;
+		uint32_t end = entry.end;
+
+		while (end - begin > KKDLEAFSIZE)
+		{
+			uint32_t mid = begin + (end - begin) / 2;
+			int axis = m_axis[mid];
+			float diff = center[axis] - m_split[mid];
+
+			assert(top < KKDSTACKSIZE);
+			stack[top].boundSq = MAX(entry.boundSq, diff * diff);
+
+			if (diff < 0.0f)
+			{
+				stack[top].begin = mid;
+				stack[top].end = end;
+				end = mid;
+			}
+			else
+			{
+				stack[top].begin = begin;
+				stack[top].end = mid;
+				begin = mid;
+			}
+
+			top++;
+		}
+
+		// 结果按距离升序保存，插入排序；k 通常很小
+
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const KdPoint &pt = m_points[i];
+			float dx = pt.p[0] - center[0];
+			float dy = pt.p[1] - center[1];
+			float dz = pt.p[2] - center[2];
+			float distSq = dx * dx + dy * dy + dz * dz;
+
+			if (distSq > worst || (found == k && distSq == worst))
+			{
+				continue;
+			}
+
+			size_t slot = found < k ? found++ : k - 1;
+
+			while (slot > 0 && outDistSq[slot - 1] > distSq)
+			{
+				outDistSq[slot] = outDistSq[slot - 1];
+				outIds[slot] = outIds[slot - 1];
+				slot--;
+			}
+
+			outDistSq[slot] = distSq;
+			outIds[slot] = pt.id;
+
+			worst = found == k ? outDistSq[k - 1] : limitSq;
+		}
+	}
+
+	return found;
+}
+
+size_t KdTree3D::QueryKNearest(const Point3D &center, size_t k, int *outIds, float *outDistSq, float maxRadius) const
+{
+	std::vector<float> localDist;
+
+	if (outDistSq == NULL && k > 0)
+	{
+		localDist.resize(k);
+		outDistSq = &localDist[0];
+	}
+
+	float c[3] = { center.x, center.y, center.z };
+	return KNearest(c, k, outIds, outDistSq, maxRadius * maxRadius);
+}
+
+int KdTree3D::QueryNearest(const Point3D &center, float *outDistSq) const
+{
+	int id = KKDNOPOINT;
+	float distSq = 3.4e38f;
+	float c[3] = { center.x, center.y, center.z };
+
+	KNearest(c, 1, &id, &distSq, 3.4e38f);
+
+	if (outDistSq != NULL)
+	{
+		*outDistSq = distSq;
+	}
+
+	return id;
+}
+
+size_t KdTree3D::QueryRadius(const Point3D &center, float radius, std::vector<int> &out) const
+{
+	size_t before = out.size();
+
+	if (m_points.empty())
+	{
+		return 0;
+	}
+
+	float c[3] = { center.x, center.y, center.z };
+	float radiusSq = radius * radius;
+
+	KdStackEntry stack[KKDSTACKSIZE];
+	int top = 0;
+
+	stack[top].begin = 0;
+	stack[top].end = (uint32_t)m_points.size();
+	stack[top].boundSq = 0.0f;
+	top++;
+
+	// 先按叶子大小预留空间，无分支地写入，命中的点才推进 written
+
+	size_t written = before;
+
+	while (top > 0)
+	{
+		const KdStackEntry entry = stack[--top];
+
+		if (entry.boundSq > radiusSq)
+		{
+			continue;
+		}
+
+		uint32_t begin = entry.begin;
+		uint32_t end = entry.end;
+
+		while (end - begin > KKDLEAFSIZE)
+		{
+			uint32_t mid = begin + (end - begin) / 2;
+			int axis = m_axis[mid];
+			float diff = c[axis] - m_split[mid];
+			float farBound = MAX(entry.boundSq, diff * diff);
+
+			// 远侧已超出半径时不必压栈
+
+			if (farBound <= radiusSq)
+			{
+				assert(top < KKDSTACKSIZE);
+				stack[top].boundSq = farBound;
+				stack[top].begin = diff < 0.0f ? mid : begin;
+				stack[top].end = diff < 0.0f ? end : mid;
+				top++;
+			}
+
+			if (diff < 0.0f)
+			{
+				end = mid;
+			}
+			else
+			{
+				begin = mid;
+			}
+		}
+
+		if (out.size() < written + KKDLEAFSIZE)
+		{
+			out.resize(MAX(out.size() * 2, written + KKDLEAFSIZE));
+		}
+
+		int *dst = &out[0];
+
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const KdPoint &pt = m_points[i];
+			float dx = pt.p[0] - c[0];
+			float dy = pt.p[1] - c[1];
+			float dz = pt.p[2] - c[2];
+
+			dst[written] = pt.id;
+			written += dx * dx + dy * dy + dz * dz <= radiusSq ? 1 : 0;
+		}
+	}
+
+	out.resize(written);
+	return written - before;
+}
+
+void KdTree3D::QueryKNearestN(const Point3D *centers, size_t n, size_t k, int *outIds, float *outDistSq, JobPool *pool) const
+{
+	if (k == 0)
+	{
+		return;
+	}
+
+	auto queryRange = [&](size_t begin, size_t end)
+	{
+		std::vector<float> localDist;
+
+		if (outDistSq == NULL)
+		{
+			localDist.resize(k);
+		}
+
+		for (size_t i = begin; i < end; i++)
+		{
+			int *ids = outIds + i * k;
+			float *dist = outDistSq != NULL ? outDistSq + i * k : &localDist[0];
+			float c[3] = { centers[i].x, centers[i].y, centers[i].z };
+
+			for (size_t j = KNearest(c, k, ids, dist, 3.4e38f); j < k; j++)
+			{
+				ids[j] = KKDNOPOINT;
+				dist[j] = 3.4e38f;
+			}
+		}
+	};
+
+	ParallelFor(pool, 0, n, KKDQUERYGRAIN, queryRange);
+}
+
+size_t KdTree3D::QueryRadiusN(const Point3D *centers, size_t n, float radius, std::vector<int> &neighbours,
+	std::vector<uint32_t> &start, std::vector<uint32_t> &count, JobPool *pool) const
+{
+	start.resize(n);
+	count.resize(n);
+
+	size_t blockCount = (n + KKDQUERYGRAIN - 1) / KKDQUERYGRAIN;
+	std::vector<std::vector<int> > blocks(blockCount);
+
+	// 一次回调的区间可能包含多个块（pool 为NULL时是整个区间），
+	// 按块的边界切开，每块只写自己的结果
+
+	auto queryRange = [&](size_t begin, size_t end)
+	{
+		while (begin < end)
+		{
+			size_t b = begin / KKDQUERYGRAIN;
+			size_t blockEnd = MIN((b + 1) * KKDQUERYGRAIN, end);
+
+			std::vector<int> &local = blocks[b];
+			local.clear();
+
+			for (size_t i = begin; i < blockEnd; i++)
+			{
+				start[i] = (uint32_t)local.size();
+				count[i] = (uint32_t)QueryRadius(centers[i], radius, local);
+			}
+
+			begin = blockEnd;
+		}
+	};
+
+	ParallelFor(pool, 0, n, KKDQUERYGRAIN, queryRange);
+
+	// 各块的结果首尾相接，块内的起点加上块的偏移
+
+	size_t offset = 0;
+
+	for (size_t b = 0; b < blockCount; b++)
+	{
+		size_t end = MIN((b + 1) * KKDQUERYGRAIN, n);
+
+		for (size_t i = b * KKDQUERYGRAIN; i < end; i++)
+		{
+			start[i] += (uint32_t)offset;
+		}
+
+		offset += blocks[b].size();
+	}
+
+	neighbours.resize(offset);
+	offset = 0;
+
+	for (size_t b = 0; b < blockCount; b++)
+	{
+		if (!blocks[b].empty())
+		{
+			memcpy(&neighbours[offset], &blocks[b][0], blocks[b].size() * sizeof(int));
+		}
+
+		offset += blocks[b].size();
+	}
+
+	return offset;
+}
@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: KdTree3D.h
+// func: 静态三维点集的隐式k-d树，用于最近邻与半径查询
+// disc: 不保存节点与指针：点按中位数递归重排后，区间 [b, e) 的
+//		 切分位置固定为中点 m = b + (e - b) / 2，左子树为 [b, m)，
+//		 右子树为 [m, e)，每个切分位置只额外记切分轴与切分值
+//		 点数不超过 KKDLEAFSIZE 的区间作为叶子整段扫描
+//		 建好后只读，多个线程可以同时查询同一棵树
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_KdTree3D_h
+#define Wander_KdTree3D_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Vector3D.h"
+
+class JobPool;
+
+// 批量k近邻中不足 k 个的结果编号
+
+const int KKDNOPOINT = -1;
+
+class KdTree3D
+{
+public:
+	KdTree3D();
+
+	// Build
+	//
+	// 用 n 个点建树，点的编号即在 points 中的下标
+	// pool 为NULL时在当前线程构建
+
+	void Build(const Point3D *points, size_t n, JobPool *pool = NULL);
+
+	void Clear();
+
+	size_t Size() const
+	{
+		return m_points.size();
+	}
+
+	// QueryKNearest
+	//
+	// 找出离 center 最近的至多 k 个点，按距离从近到远写入 outIds，
+	// outDistSq 不为NULL时写入对应的距离平方；只考虑 maxRadius 以内的点
+	// 返回找到的个数
+
+	size_t QueryKNearest(const Point3D &center, size_t k, int *outIds, float *outDistSq = NULL,
+		float maxRadius = 3.4e38f) const;
+
+	// QueryNearest
+	//
+	// 最近的一个点，树为空时返回 KKDNOPOINT
+
+	int QueryNearest(const Point3D &center, float *outDistSq = NULL) const;
+
+	// QueryRadius
+	//
+	// 把与 center 距离不超过 radius 的点的编号追加到 out，返回追加的个数
+	// 结果不按距离排序
+
+	size_t QueryRadius(const Point3D &center, float radius, std::vector<int> &out) const;
+
+	// QueryKNearestN
+	//
+	// 批量k近邻，第 i 个查询的结果写入 outIds[i * k] 起的 k 个位置，
+	// 不足 k 个时其余编号为 KKDNOPOINT、距离平方为 3.4e38f
+	// pool 不为NULL时分块并行
+
+	void QueryKNearestN(const Point3D *centers, size_t n, size_t k, int *outIds, float *outDistSq = NULL,
+		JobPool *pool = NULL) const;
+
+	// QueryRadiusN
+	//
+	// 批量半径查询，第 i 个查询的结果为
+	// neighbours[start[i]] 到 neighbours[start[i] + count[i] - 1]
+	// pool 不为NULL时分块并行，返回结果总数
+
+	size_t QueryRadiusN(const Point3D *centers, size_t n, float radius, std::vector<int> &neighbours,
+		std::vector<uint32_t> &start, std::vector<uint32_t> &count, JobPool *pool = NULL) const;
+
+private:
+
+	// 重排后的点，16字节，叶子扫描时连续读取
+
+	struct KdPoint
+	{
+		float p[3];
+		int id;
+	};
+
+	KdTree3D(const KdTree3D &);
+	KdTree3D &operator = (const KdTree3D &);
+
+	void BuildRange(size_t begin, size_t end);
+	void SplitRange(size_t begin, size_t end);
+
+	// outDistSq 不能为NULL
+
+	size_t KNearest(const float *center, size_t k, int *outIds, float *outDistSq, float limitSq) const;
+
+private:
+	std::vector<KdPoint> m_points;
+
+	// 以 m 为切分位置的区间的切分轴与切分值，叶子中的位置不使用
+	// 右子树重排后 m 上的点会变，所以切分值单独保存
+
+	std::vector<float> m_split;
+	std::vector<uint8_t> m_axis;
+};
+
+#endif
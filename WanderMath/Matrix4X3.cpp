@@ -24,14 +24,6 @@ using namespace std;
 //
 ///////////////////////////////////////////////////////////////////
 
-Matrix4X3::Matrix4X3()
-{
-	m11 = 1.0f; m12 = 0.0f; m13 = 0.0f;
-	m21 = 0.0f; m22 = 1.0f; m23 = 0.0f;
-	m31 = 0.0f; m32 = 0.0f; m33 = 1.0f;
-    
-	tx = 0.0f; ty = 0.0f; tz = 0.0f;
-}
 // Matrix4X3::Reset
 //
 // 将矩阵重置
@@ -287,7 +279,7 @@ void Matrix4X3::FromQuaternion(const Quaternion &q)
     
 	m11 = 1.0f - yy*q.y - zz*q.z;
 	m12 = xx*q.y + ww*q.z;
-	m13 = xx*q.z - ww*q.x;
+	m13 = xx*q.z - ww*q.y;
     
 	m21 = xx*q.y - ww*q.z;
 	m22 = 1.0f - xx*q.x - zz*q.z;
@@ -611,18 +603,91 @@ float Determinant(const Matrix4X3 &m)
 			m.m13 * (m.m21*m.m32 - m.m22*m.m31));
 }
 
+// IsOrthonormal
+//
+// 检查三行的长度平方与两两点积，只用乘加，不开方
+
+bool IsOrthonormal(const Matrix4X3 &m, float tolerance)
+{
+	float d11 = m.m11*m.m11 + m.m12*m.m12 + m.m13*m.m13;
+	float d22 = m.m21*m.m21 + m.m22*m.m22 + m.m23*m.m23;
+	float d33 = m.m31*m.m31 + m.m32*m.m32 + m.m33*m.m33;
+
+	float d12 = m.m11*m.m21 + m.m12*m.m22 + m.m13*m.m23;
+	float d13 = m.m11*m.m31 + m.m12*m.m32 + m.m13*m.m33;
+	float d23 = m.m21*m.m31 + m.m22*m.m32 + m.m23*m.m33;
+
+	return (fabs(d11 - 1.0f) <= tolerance && fabs(d22 - 1.0f) <= tolerance &&
+			fabs(d33 - 1.0f) <= tolerance && fabs(d12) <= tolerance &&
+			fabs(d13) <= tolerance && fabs(d23) <= tolerance);
+}
+
 Matrix4X3 Inverse(const Matrix4X3 &m)
+{
+	// 绝大多数矩阵是刚体变换，逆就是转置
+
+	if (IsOrthonormal(m))
+	{
+		return InverseRigid(m);
+	}
+
+	return InverseAffine(m);
+}
+
+// InverseRigid
+//
+// 旋转部分正交时 R的逆 = R的转置，平移部分的逆为 -t * R的转置
+
+Matrix4X3 InverseRigid(const Matrix4X3 &m)
+{
+	Matrix4X3 tm;
+
+	tm.m11 = m.m11; tm.m12 = m.m21; tm.m13 = m.m31;
+	tm.m21 = m.m12; tm.m22 = m.m22; tm.m23 = m.m32;
+	tm.m31 = m.m13; tm.m32 = m.m23; tm.m33 = m.m33;
+
+	tm.tx = -(m.tx*m.m11 + m.ty*m.m12 + m.tz*m.m13);
+	tm.ty = -(m.tx*m.m21 + m.ty*m.m22 + m.tz*m.m23);
+	tm.tz = -(m.tx*m.m31 + m.ty*m.m32 + m.tz*m.m33);
+
+	return tm;
+}
+
+// InverseAffine
+//
+// 一般情况：伴随矩阵除以行列式
+
+Matrix4X3 InverseAffine(const Matrix4X3 &m)
+{
+	Matrix4X3 tm;
+
+	bool ok = TryInverse(m, tm);
+
+	// 如果是奇异矩阵，则矩阵没有逆
+
+	assert(ok);
+	(void)ok;
+
+	return tm;
+}
+
+// TryInverse
+//
+// 与InverseAffine相同，但奇异时返回false，供服务器等不能中断的场合使用
+
+bool TryInverse(const Matrix4X3 &m, Matrix4X3 &out)
 {
 	float det = Determinant(m);
-    
-	// 如果是零矩阵，则矩阵没有逆
-    
-	assert(fabs(det) > 0.000001f);
-    
+
+	if (!(fabs(det) > 0.000001f))
+	{
+		return false;
+	}
+
 	float oneOverDet = 1.0f / det;
-    
+
 	Matrix4X3 tm;
-    
+
 	tm.m11 = (m.m22*m.m33 - m.m23*m.m32) * oneOverDet;
 	tm.m12 = (m.m13*m.m32 - m.m12*m.m33) * oneOverDet;
 	tm.m13 = (m.m12*m.m23 - m.m13*m.m22) * oneOverDet;
@@ -640,8 +705,10 @@ Matrix4X3 Inverse(const Matrix4X3 &m)
 	tm.tx = -(m.tx*tm.m11 + m.ty*tm.m21 + m.tz*tm.m31);
 	tm.ty = -(m.tx*tm.m12 + m.ty*tm.m22 + m.tz*tm.m32);
 	tm.tz = -(m.tx*tm.m13 + m.ty*tm.m23 + m.tz*tm.m33);
+
+	out = tm;
     
-	return tm;
+	return true;
 }
 
 // GetTranslation
@@ -19,15 +19,38 @@ class RotationMatrix;
 
 typedef Vector3D Point3D;
 #include <fstream>
+#include <type_traits>
 using namespace std;
 
 class Matrix4X3
 {
 public:
     
+	// 默认为单位矩阵
+    
+	constexpr Matrix4X3()
+		: m11(1.0f), m12(0.0f), m13(0.0f)
+		, m21(0.0f), m22(1.0f), m23(0.0f)
+		, m31(0.0f), m32(0.0f), m33(1.0f)
+		, tx(0.0f), ty(0.0f), tz(0.0f)
+	{
+	}
+    
+	// 按行给出旋转部分与平移部分
+    
+	constexpr Matrix4X3(float _m11, float _m12, float _m13,
+						float _m21, float _m22, float _m23,
+						float _m31, float _m32, float _m33,
+						float _tx, float _ty, float _tz)
+		: m11(_m11), m12(_m12), m13(_m13)
+		, m21(_m21), m22(_m22), m23(_m23)
+		, m31(_m31), m32(_m32), m33(_m33)
+		, tx(_tx), ty(_ty), tz(_tz)
+	{
+	}
+    
 	// 重置矩阵
     
-	Matrix4X3();
     
 	void Reset();
     
@@ -112,6 +135,9 @@ public:
 	float tx, ty, tz;
 };
 
+static_assert(std::is_trivially_copyable<Matrix4X3>::value, "Matrix4X3 must stay trivially copyable");
+static_assert(std::is_standard_layout<Matrix4X3>::value, "Matrix4X3 must stay standard layout");
+
 // 重载操作符*和*= 用于执行点与矩阵的叉乘以及矩阵之间的叉乘
 
 extern Point3D operator *(const Point3D &p, const Matrix4X3 &m);
@@ -128,10 +154,29 @@ extern Matrix4X3 &operator *=(Matrix4X3 &a, const Matrix4X3 &b);
 
 extern float Determinant(const Matrix4X3 &m);
 
+// 判断旋转部分是否为正交矩阵（各行为单位向量且两两垂直）
+// tolerance 为点积允许的误差
+
+extern bool IsOrthonormal(const Matrix4X3 &m, float tolerance = 1e-5f);
+
 // 计算矩阵的逆
+// 旋转部分正交时自动走 InverseRigid，否则走 InverseAffine
 
 extern Matrix4X3 Inverse(const Matrix4X3 &m);
 
+// 刚体变换（旋转+平移）的逆，旋转部分直接转置
+// 调用者保证旋转部分正交
+
+extern Matrix4X3 InverseRigid(const Matrix4X3 &m);
+
+// 一般仿射变换的逆，用伴随矩阵除以行列式，矩阵奇异时断言
+
+extern Matrix4X3 InverseAffine(const Matrix4X3 &m);
+
+// 不断言的求逆，矩阵奇异时返回false且不修改out
+
+extern bool TryInverse(const Matrix4X3 &m, Matrix4X3 &out);
+
 // 取出矩阵中的变换部分
 
 extern Vector3D GetTranslation(const Matrix4X3 &m);
@@ -0,0 +1,541 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Matrix4X3Batch.cpp
+// func: 基于Matrix4X3的批量变换内核
+//
+///////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+#include "JobPool.h"
+#include "Matrix4X3Batch.h"
+#include "Matrix4X3.h"
+#include "Vector3D.h"
+#include "Vector3DSoA.h"
+#include "Simd.h"
+
+// 输出超过此点数时使用非临时存储，避免结果把输入挤出缓存
+
+static const size_t KSTREAMTHRESHOLD = 1 << 18;
+
+/////////////////////////////////////////////////
+//
+// 内部实现
+//
+/////////////////////////////////////////////////
+
+// TransformSoA
+//
+// translate为false时只做旋转部分，stream为true时输出用非临时存储
+
+template <bool translate, bool stream>
+static void TransformSoA(const Matrix4X3 &m,
+						 const float *inX, const float *inY, const float *inZ,
+						 float *outX, float *outY, float *outZ, size_t n)
+{
+	SimdFloat m11 = SimdSet1(m.m11), m12 = SimdSet1(m.m12), m13 = SimdSet1(m.m13);
+	SimdFloat m21 = SimdSet1(m.m21), m22 = SimdSet1(m.m22), m23 = SimdSet1(m.m23);
+	SimdFloat m31 = SimdSet1(m.m31), m32 = SimdSet1(m.m32), m33 = SimdSet1(m.m33);
+	SimdFloat tx = SimdSet1(translate ? m.tx : 0.0f);
+	SimdFloat ty = SimdSet1(translate ? m.ty : 0.0f);
+	SimdFloat tz = SimdSet1(translate ? m.tz : 0.0f);
+
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat px = SimdLoad(inX + i);
+		SimdFloat py = SimdLoad(inY + i);
+		SimdFloat pz = SimdLoad(inZ + i);
+
+		SimdFloat rx = SimdMulAdd(pz, m31, SimdMulAdd(py, m21, SimdMulAdd(px, m11, tx)));
+		SimdFloat ry = SimdMulAdd(pz, m32, SimdMulAdd(py, m22, SimdMulAdd(px, m12, ty)));
+		SimdFloat rz = SimdMulAdd(pz, m33, SimdMulAdd(py, m23, SimdMulAdd(px, m13, tz)));
+
+		if (stream)
+		{
+			SimdStream(outX + i, rx);
+			SimdStream(outY + i, ry);
+			SimdStream(outZ + i, rz);
+		}
+		else
+		{
+			SimdStore(outX + i, rx);
+			SimdStore(outY + i, ry);
+			SimdStore(outZ + i, rz);
+		}
+	}
+
+	// 尾部逐个处理
+
+	for (; i < n; i++)
+	{
+		float px = inX[i], py = inY[i], pz = inZ[i];
+
+		outX[i] = px*m.m11 + py*m.m21 + pz*m.m31 + (translate ? m.tx : 0.0f);
+		outY[i] = px*m.m12 + py*m.m22 + pz*m.m32 + (translate ? m.ty : 0.0f);
+		outZ[i] = px*m.m13 + py*m.m23 + pz*m.m33 + (translate ? m.tz : 0.0f);
+	}
+
+	if (stream)
+	{
+		SimdFence();
+	}
+}
+
+// 大批量、非原地、输出对齐时才值得走非临时存储
+
+static bool UseStreamingStores(const float *inX, const float *outX, const float *outY, const float *outZ, size_t n)
+{
+	return n >= KSTREAMTHRESHOLD && inX != outX &&
+		   SimdIsAligned(outX, KSIMDWIDTH * sizeof(float)) &&
+		   SimdIsAligned(outY, KSIMDWIDTH * sizeof(float)) &&
+		   SimdIsAligned(outZ, KSIMDWIDTH * sizeof(float));
+}
+
+// TransformSoABlocks
+//
+// 是否走非临时存储按整批判断，分块后各块使用同一种存储方式
+
+template <bool translate>
+static void TransformSoABlocks(const Matrix4X3 &m,
+							   const float *inX, const float *inY, const float *inZ,
+							   float *outX, float *outY, float *outZ, size_t n, JobPool *pool)
+{
+	bool stream = UseStreamingStores(inX, outX, outY, outZ, n);
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		if (stream)
+		{
+			TransformSoA<translate, true>(m, inX + begin, inY + begin, inZ + begin,
+										  outX + begin, outY + begin, outZ + begin, end - begin);
+		}
+		else
+		{
+			TransformSoA<translate, false>(m, inX + begin, inY + begin, inZ + begin,
+										   outX + begin, outY + begin, outZ + begin, end - begin);
+		}
+	});
+}
+
+/////////////////////////////////////////////////
+//
+// 非成员函数
+//
+/////////////////////////////////////////////////
+
+void TransformPointsSoA(const Matrix4X3 &m,
+						const float *inX, const float *inY, const float *inZ,
+						float *outX, float *outY, float *outZ, size_t n, JobPool *pool)
+{
+	TransformSoABlocks<true>(m, inX, inY, inZ, outX, outY, outZ, n, pool);
+}
+
+void TransformDirectionsSoA(const Matrix4X3 &m,
+							const float *inX, const float *inY, const float *inZ,
+							float *outX, float *outY, float *outZ, size_t n, JobPool *pool)
+{
+	TransformSoABlocks<false>(m, inX, inY, inZ, outX, outY, outZ, n, pool);
+}
+
+void TransformPoints(const Matrix4X3 &m, const Point3DSoA &in, Point3DSoA &out, size_t n, JobPool *pool)
+{
+	assert(n <= in.Size());
+
+	if (out.Size() < n)
+	{
+		out.Resize(n);
+	}
+
+	TransformPointsSoA(m, in.x, in.y, in.z, out.x, out.y, out.z, n, pool);
+}
+
+void TransformPointsInPlace(const Matrix4X3 &m, Point3DSoA &p, size_t n, JobPool *pool)
+{
+	assert(n <= p.Size());
+
+	TransformPointsSoA(m, p.x, p.y, p.z, p.x, p.y, p.z, n, pool);
+}
+
+void TransformDirections(const Matrix4X3 &m, const Vector3DSoA &in, Vector3DSoA &out, size_t n, JobPool *pool)
+{
+	assert(n <= in.Size());
+
+	if (out.Size() < n)
+	{
+		out.Resize(n);
+	}
+
+	TransformDirectionsSoA(m, in.x, in.y, in.z, out.x, out.y, out.z, n, pool);
+}
+
+void TransformDirectionsInPlace(const Matrix4X3 &m, Vector3DSoA &v, size_t n, JobPool *pool)
+{
+	assert(n <= v.Size());
+
+	TransformDirectionsSoA(m, v.x, v.y, v.z, v.x, v.y, v.z, n, pool);
+}
+
+void TransformPoints(const Matrix4X3 &m, const Point3D *in, Point3D *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			float px = in[i].x, py = in[i].y, pz = in[i].z;
+
+			out[i].x = px*m.m11 + py*m.m21 + pz*m.m31 + m.tx;
+			out[i].y = px*m.m12 + py*m.m22 + pz*m.m32 + m.ty;
+			out[i].z = px*m.m13 + py*m.m23 + pz*m.m33 + m.tz;
+		}
+	});
+}
+
+void TransformDirections(const Matrix4X3 &m, const Vector3D *in, Vector3D *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			float px = in[i].x, py = in[i].y, pz = in[i].z;
+
+			out[i].x = px*m.m11 + py*m.m21 + pz*m.m31;
+			out[i].y = px*m.m12 + py*m.m22 + pz*m.m32;
+			out[i].z = px*m.m13 + py*m.m23 + pz*m.m33;
+		}
+	});
+}
+
+/////////////////////////////////////////////////
+//
+// 批量求逆
+//
+/////////////////////////////////////////////////
+
+// 按12个float的步长跨矩阵载入
+
+static_assert(sizeof(Matrix4X3) == 12 * sizeof(float), "Matrix4X3 must be twelve packed floats");
+
+// 一组矩阵按元素拆成通道
+
+struct MatrixLanes
+{
+	SimdFloat m11, m12, m13;
+	SimdFloat m21, m22, m23;
+	SimdFloat m31, m32, m33;
+	SimdFloat tx, ty, tz;
+};
+
+static void LoadMatrixLanes(const float *p, MatrixLanes &l)
+{
+	SimdLoadStrided4(p, 12, l.m11, l.m12, l.m13, l.m21);
+	SimdLoadStrided4(p + 4, 12, l.m22, l.m23, l.m31, l.m32);
+	SimdLoadStrided4(p + 8, 12, l.m33, l.tx, l.ty, l.tz);
+}
+
+static void LoadMatrixLanes(const Matrix4X3 *m, MatrixLanes &l)
+{
+	LoadMatrixLanes(&m->m11, l);
+}
+
+static void StoreMatrixLanes(Matrix4X3 *m, const MatrixLanes &l)
+{
+	float *p = &m->m11;
+
+	SimdStoreStrided4(p, 12, l.m11, l.m12, l.m13, l.m21);
+	SimdStoreStrided4(p + 4, 12, l.m22, l.m23, l.m31, l.m32);
+	SimdStoreStrided4(p + 8, 12, l.m33, l.tx, l.ty, l.tz);
+}
+
+static SimdFloat Dot3(SimdFloat a1, SimdFloat a2, SimdFloat a3, SimdFloat b1, SimdFloat b2, SimdFloat b3)
+{
+	return SimdMulAdd(a3, b3, SimdMulAdd(a2, b2, SimdMul(a1, b1)));
+}
+
+// 与 IsOrthonormal 相同的检查，返回各通道的结果
+
+static SimdMask OrthonormalMask(const MatrixLanes &m)
+{
+	SimdFloat one = SimdSet1(1.0f);
+	SimdFloat tol = SimdSet1(1e-5f);
+
+	SimdFloat d11 = SimdAbs(SimdSub(Dot3(m.m11, m.m12, m.m13, m.m11, m.m12, m.m13), one));
+	SimdFloat d22 = SimdAbs(SimdSub(Dot3(m.m21, m.m22, m.m23, m.m21, m.m22, m.m23), one));
+	SimdFloat d33 = SimdAbs(SimdSub(Dot3(m.m31, m.m32, m.m33, m.m31, m.m32, m.m33), one));
+	SimdFloat d12 = SimdAbs(Dot3(m.m11, m.m12, m.m13, m.m21, m.m22, m.m23));
+	SimdFloat d13 = SimdAbs(Dot3(m.m11, m.m12, m.m13, m.m31, m.m32, m.m33));
+	SimdFloat d23 = SimdAbs(Dot3(m.m21, m.m22, m.m23, m.m31, m.m32, m.m33));
+
+	SimdFloat worst = SimdMax(SimdMax(SimdMax(d11, d22), SimdMax(d33, d12)), SimdMax(d13, d23));
+	return SimdCmpLe(worst, tol);
+}
+
+// 转置旋转部分，平移为 -t * R的转置
+
+static void InverseRigidLanes(const MatrixLanes &m, MatrixLanes &r)
+{
+	SimdFloat neg = SimdSet1(-0.0f);
+
+	r.m11 = m.m11; r.m12 = m.m21; r.m13 = m.m31;
+	r.m21 = m.m12; r.m22 = m.m22; r.m23 = m.m32;
+	r.m31 = m.m13; r.m32 = m.m23; r.m33 = m.m33;
+
+	r.tx = SimdXor(Dot3(m.tx, m.ty, m.tz, m.m11, m.m12, m.m13), neg);
+	r.ty = SimdXor(Dot3(m.tx, m.ty, m.tz, m.m21, m.m22, m.m23), neg);
+	r.tz = SimdXor(Dot3(m.tx, m.ty, m.tz, m.m31, m.m32, m.m33), neg);
+}
+
+// 伴随矩阵除以行列式，返回奇异通道的掩码，奇异通道结果为单位矩阵
+
+static SimdMask InverseAffineLanes(const MatrixLanes &m, MatrixLanes &r)
+{
+	SimdFloat c11 = SimdNegMulAdd(m.m23, m.m32, SimdMul(m.m22, m.m33));
+	SimdFloat c12 = SimdNegMulAdd(m.m12, m.m33, SimdMul(m.m13, m.m32));
+	SimdFloat c13 = SimdNegMulAdd(m.m13, m.m22, SimdMul(m.m12, m.m23));
+
+	SimdFloat c21 = SimdNegMulAdd(m.m21, m.m33, SimdMul(m.m23, m.m31));
+	SimdFloat c22 = SimdNegMulAdd(m.m13, m.m31, SimdMul(m.m11, m.m33));
+	SimdFloat c23 = SimdNegMulAdd(m.m11, m.m23, SimdMul(m.m13, m.m21));
+
+	SimdFloat c31 = SimdNegMulAdd(m.m22, m.m31, SimdMul(m.m21, m.m32));
+	SimdFloat c32 = SimdNegMulAdd(m.m11, m.m32, SimdMul(m.m12, m.m31));
+	SimdFloat c33 = SimdNegMulAdd(m.m12, m.m21, SimdMul(m.m11, m.m22));
+
+	// 行列式按第一列展开，与 Determinant 相同
+
+	SimdFloat det = Dot3(m.m11, m.m12, m.m13, c11, c21, c31);
+
+	// 用 !(|det| > eps) 使NaN也算作奇异
+
+	SimdMask valid = SimdCmpGt(SimdAbs(det), SimdSet1(0.000001f));
+	SimdFloat oneOverDet = SimdDiv(SimdSet1(1.0f), SimdSelect(valid, det, SimdSet1(1.0f)));
+
+	SimdFloat one = SimdSet1(1.0f);
+	SimdFloat zero = SimdZero();
+
+	r.m11 = SimdSelect(valid, SimdMul(c11, oneOverDet), one);
+	r.m12 = SimdSelect(valid, SimdMul(c12, oneOverDet), zero);
+	r.m13 = SimdSelect(valid, SimdMul(c13, oneOverDet), zero);
+	r.m21 = SimdSelect(valid, SimdMul(c21, oneOverDet), zero);
+	r.m22 = SimdSelect(valid, SimdMul(c22, oneOverDet), one);
+	r.m23 = SimdSelect(valid, SimdMul(c23, oneOverDet), zero);
+	r.m31 = SimdSelect(valid, SimdMul(c31, oneOverDet), zero);
+	r.m32 = SimdSelect(valid, SimdMul(c32, oneOverDet), zero);
+	r.m33 = SimdSelect(valid, SimdMul(c33, oneOverDet), one);
+
+	SimdFloat neg = SimdSet1(-0.0f);
+
+	r.tx = SimdXor(Dot3(m.tx, m.ty, m.tz, r.m11, r.m21, r.m31), neg);
+	r.ty = SimdXor(Dot3(m.tx, m.ty, m.tz, r.m12, r.m22, r.m32), neg);
+	r.tz = SimdXor(Dot3(m.tx, m.ty, m.tz, r.m13, r.m23, r.m33), neg);
+
+	r.tx = SimdSelect(valid, r.tx, zero);
+	r.ty = SimdSelect(valid, r.ty, zero);
+	r.tz = SimdSelect(valid, r.tz, zero);
+
+	return valid;
+}
+
+static size_t InverseRange(const Matrix4X3 *m, Matrix4X3 *out, size_t n, bool *singular)
+{
+	const int allLanes = (1 << KSIMDWIDTH) - 1;
+
+	size_t singularCount = 0;
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		MatrixLanes in, r;
+		LoadMatrixLanes(m + i, in);
+
+		// 整组都正交时只需转置
+
+		int validBits = allLanes;
+
+		if (SimdMaskBits(OrthonormalMask(in)) == allLanes)
+		{
+			InverseRigidLanes(in, r);
+		}
+		else
+		{
+			validBits = SimdMaskBits(InverseAffineLanes(in, r));
+		}
+
+		StoreMatrixLanes(out + i, r);
+
+		for (size_t k = 0; k < KSIMDWIDTH; k++)
+		{
+			bool bad = (validBits & (1 << k)) == 0;
+
+			singularCount += bad ? 1 : 0;
+
+			if (singular != NULL)
+			{
+				singular[i + k] = bad;
+			}
+		}
+	}
+
+	// 尾部逐个处理
+
+	for (; i < n; i++)
+	{
+		bool bad = false;
+
+		if (IsOrthonormal(m[i]))
+		{
+			out[i] = InverseRigid(m[i]);
+		}
+		else if (!TryInverse(m[i], out[i]))
+		{
+			out[i].Reset();
+			bad = true;
+		}
+
+		singularCount += bad ? 1 : 0;
+
+		if (singular != NULL)
+		{
+			singular[i] = bad;
+		}
+	}
+
+	return singularCount;
+}
+
+static void InverseRigidRange(const Matrix4X3 *m, Matrix4X3 *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		MatrixLanes in, r;
+		LoadMatrixLanes(m + i, in);
+		InverseRigidLanes(in, r);
+		StoreMatrixLanes(out + i, r);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = InverseRigid(m[i]);
+	}
+}
+
+size_t InverseN(const Matrix4X3 *m, Matrix4X3 *out, size_t n, bool *singular, JobPool *pool)
+{
+	std::atomic<size_t> singularCount(0);
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		size_t count = InverseRange(m + begin, out + begin, end - begin, singular != NULL ? singular + begin : NULL);
+		singularCount.fetch_add(count, std::memory_order_relaxed);
+	});
+
+	return singularCount.load();
+}
+
+void InverseRigidN(const Matrix4X3 *m, Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		InverseRigidRange(m + begin, out + begin, end - begin);
+	});
+}
+
+/////////////////////////////////////////////////
+//
+// 批量连接
+//
+/////////////////////////////////////////////////
+
+// 与 operator *(const Matrix4X3 &, const Matrix4X3 &) 相同的展开
+
+static void ConcatenateLanes(const MatrixLanes &a, const MatrixLanes &b, MatrixLanes &r)
+{
+	r.m11 = Dot3(a.m11, a.m12, a.m13, b.m11, b.m21, b.m31);
+	r.m12 = Dot3(a.m11, a.m12, a.m13, b.m12, b.m22, b.m32);
+	r.m13 = Dot3(a.m11, a.m12, a.m13, b.m13, b.m23, b.m33);
+
+	r.m21 = Dot3(a.m21, a.m22, a.m23, b.m11, b.m21, b.m31);
+	r.m22 = Dot3(a.m21, a.m22, a.m23, b.m12, b.m22, b.m32);
+	r.m23 = Dot3(a.m21, a.m22, a.m23, b.m13, b.m23, b.m33);
+
+	r.m31 = Dot3(a.m31, a.m32, a.m33, b.m11, b.m21, b.m31);
+	r.m32 = Dot3(a.m31, a.m32, a.m33, b.m12, b.m22, b.m32);
+	r.m33 = Dot3(a.m31, a.m32, a.m33, b.m13, b.m23, b.m33);
+
+	r.tx = SimdAdd(Dot3(a.tx, a.ty, a.tz, b.m11, b.m21, b.m31), b.tx);
+	r.ty = SimdAdd(Dot3(a.tx, a.ty, a.tz, b.m12, b.m22, b.m32), b.ty);
+	r.tz = SimdAdd(Dot3(a.tx, a.ty, a.tz, b.m13, b.m23, b.m33), b.tz);
+}
+
+static void ConcatenateRange(const Matrix4X3 *a, const Matrix4X3 *b, Matrix4X3 *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		MatrixLanes la, lb, r;
+		LoadMatrixLanes(a + i, la);
+		LoadMatrixLanes(b + i, lb);
+		ConcatenateLanes(la, lb, r);
+		StoreMatrixLanes(out + i, r);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = a[i] * b[i];
+	}
+}
+
+static void ConcatenateIndexedRange(const Matrix4X3 *local, const Matrix4X3 *world, const int *parent,
+									Matrix4X3 *out, size_t n)
+{
+	size_t i = 0;
+
+	// 没有SIMD时拷贝到缓冲区并不划算，全部交给下面的逐个连接
+
+	for (; KSIMDWIDTH > 1 && i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		// 父矩阵分散在上一层中，先拷到连续的缓冲区再按通道载入
+		// 同一层的兄弟节点通常共享父节点，缓冲区的读取多半命中L1
+
+		float gathered[KSIMDWIDTH * 12];
+
+		for (size_t k = 0; k < KSIMDWIDTH; k++)
+		{
+			memcpy(gathered + k * 12, &world[parent[i + k]], sizeof(Matrix4X3));
+		}
+
+		MatrixLanes la, lb, r;
+		LoadMatrixLanes(local + i, la);
+		LoadMatrixLanes(gathered, lb);
+		ConcatenateLanes(la, lb, r);
+		StoreMatrixLanes(out + i, r);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = local[i] * world[parent[i]];
+	}
+}
+
+void ConcatenateN(const Matrix4X3 *a, const Matrix4X3 *b, Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		ConcatenateRange(a + begin, b + begin, out + begin, end - begin);
+	});
+}
+
+void ConcatenateIndexedN(const Matrix4X3 *local, const Matrix4X3 *world, const int *parent,
+						 Matrix4X3 *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		ConcatenateIndexedRange(local + begin, world, parent + begin, out + begin, end - begin);
+	});
+}
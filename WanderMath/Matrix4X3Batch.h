@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Matrix4X3Batch.h
+// func: 基于Matrix4X3的批量变换内核
+// disc: 与 operator *(const Point3D &, const Matrix4X3 &) 结果一致，
+//		 但整批在一个函数内完成，SoA输入按SIMD宽度处理
+//		 pool 不为NULL时按 KJOBBATCHGRAIN 分块并行，结果与串行相同
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class Vector3D;
+class Vector3DSoA;
+class Matrix4X3;
+class JobPool;
+
+typedef Vector3D Point3D;
+typedef Vector3DSoA Point3DSoA;
+
+// 变换点 p' = p * m，包含平移
+// out的元素个数不足n时会自动扩充
+
+extern void TransformPoints(const Matrix4X3 &m, const Point3DSoA &in, Point3DSoA &out, size_t n, JobPool *pool = NULL);
+extern void TransformPointsInPlace(const Matrix4X3 &m, Point3DSoA &p, size_t n, JobPool *pool = NULL);
+
+// 变换方向向量，只用旋转部分，忽略平移
+
+extern void TransformDirections(const Matrix4X3 &m, const Vector3DSoA &in, Vector3DSoA &out, size_t n, JobPool *pool = NULL);
+extern void TransformDirectionsInPlace(const Matrix4X3 &m, Vector3DSoA &v, size_t n, JobPool *pool = NULL);
+
+// 直接作用于三条float流，输入输出可以是同一组指针
+
+extern void TransformPointsSoA(const Matrix4X3 &m,
+							   const float *inX, const float *inY, const float *inZ,
+							   float *outX, float *outY, float *outZ, size_t n, JobPool *pool = NULL);
+extern void TransformDirectionsSoA(const Matrix4X3 &m,
+								   const float *inX, const float *inY, const float *inZ,
+								   float *outX, float *outY, float *outZ, size_t n, JobPool *pool = NULL);
+
+// 批量求逆，每组矩阵全部正交时走转置的快速路径，否则用伴随矩阵
+// 不断言：奇异矩阵的结果置为单位矩阵，singular非空时逐个标记，返回奇异矩阵的个数
+// out 可以与 m 相同
+
+extern size_t InverseN(const Matrix4X3 *m, Matrix4X3 *out, size_t n, bool *singular = NULL, JobPool *pool = NULL);
+
+// 批量求刚体变换的逆，调用者保证旋转部分正交
+
+extern void InverseRigidN(const Matrix4X3 *m, Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+
+// 批量连接 out[i] = a[i] * b[i]，out 可以与 a 或 b 相同
+
+extern void ConcatenateN(const Matrix4X3 *a, const Matrix4X3 *b, Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+
+// 按父节点下标连接 out[i] = local[i] * world[parent[i]]，用于逐层计算世界矩阵
+// out 不能与被引用的 world 元素重叠
+
+extern void ConcatenateIndexedN(const Matrix4X3 *local, const Matrix4X3 *world, const int *parent,
+								Matrix4X3 *out, size_t n, JobPool *pool = NULL);
+
+// 数组结构(AoS)版本，省去逐点的跨编译单元调用
+
+extern void TransformPoints(const Matrix4X3 &m, const Point3D *in, Point3D *out, size_t n, JobPool *pool = NULL);
+extern void TransformDirections(const Matrix4X3 &m, const Vector3D *in, Vector3D *out, size_t n, JobPool *pool = NULL);
@@ -0,0 +1,383 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Matrix4X4.cpp
+// func: 4X4矩阵的实现
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+
+#include "Matrix4X4.h"
+#include "Matrix4X3.h"
+#include "Vector4D.h"
+
+// 行列式绝对值小于此值时视为奇异，与 Matrix4X3 相同
+
+static const float KSINGULAREPSILON = 0.000001f;
+
+#if defined(WANDER_SIMD_SSE)
+
+/////////////////////////////////////////////////
+//
+// SSE辅助函数
+//
+/////////////////////////////////////////////////
+
+// 选出寄存器中的一个通道并广播
+
+#define WANDER_SPLAT(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+// 一行乘以矩阵 r = v.x*b0 + v.y*b1 + v.z*b2 + v.w*b3，两两相加缩短依赖链
+
+static inline __m128 RowMultiply(__m128 v, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+{
+	__m128 r01 = _mm_add_ps(_mm_mul_ps(WANDER_SPLAT(v, 0), b0), _mm_mul_ps(WANDER_SPLAT(v, 1), b1));
+	__m128 r23 = _mm_add_ps(_mm_mul_ps(WANDER_SPLAT(v, 2), b2), _mm_mul_ps(WANDER_SPLAT(v, 3), b3));
+	return _mm_add_ps(r01, r23);
+}
+
+// 2X2矩阵按 (m11, m12, m21, m22) 存放在一个寄存器中
+// A * B
+
+static inline __m128 Mat2Mul(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+					  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+								 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// A的伴随矩阵 * B
+
+static inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+					  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+								 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+// A * B的伴随矩阵
+
+static inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+					  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+								 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+#endif
+
+/////////////////////////////////////////////////
+//
+// Matrix4X4类成员
+//
+/////////////////////////////////////////////////
+
+void Matrix4X4::Reset()
+{
+	m11 = 1.0f; m12 = 0.0f; m13 = 0.0f; m14 = 0.0f;
+	m21 = 0.0f; m22 = 1.0f; m23 = 0.0f; m24 = 0.0f;
+	m31 = 0.0f; m32 = 0.0f; m33 = 1.0f; m34 = 0.0f;
+	tx  = 0.0f; ty  = 0.0f; tz  = 0.0f; tw  = 1.0f;
+}
+
+void Matrix4X4::FromMatrix4X3(const Matrix4X3 &m)
+{
+	m11 = m.m11; m12 = m.m12; m13 = m.m13; m14 = 0.0f;
+	m21 = m.m21; m22 = m.m22; m23 = m.m23; m24 = 0.0f;
+	m31 = m.m31; m32 = m.m32; m33 = m.m33; m34 = 0.0f;
+	tx  = m.tx;  ty  = m.ty;  tz  = m.tz;  tw  = 1.0f;
+}
+
+// Matrix4X4::SetupPerspectiveFov
+//
+// x' = x * xScale，y' = y * yScale，w' = z，
+// z' 在近平面为0、远平面为w'
+
+void Matrix4X4::SetupPerspectiveFov(float fovY, float aspect, float zNear, float zFar)
+{
+	assert(aspect > 0.0f && zNear > 0.0f && zFar > zNear);
+
+	float yScale = 1.0f / tanf(fovY * 0.5f);
+	float xScale = yScale / aspect;
+	float zScale = zFar / (zFar - zNear);
+
+	m11 = xScale; m12 = 0.0f;   m13 = 0.0f;            m14 = 0.0f;
+	m21 = 0.0f;   m22 = yScale; m23 = 0.0f;            m24 = 0.0f;
+	m31 = 0.0f;   m32 = 0.0f;   m33 = zScale;          m34 = 1.0f;
+	tx  = 0.0f;   ty  = 0.0f;   tz  = -zNear * zScale; tw  = 0.0f;
+}
+
+void Matrix4X4::SetupOrthographic(float width, float height, float zNear, float zFar)
+{
+	float halfWidth = width * 0.5f;
+	float halfHeight = height * 0.5f;
+
+	SetupOrthographicOffCenter(-halfWidth, halfWidth, -halfHeight, halfHeight, zNear, zFar);
+}
+
+void Matrix4X4::SetupOrthographicOffCenter(float left, float right, float bottom, float top,
+										   float zNear, float zFar)
+{
+	assert(right != left && top != bottom && zFar != zNear);
+
+	float oneOverWidth = 1.0f / (right - left);
+	float oneOverHeight = 1.0f / (top - bottom);
+	float oneOverDepth = 1.0f / (zFar - zNear);
+
+	m11 = 2.0f * oneOverWidth; m12 = 0.0f; m13 = 0.0f; m14 = 0.0f;
+	m21 = 0.0f; m22 = 2.0f * oneOverHeight; m23 = 0.0f; m24 = 0.0f;
+	m31 = 0.0f; m32 = 0.0f; m33 = oneOverDepth; m34 = 0.0f;
+
+	tx = -(left + right) * oneOverWidth;
+	ty = -(top + bottom) * oneOverHeight;
+	tz = -zNear * oneOverDepth;
+	tw = 1.0f;
+}
+
+/////////////////////////////////////////////////
+//
+// 非成员函数
+//
+/////////////////////////////////////////////////
+
+Vector4D operator *(const Vector4D &p, const Matrix4X4 &m)
+{
+#if defined(WANDER_SIMD_SSE)
+	__m128 r = RowMultiply(_mm_loadu_ps(&p.x), _mm_load_ps(&m.m11), _mm_load_ps(&m.m21),
+						   _mm_load_ps(&m.m31), _mm_load_ps(&m.tx));
+
+	Vector4D ret;
+	_mm_storeu_ps(&ret.x, r);
+	return ret;
+#else
+	return Vector4D(p.x*m.m11 + p.y*m.m21 + p.z*m.m31 + p.w*m.tx,
+					p.x*m.m12 + p.y*m.m22 + p.z*m.m32 + p.w*m.ty,
+					p.x*m.m13 + p.y*m.m23 + p.z*m.m33 + p.w*m.tz,
+					p.x*m.m14 + p.y*m.m24 + p.z*m.m34 + p.w*m.tw);
+#endif
+}
+
+Matrix4X4 operator *(const Matrix4X4 &a, const Matrix4X4 &b)
+{
+	Matrix4X4 tm;
+
+#if defined(WANDER_SIMD_SSE)
+	__m128 b0 = _mm_load_ps(&b.m11);
+	__m128 b1 = _mm_load_ps(&b.m21);
+	__m128 b2 = _mm_load_ps(&b.m31);
+	__m128 b3 = _mm_load_ps(&b.tx);
+
+	_mm_store_ps(&tm.m11, RowMultiply(_mm_load_ps(&a.m11), b0, b1, b2, b3));
+	_mm_store_ps(&tm.m21, RowMultiply(_mm_load_ps(&a.m21), b0, b1, b2, b3));
+	_mm_store_ps(&tm.m31, RowMultiply(_mm_load_ps(&a.m31), b0, b1, b2, b3));
+	_mm_store_ps(&tm.tx, RowMultiply(_mm_load_ps(&a.tx), b0, b1, b2, b3));
+#else
+	const float *pa = &a.m11;
+	const float *pb = &b.m11;
+	float *pr = &tm.m11;
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			pr[i*4 + j] = pa[i*4]*pb[j] + pa[i*4 + 1]*pb[4 + j] + pa[i*4 + 2]*pb[8 + j] + pa[i*4 + 3]*pb[12 + j];
+		}
+	}
+#endif
+
+	return tm;
+}
+
+Matrix4X4 &operator *=(Matrix4X4 &a, const Matrix4X4 &b)
+{
+	a = a * b;
+
+	return a;
+}
+
+Matrix4X4 Transpose(const Matrix4X4 &m)
+{
+	Matrix4X4 tm;
+
+#if defined(WANDER_SIMD_SSE)
+	__m128 r0 = _mm_load_ps(&m.m11);
+	__m128 r1 = _mm_load_ps(&m.m21);
+	__m128 r2 = _mm_load_ps(&m.m31);
+	__m128 r3 = _mm_load_ps(&m.tx);
+
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	_mm_store_ps(&tm.m11, r0);
+	_mm_store_ps(&tm.m21, r1);
+	_mm_store_ps(&tm.m31, r2);
+	_mm_store_ps(&tm.tx, r3);
+#else
+	const float *pm = &m.m11;
+	float *pr = &tm.m11;
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			pr[i*4 + j] = pm[j*4 + i];
+		}
+	}
+#endif
+
+	return tm;
+}
+
+// Determinant
+//
+// 用前两行与后两行的2X2子式展开（拉普拉斯展开）
+
+float Determinant(const Matrix4X4 &m)
+{
+	float s0 = m.m11*m.m22 - m.m21*m.m12;
+	float s1 = m.m11*m.m23 - m.m21*m.m13;
+	float s2 = m.m11*m.m24 - m.m21*m.m14;
+	float s3 = m.m12*m.m23 - m.m22*m.m13;
+	float s4 = m.m12*m.m24 - m.m22*m.m14;
+	float s5 = m.m13*m.m24 - m.m23*m.m14;
+
+	float c0 = m.m31*m.ty - m.tx*m.m32;
+	float c1 = m.m31*m.tz - m.tx*m.m33;
+	float c2 = m.m31*m.tw - m.tx*m.m34;
+	float c3 = m.m32*m.tz - m.ty*m.m33;
+	float c4 = m.m32*m.tw - m.ty*m.m34;
+	float c5 = m.m33*m.tw - m.tz*m.m34;
+
+	return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+}
+
+// TryInverse
+//
+// SSE下把矩阵分成四个2X2块 | A B |，用块矩阵求逆公式：
+//							 | C D |
+// |M| = |A||D| + |B||C| - tr((A#B)(D#C))，#表示伴随矩阵，
+// 各块的逆由2X2的乘法与伴随组合得到，全程不需要标量的余子式
+// 标量版本用与 Determinant 相同的2X2子式求伴随矩阵
+
+bool TryInverse(const Matrix4X4 &m, Matrix4X4 &out)
+{
+#if defined(WANDER_SIMD_SSE)
+	__m128 r0 = _mm_load_ps(&m.m11);
+	__m128 r1 = _mm_load_ps(&m.m21);
+	__m128 r2 = _mm_load_ps(&m.m31);
+	__m128 r3 = _mm_load_ps(&m.tx);
+
+	__m128 a = _mm_movelh_ps(r0, r1);
+	__m128 b = _mm_movehl_ps(r1, r0);
+	__m128 c = _mm_movelh_ps(r2, r3);
+	__m128 d = _mm_movehl_ps(r3, r2);
+
+	// 四个块的行列式 (|A|, |B|, |C|, |D|)
+
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+		_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+
+	__m128 detA = WANDER_SPLAT(detSub, 0);
+	__m128 detB = WANDER_SPLAT(detSub, 1);
+	__m128 detC = WANDER_SPLAT(detSub, 2);
+	__m128 detD = WANDER_SPLAT(detSub, 3);
+
+	__m128 dc = Mat2AdjMul(d, c);
+	__m128 ab = Mat2AdjMul(a, b);
+
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
+
+	// tr((A#B)(D#C))，两次洗牌相加代替SSE3的hadd
+
+	__m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+	tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+	tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+
+	__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+	// 用 !(|det| > eps) 使NaN也算作奇异
+
+	if (!(fabsf(_mm_cvtss_f32(det)) > KSINGULAREPSILON))
+	{
+		return false;
+	}
+
+	__m128 oneOverDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+
+	x = _mm_mul_ps(x, oneOverDet);
+	y = _mm_mul_ps(y, oneOverDet);
+	z = _mm_mul_ps(z, oneOverDet);
+	w = _mm_mul_ps(w, oneOverDet);
+
+	// 取伴随并按行写回
+
+	_mm_store_ps(&out.m11, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_store_ps(&out.m21, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+	_mm_store_ps(&out.m31, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_store_ps(&out.tx, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+
+	return true;
+#else
+	float s0 = m.m11*m.m22 - m.m21*m.m12;
+	float s1 = m.m11*m.m23 - m.m21*m.m13;
+	float s2 = m.m11*m.m24 - m.m21*m.m14;
+	float s3 = m.m12*m.m23 - m.m22*m.m13;
+	float s4 = m.m12*m.m24 - m.m22*m.m14;
+	float s5 = m.m13*m.m24 - m.m23*m.m14;
+
+	float c0 = m.m31*m.ty - m.tx*m.m32;
+	float c1 = m.m31*m.tz - m.tx*m.m33;
+	float c2 = m.m31*m.tw - m.tx*m.m34;
+	float c3 = m.m32*m.tz - m.ty*m.m33;
+	float c4 = m.m32*m.tw - m.ty*m.m34;
+	float c5 = m.m33*m.tw - m.tz*m.m34;
+
+	float det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+
+	if (!(fabsf(det) > KSINGULAREPSILON))
+	{
+		return false;
+	}
+
+	float oneOverDet = 1.0f / det;
+
+	out.m11 = ( m.m22*c5 - m.m23*c4 + m.m24*c3) * oneOverDet;
+	out.m12 = (-m.m12*c5 + m.m13*c4 - m.m14*c3) * oneOverDet;
+	out.m13 = ( m.ty*s5 - m.tz*s4 + m.tw*s3) * oneOverDet;
+	out.m14 = (-m.m32*s5 + m.m33*s4 - m.m34*s3) * oneOverDet;
+
+	out.m21 = (-m.m21*c5 + m.m23*c2 - m.m24*c1) * oneOverDet;
+	out.m22 = ( m.m11*c5 - m.m13*c2 + m.m14*c1) * oneOverDet;
+	out.m23 = (-m.tx*s5 + m.tz*s2 - m.tw*s1) * oneOverDet;
+	out.m24 = ( m.m31*s5 - m.m33*s2 + m.m34*s1) * oneOverDet;
+
+	out.m31 = ( m.m21*c4 - m.m22*c2 + m.m24*c0) * oneOverDet;
+	out.m32 = (-m.m11*c4 + m.m12*c2 - m.m14*c0) * oneOverDet;
+	out.m33 = ( m.tx*s4 - m.ty*s2 + m.tw*s0) * oneOverDet;
+	out.m34 = (-m.m31*s4 + m.m32*s2 - m.m34*s0) * oneOverDet;
+
+	out.tx = (-m.m21*c3 + m.m22*c1 - m.m23*c0) * oneOverDet;
+	out.ty = ( m.m11*c3 - m.m12*c1 + m.m13*c0) * oneOverDet;
+	out.tz = (-m.tx*s3 + m.ty*s1 - m.tz*s0) * oneOverDet;
+	out.tw = ( m.m31*s3 - m.m32*s1 + m.m33*s0) * oneOverDet;
+
+	return true;
+#endif
+}
+
+Matrix4X4 Inverse(const Matrix4X4 &m)
+{
+	Matrix4X4 r;
+	bool ok = TryInverse(m, r);
+
+	// 矩阵奇异时断言
+
+	assert(ok);
+	(void)ok;
+
+	return r;
+}
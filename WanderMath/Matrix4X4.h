@@ -3,6 +3,10 @@
 // name: Matrix4X3.h
 // func: 4X4矩阵的定义
 // date: 2010.10.6
+// disc: 与 Matrix4X3 相同采用行向量约定 p' = p * M，最后一行为平移；
+//		 投影矩阵为左手坐标系，裁剪空间 z 在 [0, w] 之间；
+//		 按16字节对齐，每一行正好是一个SSE寄存器，乘法、转置与求逆
+//		 在SSE下按行计算，定义 WANDER_NO_SIMD 时退化为标量版本
 //
 ///////////////////////////////////////////////////////////////////
 
@@ -11,20 +15,77 @@
 #ifndef MATRIX4X4_H
 #define MATRIX4X4_H
 
+#include "Simd.h"
 
-class Matrix4X4
+class Matrix4X3;
+class Vector4D;
+
+class WANDER_ALIGN(16) Matrix4X4
 {
 public:
-    
+
+	// 重置为单位矩阵
+
+	Matrix4X4()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	// 由4X3矩阵扩展，第四列为 (0, 0, 0, 1)
+
+	void FromMatrix4X3(const Matrix4X3 &m);
+
+	// 建立透视投影矩阵
+	// fovY 为竖直方向的视角（弧度），aspect 为宽高比，zNear/zFar 为近远平面的距离
+
+	void SetupPerspectiveFov(float fovY, float aspect, float zNear, float zFar);
+
+	// 建立正交投影矩阵，视景体以视线为中心
+
+	void SetupOrthographic(float width, float height, float zNear, float zFar);
+
+	// 建立正交投影矩阵，视景体由左右上下近远六个平面给出
+
+	void SetupOrthographicOffCenter(float left, float right, float bottom, float top,
+									float zNear, float zFar);
+
+public:
+
 	// 旋转部分
-    
+
 	float m11, m12, m13, m14;
 	float m21, m22, m23, m24;
 	float m31, m32, m33, m34;
-    
+
 	// 平移部分
-    
+
 	float tx, ty, tz, tw;
 };
 
+static_assert(sizeof(Matrix4X4) == 16 * sizeof(float), "Matrix4X4 must be sixteen packed floats");
+
+// 向量与矩阵相乘以及矩阵之间相乘
+
+extern Vector4D operator *(const Vector4D &p, const Matrix4X4 &m);
+extern Matrix4X4 operator *(const Matrix4X4 &a, const Matrix4X4 &b);
+extern Matrix4X4 &operator *=(Matrix4X4 &a, const Matrix4X4 &b);
+
+// 转置
+
+extern Matrix4X4 Transpose(const Matrix4X4 &m);
+
+// 计算行列式的值
+
+extern float Determinant(const Matrix4X4 &m);
+
+// 计算矩阵的逆，矩阵必须可逆
+
+extern Matrix4X4 Inverse(const Matrix4X4 &m);
+
+// 不断言的求逆：行列式接近零时返回false，out不被修改
+
+extern bool TryInverse(const Matrix4X4 &m, Matrix4X4 &out);
+
 #endif
\ No newline at end of file
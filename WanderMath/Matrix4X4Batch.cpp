@@ -0,0 +1,93 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Matrix4X4Batch.cpp
+// func: 基于Matrix4X4的批量裁剪空间变换
+//
+///////////////////////////////////////////////////////////////////
+
+#include "JobPool.h"
+#include "Matrix4X4Batch.h"
+#include "Matrix4X4.h"
+#include "Vector3D.h"
+#include "Vector4D.h"
+#include "Simd.h"
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D must be three packed floats");
+static_assert(sizeof(Vector4D) == 4 * sizeof(float), "Vector4D must be four packed floats");
+
+// TransformClip
+//
+// 每组按3个float的步长载入4个分量，第4个分量属于下一个点，不使用；
+// 因此最后一组必须留在尾部逐个处理，避免越过数组末尾读取
+
+template <bool divide>
+static void TransformClip(const Matrix4X4 &m, const Point3D *in, Vector4D *out, size_t n)
+{
+	SimdFloat m11 = SimdSet1(m.m11), m12 = SimdSet1(m.m12), m13 = SimdSet1(m.m13), m14 = SimdSet1(m.m14);
+	SimdFloat m21 = SimdSet1(m.m21), m22 = SimdSet1(m.m22), m23 = SimdSet1(m.m23), m24 = SimdSet1(m.m24);
+	SimdFloat m31 = SimdSet1(m.m31), m32 = SimdSet1(m.m32), m33 = SimdSet1(m.m33), m34 = SimdSet1(m.m34);
+	SimdFloat tx = SimdSet1(m.tx), ty = SimdSet1(m.ty), tz = SimdSet1(m.tz), tw = SimdSet1(m.tw);
+
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH < n; i += KSIMDWIDTH)
+	{
+		SimdFloat x, y, z, unused;
+		SimdLoadStrided4(&in[i].x, 3, x, y, z, unused);
+
+		SimdFloat cx = SimdMulAdd(z, m31, SimdMulAdd(y, m21, SimdMulAdd(x, m11, tx)));
+		SimdFloat cy = SimdMulAdd(z, m32, SimdMulAdd(y, m22, SimdMulAdd(x, m12, ty)));
+		SimdFloat cz = SimdMulAdd(z, m33, SimdMulAdd(y, m23, SimdMulAdd(x, m13, tz)));
+		SimdFloat cw = SimdMulAdd(z, m34, SimdMulAdd(y, m24, SimdMulAdd(x, m14, tw)));
+
+		if (divide)
+		{
+			SimdFloat oneOverW = SimdDiv(SimdSet1(1.0f), cw);
+
+			cx = SimdMul(cx, oneOverW);
+			cy = SimdMul(cy, oneOverW);
+			cz = SimdMul(cz, oneOverW);
+			cw = oneOverW;
+		}
+
+		SimdStoreStrided4(&out[i].x, 4, cx, cy, cz, cw);
+	}
+
+	for (; i < n; i++)
+	{
+		float x = in[i].x, y = in[i].y, z = in[i].z;
+
+		float cx = x*m.m11 + y*m.m21 + z*m.m31 + m.tx;
+		float cy = x*m.m12 + y*m.m22 + z*m.m32 + m.ty;
+		float cz = x*m.m13 + y*m.m23 + z*m.m33 + m.tz;
+		float cw = x*m.m14 + y*m.m24 + z*m.m34 + m.tw;
+
+		if (divide)
+		{
+			float oneOverW = 1.0f / cw;
+
+			cx *= oneOverW;
+			cy *= oneOverW;
+			cz *= oneOverW;
+			cw = oneOverW;
+		}
+
+		out[i].Init(cx, cy, cz, cw);
+	}
+}
+
+void TransformToClipN(const Matrix4X4 &m, const Point3D *in, Vector4D *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		TransformClip<false>(m, in + begin, out + begin, end - begin);
+	});
+}
+
+void ProjectPointsN(const Matrix4X4 &m, const Point3D *in, Vector4D *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		TransformClip<true>(m, in + begin, out + begin, end - begin);
+	});
+}
@@ -0,0 +1,30 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Matrix4X4Batch.h
+// func: 基于Matrix4X4的批量裁剪空间变换
+// disc: 输入为连续存放的 Vector3D 数组(w取1)，输出为连续存放的
+//		 Vector4D 数组，按SIMD宽度一次处理一组点
+//		 pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class Vector3D;
+class Vector4D;
+class Matrix4X4;
+class JobPool;
+
+typedef Vector3D Point3D;
+
+// 变换到裁剪空间 out = (p, 1) * m，不做透视除法
+
+extern void TransformToClipN(const Matrix4X4 &m, const Point3D *in, Vector4D *out, size_t n, JobPool *pool = NULL);
+
+// 变换到裁剪空间后立即做透视除法
+// 输出 (x/w, y/w, z/w, 1/w)，1/w 可用于透视校正插值，其符号与w相同，
+// 可据此剔除位于相机后方的点；w为零时结果为无穷大
+
+extern void ProjectPointsN(const Matrix4X4 &m, const Point3D *in, Vector4D *out, size_t n, JobPool *pool = NULL);
@@ -15,6 +15,32 @@ public:
 		}
 	}
     
+	// 用平面方程 ax + by + cz + d = 0 初始化，法向量被标准化
+	// p0 取平面上离原点最近的点
+    
+	void InitFromEquation(float a, float b, float c, float d)
+	{
+		float mag = sqrt(a*a + b*b + c*c);
+		assert(mag > 0.0f);
+		float magOver1 = 1.0f / mag;
+		v.Init(a * magOver1, b * magOver1, c * magOver1);
+		p0 = v * (-d * magOver1);
+	}
+    
+	// 法线-距离形式中的 d，即 n * p + d = 0
+    
+	float Distance() const
+	{
+		return -(v * p0);
+	}
+    
+	// 点到平面的有向距离，法向量为单位向量时为真实距离，在法向量一侧为正
+    
+	float SignedDistance(const Point3D &p) const
+	{
+		return v * p + Distance();
+	}
+    
 public:
 	Point3D p0;
 	Vector3D v;
@@ -14,10 +14,6 @@
 
 #include <assert.h>
 
-// 初始化全局变量gQuaternionIdentity
-
-const Quaternion gQuaternionIdentity = {1.0f, 0.0f, 0.0f, 0.0f};
-
 /////////////////////////////////////////////////////////////////////
 //
 // 成员函数
@@ -90,8 +86,8 @@ void Quaternion::SetRotateAxis(const Vector3D &axis, float theta)
     
 	w = cos(halfTheta);
 	x = axis.x * sinHalfTheta;
-	x = axis.y * sinHalfTheta;
-	x = axis.z * sinHalfTheta;
+	y = axis.y * sinHalfTheta;
+	z = axis.z * sinHalfTheta;
 }
 
 // Quaternion::SetRotateInertialToObject
@@ -319,6 +315,68 @@ Quaternion Slerp(const Quaternion &q0, const Quaternion &q1, float t)
 	return ret;
 }
 
+// FastSlerp 的插值参数修正系数
+// 第 m 行为 (t - 0.5)^2m 项的系数关于夹角余弦 d 的三次多项式，
+// 在 d ∈ [0, 1]、t ∈ [0, 1] 上按最大旋转角误差拟合
+
+const float gFastSlerpCoeff[3][4] =
+{
+	{ 0.859370211f, -1.14321689f, 0.397596831f, -0.116784147f },
+	{ 0.810219104f, -1.93840935f, 1.40575967f, -0.267917262f },
+	{ 1.2102495f, -5.01138485f, 7.3784745f, -3.70257109f },
+};
+
+// FastSlerp
+//
+// 线性插值后归一化（nlerp）的角速度不均匀，中间快两头慢，
+// 先把 t 修正为 t + t(t - 0.5)(t - 1) * K(t, d)，使 nlerp 的结果落在
+// Slerp 的位置上，K 为上面系数给出的多项式
+// 全程没有分支，t 截断到 [0, 1]
+
+Quaternion FastSlerp(const Quaternion &q0, const Quaternion &q1, float t)
+{
+	t = MIN(MAX(t, 0.0f), 1.0f);
+
+	// 点积为负时翻转q1，取短弧
+
+	float cosOmega = DotProduct(q0, q1);
+	float sign = copysignf(1.0f, cosOmega);
+	float d = fabsf(cosOmega);
+
+	const float (*c)[4] = gFastSlerpCoeff;
+
+	float k0 = c[0][0] + d * (c[0][1] + d * (c[0][2] + d * c[0][3]));
+	float k1 = c[1][0] + d * (c[1][1] + d * (c[1][2] + d * c[1][3]));
+	float k2 = c[2][0] + d * (c[2][1] + d * (c[2][2] + d * c[2][3]));
+
+	float h = t - 0.5f;
+	float u = h * h;
+	float k = k0 + u * (k1 + u * k2);
+
+	t = t + t * h * (t - 1.0f) * k;
+
+	float s0 = 1.0f - t;
+	float s1 = t * sign;
+
+	Quaternion ret;
+
+	ret.w = s0*q0.w + s1*q1.w;
+	ret.x = s0*q0.x + s1*q1.x;
+	ret.y = s0*q0.y + s1*q1.y;
+	ret.z = s0*q0.z + s1*q1.z;
+
+	// 翻转后两者夹角不超过90度，结果的模不小于 cos(45度)
+
+	float oneOverMag = 1.0f / sqrt(DotProduct(ret, ret));
+
+	ret.w *= oneOverMag;
+	ret.x *= oneOverMag;
+	ret.y *= oneOverMag;
+	ret.z *= oneOverMag;
+
+	return ret;
+}
+
 // Conjugate
 //
 // 对四元数进行取反操作
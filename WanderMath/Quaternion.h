@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 class Vector3D;
 class EulerAngles;
 
@@ -54,9 +56,12 @@ public:
 	float z;
 };
 
-// 全局声明
+static_assert(std::is_trivially_copyable<Quaternion>::value, "Quaternion must stay trivially copyable");
+static_assert(std::is_standard_layout<Quaternion>::value, "Quaternion must stay standard layout");
+
+// 单位四元数，编译期常量
 
-extern const Quaternion gQuaternionIdentity;
+constexpr Quaternion gQuaternionIdentity = {1.0f, 0.0f, 0.0f, 0.0f};
 
 // 点积
 
@@ -66,6 +71,18 @@ extern float DotProduct(const Quaternion &a, const Quaternion &b);
 
 extern Quaternion Slerp(const Quaternion &q0, const Quaternion &q1, float t);
 
+// 近似的圆弧线性插值，用修正过 t 的 nlerp 代替三角函数
+// 保持匀速，与 Slerp 的旋转角误差不超过 KFASTSLERPMAXERROR 弧度
+// 没有分支，结果与 Slerp 可能相差一个符号（表示同一旋转）
+
+const float KFASTSLERPMAXERROR = 1e-4f;
+
+extern Quaternion FastSlerp(const Quaternion &q0, const Quaternion &q1, float t);
+
+// FastSlerp 的 t 修正系数，批量版本共用
+
+extern const float gFastSlerpCoeff[3][4];
+
 // 取共轭数 表示相反的旋转
 
 extern Quaternion Conjugate(const Quaternion &q);
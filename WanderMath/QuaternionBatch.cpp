@@ -0,0 +1,186 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionBatch.cpp
+// func: 基于Quaternion的批量运算内核
+//
+///////////////////////////////////////////////////////////////////
+
+#include "JobPool.h"
+#include "QuaternionBatch.h"
+#include "Quaternion.h"
+#include "SimdMath.h"
+
+// Quaternion 的内存布局为 w, x, y, z 四个连续的float
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be four packed floats");
+
+// SlerpN
+//
+// 与 Slerp 相同的推导，各通道独立：
+// 1. 点积为负时翻转 q1，取短弧
+// 2. 夹角余弦大于0.9999时用线性插值，否则用 sin 的比值作为插值参数
+// 3. t <= 0 返回 q0，t >= 1 返回未翻转的 q1
+
+static void SlerpRange(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n)
+{
+	const SimdFloat one = SimdSet1(1.0f);
+	const SimdFloat zero = SimdZero();
+
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat aw, ax, ay, az;
+		SimdFloat bw, bx, by, bz;
+
+		SimdLoadAoS4(&q0[i].w, aw, ax, ay, az);
+		SimdLoadAoS4(&q1[i].w, bw, bx, by, bz);
+
+		SimdFloat tt = SimdLoad(t + i);
+
+		// 计算点积，并按符号翻转q1
+
+		SimdFloat cosOmega = SimdMul(aw, bw);
+		cosOmega = SimdMulAdd(ax, bx, cosOmega);
+		cosOmega = SimdMulAdd(ay, by, cosOmega);
+		cosOmega = SimdMulAdd(az, bz, cosOmega);
+
+		SimdFloat sign = SimdSignBit(cosOmega);
+		cosOmega = SimdAbs(cosOmega);
+
+		SimdFloat fw = SimdXor(bw, sign);
+		SimdFloat fx = SimdXor(bx, sign);
+		SimdFloat fy = SimdXor(by, sign);
+		SimdFloat fz = SimdXor(bz, sign);
+
+		// 计算插值参数
+
+		SimdFloat sinOmega = SimdSqrt(SimdMax(SimdNegMulAdd(cosOmega, cosOmega, one), zero));
+		SimdFloat omega = SimdAtan2Positive(sinOmega, cosOmega);
+		SimdFloat oneOverSinOmega = SimdDiv(one, SimdMax(sinOmega, SimdSet1(1e-30f)));
+
+		SimdFloat oneMinusT = SimdSub(one, tt);
+		SimdFloat k0 = SimdMul(SimdSinHalfPi(SimdMul(oneMinusT, omega)), oneOverSinOmega);
+		SimdFloat k1 = SimdMul(SimdSinHalfPi(SimdMul(tt, omega)), oneOverSinOmega);
+
+		// 两个四元数非常相近时只执行普通线性插值
+
+		SimdMask nearMask = SimdCmpGt(cosOmega, SimdSet1(0.9999f));
+		k0 = SimdSelect(nearMask, oneMinusT, k0);
+		k1 = SimdSelect(nearMask, tt, k1);
+
+		SimdFloat rw = SimdMulAdd(k1, fw, SimdMul(k0, aw));
+		SimdFloat rx = SimdMulAdd(k1, fx, SimdMul(k0, ax));
+		SimdFloat ry = SimdMulAdd(k1, fy, SimdMul(k0, ay));
+		SimdFloat rz = SimdMulAdd(k1, fz, SimdMul(k0, az));
+
+		// 处理 t 超出范围的情况
+
+		SimdMask low = SimdCmpLe(tt, zero);
+		SimdMask high = SimdCmpGe(tt, one);
+
+		rw = SimdSelect(low, aw, SimdSelect(high, bw, rw));
+		rx = SimdSelect(low, ax, SimdSelect(high, bx, rx));
+		ry = SimdSelect(low, ay, SimdSelect(high, by, ry));
+		rz = SimdSelect(low, az, SimdSelect(high, bz, rz));
+
+		SimdStoreAoS4(&out[i].w, rw, rx, ry, rz);
+	}
+
+	// 尾部逐个处理
+
+	for (; i < n; i++)
+	{
+		out[i] = Slerp(q0[i], q1[i], t[i]);
+	}
+}
+
+void SlerpN(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		SlerpRange(q0 + begin, q1 + begin, t + begin, out + begin, end - begin);
+	});
+}
+
+// 关于夹角余弦 d 的三次多项式，系数取 gFastSlerpCoeff 的一行
+
+static inline SimdFloat FastSlerpPoly(const float *c, SimdFloat d)
+{
+	SimdFloat r = SimdMulAdd(SimdSet1(c[3]), d, SimdSet1(c[2]));
+	r = SimdMulAdd(r, d, SimdSet1(c[1]));
+	return SimdMulAdd(r, d, SimdSet1(c[0]));
+}
+
+// FastSlerpN
+//
+// 与 FastSlerp 相同的 t 修正，本身没有分支，逐通道照搬即可
+
+static void FastSlerpRange(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n)
+{
+	const SimdFloat one = SimdSet1(1.0f);
+	const SimdFloat half = SimdSet1(0.5f);
+
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat aw, ax, ay, az;
+		SimdFloat bw, bx, by, bz;
+
+		SimdLoadAoS4(&q0[i].w, aw, ax, ay, az);
+		SimdLoadAoS4(&q1[i].w, bw, bx, by, bz);
+
+		SimdFloat tt = SimdMin(SimdMax(SimdLoad(t + i), SimdZero()), one);
+
+		SimdFloat cosOmega = SimdMul(aw, bw);
+		cosOmega = SimdMulAdd(ax, bx, cosOmega);
+		cosOmega = SimdMulAdd(ay, by, cosOmega);
+		cosOmega = SimdMulAdd(az, bz, cosOmega);
+
+		SimdFloat sign = SimdSignBit(cosOmega);
+		SimdFloat d = SimdAbs(cosOmega);
+
+		// 修正插值参数
+
+		SimdFloat k0 = FastSlerpPoly(gFastSlerpCoeff[0], d);
+		SimdFloat k1 = FastSlerpPoly(gFastSlerpCoeff[1], d);
+		SimdFloat k2 = FastSlerpPoly(gFastSlerpCoeff[2], d);
+
+		SimdFloat h = SimdSub(tt, half);
+		SimdFloat u = SimdMul(h, h);
+		SimdFloat k = SimdMulAdd(SimdMulAdd(k2, u, k1), u, k0);
+
+		tt = SimdMulAdd(SimdMul(SimdMul(tt, h), SimdSub(tt, one)), k, tt);
+
+		// 线性插值后归一化
+
+		SimdFloat s0 = SimdSub(one, tt);
+		SimdFloat s1 = SimdXor(tt, sign);
+
+		SimdFloat rw = SimdMulAdd(s1, bw, SimdMul(s0, aw));
+		SimdFloat rx = SimdMulAdd(s1, bx, SimdMul(s0, ax));
+		SimdFloat ry = SimdMulAdd(s1, by, SimdMul(s0, ay));
+		SimdFloat rz = SimdMulAdd(s1, bz, SimdMul(s0, az));
+
+		SimdFloat magSq = SimdMulAdd(rz, rz, SimdMulAdd(ry, ry, SimdMulAdd(rx, rx, SimdMul(rw, rw))));
+		SimdFloat inv = SimdDiv(one, SimdSqrt(magSq));
+
+		SimdStoreAoS4(&out[i].w, SimdMul(rw, inv), SimdMul(rx, inv), SimdMul(ry, inv), SimdMul(rz, inv));
+	}
+
+	// 尾部逐个处理
+
+	for (; i < n; i++)
+	{
+		out[i] = FastSlerp(q0[i], q1[i], t[i]);
+	}
+}
+
+void FastSlerpN(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		FastSlerpRange(q0 + begin, q1 + begin, t + begin, out + begin, end - begin);
+	});
+}
@@ -0,0 +1,29 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionBatch.h
+// func: 基于Quaternion的批量运算内核
+// disc: 每次处理 KSIMDWIDTH 个四元数（SSE为4个，AVX2为8个），
+//		 结果与逐个调用标量版本一致，只是三角函数改用多项式近似
+//		 pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class Quaternion;
+class JobPool;
+
+// 批量圆弧线性插值 out[i] = Slerp(q0[i], q1[i], t[i])
+// 保留标量版本的短弧翻转、相近时退化为线性插值以及 t 的边界处理
+// out 可以与 q0 或 q1 相同
+
+extern void SlerpN(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n,
+				   JobPool *pool = NULL);
+
+// 批量近似圆弧线性插值 out[i] = FastSlerp(q0[i], q1[i], t[i])
+// out 可以与 q0 或 q1 相同
+
+extern void FastSlerpN(const Quaternion *q0, const Quaternion *q1, const float *t, Quaternion *out, size_t n,
+					   JobPool *pool = NULL);
@@ -0,0 +1,296 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionBlend.cpp
+// func: 多个四元数的加权混合与平均
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+
+#include "JobPool.h"
+#include "QuaternionBlend.h"
+#include "Quaternion.h"
+#include "Simd.h"
+
+// 雅可比迭代的最大轮数，4x4 对称矩阵通常五六轮就收敛
+
+static const int KJACOBIMAXSWEEPS = 16;
+
+/////////////////////////////////////////////////
+//
+// 内部实现
+//
+/////////////////////////////////////////////////
+
+// LargestEigenvector
+//
+// 循环雅可比法把对称矩阵 a 对角化，旋转累积在 v 的列中，
+// 返回最大对角元对应的列；a 在计算中被改写
+
+static void LargestEigenvector(double a[4][4], double out[4])
+{
+	double v[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+
+	double scale = 0.0;
+
+	for (int p = 0; p < 4; p++)
+	{
+		for (int q = 0; q < 4; q++)
+		{
+			scale += a[p][q] * a[p][q];
+		}
+	}
+
+	for (int sweep = 0; sweep < KJACOBIMAXSWEEPS; sweep++)
+	{
+		double off = 0.0;
+
+		for (int p = 0; p < 3; p++)
+		{
+			for (int q = p + 1; q < 4; q++)
+			{
+				off += a[p][q] * a[p][q];
+			}
+		}
+
+		if (off <= 1e-28 * scale)
+		{
+			break;
+		}
+
+		for (int p = 0; p < 3; p++)
+		{
+			for (int q = p + 1; q < 4; q++)
+			{
+				if (a[p][q] == 0.0)
+				{
+					continue;
+				}
+
+				// 选取旋转角使 a[p][q] 变为零，取绝对值较小的 tan 以保证稳定
+
+				double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+				double t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+				t = theta < 0.0 ? -t : t;
+
+				double c = 1.0 / sqrt(t * t + 1.0);
+				double s = t * c;
+
+				for (int k = 0; k < 4; k++)
+				{
+					double akp = a[k][p], akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+
+				for (int k = 0; k < 4; k++)
+				{
+					double apk = a[p][k], aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+
+				for (int k = 0; k < 4; k++)
+				{
+					double vkp = v[k][p], vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	int best = 0;
+
+	for (int k = 1; k < 4; k++)
+	{
+		if (a[k][k] > a[best][best])
+		{
+			best = k;
+		}
+	}
+
+	for (int k = 0; k < 4; k++)
+	{
+		out[k] = v[k][best];
+	}
+}
+
+// 按第一个输入对齐符号后的加权和，未标准化
+
+static void AccumulateAligned(const Quaternion *q, const float *weights, size_t n, double sum[4])
+{
+	sum[0] = sum[1] = sum[2] = sum[3] = 0.0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		assert(weights[i] >= 0.0f);
+
+		double w = DotProduct(q[0], q[i]) < 0.0f ? -weights[i] : weights[i];
+
+		sum[0] += w * q[i].w;
+		sum[1] += w * q[i].x;
+		sum[2] += w * q[i].y;
+		sum[3] += w * q[i].z;
+	}
+}
+
+// BlendQuaternionsRange
+//
+// 每次 KSIMDWIDTH 根骨骼，逐个姿势累加后标准化，尾部逐根处理
+
+static void BlendQuaternionsRange(const float *const *poses, const float *weights, size_t inputs,
+								  float *out, size_t bones, size_t begin, size_t end)
+{
+	size_t i = begin;
+
+	const float *ref = poses[0];
+
+	for (; i + KSIMDWIDTH <= end; i += KSIMDWIDTH)
+	{
+		SimdFloat rw = SimdLoad(ref + i);
+		SimdFloat rx = SimdLoad(ref + bones + i);
+		SimdFloat ry = SimdLoad(ref + 2 * bones + i);
+		SimdFloat rz = SimdLoad(ref + 3 * bones + i);
+
+		SimdFloat sw = SimdZero(), sx = SimdZero(), sy = SimdZero(), sz = SimdZero();
+
+		for (size_t k = 0; k < inputs; k++)
+		{
+			const float *pose = poses[k];
+
+			SimdFloat qw = SimdLoad(pose + i);
+			SimdFloat qx = SimdLoad(pose + bones + i);
+			SimdFloat qy = SimdLoad(pose + 2 * bones + i);
+			SimdFloat qz = SimdLoad(pose + 3 * bones + i);
+
+			// 与第一个姿势点积为负时权重取反
+
+			SimdFloat dot = SimdMulAdd(rz, qz, SimdMulAdd(ry, qy, SimdMulAdd(rx, qx, SimdMul(rw, qw))));
+			SimdFloat w = SimdXor(SimdSet1(weights[k]), SimdSignBit(dot));
+
+			sw = SimdMulAdd(w, qw, sw);
+			sx = SimdMulAdd(w, qx, sx);
+			sy = SimdMulAdd(w, qy, sy);
+			sz = SimdMulAdd(w, qz, sz);
+		}
+
+		SimdFloat magSq = SimdMulAdd(sz, sz, SimdMulAdd(sy, sy, SimdMulAdd(sx, sx, SimdMul(sw, sw))));
+		SimdFloat inv = SimdDiv(SimdSet1(1.0f), SimdSqrt(magSq));
+
+		SimdStore(out + i, SimdMul(sw, inv));
+		SimdStore(out + bones + i, SimdMul(sx, inv));
+		SimdStore(out + 2 * bones + i, SimdMul(sy, inv));
+		SimdStore(out + 3 * bones + i, SimdMul(sz, inv));
+	}
+
+	// 尾部逐根处理
+
+	for (; i < end; i++)
+	{
+		Quaternion first = { ref[i], ref[bones + i], ref[2 * bones + i], ref[3 * bones + i] };
+		float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		for (size_t k = 0; k < inputs; k++)
+		{
+			const float *pose = poses[k];
+			Quaternion q = { pose[i], pose[bones + i], pose[2 * bones + i], pose[3 * bones + i] };
+
+			float w = DotProduct(first, q) < 0.0f ? -weights[k] : weights[k];
+
+			sum[0] += w * q.w;
+			sum[1] += w * q.x;
+			sum[2] += w * q.y;
+			sum[3] += w * q.z;
+		}
+
+		float inv = 1.0f / sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2] + sum[3] * sum[3]);
+
+		out[i] = sum[0] * inv;
+		out[bones + i] = sum[1] * inv;
+		out[2 * bones + i] = sum[2] * inv;
+		out[3 * bones + i] = sum[3] * inv;
+	}
+}
+
+/////////////////////////////////////////////////
+//
+// 非成员函数
+//
+/////////////////////////////////////////////////
+
+Quaternion BlendQuaternions(const Quaternion *q, const float *weights, size_t n, bool exact)
+{
+	assert(n > 0);
+
+	double sum[4];
+	AccumulateAligned(q, weights, n, sum);
+
+	double result[4] = { sum[0], sum[1], sum[2], sum[3] };
+
+	if (exact)
+	{
+		// M = sum(w[i] * q[i] * q[i]^T)，与 q[i] 的符号无关
+
+		double m[4][4] = {};
+
+		for (size_t i = 0; i < n; i++)
+		{
+			double v[4] = { q[i].w, q[i].x, q[i].y, q[i].z };
+
+			for (int r = 0; r < 4; r++)
+			{
+				for (int c = r; c < 4; c++)
+				{
+					m[r][c] += weights[i] * v[r] * v[c];
+				}
+			}
+		}
+
+		for (int r = 1; r < 4; r++)
+		{
+			for (int c = 0; c < r; c++)
+			{
+				m[r][c] = m[c][r];
+			}
+		}
+
+		LargestEigenvector(m, result);
+
+		// 特征向量的符号任意，取与累加结果相同的半球
+
+		double dot = result[0]*sum[0] + result[1]*sum[1] + result[2]*sum[2] + result[3]*sum[3];
+
+		if (dot < 0.0)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				result[k] = -result[k];
+			}
+		}
+	}
+
+	double magSq = result[0]*result[0] + result[1]*result[1] + result[2]*result[2] + result[3]*result[3];
+	assert(magSq > 0.0);
+
+	double inv = 1.0 / sqrt(magSq);
+
+	Quaternion ret;
+	ret.w = (float)(result[0] * inv);
+	ret.x = (float)(result[1] * inv);
+	ret.y = (float)(result[2] * inv);
+	ret.z = (float)(result[3] * inv);
+	return ret;
+}
+
+void BlendQuaternionsSoA(const float *const *poses, const float *weights, size_t inputs,
+						 float *out, size_t bones, JobPool *pool)
+{
+	assert(inputs > 0);
+
+	ParallelFor(pool, 0, bones, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		BlendQuaternionsRange(poses, weights, inputs, out, bones, begin, end);
+	});
+}
@@ -0,0 +1,41 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionBlend.h
+// func: 多个四元数的加权混合与平均，用于混合树与群体姿势变化
+// disc: 两两串联 Slerp 的结果与混合顺序有关，且每一步都要求三角函数；
+//		 这里一次累加全部输入：
+//		 默认方式与 DualQuaternion 的 Blend 相同，与第一个输入点积为负
+//		 的项翻转符号后按权重累加，再标准化（nlerp）；对齐后两两点积
+//		 都为正时（例如彼此相差不超过90度的旋转），结果与顺序无关
+//		 精确方式求 M = sum(w[i] * q[i] * q[i]^T) 最大特征值的特征向量，
+//		 即与各旋转矩阵之差的 Frobenius 范数平方加权和最小的旋转，
+//		 与符号和顺序都无关；
+//		 输入彼此接近时两者相差很小
+//		 SoA 批量版本一次混合 K 个姿势的 M 根骨骼，每次处理 KSIMDWIDTH
+//		 根骨骼，pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class Quaternion;
+class JobPool;
+
+// BlendQuaternions
+//
+// 按权重混合 n 个单位四元数，权重非负，和不必为1但不能为零
+// exact 为 true 时用特征向量求精确的加权平均，结果与累加方式取同一半球
+
+extern Quaternion BlendQuaternions(const Quaternion *q, const float *weights, size_t n, bool exact = false);
+
+// BlendQuaternionsSoA
+//
+// 第 k 个姿势 poses[k] 为 bones 根骨骼的四条float流 w, x, y, z 依次连续存放，
+// 即 poses[k][c * bones + i] 为第 i 根骨骼的第 c 个分量，out 布局相同
+// out[i] = BlendQuaternions({ poses[0][i], ..., poses[inputs - 1][i] }, weights, inputs)
+// 各骨骼共用 inputs 个权重，out 可以与某个输入姿势相同
+
+extern void BlendQuaternionsSoA(const float *const *poses, const float *weights, size_t inputs,
+								float *out, size_t bones, JobPool *pool = NULL);
@@ -0,0 +1,518 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionCompress.cpp
+// func: 单位四元数的压缩编码与解码
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+
+#include "JobPool.h"
+#include "QuaternionCompress.h"
+#include "Quaternion.h"
+#include "CommonMath.h"
+#include "Simd.h"
+#include "SimdMath.h"
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be four packed floats");
+
+// 最小三分量的取值范围 [-KSMALLESTRANGE, KSMALLESTRANGE]
+
+static const float KSMALLESTRANGE = 0.70710678118f;
+
+// 15位与10位的最大量化值
+
+static const int KQUANT15 = (1 << 15) - 1;
+static const int KQUANT10 = (1 << 10) - 1;
+
+// 对数映射的分量在 [-PI/2, PI/2] 内，映射到 [-32767, 32767]
+
+static const float KLOGSCALE = 32767.0f / KPIOVER2;
+
+/////////////////////////////////////////////////
+//
+// 单个编码
+//
+/////////////////////////////////////////////////
+
+// 取出最小三分量，返回最大分量的位置
+// 比较用严格大于，绝对值相同时取靠前的分量，与批量版本一致
+
+static int SmallestThree(const Quaternion &q, int maxQuant, int quant[3])
+{
+	const float c[4] = { q.w, q.x, q.y, q.z };
+
+	int largest = 0;
+
+	for (int k = 1; k < 4; k++)
+	{
+		if (fabsf(c[k]) > fabsf(c[largest]))
+		{
+			largest = k;
+		}
+	}
+
+	float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+	float scale = maxQuant * 0.5f / KSMALLESTRANGE;
+
+	for (int k = 0, j = 0; k < 4; k++)
+	{
+		if (k == largest)
+		{
+			continue;
+		}
+
+		float a = MIN(MAX(c[k] * sign, -KSMALLESTRANGE), KSMALLESTRANGE);
+		quant[j++] = (int)nearbyintf(a * scale + maxQuant * 0.5f);
+	}
+
+	return largest;
+}
+
+// 由三个量化值和最大分量的位置恢复四元数
+
+static Quaternion FromSmallestThree(int largest, int maxQuant, const int quant[3])
+{
+	float step = 2.0f * KSMALLESTRANGE / maxQuant;
+	float c[4];
+	float sumSq = 0.0f;
+
+	for (int k = 0, j = 0; k < 4; k++)
+	{
+		if (k == largest)
+		{
+			continue;
+		}
+
+		c[k] = quant[j++] * step - KSMALLESTRANGE;
+		sumSq += c[k] * c[k];
+	}
+
+	c[largest] = sqrt(MAX(1.0f - sumSq, 0.0f));
+
+	Quaternion q;
+	q.w = c[0];
+	q.x = c[1];
+	q.y = c[2];
+	q.z = c[3];
+	return q;
+}
+
+PackedQuaternion48 PackQuaternion48(const Quaternion &q)
+{
+	int quant[3];
+	int largest = SmallestThree(q, KQUANT15, quant);
+
+	PackedQuaternion48 p;
+	p.v[0] = (uint16_t)(quant[0] | ((largest >> 1) << 15));
+	p.v[1] = (uint16_t)(quant[1] | ((largest & 1) << 15));
+	p.v[2] = (uint16_t)quant[2];
+	return p;
+}
+
+PackedQuaternion32 PackQuaternion32(const Quaternion &q)
+{
+	int quant[3];
+	int largest = SmallestThree(q, KQUANT10, quant);
+
+	PackedQuaternion32 p;
+	p.v = ((uint32_t)largest << 30) | ((uint32_t)quant[0] << 20) | ((uint32_t)quant[1] << 10) | (uint32_t)quant[2];
+	return p;
+}
+
+// LogLanes
+//
+// 各通道的对数映射并量化：翻转到 w >= 0 的半球，
+// 半角 = atan2(|v|, w) 在 [0, PI/2]，对数为 v * 半角 / |v|，
+// |v| 很小时 半角 / |v| 趋于1
+// 单个编码与批量内核都经过这里，atan2 用同一个多项式，两者逐位一致
+
+static void LogLanes(SimdFloat w, SimdFloat x, SimdFloat y, SimdFloat z, SimdInt &qa, SimdInt &qb, SimdInt &qc)
+{
+	SimdFloat sign = SimdSignBit(w);
+	w = SimdXor(w, sign);
+	x = SimdXor(x, sign);
+	y = SimdXor(y, sign);
+	z = SimdXor(z, sign);
+
+	SimdFloat s = SimdSqrt(SimdMulAdd(z, z, SimdMulAdd(y, y, SimdMul(x, x))));
+	SimdFloat half = SimdAtan2Positive(s, w);
+
+	SimdMask small = SimdCmpLe(s, SimdSet1(1e-6f));
+	SimdFloat factor = SimdSelect(small, SimdSet1(1.0f), SimdDiv(half, SimdMax(s, SimdSet1(1e-6f))));
+	factor = SimdMul(factor, SimdSet1(KLOGSCALE));
+
+	SimdFloat lo = SimdSet1(-32767.0f);
+	SimdFloat hi = SimdSet1(32767.0f);
+
+	qa = SimdRoundToInt(SimdMin(SimdMax(SimdMul(x, factor), lo), hi));
+	qb = SimdRoundToInt(SimdMin(SimdMax(SimdMul(y, factor), lo), hi));
+	qc = SimdRoundToInt(SimdMin(SimdMax(SimdMul(z, factor), lo), hi));
+}
+
+// PackLogQuaternion48
+//
+// 广播到每个通道后交给 LogLanes，取第一个通道
+
+LogQuaternion48 PackLogQuaternion48(const Quaternion &q)
+{
+	SimdInt qa, qb, qc;
+	LogLanes(SimdSet1(q.w), SimdSet1(q.x), SimdSet1(q.y), SimdSet1(q.z), qa, qb, qc);
+
+	int a[KSIMDWIDTH], b[KSIMDWIDTH], c[KSIMDWIDTH];
+	SimdIntStore(a, qa);
+	SimdIntStore(b, qb);
+	SimdIntStore(c, qc);
+
+	LogQuaternion48 p;
+	p.v[0] = (int16_t)a[0];
+	p.v[1] = (int16_t)b[0];
+	p.v[2] = (int16_t)c[0];
+	return p;
+}
+
+Quaternion Unpack(const PackedQuaternion48 &p)
+{
+	int largest = ((p.v[0] >> 15) << 1) | (p.v[1] >> 15);
+	int quant[3] = { p.v[0] & 0x7fff, p.v[1] & 0x7fff, p.v[2] & 0x7fff };
+
+	return FromSmallestThree(largest, KQUANT15, quant);
+}
+
+Quaternion Unpack(const PackedQuaternion32 &p)
+{
+	int largest = (int)(p.v >> 30);
+	int quant[3] = { (int)(p.v >> 20) & KQUANT10, (int)(p.v >> 10) & KQUANT10, (int)p.v & KQUANT10 };
+
+	return FromSmallestThree(largest, KQUANT10, quant);
+}
+
+// 指数映射：半角 = |l|，q = (cos(半角), l * sin(半角) / 半角)
+
+Quaternion Unpack(const LogQuaternion48 &p)
+{
+	float x = p.v[0] / KLOGSCALE;
+	float y = p.v[1] / KLOGSCALE;
+	float z = p.v[2] / KLOGSCALE;
+
+	float half = MIN(sqrt(x*x + y*y + z*z), KPIOVER2);
+	float sinc = half > 1e-6f ? sin(half) / half : 1.0f;
+
+	Quaternion q;
+	q.w = cos(half);
+	q.x = x * sinc;
+	q.y = y * sinc;
+	q.z = z * sinc;
+	return q;
+}
+
+/////////////////////////////////////////////////
+//
+// 批量内核
+//
+/////////////////////////////////////////////////
+
+// 各通道取出最小三分量并量化，largest 为最大分量的位置
+// 三个剩余分量按原顺序排列：位置0时为 (x, y, z)，1时为 (w, y, z)，
+// 2时为 (w, x, z)，3时为 (w, x, y)，于是每个只需一次选择
+
+static void SmallestThreeLanes(SimdFloat w, SimdFloat x, SimdFloat y, SimdFloat z, int maxQuant,
+							   SimdInt &largest, SimdInt &qa, SimdInt &qb, SimdInt &qc)
+{
+	SimdFloat best = SimdAbs(w);
+	SimdFloat bestValue = w;
+	SimdFloat index = SimdZero();
+
+	SimdMask m = SimdCmpGt(SimdAbs(x), best);
+	best = SimdSelect(m, SimdAbs(x), best);
+	bestValue = SimdSelect(m, x, bestValue);
+	index = SimdSelect(m, SimdSet1(1.0f), index);
+
+	m = SimdCmpGt(SimdAbs(y), best);
+	best = SimdSelect(m, SimdAbs(y), best);
+	bestValue = SimdSelect(m, y, bestValue);
+	index = SimdSelect(m, SimdSet1(2.0f), index);
+
+	m = SimdCmpGt(SimdAbs(z), best);
+	bestValue = SimdSelect(m, z, bestValue);
+	index = SimdSelect(m, SimdSet1(3.0f), index);
+
+	SimdMask ge1 = SimdCmpGt(index, SimdSet1(0.5f));
+	SimdMask ge2 = SimdCmpGt(index, SimdSet1(1.5f));
+	SimdMask ge3 = SimdCmpGt(index, SimdSet1(2.5f));
+
+	// 最大分量为负时整体翻转
+
+	SimdFloat sign = SimdSignBit(bestValue);
+
+	SimdFloat a = SimdXor(SimdSelect(ge1, w, x), sign);
+	SimdFloat b = SimdXor(SimdSelect(ge2, x, y), sign);
+	SimdFloat c = SimdXor(SimdSelect(ge3, y, z), sign);
+
+	SimdFloat lo = SimdSet1(-KSMALLESTRANGE);
+	SimdFloat hi = SimdSet1(KSMALLESTRANGE);
+	SimdFloat scale = SimdSet1(maxQuant * 0.5f / KSMALLESTRANGE);
+	SimdFloat bias = SimdSet1(maxQuant * 0.5f);
+
+	qa = SimdRoundToInt(SimdAdd(SimdMul(SimdMin(SimdMax(a, lo), hi), scale), bias));
+	qb = SimdRoundToInt(SimdAdd(SimdMul(SimdMin(SimdMax(b, lo), hi), scale), bias));
+	qc = SimdRoundToInt(SimdAdd(SimdMul(SimdMin(SimdMax(c, lo), hi), scale), bias));
+	largest = SimdRoundToInt(index);
+}
+
+// SmallestThreeLanes 的逆，写出 KSIMDWIDTH 个四元数
+
+static void FromSmallestThreeLanes(SimdFloat index, SimdFloat qa, SimdFloat qb, SimdFloat qc, int maxQuant,
+								   Quaternion *out)
+{
+	SimdFloat step = SimdSet1(2.0f * KSMALLESTRANGE / maxQuant);
+	SimdFloat offset = SimdSet1(-KSMALLESTRANGE);
+
+	SimdFloat a = SimdMulAdd(qa, step, offset);
+	SimdFloat b = SimdMulAdd(qb, step, offset);
+	SimdFloat c = SimdMulAdd(qc, step, offset);
+
+	SimdFloat sumSq = SimdMulAdd(c, c, SimdMulAdd(b, b, SimdMul(a, a)));
+	SimdFloat l = SimdSqrt(SimdMax(SimdSub(SimdSet1(1.0f), sumSq), SimdZero()));
+
+	SimdMask ge1 = SimdCmpGt(index, SimdSet1(0.5f));
+	SimdMask ge2 = SimdCmpGt(index, SimdSet1(1.5f));
+	SimdMask ge3 = SimdCmpGt(index, SimdSet1(2.5f));
+
+	SimdFloat w = SimdSelect(ge1, a, l);
+	SimdFloat x = SimdSelect(ge2, b, SimdSelect(ge1, l, a));
+	SimdFloat y = SimdSelect(ge3, c, SimdSelect(ge2, l, b));
+	SimdFloat z = SimdSelect(ge3, l, c);
+
+	SimdStoreAoS4(&out->w, w, x, y, z);
+}
+
+static void Pack48Range(const Quaternion *q, PackedQuaternion48 *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat w, x, y, z;
+		SimdLoadAoS4(&q[i].w, w, x, y, z);
+
+		SimdInt largest, qa, qb, qc;
+		SmallestThreeLanes(w, x, y, z, KQUANT15, largest, qa, qb, qc);
+
+		// 6字节的结构不能整组写出，经缓冲区逐个拼装
+
+		int l[KSIMDWIDTH], a[KSIMDWIDTH], b[KSIMDWIDTH], c[KSIMDWIDTH];
+		SimdIntStore(l, largest);
+		SimdIntStore(a, qa);
+		SimdIntStore(b, qb);
+		SimdIntStore(c, qc);
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			PackedQuaternion48 &p = out[i + lane];
+			p.v[0] = (uint16_t)(a[lane] | ((l[lane] >> 1) << 15));
+			p.v[1] = (uint16_t)(b[lane] | ((l[lane] & 1) << 15));
+			p.v[2] = (uint16_t)c[lane];
+		}
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = PackQuaternion48(q[i]);
+	}
+}
+
+static void Pack32Range(const Quaternion *q, PackedQuaternion32 *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat w, x, y, z;
+		SimdLoadAoS4(&q[i].w, w, x, y, z);
+
+		SimdInt largest, qa, qb, qc;
+		SmallestThreeLanes(w, x, y, z, KQUANT10, largest, qa, qb, qc);
+
+		SimdInt v = SimdIntOr(SimdIntOr(SimdIntShiftLeft(largest, 30), SimdIntShiftLeft(qa, 20)),
+							  SimdIntOr(SimdIntShiftLeft(qb, 10), qc));
+
+		SimdIntStore((int *)&out[i].v, v);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = PackQuaternion32(q[i]);
+	}
+}
+
+static void PackLog48Range(const Quaternion *q, LogQuaternion48 *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat w, x, y, z;
+		SimdLoadAoS4(&q[i].w, w, x, y, z);
+
+		SimdInt qa, qb, qc;
+		LogLanes(w, x, y, z, qa, qb, qc);
+
+		int a[KSIMDWIDTH], b[KSIMDWIDTH], c[KSIMDWIDTH];
+		SimdIntStore(a, qa);
+		SimdIntStore(b, qb);
+		SimdIntStore(c, qc);
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			LogQuaternion48 &p = out[i + lane];
+			p.v[0] = (int16_t)a[lane];
+			p.v[1] = (int16_t)b[lane];
+			p.v[2] = (int16_t)c[lane];
+		}
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = PackLogQuaternion48(q[i]);
+	}
+}
+
+static void Unpack48Range(const PackedQuaternion48 *p, Quaternion *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		float l[KSIMDWIDTH], a[KSIMDWIDTH], b[KSIMDWIDTH], c[KSIMDWIDTH];
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			const PackedQuaternion48 &s = p[i + lane];
+			l[lane] = (float)(((s.v[0] >> 15) << 1) | (s.v[1] >> 15));
+			a[lane] = (float)(s.v[0] & 0x7fff);
+			b[lane] = (float)(s.v[1] & 0x7fff);
+			c[lane] = (float)(s.v[2] & 0x7fff);
+		}
+
+		FromSmallestThreeLanes(SimdLoad(l), SimdLoad(a), SimdLoad(b), SimdLoad(c), KQUANT15, out + i);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = Unpack(p[i]);
+	}
+}
+
+static void Unpack32Range(const PackedQuaternion32 *p, Quaternion *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdInt v = SimdIntLoad((const int *)&p[i].v);
+
+		SimdFloat l = SimdIntToFloat(SimdIntShiftRight(v, 30));
+		SimdFloat a = SimdIntToFloat(SimdIntAnd(SimdIntShiftRight(v, 20), KQUANT10));
+		SimdFloat b = SimdIntToFloat(SimdIntAnd(SimdIntShiftRight(v, 10), KQUANT10));
+		SimdFloat c = SimdIntToFloat(SimdIntAnd(v, KQUANT10));
+
+		FromSmallestThreeLanes(l, a, b, c, KQUANT10, out + i);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = Unpack(p[i]);
+	}
+}
+
+static void UnpackLog48Range(const LogQuaternion48 *p, Quaternion *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		float a[KSIMDWIDTH], b[KSIMDWIDTH], c[KSIMDWIDTH];
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			a[lane] = p[i + lane].v[0];
+			b[lane] = p[i + lane].v[1];
+			c[lane] = p[i + lane].v[2];
+		}
+
+		SimdFloat invScale = SimdSet1(1.0f / KLOGSCALE);
+		SimdFloat x = SimdMul(SimdLoad(a), invScale);
+		SimdFloat y = SimdMul(SimdLoad(b), invScale);
+		SimdFloat z = SimdMul(SimdLoad(c), invScale);
+
+		SimdFloat half = SimdMin(SimdSqrt(SimdMulAdd(z, z, SimdMulAdd(y, y, SimdMul(x, x)))), SimdSet1(KPIOVER2));
+		SimdFloat s = SimdSinHalfPi(half);
+		SimdFloat w = SimdSinHalfPi(SimdSub(SimdSet1(KPIOVER2), half));
+
+		SimdMask small = SimdCmpLe(half, SimdSet1(1e-6f));
+		SimdFloat sinc = SimdSelect(small, SimdSet1(1.0f), SimdDiv(s, SimdMax(half, SimdSet1(1e-6f))));
+
+		SimdStoreAoS4(&out[i].w, w, SimdMul(x, sinc), SimdMul(y, sinc), SimdMul(z, sinc));
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = Unpack(p[i]);
+	}
+}
+
+/////////////////////////////////////////////////
+//
+// 对外接口
+//
+/////////////////////////////////////////////////
+
+void PackN(const Quaternion *q, PackedQuaternion48 *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		Pack48Range(q + begin, out + begin, end - begin);
+	});
+}
+
+void PackN(const Quaternion *q, PackedQuaternion32 *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		Pack32Range(q + begin, out + begin, end - begin);
+	});
+}
+
+void PackN(const Quaternion *q, LogQuaternion48 *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		PackLog48Range(q + begin, out + begin, end - begin);
+	});
+}
+
+void UnpackN(const PackedQuaternion48 *p, Quaternion *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		Unpack48Range(p + begin, out + begin, end - begin);
+	});
+}
+
+void UnpackN(const PackedQuaternion32 *p, Quaternion *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		Unpack32Range(p + begin, out + begin, end - begin);
+	});
+}
+
+void UnpackN(const LogQuaternion48 *p, Quaternion *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		UnpackLog48Range(p + begin, out + begin, end - begin);
+	});
+}
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionCompress.h
+// func: 单位四元数的压缩存储，用于动画关键帧与网络同步
+// disc: 三种编码，只用于单位四元数，q 与 -q 编码后相同：
+//		 PackedQuaternion48  最小三分量，6字节，每个分量15位
+//		 PackedQuaternion32  最小三分量，4字节，每个分量10位
+//		 LogQuaternion48     对数映射 (x, y, z) * 半角 / sin(半角)，6字节，
+//		                     每个分量16位，误差在各个方向上均匀
+//		 最小三分量：去掉绝对值最大的分量（翻转符号使它为正），
+//		 其余三个分量必然在 [-1/sqrt(2), 1/sqrt(2)] 内，均匀量化后存下，
+//		 解码时由单位长度求回最大分量，2位记录它的位置
+//		 批量版本每次处理 KSIMDWIDTH 个四元数，pool 不为NULL时按
+//		 KJOBBATCHGRAIN 分块并行；批量与逐个编码的结果逐位一致
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Quaternion;
+class JobPool;
+
+struct PackedQuaternion48
+{
+	uint16_t v[3];
+};
+
+struct PackedQuaternion32
+{
+	uint32_t v;
+};
+
+struct LogQuaternion48
+{
+	int16_t v[3];
+};
+
+static_assert(sizeof(PackedQuaternion48) == 6, "PackedQuaternion48 must be six bytes");
+static_assert(sizeof(PackedQuaternion32) == 4, "PackedQuaternion32 must be four bytes");
+static_assert(sizeof(LogQuaternion48) == 6, "LogQuaternion48 must be six bytes");
+
+// 编码再解码后与原四元数之间的最大夹角（弧度），
+// 由量化步长推出的上界，实测值见 BenchQuaternionCompress
+
+const float KPACKED48MAXERROR = 1.5e-4f;
+const float KPACKED32MAXERROR = 5.0e-3f;
+const float KLOG48MAXERROR = 1.0e-4f;
+
+// 单个编码与解码
+
+extern PackedQuaternion48 PackQuaternion48(const Quaternion &q);
+extern PackedQuaternion32 PackQuaternion32(const Quaternion &q);
+extern LogQuaternion48 PackLogQuaternion48(const Quaternion &q);
+
+extern Quaternion Unpack(const PackedQuaternion48 &p);
+extern Quaternion Unpack(const PackedQuaternion32 &p);
+extern Quaternion Unpack(const LogQuaternion48 &p);
+
+// 批量编码 out[i] = Pack(q[i])
+
+extern void PackN(const Quaternion *q, PackedQuaternion48 *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Quaternion *q, PackedQuaternion32 *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Quaternion *q, LogQuaternion48 *out, size_t n, JobPool *pool = NULL);
+
+// 批量解码 out[i] = Unpack(p[i])
+
+extern void UnpackN(const PackedQuaternion48 *p, Quaternion *out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const PackedQuaternion32 *p, Quaternion *out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const LogQuaternion48 *p, Quaternion *out, size_t n, JobPool *pool = NULL);
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionSimd.cpp
+// func: 以 __m128 存放的四元数
+// disc: 建立旋转、插值、求角度等不在热点上的操作转给 Quaternion，
+//		 保证两者结果一致
+//
+///////////////////////////////////////////////////////////////////
+
+#include "QuaternionSimd.h"
+#include "Vector3D.h"
+#include "EulerAngles.h"
+
+void QuaternionSimd::SetRotateX(float theta)
+{
+	Quaternion q;
+	q.SetRotateX(theta);
+	*this = QuaternionSimd(q);
+}
+
+void QuaternionSimd::SetRotateY(float theta)
+{
+	Quaternion q;
+	q.SetRotateY(theta);
+	*this = QuaternionSimd(q);
+}
+
+void QuaternionSimd::SetRotateZ(float theta)
+{
+	Quaternion q;
+	q.SetRotateZ(theta);
+	*this = QuaternionSimd(q);
+}
+
+void QuaternionSimd::SetRotateAxis(const Vector3D &axis, float theta)
+{
+	Quaternion q;
+	q.SetRotateAxis(axis, theta);
+	*this = QuaternionSimd(q);
+}
+
+void QuaternionSimd::SetRotateObjectToInertial(const EulerAngles &orientation)
+{
+	Quaternion q;
+	q.SetRotateObjectToInertial(orientation);
+	*this = QuaternionSimd(q);
+}
+
+void QuaternionSimd::SetRotateInertialToObject(const EulerAngles &orientation)
+{
+	Quaternion q;
+	q.SetRotateInertialToObject(orientation);
+	*this = QuaternionSimd(q);
+}
+
+float QuaternionSimd::GetRatateAngle() const
+{
+	return ToQuaternion().GetRatateAngle();
+}
+
+Vector3D QuaternionSimd::GetRAtateAxis() const
+{
+	return ToQuaternion().GetRAtateAxis();
+}
+
+QuaternionSimd Slerp(const QuaternionSimd &q0, const QuaternionSimd &q1, float t)
+{
+	return QuaternionSimd(Slerp(q0.ToQuaternion(), q1.ToQuaternion(), t));
+}
+
+QuaternionSimd Pow(const QuaternionSimd &q, float exp)
+{
+	return QuaternionSimd(Pow(q.ToQuaternion(), exp));
+}
@@ -0,0 +1,240 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: QuaternionSimd.h
+// func: 以 __m128 存放的四元数
+// disc: 成员名、内存布局(w, x, y, z)与接口同 Quaternion，按16字节对齐；
+//		 叉乘、点积、标准化和共轭用洗牌指令在一个寄存器中完成，
+//		 写成内联以便连乘时留在寄存器中；成员是普通的 float，
+//		 经 Load/Store 整体进出寄存器，不依赖匿名结构体；
+//		 定义 WANDER_NO_SIMD 或没有SSE时退化为逐分量计算
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_QuaternionSimd_h
+#define Wander_QuaternionSimd_h
+
+#include <cassert>
+#include <cmath>
+
+#include "Simd.h"
+#include "Quaternion.h"
+
+class Vector3D;
+class EulerAngles;
+
+class WANDER_ALIGN(16) QuaternionSimd
+{
+public:
+
+	QuaternionSimd(){}
+
+	QuaternionSimd(float nw, float nx, float ny, float nz)
+	{
+		Init(nw, nx, ny, nz);
+	}
+
+	explicit QuaternionSimd(const Quaternion &q)
+	{
+		Init(q.w, q.x, q.y, q.z);
+	}
+
+#if defined(WANDER_SIMD_SSE)
+	explicit QuaternionSimd(__m128 a)
+	{
+		Store(a);
+	}
+
+	// 四个分量按 w, x, y, z 的顺序整体载入或写回
+
+	__m128 Load() const
+	{
+		return _mm_load_ps(&w);
+	}
+
+	void Store(__m128 a)
+	{
+		_mm_store_ps(&w, a);
+	}
+#endif
+
+	Quaternion ToQuaternion() const
+	{
+		Quaternion q;
+		q.w = w;
+		q.x = x;
+		q.y = y;
+		q.z = z;
+		return q;
+	}
+
+	void Init(float nw, float nx, float ny, float nz)
+	{
+		w = nw;
+		x = nx;
+		y = ny;
+		z = nz;
+	}
+
+	// 将成员置为零
+
+	void Zero()
+	{
+		w = x = y = z = 0.0f;
+	}
+
+	// 绕x, y, z 以及任意轴旋转函数
+
+	void SetRotateX(float theta);
+	void SetRotateY(float theta);
+	void SetRotateZ(float theta);
+	void SetRotateAxis(const Vector3D &axis, float theta);
+
+	// 很据已知欧拉角建立惯性坐标系和物体坐标系相互转化的四元数
+
+	void SetRotateObjectToInertial(const EulerAngles &orientation);
+	void SetRotateInertialToObject(const EulerAngles &orientation);
+
+	// 叉乘重载*号
+
+	QuaternionSimd operator *(const QuaternionSimd &q) const;
+	QuaternionSimd operator *=(const QuaternionSimd &q)
+	{
+		*this = (*this) * q;
+		return *this;
+	}
+
+	// 置模为1
+
+	void Normalize();
+
+	// 返回旋转角和旋转轴
+
+	float GetRatateAngle() const;
+	Vector3D GetRAtateAxis() const;
+
+public:
+	float w;
+	float x;
+	float y;
+	float z;
+};
+
+static_assert(sizeof(QuaternionSimd) == sizeof(Quaternion), "QuaternionSimd must match the Quaternion layout");
+
+#if defined(WANDER_SIMD_SSE)
+
+// 四个通道乘积之和，广播到所有通道
+
+inline __m128 QuaternionSimdDot(__m128 a, __m128 b)
+{
+	__m128 m = _mm_mul_ps(a, b);
+	__m128 t = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+#endif
+
+// QuaternionSimd::operator *
+//
+// 按a的分量展开：
+// a*b = aw*(bw, bx, by, bz) + ax*(-bx, bw, bz, -by)
+//	   + ay*(-by, -bz, bw, bx) + az*(-bz, by, -bx, bw)
+// 每一项是b的一次洗牌加一次符号翻转，与 Quaternion::operator * 结果一致
+
+inline QuaternionSimd QuaternionSimd::operator *(const QuaternionSimd &q) const
+{
+#if defined(WANDER_SIMD_SSE)
+	const __m128 signX = _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f);
+	const __m128 signY = _mm_setr_ps(-0.0f, -0.0f, 0.0f, 0.0f);
+	const __m128 signZ = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+
+	__m128 a = Load();
+	__m128 b = q.Load();
+
+	__m128 bx = _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), signX);
+	__m128 by = _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), signY);
+	__m128 bz = _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), signZ);
+
+	// 两两相加，连乘时依赖链只有两级加法
+
+	__m128 rw = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b);
+	__m128 rx = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), bx);
+	__m128 ry = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), by);
+	__m128 rz = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), bz);
+
+	return QuaternionSimd(_mm_add_ps(_mm_add_ps(rw, rx), _mm_add_ps(ry, rz)));
+#else
+	return QuaternionSimd(w*q.w - x*q.x - y*q.y - z*q.z,
+						  w*q.x + x*q.w + z*q.y - y*q.z,
+						  w*q.y + y*q.w + x*q.z - z*q.x,
+						  w*q.z + z*q.w + y*q.x - x*q.y);
+#endif
+}
+
+// QuaternionSimd::Normalize
+//
+// 点积广播到四个通道后一次开方、一次除法
+
+inline void QuaternionSimd::Normalize()
+{
+#if defined(WANDER_SIMD_SSE)
+	__m128 a = Load();
+	__m128 mag = _mm_sqrt_ps(QuaternionSimdDot(a, a));
+
+	if (_mm_cvtss_f32(mag) > 0.0f)
+	{
+		Store(_mm_div_ps(a, mag));
+		return;
+	}
+#else
+	float mag = std::sqrt(w*w + x*x + y*y + z*z);
+
+	if (mag > 0.0f)
+	{
+		float oneOverMag = 1.0f / mag;
+		w *= oneOverMag;
+		x *= oneOverMag;
+		y *= oneOverMag;
+		z *= oneOverMag;
+		return;
+	}
+#endif
+
+	// 与 Quaternion::Normalize 相同，在Release阶段只是简单的归零
+
+	assert(false);
+
+	Zero();
+}
+
+// 点积
+
+inline float DotProduct(const QuaternionSimd &a, const QuaternionSimd &b)
+{
+#if defined(WANDER_SIMD_SSE)
+	return _mm_cvtss_f32(QuaternionSimdDot(a.Load(), b.Load()));
+#else
+	return a.w*b.w + a.x*b.x + a.y*b.y + a.z*b.z;
+#endif
+}
+
+// 取共轭数 表示相反的旋转
+
+inline QuaternionSimd Conjugate(const QuaternionSimd &q)
+{
+#if defined(WANDER_SIMD_SSE)
+	return QuaternionSimd(_mm_xor_ps(q.Load(), _mm_setr_ps(0.0f, -0.0f, -0.0f, -0.0f)));
+#else
+	return QuaternionSimd(q.w, -q.x, -q.y, -q.z);
+#endif
+}
+
+// 线性插值
+
+extern QuaternionSimd Slerp(const QuaternionSimd &q0, const QuaternionSimd &q1, float t);
+
+// 四元数指数运算
+
+extern QuaternionSimd Pow(const QuaternionSimd &q, float exp);
+
+#endif
@@ -0,0 +1,355 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Simd.h
+// func: 批量内核使用的SIMD抽象层
+// disc: SimdFloat 在AVX2下为8路，在SSE下为4路，关闭SIMD时退化为
+//		 标量float，批量内核只写一遍，按 KSIMDWIDTH 步进即可
+//		 定义 WANDER_NO_SIMD 可强制使用标量版本
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_Simd_h
+#define Wander_Simd_h
+
+#include <cstddef>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#if !defined(WANDER_NO_SIMD) && defined(__AVX2__) && defined(__FMA__)
+#define WANDER_SIMD_AVX2 1
+#define WANDER_SIMD_SSE  1
+#elif !defined(WANDER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define WANDER_SIMD_SSE  1
+#endif
+
+#if defined(WANDER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(WANDER_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#define WANDER_ALIGN(n) __declspec(align(n))
+#define WANDER_FORCEINLINE __forceinline
+#else
+#define WANDER_ALIGN(n) __attribute__((aligned(n)))
+#define WANDER_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+///////////////////////////////////////////////////////////////////
+//
+// 常量
+//
+///////////////////////////////////////////////////////////////////
+
+// SoA数据流的对齐与补齐粒度，一条缓存行
+
+const size_t KSIMDALIGN = 64;
+const size_t KSIMDPADFLOATS = KSIMDALIGN / sizeof(float);
+
+///////////////////////////////////////////////////////////////////
+//
+// 对齐内存
+//
+///////////////////////////////////////////////////////////////////
+
+inline void *AlignedMalloc(size_t size, size_t align = KSIMDALIGN)
+{
+#if defined(_MSC_VER)
+	return _aligned_malloc(size, align);
+#else
+	void *p = NULL;
+	if (posix_memalign(&p, align, size) != 0)
+	{
+		return NULL;
+	}
+	return p;
+#endif
+}
+
+inline void AlignedFree(void *p)
+{
+#if defined(_MSC_VER)
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+// 把元素个数补齐到 KSIMDPADFLOATS 的整数倍
+
+inline size_t SimdPadCount(size_t n)
+{
+	return (n + KSIMDPADFLOATS - 1) & ~(KSIMDPADFLOATS - 1);
+}
+
+inline bool SimdIsAligned(const void *p, size_t align = KSIMDALIGN)
+{
+	return ((size_t)p & (align - 1)) == 0;
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// SimdFloat
+//
+///////////////////////////////////////////////////////////////////
+
+#if defined(WANDER_SIMD_AVX2)
+
+typedef __m256  SimdFloat;
+typedef __m256  SimdMask;
+typedef __m256i SimdInt;
+
+const size_t KSIMDWIDTH = 8;
+
+inline SimdFloat SimdSet1(float a)								{ return _mm256_set1_ps(a); }
+inline SimdFloat SimdZero()										{ return _mm256_setzero_ps(); }
+inline SimdFloat SimdLoad(const float *p)						{ return _mm256_loadu_ps(p); }
+inline void		 SimdStore(float *p, SimdFloat a)				{ _mm256_storeu_ps(p, a); }
+inline void		 SimdStream(float *p, SimdFloat a)				{ _mm256_stream_ps(p, a); }
+
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b)				{ return _mm256_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b)				{ return _mm256_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b)				{ return _mm256_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)				{ return _mm256_div_ps(a, b); }
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm256_fmadd_ps(a, b, c); }
+inline SimdFloat SimdNegMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm256_fnmadd_ps(a, b, c); }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b)				{ return _mm256_min_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b)				{ return _mm256_max_ps(a, b); }
+inline SimdFloat SimdSqrt(SimdFloat a)							{ return _mm256_sqrt_ps(a); }
+
+inline SimdMask  SimdCmpLt(SimdFloat a, SimdFloat b)			{ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline SimdMask  SimdCmpLe(SimdFloat a, SimdFloat b)			{ return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline SimdMask  SimdCmpGt(SimdFloat a, SimdFloat b)			{ return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline SimdMask  SimdCmpGe(SimdFloat a, SimdFloat b)			{ return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline SimdMask  SimdMaskAnd(SimdMask a, SimdMask b)			{ return _mm256_and_ps(a, b); }
+inline SimdMask  SimdMaskOr(SimdMask a, SimdMask b)				{ return _mm256_or_ps(a, b); }
+inline int		 SimdMaskBits(SimdMask m)						{ return _mm256_movemask_ps(m); }
+
+// mask为真的通道取a，否则取b
+
+inline SimdFloat SimdSelect(SimdMask m, SimdFloat a, SimdFloat b) { return _mm256_blendv_ps(b, a, m); }
+
+inline SimdFloat SimdAbs(SimdFloat a)		{ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline SimdFloat SimdSignBit(SimdFloat a)	{ return _mm256_and_ps(_mm256_set1_ps(-0.0f), a); }
+inline SimdFloat SimdXor(SimdFloat a, SimdFloat b) { return _mm256_xor_ps(a, b); }
+
+// 按当前舍入模式（默认最近偶数）取整
+
+inline SimdInt	 SimdRoundToInt(SimdFloat a)					{ return _mm256_cvtps_epi32(a); }
+inline SimdFloat SimdIntToFloat(SimdInt a)						{ return _mm256_cvtepi32_ps(a); }
+inline SimdInt	 SimdIntAnd(SimdInt a, int b)					{ return _mm256_and_si256(a, _mm256_set1_epi32(b)); }
+inline SimdInt	 SimdIntAdd(SimdInt a, int b)					{ return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+inline SimdInt	 SimdIntShiftLeft(SimdInt a, int n)				{ return _mm256_slli_epi32(a, n); }
+inline SimdMask  SimdIntIsZero(SimdInt a)						{ return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_setzero_si256())); }
+inline SimdFloat SimdIntAsFloat(SimdInt a)						{ return _mm256_castsi256_ps(a); }
+inline SimdInt	 SimdFloatAsInt(SimdFloat a)					{ return _mm256_castps_si256(a); }
+inline SimdInt	 SimdIntLoad(const int *p)						{ return _mm256_loadu_si256((const __m256i *)p); }
+inline void		 SimdIntStore(int *p, SimdInt a)				{ _mm256_storeu_si256((__m256i *)p, a); }
+inline SimdInt	 SimdIntOr(SimdInt a, SimdInt b)				{ return _mm256_or_si256(a, b); }
+inline SimdInt	 SimdIntShiftRight(SimdInt a, int n)			{ return _mm256_srli_epi32(a, n); }
+
+inline void SimdFence() { _mm_sfence(); }
+
+// 从 p, p + stride, p + 2*stride ... 处各读入4个连续的float，拆成4条通道
+// 第k、k+4个结构放在两个128位半区，转置后通道顺序与内存顺序一致
+
+inline void SimdLoadStrided4(const float *p, size_t stride, SimdFloat &a, SimdFloat &b, SimdFloat &c, SimdFloat &d)
+{
+	__m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 4 * stride), 1);
+	__m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + stride)), _mm_loadu_ps(p + 5 * stride), 1);
+	__m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 2 * stride)), _mm_loadu_ps(p + 6 * stride), 1);
+	__m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 3 * stride)), _mm_loadu_ps(p + 7 * stride), 1);
+
+	__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	__m256 t1 = _mm256_unpacklo_ps(r2, r3);
+	__m256 t2 = _mm256_unpackhi_ps(r0, r1);
+	__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+	a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// SimdLoadStrided4 的逆操作
+
+inline void SimdStoreStrided4(float *p, size_t stride, SimdFloat a, SimdFloat b, SimdFloat c, SimdFloat d)
+{
+	__m256 t0 = _mm256_unpacklo_ps(a, b);
+	__m256 t1 = _mm256_unpacklo_ps(c, d);
+	__m256 t2 = _mm256_unpackhi_ps(a, b);
+	__m256 t3 = _mm256_unpackhi_ps(c, d);
+
+	__m256 r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+	_mm_storeu_ps(p, _mm256_castps256_ps128(r0));
+	_mm_storeu_ps(p + stride, _mm256_castps256_ps128(r1));
+	_mm_storeu_ps(p + 2 * stride, _mm256_castps256_ps128(r2));
+	_mm_storeu_ps(p + 3 * stride, _mm256_castps256_ps128(r3));
+	_mm_storeu_ps(p + 4 * stride, _mm256_extractf128_ps(r0, 1));
+	_mm_storeu_ps(p + 5 * stride, _mm256_extractf128_ps(r1, 1));
+	_mm_storeu_ps(p + 6 * stride, _mm256_extractf128_ps(r2, 1));
+	_mm_storeu_ps(p + 7 * stride, _mm256_extractf128_ps(r3, 1));
+}
+
+#elif defined(WANDER_SIMD_SSE)
+
+typedef __m128  SimdFloat;
+typedef __m128  SimdMask;
+typedef __m128i SimdInt;
+
+const size_t KSIMDWIDTH = 4;
+
+inline SimdFloat SimdSet1(float a)								{ return _mm_set1_ps(a); }
+inline SimdFloat SimdZero()										{ return _mm_setzero_ps(); }
+inline SimdFloat SimdLoad(const float *p)						{ return _mm_loadu_ps(p); }
+inline void		 SimdStore(float *p, SimdFloat a)				{ _mm_storeu_ps(p, a); }
+inline void		 SimdStream(float *p, SimdFloat a)				{ _mm_stream_ps(p, a); }
+
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b)				{ return _mm_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b)				{ return _mm_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b)				{ return _mm_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)				{ return _mm_div_ps(a, b); }
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline SimdFloat SimdNegMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b)				{ return _mm_min_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b)				{ return _mm_max_ps(a, b); }
+inline SimdFloat SimdSqrt(SimdFloat a)							{ return _mm_sqrt_ps(a); }
+
+inline SimdMask  SimdCmpLt(SimdFloat a, SimdFloat b)			{ return _mm_cmplt_ps(a, b); }
+inline SimdMask  SimdCmpLe(SimdFloat a, SimdFloat b)			{ return _mm_cmple_ps(a, b); }
+inline SimdMask  SimdCmpGt(SimdFloat a, SimdFloat b)			{ return _mm_cmpgt_ps(a, b); }
+inline SimdMask  SimdCmpGe(SimdFloat a, SimdFloat b)			{ return _mm_cmpge_ps(a, b); }
+inline SimdMask  SimdMaskAnd(SimdMask a, SimdMask b)			{ return _mm_and_ps(a, b); }
+inline SimdMask  SimdMaskOr(SimdMask a, SimdMask b)				{ return _mm_or_ps(a, b); }
+inline int		 SimdMaskBits(SimdMask m)						{ return _mm_movemask_ps(m); }
+
+// SSE2没有blendv，用位运算合成
+
+inline SimdFloat SimdSelect(SimdMask m, SimdFloat a, SimdFloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+inline SimdFloat SimdAbs(SimdFloat a)		{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline SimdFloat SimdSignBit(SimdFloat a)	{ return _mm_and_ps(_mm_set1_ps(-0.0f), a); }
+inline SimdFloat SimdXor(SimdFloat a, SimdFloat b) { return _mm_xor_ps(a, b); }
+
+inline SimdInt	 SimdRoundToInt(SimdFloat a)					{ return _mm_cvtps_epi32(a); }
+inline SimdFloat SimdIntToFloat(SimdInt a)						{ return _mm_cvtepi32_ps(a); }
+inline SimdInt	 SimdIntAnd(SimdInt a, int b)					{ return _mm_and_si128(a, _mm_set1_epi32(b)); }
+inline SimdInt	 SimdIntAdd(SimdInt a, int b)					{ return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+inline SimdInt	 SimdIntShiftLeft(SimdInt a, int n)				{ return _mm_slli_epi32(a, n); }
+inline SimdMask  SimdIntIsZero(SimdInt a)						{ return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_setzero_si128())); }
+inline SimdFloat SimdIntAsFloat(SimdInt a)						{ return _mm_castsi128_ps(a); }
+inline SimdInt	 SimdFloatAsInt(SimdFloat a)					{ return _mm_castps_si128(a); }
+inline SimdInt	 SimdIntLoad(const int *p)						{ return _mm_loadu_si128((const __m128i *)p); }
+inline void		 SimdIntStore(int *p, SimdInt a)				{ _mm_storeu_si128((__m128i *)p, a); }
+inline SimdInt	 SimdIntOr(SimdInt a, SimdInt b)				{ return _mm_or_si128(a, b); }
+inline SimdInt	 SimdIntShiftRight(SimdInt a, int n)			{ return _mm_srli_epi32(a, n); }
+
+inline void SimdFence() { _mm_sfence(); }
+
+inline void SimdLoadStrided4(const float *p, size_t stride, SimdFloat &a, SimdFloat &b, SimdFloat &c, SimdFloat &d)
+{
+	a = _mm_loadu_ps(p);
+	b = _mm_loadu_ps(p + stride);
+	c = _mm_loadu_ps(p + 2 * stride);
+	d = _mm_loadu_ps(p + 3 * stride);
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+inline void SimdStoreStrided4(float *p, size_t stride, SimdFloat a, SimdFloat b, SimdFloat c, SimdFloat d)
+{
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+	_mm_storeu_ps(p, a);
+	_mm_storeu_ps(p + stride, b);
+	_mm_storeu_ps(p + 2 * stride, c);
+	_mm_storeu_ps(p + 3 * stride, d);
+}
+
+#else
+
+// 标量退化版本
+
+typedef float SimdFloat;
+typedef bool  SimdMask;
+typedef int   SimdInt;
+
+const size_t KSIMDWIDTH = 1;
+
+inline SimdFloat SimdSet1(float a)								{ return a; }
+inline SimdFloat SimdZero()										{ return 0.0f; }
+inline SimdFloat SimdLoad(const float *p)						{ return *p; }
+inline void		 SimdStore(float *p, SimdFloat a)				{ *p = a; }
+inline void		 SimdStream(float *p, SimdFloat a)				{ *p = a; }
+
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b)				{ return a + b; }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b)				{ return a - b; }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b)				{ return a * b; }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)				{ return a / b; }
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return a * b + c; }
+inline SimdFloat SimdNegMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return c - a * b; }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b)				{ return a < b ? a : b; }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b)				{ return a > b ? a : b; }
+inline SimdFloat SimdSqrt(SimdFloat a)							{ return std::sqrt(a); }
+
+inline SimdMask  SimdCmpLt(SimdFloat a, SimdFloat b)			{ return a < b; }
+inline SimdMask  SimdCmpLe(SimdFloat a, SimdFloat b)			{ return a <= b; }
+inline SimdMask  SimdCmpGt(SimdFloat a, SimdFloat b)			{ return a > b; }
+inline SimdMask  SimdCmpGe(SimdFloat a, SimdFloat b)			{ return a >= b; }
+inline SimdMask  SimdMaskAnd(SimdMask a, SimdMask b)			{ return a && b; }
+inline SimdMask  SimdMaskOr(SimdMask a, SimdMask b)				{ return a || b; }
+inline int		 SimdMaskBits(SimdMask m)						{ return m ? 1 : 0; }
+
+inline SimdFloat SimdSelect(SimdMask m, SimdFloat a, SimdFloat b) { return m ? a : b; }
+
+inline SimdFloat SimdAbs(SimdFloat a)		{ return std::fabs(a); }
+inline SimdFloat SimdSignBit(SimdFloat a)	{ return std::signbit(a) ? -0.0f : 0.0f; }
+
+// 仅用于按符号位翻转：b为0.0f或-0.0f
+
+inline SimdFloat SimdXor(SimdFloat a, SimdFloat b) { return std::signbit(b) ? -a : a; }
+
+inline SimdInt	 SimdRoundToInt(SimdFloat a)					{ return (int)std::nearbyint(a); }
+inline SimdFloat SimdIntToFloat(SimdInt a)						{ return (float)a; }
+inline SimdInt	 SimdIntAnd(SimdInt a, int b)					{ return a & b; }
+inline SimdInt	 SimdIntAdd(SimdInt a, int b)					{ return a + b; }
+inline SimdInt	 SimdIntShiftLeft(SimdInt a, int n)				{ return (int)((unsigned)a << n); }
+inline SimdMask  SimdIntIsZero(SimdInt a)						{ return a == 0; }
+inline SimdFloat SimdIntAsFloat(SimdInt a)						{ float f; memcpy(&f, &a, sizeof(f)); return f; }
+inline SimdInt	 SimdFloatAsInt(SimdFloat a)					{ int i; memcpy(&i, &a, sizeof(i)); return i; }
+inline SimdInt	 SimdIntLoad(const int *p)						{ return *p; }
+inline void		 SimdIntStore(int *p, SimdInt a)				{ *p = a; }
+inline SimdInt	 SimdIntOr(SimdInt a, SimdInt b)				{ return a | b; }
+inline SimdInt	 SimdIntShiftRight(SimdInt a, int n)			{ return (int)((unsigned)a >> n); }
+
+inline void SimdFence() {}
+
+inline void SimdLoadStrided4(const float *p, size_t, SimdFloat &a, SimdFloat &b, SimdFloat &c, SimdFloat &d)
+{
+	a = p[0]; b = p[1]; c = p[2]; d = p[3];
+}
+
+inline void SimdStoreStrided4(float *p, size_t, SimdFloat a, SimdFloat b, SimdFloat c, SimdFloat d)
+{
+	p[0] = a; p[1] = b; p[2] = c; p[3] = d;
+}
+
+#endif
+
+// 连续存放的4个float的结构（如Quaternion）
+
+inline void SimdLoadAoS4(const float *p, SimdFloat &a, SimdFloat &b, SimdFloat &c, SimdFloat &d)
+{
+	SimdLoadStrided4(p, 4, a, b, c, d);
+}
+
+inline void SimdStoreAoS4(float *p, SimdFloat a, SimdFloat b, SimdFloat c, SimdFloat d)
+{
+	SimdStoreStrided4(p, 4, a, b, c, d);
+}
+
+#endif
@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: SimdMath.h
+// func: 基于SimdFloat的多项式超越函数
+// disc: 多项式系数来源于Cephes库的单精度实现，每个通道独立计算，
+//		 没有分支，可直接用于批量内核
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_SimdMath_h
+#define Wander_SimdMath_h
+
+#include "Simd.h"
+#include "CommonMath.h"
+
+///////////////////////////////////////////////////////////////////
+//
+// 基础多项式，输入范围 [-PI/4, PI/4]
+//
+///////////////////////////////////////////////////////////////////
+
+inline SimdFloat SimdSinPoly(SimdFloat x)
+{
+	SimdFloat z = SimdMul(x, x);
+	SimdFloat y = SimdMulAdd(SimdSet1(-1.9515295891e-4f), z, SimdSet1(8.3321608736e-3f));
+	y = SimdMulAdd(y, z, SimdSet1(-1.6666654611e-1f));
+	y = SimdMul(SimdMul(y, z), x);
+	return SimdAdd(y, x);
+}
+
+inline SimdFloat SimdCosPoly(SimdFloat x)
+{
+	SimdFloat z = SimdMul(x, x);
+	SimdFloat y = SimdMulAdd(SimdSet1(2.443315711809948e-5f), z, SimdSet1(-1.388731625493765e-3f));
+	y = SimdMulAdd(y, z, SimdSet1(4.166664568298827e-2f));
+	y = SimdMul(SimdMul(y, z), z);
+	return SimdAdd(SimdNegMulAdd(SimdSet1(0.5f), z, SimdSet1(1.0f)), y);
+}
+
+// 输入范围 [-1, 1] 的反正切
+
+inline SimdFloat SimdAtanUnit(SimdFloat x)
+{
+	// 以 tan(PI/8) 为界，大于它时用 atan(x) = PI/4 + atan((x-1)/(x+1))
+
+	SimdFloat ax = SimdAbs(x);
+	SimdMask big = SimdCmpGt(ax, SimdSet1(0.4142135623730950f));
+	SimdFloat r = SimdSelect(big, SimdDiv(SimdSub(ax, SimdSet1(1.0f)), SimdAdd(ax, SimdSet1(1.0f))), ax);
+	SimdFloat base = SimdSelect(big, SimdSet1(KPI * 0.25f), SimdZero());
+
+	SimdFloat z = SimdMul(r, r);
+	SimdFloat y = SimdMulAdd(SimdSet1(8.05374449538e-2f), z, SimdSet1(-1.38776856032e-1f));
+	y = SimdMulAdd(y, z, SimdSet1(1.99777106478e-1f));
+	y = SimdMulAdd(y, z, SimdSet1(-3.33329491539e-1f));
+	y = SimdMulAdd(SimdMul(y, z), r, r);
+
+	return SimdXor(SimdAdd(base, y), SimdSignBit(x));
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// 限定范围的函数，省去通用的周期归约
+//
+///////////////////////////////////////////////////////////////////
+
+// 输入范围 [0, PI/2] 的正弦，大于PI/4时用 cos(PI/2 - x)
+
+inline SimdFloat SimdSinHalfPi(SimdFloat x)
+{
+	SimdMask upper = SimdCmpGt(x, SimdSet1(KPI * 0.25f));
+	SimdFloat s = SimdSinPoly(x);
+	SimdFloat c = SimdCosPoly(SimdSub(SimdSet1(KPIOVER2), x));
+	return SimdSelect(upper, c, s);
+}
+
+// y >= 0 且 x >= 0 时的 atan2(y, x)，结果在 [0, PI/2]
+
+inline SimdFloat SimdAtan2Positive(SimdFloat y, SimdFloat x)
+{
+	SimdFloat num = SimdMin(y, x);
+	SimdFloat den = SimdMax(SimdMax(y, x), SimdSet1(1e-30f));
+	SimdFloat a = SimdAtanUnit(SimdDiv(num, den));
+	return SimdSelect(SimdCmpGt(y, x), SimdSub(SimdSet1(KPIOVER2), a), a);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// 通用sin/cos
+//
+///////////////////////////////////////////////////////////////////
+
+// SimdSinCos
+//
+// 同时计算sin和cos，两者共用一次周期归约：
+// x = q * PI/2 + r，r 在 [-PI/4, PI/4]，PI/2 拆成三段(Cody-Waite)以减小
+// 相减时的舍入误差，再按 q 的低两位选择 sin(r)/cos(r) 并决定符号
+// 误差：|x| <= 8192 时绝对误差不超过 1e-7，结果绝对值不小于1e-3时
+// 不超过 2 ULP（实测 1.57 ULP）；更大的输入没有做Payne-Hanek归约，
+// 无FMA时误差随|x|增长（|x| = 1e5 时绝对误差约 1e-6）
+
+inline void SimdSinCos(SimdFloat x, SimdFloat &outSin, SimdFloat &outCos)
+{
+	SimdInt q = SimdRoundToInt(SimdMul(x, SimdSet1(0.63661977236758134f)));
+	SimdFloat fq = SimdIntToFloat(q);
+
+	SimdFloat r = SimdNegMulAdd(fq, SimdSet1(1.5703125f), x);
+	r = SimdNegMulAdd(fq, SimdSet1(4.837512969970703125e-4f), r);
+	r = SimdNegMulAdd(fq, SimdSet1(7.54978995489188216e-8f), r);
+
+	SimdFloat s = SimdSinPoly(r);
+	SimdFloat c = SimdCosPoly(r);
+
+	// q为奇数时 sin 与 cos 互换
+
+	SimdMask even = SimdIntIsZero(SimdIntAnd(q, 1));
+	SimdFloat rs = SimdSelect(even, s, c);
+	SimdFloat rc = SimdSelect(even, c, s);
+
+	// sin 在 q&2 时取反，cos 在 (q+1)&2 时取反，符号位由整数移位得到
+
+	SimdFloat sinSign = SimdIntAsFloat(SimdIntShiftLeft(SimdIntAnd(q, 2), 30));
+	SimdFloat cosSign = SimdIntAsFloat(SimdIntShiftLeft(SimdIntAnd(SimdIntAdd(q, 1), 2), 30));
+
+	outSin = SimdXor(rs, sinSign);
+	outCos = SimdXor(rc, cosSign);
+}
+
+inline SimdFloat SimdSin(SimdFloat x)
+{
+	SimdFloat s, c;
+	SimdSinCos(x, s, c);
+	return s;
+}
+
+inline SimdFloat SimdCos(SimdFloat x)
+{
+	SimdFloat s, c;
+	SimdSinCos(x, s, c);
+	return c;
+}
+
+#endif
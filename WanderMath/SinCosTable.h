@@ -0,0 +1,204 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: SinCosTable.h
+// func: 编译期生成的sin/cos查询表
+// disc: StepsPerDegree 为每度的采样数，1 -> 1度，4 -> 0.25度，
+//		 100 -> 0.01度；T 为表中元素的类型
+//		 表在编译期用泰勒级数计算，放在只读数据段中，无需初始化，
+//		 多线程同时读取也是安全的
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_SinCosTable_h
+#define Wander_SinCosTable_h
+
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////
+//
+// 编译期sin
+//
+///////////////////////////////////////////////////////////////////
+
+// 输入为 [-PI/4, PI/4] 的弧度，10项泰勒级数在此范围内误差小于1e-20
+
+constexpr double ConstexprSinRad(double x)
+{
+	double x2 = x * x;
+	double term = x;
+	double sum = x;
+
+	for (int k = 1; k < 10; k++)
+	{
+		term *= -x2 / ((2.0 * k) * (2.0 * k + 1.0));
+		sum += term;
+	}
+
+	return sum;
+}
+
+constexpr double ConstexprCosRad(double x)
+{
+	double x2 = x * x;
+	double term = 1.0;
+	double sum = 1.0;
+
+	for (int k = 1; k < 10; k++)
+	{
+		term *= -x2 / ((2.0 * k - 1.0) * (2.0 * k));
+		sum += term;
+	}
+
+	return sum;
+}
+
+// 输入为角度，利用对称性化到 [-45, 45]，90度的整数倍给出精确值
+
+constexpr double ConstexprSinDeg(double deg)
+{
+	const double degToRad = 3.14159265358979323846 / 180.0;
+
+	while (deg > 180.0)
+	{
+		deg -= 360.0;
+	}
+
+	while (deg < -180.0)
+	{
+		deg += 360.0;
+	}
+
+	// sin(x) = sin(180 - x)，化到 [-90, 90]
+
+	if (deg > 90.0)
+	{
+		deg = 180.0 - deg;
+	}
+	else if (deg < -90.0)
+	{
+		deg = -180.0 - deg;
+	}
+
+	if (deg == 0.0)
+	{
+		return 0.0;
+	}
+
+	if (deg > 45.0)
+	{
+		return ConstexprCosRad((90.0 - deg) * degToRad);
+	}
+
+	if (deg < -45.0)
+	{
+		return -ConstexprCosRad((90.0 + deg) * degToRad);
+	}
+
+	return ConstexprSinRad(deg * degToRad);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// SinCosTable
+//
+///////////////////////////////////////////////////////////////////
+
+template <int StepsPerDegree, class T = float>
+class SinCosTable
+{
+public:
+	static_assert(StepsPerDegree > 0, "StepsPerDegree must be positive");
+
+	// 一周的采样数，表多存一项以便插值时不必回绕
+
+	static const int KSTEPS = 360 * StepsPerDegree;
+
+	constexpr SinCosTable()
+		: sinTable()
+		, cosTable()
+	{
+		for (int i = 0; i <= KSTEPS; i++)
+		{
+			double deg = (double)i / StepsPerDegree;
+
+			sinTable[i] = (T)ConstexprSinDeg(deg);
+			cosTable[i] = (T)ConstexprSinDeg(deg + 90.0);
+		}
+	}
+
+	// 输入为角度
+
+	T Sin(T angle) const
+	{
+		return Lookup(sinTable, angle * (T)StepsPerDegree);
+	}
+
+	T Cos(T angle) const
+	{
+		return Lookup(cosTable, angle * (T)StepsPerDegree);
+	}
+
+	// 输入为弧度，直接换算成表的下标，不经过角度和fmod
+
+	T SinRad(T rad) const
+	{
+		return Lookup(sinTable, rad * (T)(StepsPerDegree * 57.295779513082320876798));
+	}
+
+	T CosRad(T rad) const
+	{
+		return Lookup(cosTable, rad * (T)(StepsPerDegree * 57.295779513082320876798));
+	}
+
+private:
+
+	// 不依赖SSE4.1的floor，用截断再修正，避免调用libm
+
+	static T Floor(T x)
+	{
+		T t = (T)(long long)x;
+		return t > x ? t - 1 : t;
+	}
+
+	// pos为以表项为单位的位置，先按整周回绕，再取整数部分查表、小数部分线性插值
+	// 回绕用一次乘法和取整完成，避免fmod和整数除法
+
+	static T Lookup(const T *table, T pos)
+	{
+		pos -= Floor(pos * ((T)1 / KSTEPS)) * KSTEPS;
+
+		T fl = Floor(pos);
+		T frac = pos - fl;
+		int index = (int)fl;
+
+		// 舍入误差可能使 pos 恰好等于 KSTEPS
+
+		if (index >= KSTEPS)
+		{
+			index -= KSTEPS;
+		}
+		else if (index < 0)
+		{
+			index += KSTEPS;
+		}
+
+		return table[index] + frac * (table[index + 1] - table[index]);
+	}
+
+public:
+	T sinTable[KSTEPS + 1];
+	T cosTable[KSTEPS + 1];
+};
+
+// 常用精度
+
+typedef SinCosTable<1>   SinCosTable1Deg;
+typedef SinCosTable<4>   SinCosTableQuarterDeg;
+typedef SinCosTable<100> SinCosTableCentiDeg;
+
+// 每种精度只在第一次使用时实例化一份
+
+template <int StepsPerDegree, class T = float>
+inline constexpr SinCosTable<StepsPerDegree, T> gSinCosTable{};
+
+#endif
@@ -0,0 +1,179 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: SlerpStepper.cpp
+// func: 以固定步长连续求 Slerp 的步进器
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+
+#include "SlerpStepper.h"
+#include "CommonMath.h"
+
+// d += k * q，offset += d，q = base + offset
+// 每步的增量累加到相对起点的偏移上，而不是直接加到接近1的分量上；
+// 弧很短时增量远小于分量的舍入单位，直接相加会丢掉大部分
+// k * q 拆成 k * base + k * offset，前者不变，q 不在逐步的依赖链上
+
+static inline void Step(const Quaternion &base, Quaternion &offset, Quaternion &delta, float k, Quaternion &cur)
+{
+	delta.w += k * base.w + k * offset.w;
+	delta.x += k * base.x + k * offset.x;
+	delta.y += k * base.y + k * offset.y;
+	delta.z += k * base.z + k * offset.z;
+
+	offset.w += delta.w;
+	offset.x += delta.x;
+	offset.y += delta.y;
+	offset.z += delta.z;
+
+	cur.w = base.w + offset.w;
+	cur.x = base.x + offset.x;
+	cur.y = base.y + offset.y;
+	cur.z = base.z + offset.z;
+}
+
+// 递推是线性的，q 与 d 乘以同一比例后仍满足递推关系；
+// 起点不变，q * scale - base = offset * scale + base * (scale - 1)
+
+static inline void RenormalizePair(const Quaternion &base, Quaternion &offset, Quaternion &delta, Quaternion &cur)
+{
+	float scale = 1.0f / sqrt(DotProduct(cur, cur));
+	float shrink = scale - 1.0f;
+
+	offset.w = offset.w * scale + base.w * shrink;
+	offset.x = offset.x * scale + base.x * shrink;
+	offset.y = offset.y * scale + base.y * shrink;
+	offset.z = offset.z * scale + base.z * shrink;
+
+	delta.w *= scale;
+	delta.x *= scale;
+	delta.y *= scale;
+	delta.z *= scale;
+
+	cur.w = base.w + offset.w;
+	cur.x = base.x + offset.x;
+	cur.y = base.y + offset.y;
+	cur.z = base.z + offset.z;
+}
+
+SlerpStepper::SlerpStepper()
+	: m_cur(gQuaternionIdentity)
+	, m_base(gQuaternionIdentity)
+	, m_offset({ 0.0f, 0.0f, 0.0f, 0.0f })
+	, m_delta({ 0.0f, 0.0f, 0.0f, 0.0f })
+	, m_coeff(0.0f)
+	, m_steps(0)
+{
+}
+
+SlerpStepper::SlerpStepper(const Quaternion &q0, const Quaternion &q1, float t0, float dt)
+{
+	Setup(q0, q1, t0, dt);
+}
+
+// SlerpStepper::Setup
+//
+// 用双精度直接算出 t0 - dt 与 t0 两处的结果作为递推的前两项，
+// 夹角很小时系数退化为线性插值，此时递推系数接近0，同样成立
+
+void SlerpStepper::Setup(const Quaternion &q0, const Quaternion &q1, float t0, float dt)
+{
+	double a[4] = { q0.w, q0.x, q0.y, q0.z };
+	double b[4] = { q1.w, q1.x, q1.y, q1.z };
+
+	double cosOmega = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+
+	if (cosOmega < 0.0)
+	{
+		cosOmega = -cosOmega;
+
+		for (int k = 0; k < 4; k++)
+		{
+			b[k] = -b[k];
+		}
+	}
+
+	assert(cosOmega < 1.1);
+
+	double sinOmega = sqrt(MAX(1.0 - cosOmega*cosOmega, 0.0));
+	double omega = atan2(sinOmega, cosOmega);
+
+	double t[2] = { (double)t0 - dt, (double)t0 };
+	double seed[2][4];
+
+	for (int i = 0; i < 2; i++)
+	{
+		double k0 = 1.0 - t[i];
+		double k1 = t[i];
+
+		if (sinOmega > 1e-6)
+		{
+			k0 = sin(k0 * omega) / sinOmega;
+			k1 = sin(k1 * omega) / sinOmega;
+		}
+
+		for (int k = 0; k < 4; k++)
+		{
+			seed[i][k] = k0*a[k] + k1*b[k];
+		}
+	}
+
+	m_cur.w = (float)seed[1][0];
+	m_cur.x = (float)seed[1][1];
+	m_cur.y = (float)seed[1][2];
+	m_cur.z = (float)seed[1][3];
+
+	m_base = m_cur;
+	m_offset.w = m_offset.x = m_offset.y = m_offset.z = 0.0f;
+
+	m_delta.w = (float)(seed[1][0] - seed[0][0]);
+	m_delta.x = (float)(seed[1][1] - seed[0][1]);
+	m_delta.y = (float)(seed[1][2] - seed[0][2]);
+	m_delta.z = (float)(seed[1][3] - seed[0][3]);
+
+	double halfStep = sin(0.5 * dt * omega);
+	m_coeff = (float)(-4.0 * halfStep * halfStep);
+	m_steps = 0;
+}
+
+const Quaternion &SlerpStepper::Next()
+{
+	Step(m_base, m_offset, m_delta, m_coeff, m_cur);
+
+	if (++m_steps % KSLERPSTEPPERRENORMALIZE == 0)
+	{
+		RenormalizePair(m_base, m_offset, m_delta, m_cur);
+	}
+
+	return m_cur;
+}
+
+// 状态放在局部变量中，避免每步写回成员
+
+void SlerpStepper::Fill(Quaternion *out, size_t n)
+{
+	Quaternion cur = m_cur;
+	Quaternion base = m_base;
+	Quaternion offset = m_offset;
+	Quaternion delta = m_delta;
+	float k = m_coeff;
+	unsigned steps = m_steps;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		out[i] = cur;
+		Step(base, offset, delta, k, cur);
+
+		if (++steps % KSLERPSTEPPERRENORMALIZE == 0)
+		{
+			RenormalizePair(base, offset, delta, cur);
+		}
+	}
+
+	m_cur = cur;
+	m_offset = offset;
+	m_delta = delta;
+	m_steps = steps;
+}
@@ -0,0 +1,608 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: SpatialHash2D.cpp
+// func: 二维均匀网格空间哈希
+//
+///////////////////////////////////////////////////////////////////
+
+#include <climits>
+#include <cstring>
+
+#include "SpatialHash2D.h"
+#include "JobPool.h"
+
+// 哈希表最小的桶数
+
+static const uint32_t KSPATIALMINTABLE = 64;
+
+// 稠密网格的格子数上限与点数之比
+
+static const uint64_t KSPATIALDENSERATIO = 4;
+
+// QueryRadiusAll 每块的查询数
+
+static const size_t KSPATIALQUERYGRAIN = 4096;
+
+SpatialHash2D::SpatialHash2D(float cellSize)
+	: m_builtInvCellSize(1.0f)
+	, m_tableMask(0)
+	, m_dense(false)
+	, m_gridMinX(0)
+	, m_gridMinY(0)
+	, m_gridWidth(0)
+	, m_gridHeight(0)
+	, m_minCellX(INT_MAX)
+	, m_minCellY(INT_MAX)
+	, m_maxCellX(INT_MIN)
+	, m_maxCellY(INT_MIN)
+{
+	SetCellSize(cellSize);
+}
+
+void SpatialHash2D::SetCellSize(float cellSize)
+{
+	assert(cellSize > 0.0f);
+	m_cellSize = cellSize;
+	m_invCellSize = 1.0f / cellSize;
+}
+
+// 不调用floor，截断后对负数修正
+
+inline int SpatialHash2D::CellCoord(float v) const
+{
+	float s = v * m_builtInvCellSize;
+	int c = (int)s;
+	return c - (s < (float)c ? 1 : 0);
+}
+
+// 稠密网格按行展开；否则两个大素数相乘后异或，再取低位
+
+inline uint32_t SpatialHash2D::Bucket(int cx, int cy) const
+{
+	if (m_dense)
+	{
+		return (uint32_t)(cy - m_gridMinY) * (uint32_t)m_gridWidth + (uint32_t)(cx - m_gridMinX);
+	}
+
+	uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+	return h & m_tableMask;
+}
+
+void SpatialHash2D::Build(const Point2D *points, size_t n)
+{
+	assert(n <= (size_t)INT_MAX);
+
+	m_posX.resize(n);
+	m_posY.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		m_posX[i] = points[i].x;
+		m_posY[i] = points[i].y;
+	}
+
+	Rebuild();
+}
+
+void SpatialHash2D::Rebuild()
+{
+	size_t n = m_posX.size();
+
+	m_builtInvCellSize = m_invCellSize;
+	m_moved.clear();
+
+	m_minCellX = INT_MAX;
+	m_minCellY = INT_MAX;
+	m_maxCellX = INT_MIN;
+	m_maxCellY = INT_MIN;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		int cx = CellCoord(m_posX[i]);
+		int cy = CellCoord(m_posY[i]);
+
+		m_minCellX = MIN(m_minCellX, cx);
+		m_minCellY = MIN(m_minCellY, cy);
+		m_maxCellX = MAX(m_maxCellX, cx);
+		m_maxCellY = MAX(m_maxCellY, cy);
+	}
+
+	// 格子总数不超过点数的 KSPATIALDENSERATIO 倍时用稠密网格，
+	// 否则桶数取不小于2n的2的幂，平均每个桶不到半个点
+
+	uint64_t cells = n == 0 ? 0 : (uint64_t)((int64_t)m_maxCellX - m_minCellX + 1) * (uint64_t)((int64_t)m_maxCellY - m_minCellY + 1);
+	uint32_t tableSize;
+
+	m_dense = n > 0 && cells <= (uint64_t)n * KSPATIALDENSERATIO + KSPATIALMINTABLE;
+
+	if (m_dense)
+	{
+		m_gridMinX = m_minCellX;
+		m_gridMinY = m_minCellY;
+		m_gridWidth = m_maxCellX - m_minCellX + 1;
+		m_gridHeight = m_maxCellY - m_minCellY + 1;
+		tableSize = (uint32_t)cells;
+	}
+	else
+	{
+		tableSize = KSPATIALMINTABLE;
+
+		while (tableSize < n * 2)
+		{
+			tableSize *= 2;
+		}
+
+		m_tableMask = tableSize - 1;
+	}
+
+	// 计数排序：先统计每个桶的点数，前缀和得到起始位置，再散布
+
+	m_cellStart.assign(tableSize + 1, 0);
+	m_slot.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		// 暂存桶号，散布时不必再算一次
+
+		uint32_t b = Bucket(CellCoord(m_posX[i]), CellCoord(m_posY[i]));
+		m_slot[i] = (int)b;
+		m_cellStart[b + 1]++;
+	}
+
+	for (uint32_t b = 0; b < tableSize; b++)
+	{
+		m_cellStart[b + 1] += m_cellStart[b];
+	}
+
+	m_sortedX.resize(n);
+	m_sortedY.resize(n);
+	m_sortedId.resize(n);
+
+	// 借用 m_cellStart[b] 作为写指针，散布完后它变成 b + 1 的起点，再整体右移一位
+
+	for (size_t i = 0; i < n; i++)
+	{
+		uint32_t b = (uint32_t)m_slot[i];
+		uint32_t dst = m_cellStart[b]++;
+
+		m_sortedX[dst] = m_posX[i];
+		m_sortedY[dst] = m_posY[i];
+		m_sortedId[dst] = (int)i;
+		m_slot[i] = (int)dst;
+	}
+
+	for (uint32_t b = tableSize; b > 0; b--)
+	{
+		m_cellStart[b] = m_cellStart[b - 1];
+	}
+
+	m_cellStart[0] = 0;
+}
+
+void SpatialHash2D::Move(int id, const Point2D &p)
+{
+	assert(id >= 0 && (size_t)id < m_posX.size());
+
+	m_posX[id] = p.x;
+	m_posY[id] = p.y;
+
+	int slot = m_slot[id];
+
+	if (slot < 0)
+	{
+		return;
+	}
+
+	int cx = CellCoord(p.x);
+	int cy = CellCoord(p.y);
+
+	if (cx == CellCoord(m_sortedX[slot]) && cy == CellCoord(m_sortedY[slot]))
+	{
+		m_sortedX[slot] = p.x;
+		m_sortedY[slot] = p.y;
+		return;
+	}
+
+	// 换了格子，从排序数组中移出
+
+	m_sortedId[slot] = KNOEXCLUDE;
+	m_slot[id] = -1;
+	m_moved.push_back(id);
+
+	m_minCellX = MIN(m_minCellX, cx);
+	m_minCellY = MIN(m_minCellY, cy);
+	m_maxCellX = MAX(m_maxCellX, cx);
+	m_maxCellY = MAX(m_maxCellY, cy);
+}
+
+// 哈希表的桶中可能混有冲突的其他格子，只接受确实落在 (cx, cy) 中的点，
+// 这样范围内两个格子共用一个桶时也不会重复；稠密网格没有冲突
+
+template <class Fn>
+void SpatialHash2D::ScanCell(int cx, int cy, const Point2D &center, const Fn &fn) const
+{
+	ScanRow(cx, cx, cy, center, fn);
+}
+
+template <class Fn>
+void SpatialHash2D::ScanRow(int cx0, int cx1, int cy, const Point2D &center, const Fn &fn) const
+{
+	if (m_dense)
+	{
+		// Move 扩大的范围可能超出网格，超出部分只有移动列表中的点
+
+		cx0 = MAX(cx0, m_gridMinX);
+		cx1 = MIN(cx1, m_gridMinX + m_gridWidth - 1);
+
+		if (cx0 > cx1 || cy < m_gridMinY || cy >= m_gridMinY + m_gridHeight)
+		{
+			return;
+		}
+
+		// 一行中相邻的格子连续存放，整段扫描
+
+		uint32_t end = m_cellStart[Bucket(cx1, cy) + 1];
+
+		for (uint32_t i = m_cellStart[Bucket(cx0, cy)]; i < end; i++)
+		{
+			int id = m_sortedId[i];
+
+			if (id < 0)
+			{
+				continue;
+			}
+
+			float dx = m_sortedX[i] - center.x;
+			float dy = m_sortedY[i] - center.y;
+			fn(id, dx * dx + dy * dy);
+		}
+
+		return;
+	}
+
+	for (int cx = cx0; cx <= cx1; cx++)
+	{
+		uint32_t b = Bucket(cx, cy);
+		uint32_t end = m_cellStart[b + 1];
+
+		for (uint32_t i = m_cellStart[b]; i < end; i++)
+		{
+			float x = m_sortedX[i];
+			float y = m_sortedY[i];
+			int id = m_sortedId[i];
+
+			if (id < 0 || CellCoord(x) != cx || CellCoord(y) != cy)
+			{
+				continue;
+			}
+
+			float dx = x - center.x;
+			float dy = y - center.y;
+			fn(id, dx * dx + dy * dy);
+		}
+	}
+}
+
+template <class Fn>
+void SpatialHash2D::ScanMoved(const Point2D &center, const Fn &fn) const
+{
+	for (size_t i = 0; i < m_moved.size(); i++)
+	{
+		int id = m_moved[i];
+		float dx = m_posX[id] - center.x;
+		float dy = m_posY[id] - center.y;
+		fn(id, dx * dx + dy * dy);
+	}
+}
+
+size_t SpatialHash2D::QueryRadius(const Point2D &center, float radius, std::vector<int> &out, int excludeId) const
+{
+	size_t before = out.size();
+	float radiusSq = radius * radius;
+
+	auto accept = [&](int id, float distSq)
+	{
+		if (distSq <= radiusSq && id != excludeId)
+		{
+			out.push_back(id);
+		}
+	};
+
+	ScanMoved(center, accept);
+
+	if (m_sortedId.empty())
+	{
+		return out.size() - before;
+	}
+
+	// 覆盖查询圆的格子范围，再限制在有点的范围内
+
+	int x0 = MAX(CellCoord(center.x - radius), m_minCellX);
+	int x1 = MIN(CellCoord(center.x + radius), m_maxCellX);
+	int y0 = MAX(CellCoord(center.y - radius), m_minCellY);
+	int y1 = MIN(CellCoord(center.y + radius), m_maxCellY);
+
+	if (!m_dense)
+	{
+		for (int cy = y0; cy <= y1; cy++)
+		{
+			ScanRow(x0, x1, cy, center, accept);
+		}
+
+		return out.size() - before;
+	}
+
+	// 稠密网格：先按各行的点数预留空间，每个候选点都写入，
+	// 再按是否命中推进写指针，避免难以预测的分支
+
+	x0 = MAX(x0, m_gridMinX);
+	x1 = MIN(x1, m_gridMinX + m_gridWidth - 1);
+	y0 = MAX(y0, m_gridMinY);
+	y1 = MIN(y1, m_gridMinY + m_gridHeight - 1);
+
+	if (x0 > x1 || y0 > y1)
+	{
+		return out.size() - before;
+	}
+
+	size_t capacity = 0;
+
+	for (int cy = y0; cy <= y1; cy++)
+	{
+		capacity += m_cellStart[Bucket(x1, cy) + 1] - m_cellStart[Bucket(x0, cy)];
+	}
+
+	size_t base = out.size();
+	out.resize(base + capacity);
+
+	int *dst = out.empty() ? NULL : &out[base];
+	size_t written = 0;
+
+	for (int cy = y0; cy <= y1; cy++)
+	{
+		uint32_t end = m_cellStart[Bucket(x1, cy) + 1];
+
+		for (uint32_t i = m_cellStart[Bucket(x0, cy)]; i < end; i++)
+		{
+			int id = m_sortedId[i];
+			float dx = m_sortedX[i] - center.x;
+			float dy = m_sortedY[i] - center.y;
+
+			dst[written] = id;
+			written += (dx * dx + dy * dy <= radiusSq) & (id >= 0) & (id != excludeId);
+		}
+	}
+
+	out.resize(base + written);
+	return out.size() - before;
+}
+
+size_t SpatialHash2D::QueryKNearest(const Point2D &center, size_t k, int *outIds, float *outDistSq,
+	int excludeId, float maxRadius) const
+{
+	if (k == 0)
+	{
+		return 0;
+	}
+
+	std::vector<float> localDist;
+
+	if (outDistSq == NULL)
+	{
+		localDist.resize(k);
+		outDistSq = &localDist[0];
+	}
+
+	size_t found = 0;
+	float limitSq = maxRadius * maxRadius;
+
+	// 结果按距离升序保存，插入排序；k 通常很小
+
+	auto accept = [&](int id, float distSq)
+	{
+		float worst = found == k ? outDistSq[k - 1] : limitSq;
+
+		if (distSq > worst || (found == k && distSq == worst) || id == excludeId)
+		{
+			return;
+		}
+
+		size_t i = found < k ? found++ : k - 1;
+
+		while (i > 0 && outDistSq[i - 1] > distSq)
+		{
+			outDistSq[i] = outDistSq[i - 1];
+			outIds[i] = outIds[i - 1];
+			i--;
+		}
+
+		outDistSq[i] = distSq;
+		outIds[i] = id;
+	};
+
+	ScanMoved(center, accept);
+
+	if (m_sortedId.empty())
+	{
+		return found;
+	}
+
+	// 从中心所在格子开始一圈圈向外扩展
+	// 第 r 圈的格子离中心至少 (r - 1) * cellSize + edge，edge 为中心到所在格子边界的最短距离
+
+	int cx0 = CellCoord(center.x);
+	int cy0 = CellCoord(center.y);
+
+	float cellSize = 1.0f / m_builtInvCellSize;
+	float fx = center.x - cx0 * cellSize;
+	float fy = center.y - cy0 * cellSize;
+	float edge = MIN(MIN(fx, cellSize - fx), MIN(fy, cellSize - fy));
+
+	// fx, fy 有舍入误差，留一点余量保证下界不偏大
+
+	edge = MAX(edge - cellSize * 1e-4f, 0.0f);
+
+	// 中心在点的范围外时，前面几圈都是空的
+
+	int r = 0;
+	r = MAX(r, m_minCellX - cx0);
+	r = MAX(r, cx0 - m_maxCellX);
+	r = MAX(r, m_minCellY - cy0);
+	r = MAX(r, cy0 - m_maxCellY);
+
+	for (;; r++)
+	{
+		if (r > 0)
+		{
+			float bound = (r - 1) * cellSize + edge;
+			float worst = found == k ? outDistSq[k - 1] : limitSq;
+
+			if (bound * bound > worst)
+			{
+				break;
+			}
+
+			// 上一圈已经包住所有格子
+
+			int prev = r - 1;
+
+			if (cx0 - prev <= m_minCellX && cx0 + prev >= m_maxCellX &&
+				cy0 - prev <= m_minCellY && cy0 + prev >= m_maxCellY)
+			{
+				break;
+			}
+		}
+
+		if (r == 0)
+		{
+			ScanCell(cx0, cy0, center, accept);
+			continue;
+		}
+
+		int x0 = MAX(cx0 - r, m_minCellX);
+		int x1 = MIN(cx0 + r, m_maxCellX);
+		int y0 = MAX(cy0 - r + 1, m_minCellY);
+		int y1 = MIN(cy0 + r - 1, m_maxCellY);
+
+		// 上下两行
+
+		if (cy0 - r >= m_minCellY)
+		{
+			ScanRow(x0, x1, cy0 - r, center, accept);
+		}
+
+		if (cy0 + r <= m_maxCellY)
+		{
+			ScanRow(x0, x1, cy0 + r, center, accept);
+		}
+
+		// 左右两列，不含四个角
+
+		if (cx0 - r >= m_minCellX)
+		{
+			for (int cy = y0; cy <= y1; cy++)
+			{
+				ScanCell(cx0 - r, cy, center, accept);
+			}
+		}
+
+		if (cx0 + r <= m_maxCellX)
+		{
+			for (int cy = y0; cy <= y1; cy++)
+			{
+				ScanCell(cx0 + r, cy, center, accept);
+			}
+		}
+	}
+
+	return found;
+}
+
+size_t SpatialHash2D::QueryRadiusAll(float radius, std::vector<int> &neighbours, std::vector<uint32_t> &start,
+	std::vector<uint32_t> &count, JobPool *pool) const
+{
+	size_t n = m_posX.size();
+	size_t sorted = m_sortedId.size();
+	size_t total = sorted + m_moved.size();
+
+	start.resize(n);
+	count.resize(n);
+
+	// 查询序号 q 小于 sorted 时对应排序数组中的第 q 个点，否则对应移动列表
+
+	auto queryId = [&](size_t q)
+	{
+		return q < sorted ? m_sortedId[q] : m_moved[q - sorted];
+	};
+
+	size_t blockCount = (total + KSPATIALQUERYGRAIN - 1) / KSPATIALQUERYGRAIN;
+	std::vector<std::vector<int> > blocks(blockCount);
+
+	// 一次回调的区间可能包含多个块（pool 为NULL时是整个区间），
+	// 按块的边界切开，每块只写自己的结果
+
+	auto queryRange = [&](size_t begin, size_t end)
+	{
+		while (begin < end)
+		{
+			size_t k = begin / KSPATIALQUERYGRAIN;
+			size_t blockEnd = MIN((k + 1) * KSPATIALQUERYGRAIN, end);
+
+			std::vector<int> &local = blocks[k];
+			local.clear();
+
+			for (size_t q = begin; q < blockEnd; q++)
+			{
+				int id = queryId(q);
+
+				if (id < 0)
+				{
+					continue;
+				}
+
+				start[id] = (uint32_t)local.size();
+				count[id] = (uint32_t)QueryRadius(Point2D(m_posX[id], m_posY[id]), radius, local, id);
+			}
+
+			begin = blockEnd;
+		}
+	};
+
+	ParallelFor(pool, 0, total, KSPATIALQUERYGRAIN, queryRange);
+
+	// 各块的结果首尾相接，块内的起点加上块的偏移
+
+	size_t offset = 0;
+
+	for (size_t k = 0; k < blockCount; k++)
+	{
+		size_t end = MIN((k + 1) * KSPATIALQUERYGRAIN, total);
+
+		for (size_t q = k * KSPATIALQUERYGRAIN; q < end; q++)
+		{
+			int id = queryId(q);
+
+			if (id >= 0)
+			{
+				start[id] += (uint32_t)offset;
+			}
+		}
+
+		offset += blocks[k].size();
+	}
+
+	neighbours.resize(offset);
+	offset = 0;
+
+	for (size_t k = 0; k < blockCount; k++)
+	{
+		if (!blocks[k].empty())
+		{
+			memcpy(&neighbours[offset], &blocks[k][0], blocks[k].size() * sizeof(int));
+		}
+
+		offset += blocks[k].size();
+	}
+
+	return offset;
+}
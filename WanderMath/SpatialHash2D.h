@@ -0,0 +1,170 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: SpatialHash2D.h
+// func: 二维均匀网格空间哈希，用于邻近查询
+// disc: 平面按 cellSize 划分成方格；点所占的格子范围不大时直接按行
+//		 展开成稠密网格，同一行相邻的格子在内存中也相邻，否则把格子坐标
+//		 哈希到2的幂大小的表中，世界范围不受限制
+//		 Rebuild 用计数排序把所有点按格子连续存放，查询时每个格子
+//		 （稠密网格下每一行格子）只读一段连续内存
+//		 两次重建之间可以用 Move 移动单个点：仍在原格子中的就地修改，
+//		 换了格子的放入一个小的移动列表，查询时一并扫描，
+//		 列表变长后再调用 Rebuild
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_SpatialHash2D_h
+#define Wander_SpatialHash2D_h
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Vector2D.h"
+
+class JobPool;
+
+class SpatialHash2D
+{
+public:
+
+	// 查询时不排除任何点
+
+	static const int KNOEXCLUDE = -1;
+
+	explicit SpatialHash2D(float cellSize = 1.0f);
+
+	// 格子边长，取常用查询半径左右时效率最高；修改后在下一次 Rebuild 生效
+
+	void SetCellSize(float cellSize);
+
+	float CellSize() const
+	{
+		return m_cellSize;
+	}
+
+	// Build
+	//
+	// 用 n 个点重新建立网格，点的编号即在 points 中的下标
+
+	void Build(const Point2D *points, size_t n);
+
+	// Rebuild
+	//
+	// 按当前保存的位置重新计数排序，清空移动列表
+
+	void Rebuild();
+
+	// Move
+	//
+	// 修改第 id 个点的位置
+
+	void Move(int id, const Point2D &p);
+
+	size_t Size() const
+	{
+		return m_posX.size();
+	}
+
+	Point2D Position(int id) const
+	{
+		assert(id >= 0 && (size_t)id < m_posX.size());
+		return Point2D(m_posX[id], m_posY[id]);
+	}
+
+	// 上次重建后换了格子的点数
+
+	size_t MovedCount() const
+	{
+		return m_moved.size();
+	}
+
+	// QueryRadius
+	//
+	// 把与 center 距离不超过 radius 的点的编号追加到 out，返回追加的个数
+	// 结果不按距离排序
+
+	size_t QueryRadius(const Point2D &center, float radius, std::vector<int> &out, int excludeId = KNOEXCLUDE) const;
+
+	// QueryKNearest
+	//
+	// 找出离 center 最近的至多 k 个点，按距离从近到远写入 outIds，
+	// outDistSq 不为NULL时写入对应的距离平方；只考虑 maxRadius 以内的点
+	// 返回找到的个数
+
+	size_t QueryKNearest(const Point2D &center, size_t k, int *outIds, float *outDistSq = NULL,
+		int excludeId = KNOEXCLUDE, float maxRadius = 3.4e38f) const;
+
+	// QueryRadiusAll
+	//
+	// 为每个点查找 radius 以内的其他点，第 id 个点的邻居为
+	// neighbours[start[id]] 到 neighbours[start[id] + count[id] - 1]
+	// 按格子顺序逐个查询，相邻的查询读同一片内存，比按编号逐个调用
+	// QueryRadius 快；pool 不为NULL时分块并行，返回邻居总数
+
+	size_t QueryRadiusAll(float radius, std::vector<int> &neighbours, std::vector<uint32_t> &start,
+		std::vector<uint32_t> &count, JobPool *pool = NULL) const;
+
+private:
+	int CellCoord(float v) const;
+	uint32_t Bucket(int cx, int cy) const;
+
+	// 扫描一个格子与移动列表中的候选点，fn(id, distSq)
+
+	template <class Fn>
+	void ScanCell(int cx, int cy, const Point2D &center, const Fn &fn) const;
+
+	// 扫描第 cy 行中 [cx0, cx1] 的格子
+
+	template <class Fn>
+	void ScanRow(int cx0, int cx1, int cy, const Point2D &center, const Fn &fn) const;
+
+	template <class Fn>
+	void ScanMoved(const Point2D &center, const Fn &fn) const;
+
+private:
+	float m_cellSize;
+	float m_invCellSize;
+
+	// 最近一次重建时使用的格子边长
+
+	float m_builtInvCellSize;
+
+	// 每个点的当前位置，按编号
+
+	std::vector<float> m_posX;
+	std::vector<float> m_posY;
+
+	// 按格子排序后的点，m_cellStart[b] 到 m_cellStart[b + 1] 为第 b 个桶
+	// 已移出的点编号置为 KNOEXCLUDE
+
+	std::vector<float> m_sortedX;
+	std::vector<float> m_sortedY;
+	std::vector<int> m_sortedId;
+	std::vector<uint32_t> m_cellStart;
+
+	// 每个点在排序数组中的位置，在移动列表中时为 -1
+
+	std::vector<int> m_slot;
+	std::vector<int> m_moved;
+
+	uint32_t m_tableMask;
+
+	// 稠密网格模式下网格的原点与宽高（以格子计）
+
+	bool m_dense;
+	int m_gridMinX;
+	int m_gridMinY;
+	int m_gridWidth;
+	int m_gridHeight;
+
+	// 所有点所占格子的范围，k近邻搜索以此为终止条件
+
+	int m_minCellX;
+	int m_minCellY;
+	int m_maxCellX;
+	int m_maxCellY;
+};
+
+#endif
@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: TransformHierarchy.cpp
+// func: 扁平化的变换层次结构
+//
+///////////////////////////////////////////////////////////////////
+
+#include "TransformHierarchy.h"
+#include "JobPool.h"
+#include "Matrix4X3Batch.h"
+
+// 每块的节点数，太小时线程同步的开销超过计算本身
+
+static const size_t KHIERARCHYGRAIN = 2048;
+
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+void TransformHierarchy::Reserve(size_t n)
+{
+	m_local.reserve(n);
+	m_world.reserve(n);
+	m_parent.reserve(n);
+	m_depth.reserve(n);
+}
+
+void TransformHierarchy::Clear()
+{
+	m_local.clear();
+	m_world.clear();
+	m_parent.clear();
+	m_depth.clear();
+	m_levelStart.clear();
+}
+
+int TransformHierarchy::AddNode(int parent, const Matrix4X3 &localToParent)
+{
+	// 父节点不存在时拒绝，Release 版本中也不能写入任何状态
+
+	if (parent != KNOPARENT && (parent < 0 || (size_t)parent >= m_parent.size()))
+	{
+		return -1;
+	}
+
+	int index = (int)m_parent.size();
+	int depth = parent == KNOPARENT ? 0 : m_depth[parent] + 1;
+
+	// 广度优先顺序下深度单调不减；比上一个节点浅的节点会落进已有的层，
+	// 例如在深度1之后加入根节点，UpdateWorld 会把它当作第1层读取父节点
+
+	if (!m_depth.empty() && depth < m_depth.back())
+	{
+		return -1;
+	}
+
+	// 新的一层从这里开始
+
+	if (depth == (int)m_levelStart.size())
+	{
+		m_levelStart.push_back(index);
+	}
+
+	assert(depth == (int)m_levelStart.size() - 1);
+
+	m_local.push_back(localToParent);
+	m_world.push_back(localToParent);
+	m_parent.push_back(parent);
+	m_depth.push_back(depth);
+
+	return index;
+}
+
+void TransformHierarchy::UpdateWorld(JobPool *pool)
+{
+	if (m_parent.empty())
+	{
+		return;
+	}
+
+	// 第0层都是根节点，世界矩阵就是本地矩阵
+
+	for (size_t i = 0; i < LevelEnd(0); i++)
+	{
+		m_world[i] = m_local[i];
+	}
+
+	Matrix4X3 *world = &m_world[0];
+	const Matrix4X3 *local = &m_local[0];
+	const int *parent = &m_parent[0];
+
+	for (size_t level = 1; level < m_levelStart.size(); level++)
+	{
+		size_t begin = LevelBegin(level);
+		size_t end = LevelEnd(level);
+
+		// 本层只读取上一层的结果，各块可以并行
+
+		auto concatenate = [=](size_t blockBegin, size_t blockEnd)
+		{
+			ConcatenateIndexedN(local + blockBegin, world, parent + blockBegin,
+								world + blockBegin, blockEnd - blockBegin);
+		};
+
+		ParallelFor(pool, begin, end, KHIERARCHYGRAIN, concatenate);
+	}
+}
@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: TransformHierarchy.h
+// func: 扁平化的变换层次结构
+// disc: 节点按广度优先顺序存放，只记录父节点下标，同一深度的节点
+//		 连续排列；世界矩阵逐层计算，每层内部互不依赖，可以切块
+//		 交给 JobPool 并用批量连接内核完成
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_TransformHierarchy_h
+#define Wander_TransformHierarchy_h
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "Matrix4X3.h"
+
+class JobPool;
+
+class TransformHierarchy
+{
+public:
+
+	// 根节点的父节点下标
+
+	static const int KNOPARENT = -1;
+
+	TransformHierarchy();
+
+	void Reserve(size_t n);
+	void Clear();
+
+	// AddNode
+	//
+	// 加入一个节点，返回它的下标
+	// 必须按广度优先顺序加入：父节点已经存在，且深度不小于上一个节点，
+	// 否则返回-1，层次结构保持不变
+
+	int AddNode(int parent, const Matrix4X3 &localToParent);
+
+	size_t Size() const
+	{
+		return m_parent.size();
+	}
+
+	int Parent(size_t i) const
+	{
+		assert(i < m_parent.size());
+		return m_parent[i];
+	}
+
+	// 层数与第level层的节点区间 [LevelBegin, LevelEnd)
+
+	size_t LevelCount() const
+	{
+		return m_levelStart.size();
+	}
+
+	size_t LevelBegin(size_t level) const
+	{
+		assert(level < m_levelStart.size());
+		return m_levelStart[level];
+	}
+
+	size_t LevelEnd(size_t level) const
+	{
+		assert(level < m_levelStart.size());
+		return level + 1 < m_levelStart.size() ? m_levelStart[level + 1] : m_parent.size();
+	}
+
+	// 本地到父空间的矩阵，修改后调用 UpdateWorld 生效
+
+	Matrix4X3 &Local(size_t i)
+	{
+		assert(i < m_local.size());
+		return m_local[i];
+	}
+
+	const Matrix4X3 &Local(size_t i) const
+	{
+		assert(i < m_local.size());
+		return m_local[i];
+	}
+
+	// 本地到世界的矩阵，上一次 UpdateWorld 的结果
+
+	const Matrix4X3 &World(size_t i) const
+	{
+		assert(i < m_world.size());
+		return m_world[i];
+	}
+
+	const Matrix4X3 *WorldData() const
+	{
+		return m_world.empty() ? NULL : &m_world[0];
+	}
+
+	// UpdateWorld
+	//
+	// 逐层计算 world[i] = local[i] * world[parent[i]]
+	// pool 为NULL时在当前线程完成，否则每层按块分给池中的线程
+
+	void UpdateWorld(JobPool *pool = NULL);
+
+private:
+	std::vector<Matrix4X3> m_local;
+	std::vector<Matrix4X3> m_world;
+	std::vector<int> m_parent;
+	std::vector<int> m_depth;
+	std::vector<size_t> m_levelStart;
+};
+
+#endif
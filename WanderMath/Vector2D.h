@@ -8,32 +8,22 @@
 
 #ifndef Wander_Vector2D_h
 #define Wander_Vector2D_h
+
+#include <cassert>
+#include <iostream>
+#include <type_traits>
 #include "CommonMath.h"
 
 typedef class Vector2D
 {
 public:
-	Vector2D()
+	constexpr Vector2D()
         : x(0)
         , y(0)
 	{
 	}
     
-	~Vector2D()
-	{
-        
-	}
-    
-	Vector2D(const Vector2D &v):x(v.x), y(v.y){}
-    
-	Vector2D(float nx, float ny):x(nx), y(ny){}
-    
-	Vector2D &operator = (const Vector2D &v)
-	{
-		x = v.x;
-		y = v.y;
-		return *this;
-	}
+	constexpr Vector2D(float nx, float ny):x(nx), y(ny){}
     
 	void Init(float nx, float ny)
 	{
@@ -66,7 +56,7 @@ public:
         return sqrt(x*x +y*y);
     }
     
-    float LengthSq() const 
+    constexpr float LengthSq() const 
     {
         return x*x + y*y;
     }
@@ -116,32 +106,32 @@ public:
 	}
 	//  重载操作符
     
-	bool operator == (const Vector2D &v) const
+	constexpr bool operator == (const Vector2D &v) const
 	{
 		return (x == v.x && y == v.y);
 	}
     
-	bool operator != (const Vector2D &v) const
+	constexpr bool operator != (const Vector2D &v) const
 	{
 		return !(*this == v);
 	}
     
-	Vector2D operator - (const Vector2D &v) const
+	constexpr Vector2D operator - (const Vector2D &v) const
 	{
 		return Vector2D(x - v.x, y - v.y);
 	}
     
-	Vector2D operator + (const Vector2D &v) const
+	constexpr Vector2D operator + (const Vector2D &v) const
 	{
 		return Vector2D(x + v.x, y + v.y);
 	}
     
-	Vector2D operator * (float a) const
+	constexpr Vector2D operator * (float a) const
 	{
 		return Vector2D(a * x, a * y);
 	}
     
-	Vector2D operator / (float a) const
+	constexpr Vector2D operator / (float a) const
 	{
 		assert(a != 0);
 		float tmp = 1.0f / a;
@@ -149,28 +139,28 @@ public:
 		return Vector2D(x * tmp, y * tmp);
 	}
     
-	Vector2D &operator += (const Vector2D &v)
+	constexpr Vector2D &operator += (const Vector2D &v)
 	{
 		x += v.x;
 		y += v.y;
 		return *this;
 	}
     
-	Vector2D &operator -= (const Vector2D &v)
+	constexpr Vector2D &operator -= (const Vector2D &v)
 	{
 		x -= v.x;
 		y -= v.y;
 		return *this;
 	}
     
-	Vector2D &operator *= (float a)
+	constexpr Vector2D &operator *= (float a)
 	{
 		x *= a;
 		y *= a;
 		return *this;
 	}
     
-	Vector2D &operator /= (float a)
+	constexpr Vector2D &operator /= (float a)
 	{
 		assert( a != 0);
 		float tmp = 1.0f / a;
@@ -181,7 +171,7 @@ public:
     
 	// 两向量点积
     
-	float operator * (const Vector2D &v) const
+	constexpr float operator * (const Vector2D &v) const
 	{
 		return (x*v.x + y*v.y);
 	}
@@ -192,9 +182,12 @@ public:
 	float y;
 }Point2D, *Vector2DPtr, *Point2DPtr;
 
+static_assert(std::is_trivially_copyable<Vector2D>::value, "Vector2D must stay trivially copyable");
+static_assert(std::is_standard_layout<Vector2D>::value, "Vector2D must stay standard layout");
+
 // 数乘向量
 
-inline Vector2D operator *(float k, Vector2D &v)
+constexpr Vector2D operator *(float k, const Vector2D &v)
 {
 	return Vector2D(k*v.x, k*v.y);
 }
@@ -206,7 +199,7 @@ inline float Vec2Distance(const Point2D &p1, const Point2D &p2)
 	return sqrt(dx*dx + dy*dy);
 }
 
-inline float Vec2DistanceSq(const Point2D &p1, const Point2D &p2)
+constexpr float Vec2DistanceSq(const Point2D &p1, const Point2D &p2)
 {
 	float dx = p2.x - p1.x;
 	float dy = p2.y - p1.y;
@@ -219,7 +212,7 @@ inline float Vec2Magnitute(const Vector2D &v)
 	return sqrt(v.x*v.x + v.y*v.y);
 }
 
-inline Vector2D Vec2Perp(const Vector2D &v)
+constexpr Vector2D Vec2Perp(const Vector2D &v)
 {
     return Vector2D(-v.y, v.x);
 }
@@ -13,6 +13,7 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <type_traits>
 #include "CommonMath.h"
 
 using namespace std;
@@ -20,27 +21,12 @@ using namespace std;
 typedef class Vector3D
 {
 public:
-	Vector3D()
-	{
-        
-	}
-    
-	~Vector3D()
-	{
-        
-	}
+	// 不初始化分量，与内置类型一致；复制、赋值与析构都由编译器生成，
+	// 保证类型可平凡复制，数组可以直接 memcpy
     
-	Vector3D(const Vector3D &v):x(v.x), y(v.y), z(v.z){}
+	Vector3D() = default;
     
-	Vector3D(float nx, float ny, float nz):x(nx), y(ny), z(nz){}
-    
-	Vector3D &operator = (const Vector3D &v)
-	{
-		x = v.x;
-		y = v.y;
-		z = v.z;
-		return *this;
-	}
+	constexpr Vector3D(float nx, float ny, float nz):x(nx), y(ny), z(nz){}
     
 	void Init(float nx, float ny, float nz)
 	{
@@ -65,32 +51,32 @@ public:
 	}
 	//  重载操作符
     
-	bool operator == (const Vector3D &v) const
+	constexpr bool operator == (const Vector3D &v) const
 	{
 		return (x == v.x && y == v.y && z == v.z);
 	}
     
-	bool operator != (const Vector3D &v) const
+	constexpr bool operator != (const Vector3D &v) const
 	{
 		return !(*this == v);
 	}
     
-	Vector3D operator - (const Vector3D &v) const
+	constexpr Vector3D operator - (const Vector3D &v) const
 	{
 		return Vector3D(x - v.x, y - v.y, z - v.z);
 	}
     
-	Vector3D operator + (const Vector3D &v) const
+	constexpr Vector3D operator + (const Vector3D &v) const
 	{
 		return Vector3D(x + v.x, y + v.y, z + v.z);
 	}
     
-	Vector3D operator * (float a) const
+	constexpr Vector3D operator * (float a) const
 	{
 		return Vector3D(a * x, a * y, a * z);
 	}
     
-	Vector3D operator / (float a) const
+	constexpr Vector3D operator / (float a) const
 	{
 		assert(a != 0);
 		float tmp = 1.0f / a;
@@ -98,7 +84,7 @@ public:
 		return Vector3D(x * tmp, y * tmp, z *tmp);
 	}
     
-	Vector3D &operator += (const Vector3D &v)
+	constexpr Vector3D &operator += (const Vector3D &v)
 	{
 		x += v.x;
 		y += v.y;
@@ -106,7 +92,7 @@ public:
 		return *this;
 	}
     
-	Vector3D &operator -= (const Vector3D &v)
+	constexpr Vector3D &operator -= (const Vector3D &v)
 	{
 		x -= v.x;
 		y -= v.y;
@@ -114,7 +100,7 @@ public:
 		return *this;
 	}
     
-	Vector3D &operator *= (float a)
+	constexpr Vector3D &operator *= (float a)
 	{
 		x *= a;
 		y *= a;
@@ -122,7 +108,7 @@ public:
 		return *this;
 	}
     
-	Vector3D &operator /= (float a)
+	constexpr Vector3D &operator /= (float a)
 	{
 		assert( a != 0);
 		float tmp = 1.0f / a;
@@ -134,7 +120,7 @@ public:
     
 	// 两向量点积
     
-	float operator * (const Vector3D &v) const
+	constexpr float operator * (const Vector3D &v) const
 	{
 		return (x*v.x + y*v.y + z*v.z);
 	}
@@ -146,10 +132,20 @@ public:
 	float z;
 }Point3D, *Vector3DPtr, *Point3DPtr;
 
+static_assert(std::is_trivially_copyable<Vector3D>::value, "Vector3D must stay trivially copyable");
+static_assert(std::is_standard_layout<Vector3D>::value, "Vector3D must stay standard layout");
+
+// 常用的向量，编译期即可确定
+
+constexpr Vector3D KVECTOR3DZERO(0.0f, 0.0f, 0.0f);
+constexpr Vector3D KVECTOR3DUNITX(1.0f, 0.0f, 0.0f);
+constexpr Vector3D KVECTOR3DUNITY(0.0f, 1.0f, 0.0f);
+constexpr Vector3D KVECTOR3DUNITZ(0.0f, 0.0f, 1.0f);
+
 
 // 计算两个向量叉乘
 
-inline Vector3D CrossProduct(const Vector3D &v1, const Vector3D &v2)
+constexpr Vector3D CrossProduct(const Vector3D &v1, const Vector3D &v2)
 {
 	return Vector3D(v1.y*v2.z - v2.y*v1.z,
 				    v1.z*v2.x - v2.z*v1.x,
@@ -159,7 +155,7 @@ inline Vector3D CrossProduct(const Vector3D &v1, const Vector3D &v2)
 
 // 数乘向量
 
-inline Vector3D operator *(float k, Vector3D &v)
+constexpr Vector3D operator *(float k, const Vector3D &v)
 {
 	return Vector3D(k*v.x, k*v.y, k*v.z);
 }
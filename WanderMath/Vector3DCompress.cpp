@@ -0,0 +1,710 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Vector3DCompress.cpp
+// func: 三维向量的压缩编码、解码与直接变换
+//
+///////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "JobPool.h"
+#include "Vector3DCompress.h"
+#include "Vector3D.h"
+#include "Vector3DSoA.h"
+#include "AABB3D.h"
+#include "Matrix4X3.h"
+#include "CommonMath.h"
+#include "Simd.h"
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D must be three packed floats");
+
+// 半精度最小的规格化数 2^-14，非规格化数的步长 2^-24
+
+static const float KHALFMINNORMAL = 1.0f / 16384.0f;
+static const float KHALFDENORMALSCALE = 16777216.0f;
+
+// 半精度与单精度的指数偏置之差 (127 - 15)，已移到指数位上
+
+static const int KHALFEXPONENTREBIAS = 112 << 23;
+
+// 16位定点数的最大值
+
+static const float KQUANT16 = 65535.0f;
+
+// 八面体坐标在 [-1, 1] 内，映射到 [-32767, 32767]
+
+static const float KOCTSCALE = 32767.0f;
+
+static float AsFloat(uint32_t i)
+{
+	float f;
+	memcpy(&f, &i, sizeof(f));
+	return f;
+}
+
+static uint32_t AsUint(float f)
+{
+	uint32_t i;
+	memcpy(&i, &f, sizeof(i));
+	return i;
+}
+
+/////////////////////////////////////////////////
+//
+// 单个编码
+//
+/////////////////////////////////////////////////
+
+// FloatToHalf
+//
+// 超出范围的值截断到 ±KHALFMAX；规格化数先加上再减去 2^(e+13)，
+// 由硬件把尾数按最近偶数舍入到10位，再调整指数偏置；
+// 非规格化数直接按步长 2^-24 取整
+
+static uint16_t FloatToHalf(float f)
+{
+	uint32_t sign = AsUint(f) & 0x80000000u;
+	float a = MIN(fabsf(f), KHALFMAX);
+	uint32_t h;
+
+	if (a < KHALFMINNORMAL)
+	{
+		h = (uint32_t)(int)nearbyintf(a * KHALFDENORMALSCALE);
+	}
+	else
+	{
+		float c = AsFloat((AsUint(a) & 0x7f800000u) + (13u << 23));
+		float r = (a + c) - c;
+		h = (AsUint(r) - KHALFEXPONENTREBIAS) >> 13;
+	}
+
+	return (uint16_t)(h | (sign >> 16));
+}
+
+// 编码器不会产生无穷大与NaN，解码时不区分
+
+static float HalfToFloat(uint16_t h)
+{
+	uint32_t em = h & 0x7fffu;
+	float a = em < 0x400u ? em * (1.0f / KHALFDENORMALSCALE) : AsFloat((em << 13) + KHALFEXPONENTREBIAS);
+	return (h & 0x8000u) ? -a : a;
+}
+
+HalfVector3D PackHalf(const Vector3D &v)
+{
+	HalfVector3D p;
+	p.v[0] = FloatToHalf(v.x);
+	p.v[1] = FloatToHalf(v.y);
+	p.v[2] = FloatToHalf(v.z);
+	return p;
+}
+
+Vector3D Unpack(const HalfVector3D &p)
+{
+	return Vector3D(HalfToFloat(p.v[0]), HalfToFloat(p.v[1]), HalfToFloat(p.v[2]));
+}
+
+// 包围盒某轴的尺寸为零时该轴全部编码为0
+
+static float QuantizeScale(float size)
+{
+	return size > 0.0f ? KQUANT16 / size : 0.0f;
+}
+
+static uint16_t Quantize(float v, float min, float scale)
+{
+	return (uint16_t)(int)nearbyintf(MIN(MAX((v - min) * scale, 0.0f), KQUANT16));
+}
+
+// 半个量化步长，加上解码时 q * step + min 的几次浮点舍入
+
+Vector3D GetQuantizationError(const AABB3D &bounds)
+{
+	Vector3D rounding(MAX(fabsf(bounds.min.x), fabsf(bounds.max.x)),
+					  MAX(fabsf(bounds.min.y), fabsf(bounds.max.y)),
+					  MAX(fabsf(bounds.min.z), fabsf(bounds.max.z)));
+
+	return bounds.Size() * (0.5f / KQUANT16) + rounding * (4.0f * FLT_EPSILON);
+}
+
+QuantizedVector3D PackQuantized(const Vector3D &v, const AABB3D &bounds)
+{
+	Vector3D size = bounds.Size();
+
+	QuantizedVector3D p;
+	p.v[0] = Quantize(v.x, bounds.min.x, QuantizeScale(size.x));
+	p.v[1] = Quantize(v.y, bounds.min.y, QuantizeScale(size.y));
+	p.v[2] = Quantize(v.z, bounds.min.z, QuantizeScale(size.z));
+	return p;
+}
+
+Vector3D Unpack(const QuantizedVector3D &p, const AABB3D &bounds)
+{
+	Vector3D step = bounds.Size() * (1.0f / KQUANT16);
+
+	return Vector3D(p.v[0] * step.x + bounds.min.x,
+					p.v[1] * step.y + bounds.min.y,
+					p.v[2] * step.z + bounds.min.z);
+}
+
+// PackOctahedral
+//
+// 投影到八面体 |x| + |y| + |z| = 1 上，下半部分 (z < 0) 沿对角线
+// 翻折到上半部分的四个角，于是整个球面展开成 [-1, 1] 的正方形
+
+OctNormal32 PackOctahedral(const Vector3D &n)
+{
+	float inv = 1.0f / MAX(fabsf(n.x) + fabsf(n.y) + fabsf(n.z), 1e-30f);
+	float x = n.x * inv;
+	float y = n.y * inv;
+
+	if (n.z < 0.0f)
+	{
+		float fx = copysignf(1.0f - fabsf(y), x);
+		float fy = copysignf(1.0f - fabsf(x), y);
+		x = fx;
+		y = fy;
+	}
+
+	OctNormal32 p;
+	p.v[0] = (int16_t)nearbyintf(MIN(MAX(x, -1.0f), 1.0f) * KOCTSCALE);
+	p.v[1] = (int16_t)nearbyintf(MIN(MAX(y, -1.0f), 1.0f) * KOCTSCALE);
+	return p;
+}
+
+Vector3D Unpack(const OctNormal32 &p)
+{
+	float x = p.v[0] * (1.0f / KOCTSCALE);
+	float y = p.v[1] * (1.0f / KOCTSCALE);
+	float z = 1.0f - fabsf(x) - fabsf(y);
+	float t = MAX(-z, 0.0f);
+
+	x -= copysignf(t, x);
+	y -= copysignf(t, y);
+
+	Vector3D n(x, y, z);
+	n.Normalize();
+	return n;
+}
+
+/////////////////////////////////////////////////
+//
+// 通道操作
+//
+/////////////////////////////////////////////////
+
+// 按步长读写 KSIMDWIDTH 个float，stride 为1时是连续的 SoA 流，
+// 为3时是 Vector3D 数组中交错的一个分量
+
+static SimdFloat LoadLanes(const float *p, size_t stride)
+{
+	if (stride == 1)
+	{
+		return SimdLoad(p);
+	}
+
+	float t[KSIMDWIDTH];
+
+	for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+	{
+		t[lane] = p[lane * stride];
+	}
+
+	return SimdLoad(t);
+}
+
+static void StoreLanes(float *p, size_t stride, SimdFloat a)
+{
+	if (stride == 1)
+	{
+		SimdStore(p, a);
+		return;
+	}
+
+	float t[KSIMDWIDTH];
+	SimdStore(t, a);
+
+	for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+	{
+		p[lane * stride] = t[lane];
+	}
+}
+
+// 与 FloatToHalf 相同的步骤，两条路径都算出后按通道选择
+
+static SimdInt FloatToHalfLanes(SimdFloat f)
+{
+	SimdFloat sign = SimdSignBit(f);
+	SimdFloat a = SimdMin(SimdAbs(f), SimdSet1(KHALFMAX));
+
+	SimdFloat c = SimdIntAsFloat(SimdIntAdd(SimdIntAnd(SimdFloatAsInt(a), 0x7f800000), 13 << 23));
+	SimdFloat r = SimdSub(SimdAdd(a, c), c);
+	SimdInt normal = SimdIntShiftRight(SimdIntAdd(SimdFloatAsInt(r), -KHALFEXPONENTREBIAS), 13);
+	SimdInt denormal = SimdRoundToInt(SimdMul(a, SimdSet1(KHALFDENORMALSCALE)));
+
+	SimdMask small = SimdCmpLt(a, SimdSet1(KHALFMINNORMAL));
+	SimdInt h = SimdFloatAsInt(SimdSelect(small, SimdIntAsFloat(denormal), SimdIntAsFloat(normal)));
+
+	return SimdIntOr(h, SimdIntShiftRight(SimdFloatAsInt(sign), 16));
+}
+
+static SimdFloat HalfToFloatLanes(SimdInt h)
+{
+	SimdInt em = SimdIntAnd(h, 0x7fff);
+	SimdFloat emf = SimdIntToFloat(em);
+
+	SimdFloat normal = SimdIntAsFloat(SimdIntAdd(SimdIntShiftLeft(em, 13), KHALFEXPONENTREBIAS));
+	SimdFloat denormal = SimdMul(emf, SimdSet1(1.0f / KHALFDENORMALSCALE));
+	SimdFloat a = SimdSelect(SimdCmpLt(emf, SimdSet1(1024.0f)), denormal, normal);
+
+	return SimdXor(a, SimdIntAsFloat(SimdIntShiftLeft(SimdIntAnd(h, 0x8000), 16)));
+}
+
+/////////////////////////////////////////////////
+//
+// 各编码的通道实现
+//
+/////////////////////////////////////////////////
+
+// 每种编码提供 Encode/Decode 处理 KSIMDWIDTH 个向量，
+// EncodeOne/DecodeOne 处理尾部，与单个编码函数一致
+
+struct HalfFormat
+{
+	typedef HalfVector3D Packed;
+
+	void Encode(SimdFloat x, SimdFloat y, SimdFloat z, Packed *out) const
+	{
+		int hx[KSIMDWIDTH], hy[KSIMDWIDTH], hz[KSIMDWIDTH];
+		SimdIntStore(hx, FloatToHalfLanes(x));
+		SimdIntStore(hy, FloatToHalfLanes(y));
+		SimdIntStore(hz, FloatToHalfLanes(z));
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			out[lane].v[0] = (uint16_t)hx[lane];
+			out[lane].v[1] = (uint16_t)hy[lane];
+			out[lane].v[2] = (uint16_t)hz[lane];
+		}
+	}
+
+	void Decode(const Packed *p, SimdFloat &x, SimdFloat &y, SimdFloat &z) const
+	{
+		int hx[KSIMDWIDTH], hy[KSIMDWIDTH], hz[KSIMDWIDTH];
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			hx[lane] = p[lane].v[0];
+			hy[lane] = p[lane].v[1];
+			hz[lane] = p[lane].v[2];
+		}
+
+		x = HalfToFloatLanes(SimdIntLoad(hx));
+		y = HalfToFloatLanes(SimdIntLoad(hy));
+		z = HalfToFloatLanes(SimdIntLoad(hz));
+	}
+
+	Packed EncodeOne(const Vector3D &v) const
+	{
+		return PackHalf(v);
+	}
+
+	Vector3D DecodeOne(const Packed &p) const
+	{
+		return Unpack(p);
+	}
+};
+
+// 定点数解码只给出整数值，由调用者把步长和包围盒并入变换矩阵
+
+struct QuantizedFormat
+{
+	typedef QuantizedVector3D Packed;
+
+	explicit QuantizedFormat(const AABB3D &bounds)
+		: min(bounds.min)
+	{
+		Vector3D size = bounds.Size();
+		scale.Init(QuantizeScale(size.x), QuantizeScale(size.y), QuantizeScale(size.z));
+	}
+
+	void Encode(SimdFloat x, SimdFloat y, SimdFloat z, Packed *out) const
+	{
+		SimdFloat zero = SimdZero();
+		SimdFloat hi = SimdSet1(KQUANT16);
+
+		int qx[KSIMDWIDTH], qy[KSIMDWIDTH], qz[KSIMDWIDTH];
+		SimdIntStore(qx, SimdRoundToInt(SimdMin(SimdMax(SimdMul(SimdSub(x, SimdSet1(min.x)), SimdSet1(scale.x)), zero), hi)));
+		SimdIntStore(qy, SimdRoundToInt(SimdMin(SimdMax(SimdMul(SimdSub(y, SimdSet1(min.y)), SimdSet1(scale.y)), zero), hi)));
+		SimdIntStore(qz, SimdRoundToInt(SimdMin(SimdMax(SimdMul(SimdSub(z, SimdSet1(min.z)), SimdSet1(scale.z)), zero), hi)));
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			out[lane].v[0] = (uint16_t)qx[lane];
+			out[lane].v[1] = (uint16_t)qy[lane];
+			out[lane].v[2] = (uint16_t)qz[lane];
+		}
+	}
+
+	void Decode(const Packed *p, SimdFloat &x, SimdFloat &y, SimdFloat &z) const
+	{
+		float qx[KSIMDWIDTH], qy[KSIMDWIDTH], qz[KSIMDWIDTH];
+
+		for (size_t lane = 0; lane < KSIMDWIDTH; lane++)
+		{
+			qx[lane] = p[lane].v[0];
+			qy[lane] = p[lane].v[1];
+			qz[lane] = p[lane].v[2];
+		}
+
+		x = SimdLoad(qx);
+		y = SimdLoad(qy);
+		z = SimdLoad(qz);
+	}
+
+	Packed EncodeOne(const Vector3D &v) const
+	{
+		Packed p;
+		p.v[0] = Quantize(v.x, min.x, scale.x);
+		p.v[1] = Quantize(v.y, min.y, scale.y);
+		p.v[2] = Quantize(v.z, min.z, scale.z);
+		return p;
+	}
+
+	Vector3D DecodeOne(const Packed &p) const
+	{
+		return Vector3D(p.v[0], p.v[1], p.v[2]);
+	}
+
+	Vector3D min;
+	Vector3D scale;
+};
+
+struct OctahedralFormat
+{
+	typedef OctNormal32 Packed;
+
+	// 与 PackOctahedral 相同，z 不参与编码
+
+	void Encode(SimdFloat x, SimdFloat y, SimdFloat z, Packed *out) const
+	{
+		SimdFloat sum = SimdAdd(SimdAdd(SimdAbs(x), SimdAbs(y)), SimdAbs(z));
+		SimdFloat inv = SimdDiv(SimdSet1(1.0f), SimdMax(sum, SimdSet1(1e-30f)));
+		SimdFloat px = SimdMul(x, inv);
+		SimdFloat py = SimdMul(y, inv);
+
+		SimdFloat one = SimdSet1(1.0f);
+		SimdFloat fx = SimdXor(SimdSub(one, SimdAbs(py)), SimdSignBit(px));
+		SimdFloat fy = SimdXor(SimdSub(one, SimdAbs(px)), SimdSignBit(py));
+
+		SimdMask lower = SimdCmpLt(z, SimdZero());
+		px = SimdSelect(lower, fx, px);
+		py = SimdSelect(lower, fy, py);
+
+		SimdFloat lo = SimdSet1(-1.0f);
+		SimdFloat scale = SimdSet1(KOCTSCALE);
+		SimdInt qx = SimdRoundToInt(SimdMul(SimdMin(SimdMax(px, lo), one), scale));
+		SimdInt qy = SimdRoundToInt(SimdMul(SimdMin(SimdMax(py, lo), one), scale));
+
+		// x 在低16位，y 在高16位，与小端序下的 v[0], v[1] 对应
+
+		int packed[KSIMDWIDTH];
+		SimdIntStore(packed, SimdIntOr(SimdIntAnd(qx, 0xffff), SimdIntShiftLeft(qy, 16)));
+		memcpy(out, packed, sizeof(packed));
+	}
+
+	// 符号扩展：低16位移到高位，高16位清掉低位，转成float后再除以 65536
+
+	void Decode(const Packed *p, SimdFloat &x, SimdFloat &y, SimdFloat &z) const
+	{
+		int packed[KSIMDWIDTH];
+		memcpy(packed, p, sizeof(packed));
+
+		SimdInt v = SimdIntLoad(packed);
+		SimdFloat scale = SimdSet1(1.0f / (KOCTSCALE * 65536.0f));
+
+		x = SimdMul(SimdIntToFloat(SimdIntShiftLeft(v, 16)), scale);
+		y = SimdMul(SimdIntToFloat(SimdIntAnd(v, (int)0xffff0000u)), scale);
+		z = SimdSub(SimdSub(SimdSet1(1.0f), SimdAbs(x)), SimdAbs(y));
+
+		SimdFloat t = SimdMax(SimdSub(SimdZero(), z), SimdZero());
+		x = SimdSub(x, SimdXor(t, SimdSignBit(x)));
+		y = SimdSub(y, SimdXor(t, SimdSignBit(y)));
+
+		SimdFloat lenSq = SimdMulAdd(z, z, SimdMulAdd(y, y, SimdMul(x, x)));
+		SimdFloat inv = SimdDiv(SimdSet1(1.0f), SimdSqrt(lenSq));
+
+		x = SimdMul(x, inv);
+		y = SimdMul(y, inv);
+		z = SimdMul(z, inv);
+	}
+
+	Packed EncodeOne(const Vector3D &v) const
+	{
+		return PackOctahedral(v);
+	}
+
+	Vector3D DecodeOne(const Packed &p) const
+	{
+		return Unpack(p);
+	}
+};
+
+/////////////////////////////////////////////////
+//
+// 批量内核
+//
+/////////////////////////////////////////////////
+
+// 三条按 stride 步进的float流编码到 out
+
+template <class Format>
+static void EncodeRange(const Format &f, const float *x, const float *y, const float *z, size_t stride,
+						typename Format::Packed *out, size_t n)
+{
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		f.Encode(LoadLanes(x + i * stride, stride), LoadLanes(y + i * stride, stride), LoadLanes(z + i * stride, stride),
+				 out + i);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = f.EncodeOne(Vector3D(x[i * stride], y[i * stride], z[i * stride]));
+	}
+}
+
+// DecodeRange
+//
+// transform为true时解码后立即乘以 m（包含平移），结果写入三条float流
+
+template <class Format, bool transform>
+static void DecodeRange(const Format &f, const Matrix4X3 &m, const typename Format::Packed *p,
+						float *x, float *y, float *z, size_t stride, size_t n)
+{
+	SimdFloat m11 = SimdSet1(m.m11), m12 = SimdSet1(m.m12), m13 = SimdSet1(m.m13);
+	SimdFloat m21 = SimdSet1(m.m21), m22 = SimdSet1(m.m22), m23 = SimdSet1(m.m23);
+	SimdFloat m31 = SimdSet1(m.m31), m32 = SimdSet1(m.m32), m33 = SimdSet1(m.m33);
+	SimdFloat tx = SimdSet1(m.tx), ty = SimdSet1(m.ty), tz = SimdSet1(m.tz);
+
+	size_t i = 0;
+
+	for (; i + KSIMDWIDTH <= n; i += KSIMDWIDTH)
+	{
+		SimdFloat px, py, pz;
+		f.Decode(p + i, px, py, pz);
+
+		if (transform)
+		{
+			SimdFloat rx = SimdMulAdd(pz, m31, SimdMulAdd(py, m21, SimdMulAdd(px, m11, tx)));
+			SimdFloat ry = SimdMulAdd(pz, m32, SimdMulAdd(py, m22, SimdMulAdd(px, m12, ty)));
+			SimdFloat rz = SimdMulAdd(pz, m33, SimdMulAdd(py, m23, SimdMulAdd(px, m13, tz)));
+			px = rx;
+			py = ry;
+			pz = rz;
+		}
+
+		StoreLanes(x + i * stride, stride, px);
+		StoreLanes(y + i * stride, stride, py);
+		StoreLanes(z + i * stride, stride, pz);
+	}
+
+	for (; i < n; i++)
+	{
+		Vector3D v = f.DecodeOne(p[i]);
+
+		if (transform)
+		{
+			v = Vector3D(v.x*m.m11 + v.y*m.m21 + v.z*m.m31 + m.tx,
+						 v.x*m.m12 + v.y*m.m22 + v.z*m.m32 + m.ty,
+						 v.x*m.m13 + v.y*m.m23 + v.z*m.m33 + m.tz);
+		}
+
+		x[i * stride] = v.x;
+		y[i * stride] = v.y;
+		z[i * stride] = v.z;
+	}
+}
+
+template <class Format>
+static void EncodeN(const Format &f, const Vector3D *v, typename Format::Packed *out, size_t n, JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		EncodeRange(f, &v[begin].x, &v[begin].y, &v[begin].z, 3, out + begin, end - begin);
+	});
+}
+
+template <class Format>
+static void EncodeN(const Format &f, const Vector3DSoA &v, typename Format::Packed *out, size_t n, JobPool *pool)
+{
+	assert(n <= v.Size());
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		EncodeRange(f, v.x + begin, v.y + begin, v.z + begin, 1, out + begin, end - begin);
+	});
+}
+
+template <class Format, bool transform>
+static void DecodeN(const Format &f, const Matrix4X3 &m, const typename Format::Packed *p, Vector3D *out, size_t n,
+					JobPool *pool)
+{
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		DecodeRange<Format, transform>(f, m, p + begin, &out[begin].x, &out[begin].y, &out[begin].z, 3, end - begin);
+	});
+}
+
+template <class Format, bool transform>
+static void DecodeN(const Format &f, const Matrix4X3 &m, const typename Format::Packed *p, Vector3DSoA &out, size_t n,
+					JobPool *pool)
+{
+	if (out.Size() < n)
+	{
+		out.Resize(n);
+	}
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		DecodeRange<Format, transform>(f, m, p + begin, out.x + begin, out.y + begin, out.z + begin, 1, end - begin);
+	});
+}
+
+// 定点数的解码 p = q * step + min 写成矩阵，再与 m 连接：
+// 各行乘以对应轴的步长，平移为 min 经 m 变换后的点
+
+static Matrix4X3 QuantizedMatrix(const AABB3D &bounds, const Matrix4X3 &m)
+{
+	Vector3D step = bounds.Size() * (1.0f / KQUANT16);
+	const Vector3D &min = bounds.min;
+
+	return Matrix4X3(m.m11 * step.x, m.m12 * step.x, m.m13 * step.x,
+					 m.m21 * step.y, m.m22 * step.y, m.m23 * step.y,
+					 m.m31 * step.z, m.m32 * step.z, m.m33 * step.z,
+					 min.x*m.m11 + min.y*m.m21 + min.z*m.m31 + m.tx,
+					 min.x*m.m12 + min.y*m.m22 + min.z*m.m32 + m.ty,
+					 min.x*m.m13 + min.y*m.m23 + min.z*m.m33 + m.tz);
+}
+
+// 只保留旋转部分
+
+static Matrix4X3 RotationPart(const Matrix4X3 &m)
+{
+	Matrix4X3 r = m;
+	r.tx = r.ty = r.tz = 0.0f;
+	return r;
+}
+
+/////////////////////////////////////////////////
+//
+// 对外接口
+//
+/////////////////////////////////////////////////
+
+void PackN(const Vector3D *v, HalfVector3D *out, size_t n, JobPool *pool)
+{
+	EncodeN(HalfFormat(), v, out, n, pool);
+}
+
+void PackN(const Vector3DSoA &v, HalfVector3D *out, size_t n, JobPool *pool)
+{
+	EncodeN(HalfFormat(), v, out, n, pool);
+}
+
+void PackN(const Vector3D *v, const AABB3D &bounds, QuantizedVector3D *out, size_t n, JobPool *pool)
+{
+	EncodeN(QuantizedFormat(bounds), v, out, n, pool);
+}
+
+void PackN(const Vector3DSoA &v, const AABB3D &bounds, QuantizedVector3D *out, size_t n, JobPool *pool)
+{
+	EncodeN(QuantizedFormat(bounds), v, out, n, pool);
+}
+
+void PackN(const Vector3D *v, OctNormal32 *out, size_t n, JobPool *pool)
+{
+	EncodeN(OctahedralFormat(), v, out, n, pool);
+}
+
+void PackN(const Vector3DSoA &v, OctNormal32 *out, size_t n, JobPool *pool)
+{
+	EncodeN(OctahedralFormat(), v, out, n, pool);
+}
+
+void UnpackN(const HalfVector3D *p, Vector3D *out, size_t n, JobPool *pool)
+{
+	DecodeN<HalfFormat, false>(HalfFormat(), Matrix4X3(), p, out, n, pool);
+}
+
+void UnpackN(const HalfVector3D *p, Vector3DSoA &out, size_t n, JobPool *pool)
+{
+	DecodeN<HalfFormat, false>(HalfFormat(), Matrix4X3(), p, out, n, pool);
+}
+
+void UnpackN(const QuantizedVector3D *p, const AABB3D &bounds, Vector3D *out, size_t n, JobPool *pool)
+{
+	DecodeN<QuantizedFormat, true>(QuantizedFormat(bounds), QuantizedMatrix(bounds, Matrix4X3()), p, out, n, pool);
+}
+
+void UnpackN(const QuantizedVector3D *p, const AABB3D &bounds, Vector3DSoA &out, size_t n, JobPool *pool)
+{
+	DecodeN<QuantizedFormat, true>(QuantizedFormat(bounds), QuantizedMatrix(bounds, Matrix4X3()), p, out, n, pool);
+}
+
+void UnpackN(const OctNormal32 *p, Vector3D *out, size_t n, JobPool *pool)
+{
+	DecodeN<OctahedralFormat, false>(OctahedralFormat(), Matrix4X3(), p, out, n, pool);
+}
+
+void UnpackN(const OctNormal32 *p, Vector3DSoA &out, size_t n, JobPool *pool)
+{
+	DecodeN<OctahedralFormat, false>(OctahedralFormat(), Matrix4X3(), p, out, n, pool);
+}
+
+void TransformPoints(const Matrix4X3 &m, const HalfVector3D *in, Point3D *out, size_t n, JobPool *pool)
+{
+	DecodeN<HalfFormat, true>(HalfFormat(), m, in, out, n, pool);
+}
+
+void TransformPoints(const Matrix4X3 &m, const HalfVector3D *in, Point3DSoA &out, size_t n, JobPool *pool)
+{
+	DecodeN<HalfFormat, true>(HalfFormat(), m, in, out, n, pool);
+}
+
+void TransformPoints(const Matrix4X3 &m, const QuantizedVector3D *in, const AABB3D &bounds, Point3D *out, size_t n,
+					 JobPool *pool)
+{
+	DecodeN<QuantizedFormat, true>(QuantizedFormat(bounds), QuantizedMatrix(bounds, m), in, out, n, pool);
+}
+
+void TransformPoints(const Matrix4X3 &m, const QuantizedVector3D *in, const AABB3D &bounds, Point3DSoA &out, size_t n,
+					 JobPool *pool)
+{
+	DecodeN<QuantizedFormat, true>(QuantizedFormat(bounds), QuantizedMatrix(bounds, m), in, out, n, pool);
+}
+
+void TransformDirections(const Matrix4X3 &m, const HalfVector3D *in, Vector3D *out, size_t n, JobPool *pool)
+{
+	DecodeN<HalfFormat, true>(HalfFormat(), RotationPart(m), in, out, n, pool);
+}
+
+void TransformDirections(const Matrix4X3 &m, const HalfVector3D *in, Vector3DSoA &out, size_t n, JobPool *pool)
+{
+	DecodeN<HalfFormat, true>(HalfFormat(), RotationPart(m), in, out, n, pool);
+}
+
+void TransformDirections(const Matrix4X3 &m, const OctNormal32 *in, Vector3D *out, size_t n, JobPool *pool)
+{
+	DecodeN<OctahedralFormat, true>(OctahedralFormat(), RotationPart(m), in, out, n, pool);
+}
+
+void TransformDirections(const Matrix4X3 &m, const OctNormal32 *in, Vector3DSoA &out, size_t n, JobPool *pool)
+{
+	DecodeN<OctahedralFormat, true>(OctahedralFormat(), RotationPart(m), in, out, n, pool);
+}
@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Vector3DCompress.h
+// func: 三维向量的压缩存储，用于顶点、法线与速度等大批量数据
+// disc: 三种编码：
+//		 HalfVector3D       每个分量一个半精度浮点数，6字节
+//		 QuantizedVector3D  相对于给定包围盒的16位定点数，6字节，
+//		                    包围盒不随数据存放，编码与解码时传入同一个
+//		 OctNormal32        单位向量的八面体映射，每个分量16位，4字节
+//		 批量版本每次处理 KSIMDWIDTH 个向量，输入输出可以是 Vector3D 数组
+//		 或 Vector3DSoA，pool 不为NULL时按 KJOBBATCHGRAIN 分块并行；
+//		 批量与逐个编码的结果可能在舍入边界上差一个量化步长
+//		 变换函数直接读取压缩数据，解码后在寄存器中完成变换
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Vector3D;
+class Vector3DSoA;
+class AABB3D;
+class Matrix4X3;
+class JobPool;
+
+typedef Vector3D Point3D;
+typedef Vector3DSoA Point3DSoA;
+
+struct HalfVector3D
+{
+	uint16_t v[3];
+};
+
+struct QuantizedVector3D
+{
+	uint16_t v[3];
+};
+
+struct OctNormal32
+{
+	int16_t v[2];
+};
+
+static_assert(sizeof(HalfVector3D) == 6, "HalfVector3D must be six bytes");
+static_assert(sizeof(QuantizedVector3D) == 6, "QuantizedVector3D must be six bytes");
+static_assert(sizeof(OctNormal32) == 4, "OctNormal32 must be four bytes");
+
+// 半精度的表示范围，超出的分量截断到 ±KHALFMAX，不产生无穷大
+
+const float KHALFMAX = 65504.0f;
+
+// 半精度的误差：|v| >= 2^-14 时相对误差不超过 2^-11，
+// 更小的值（非规格化数）绝对误差不超过 2^-25
+
+const float KHALFMAXRELERROR = 1.0f / 2048.0f;
+const float KHALFMAXABSERROR = 1.0f / 33554432.0f;
+
+// 八面体编码再解码后与原单位向量的最大夹角（弧度），实测值见 BenchVector3DCompress
+
+const float KOCTNORMALMAXERROR = 7.0e-5f;
+
+// 定点编码各轴的最大误差，为包围盒在该轴上尺寸的 1/131070 加上解码的舍入误差，
+// 包围盒外的点截断到包围盒表面
+
+extern Vector3D GetQuantizationError(const AABB3D &bounds);
+
+// 单个编码与解码，PackOctahedral 的输入必须是单位向量
+
+extern HalfVector3D PackHalf(const Vector3D &v);
+extern QuantizedVector3D PackQuantized(const Vector3D &v, const AABB3D &bounds);
+extern OctNormal32 PackOctahedral(const Vector3D &n);
+
+extern Vector3D Unpack(const HalfVector3D &p);
+extern Vector3D Unpack(const QuantizedVector3D &p, const AABB3D &bounds);
+extern Vector3D Unpack(const OctNormal32 &p);
+
+// 批量编码 out[i] = Pack(v[i])
+
+extern void PackN(const Vector3D *v, HalfVector3D *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Vector3DSoA &v, HalfVector3D *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Vector3D *v, const AABB3D &bounds, QuantizedVector3D *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Vector3DSoA &v, const AABB3D &bounds, QuantizedVector3D *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Vector3D *v, OctNormal32 *out, size_t n, JobPool *pool = NULL);
+extern void PackN(const Vector3DSoA &v, OctNormal32 *out, size_t n, JobPool *pool = NULL);
+
+// 批量解码 out[i] = Unpack(p[i])，SoA 输出的元素个数不足n时会自动扩充
+
+extern void UnpackN(const HalfVector3D *p, Vector3D *out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const HalfVector3D *p, Vector3DSoA &out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const QuantizedVector3D *p, const AABB3D &bounds, Vector3D *out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const QuantizedVector3D *p, const AABB3D &bounds, Vector3DSoA &out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const OctNormal32 *p, Vector3D *out, size_t n, JobPool *pool = NULL);
+extern void UnpackN(const OctNormal32 *p, Vector3DSoA &out, size_t n, JobPool *pool = NULL);
+
+// 直接变换压缩数据，结果与先 UnpackN 再调用 Matrix4X3Batch 中的同名函数
+// 在浮点舍入误差内一致
+// 定点数的解码是仿射变换，并入矩阵后不需要单独的解码，但逐个元素拆出
+// 定点数再转成浮点仍比普通的点变换慢：1M 个点，每个点 SSE2 下约 2.19 ns，
+// 普通的 Vector3DSoA 点变换约 1.24 ns；AVX2 下约 2.29 ns 对 1.29 ns
+// 八面体法线只做旋转部分，不重新归一化
+
+extern void TransformPoints(const Matrix4X3 &m, const HalfVector3D *in, Point3D *out, size_t n, JobPool *pool = NULL);
+extern void TransformPoints(const Matrix4X3 &m, const HalfVector3D *in, Point3DSoA &out, size_t n, JobPool *pool = NULL);
+extern void TransformPoints(const Matrix4X3 &m, const QuantizedVector3D *in, const AABB3D &bounds, Point3D *out, size_t n,
+							JobPool *pool = NULL);
+extern void TransformPoints(const Matrix4X3 &m, const QuantizedVector3D *in, const AABB3D &bounds, Point3DSoA &out, size_t n,
+							JobPool *pool = NULL);
+extern void TransformDirections(const Matrix4X3 &m, const HalfVector3D *in, Vector3D *out, size_t n, JobPool *pool = NULL);
+extern void TransformDirections(const Matrix4X3 &m, const HalfVector3D *in, Vector3DSoA &out, size_t n, JobPool *pool = NULL);
+extern void TransformDirections(const Matrix4X3 &m, const OctNormal32 *in, Vector3D *out, size_t n, JobPool *pool = NULL);
+extern void TransformDirections(const Matrix4X3 &m, const OctNormal32 *in, Vector3DSoA &out, size_t n, JobPool *pool = NULL);
@@ -0,0 +1,153 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Vector3DSoA.cpp
+// func: 结构数组(SoA)形式的三维向量容器
+//
+///////////////////////////////////////////////////////////////////
+
+#include "Vector3DSoA.h"
+#include "Simd.h"
+
+#include <cassert>
+#include <cstring>
+
+Vector3DSoA::Vector3DSoA()
+	: x(NULL)
+	, y(NULL)
+	, z(NULL)
+	, m_size(0)
+	, m_capacity(0)
+{
+}
+
+Vector3DSoA::Vector3DSoA(size_t n)
+	: x(NULL)
+	, y(NULL)
+	, z(NULL)
+	, m_size(0)
+	, m_capacity(0)
+{
+	Resize(n);
+}
+
+Vector3DSoA::Vector3DSoA(const Vector3DSoA &v)
+	: x(NULL)
+	, y(NULL)
+	, z(NULL)
+	, m_size(0)
+	, m_capacity(0)
+{
+	*this = v;
+}
+
+Vector3DSoA::~Vector3DSoA()
+{
+	// 三条流共用一块内存，x指向其起始
+
+	AlignedFree(x);
+}
+
+Vector3DSoA &Vector3DSoA::operator = (const Vector3DSoA &v)
+{
+	if (this == &v)
+	{
+		return *this;
+	}
+
+	Resize(v.m_size);
+
+	if (m_size > 0)
+	{
+		memcpy(x, v.x, m_size * sizeof(float));
+		memcpy(y, v.y, m_size * sizeof(float));
+		memcpy(z, v.z, m_size * sizeof(float));
+	}
+
+	return *this;
+}
+
+// Vector3DSoA::Reserve
+//
+// 重新分配时三条流放在同一块内存中，各自按缓存行对齐
+
+void Vector3DSoA::Reserve(size_t n)
+{
+	size_t capacity = SimdPadCount(n);
+
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	float *data = (float *)AlignedMalloc(capacity * 3 * sizeof(float));
+	assert(data != NULL);
+
+	// 补齐部分置零，保证批量内核读到的尾部数据是确定值
+
+	memset(data, 0, capacity * 3 * sizeof(float));
+
+	if (m_size > 0)
+	{
+		memcpy(data, x, m_size * sizeof(float));
+		memcpy(data + capacity, y, m_size * sizeof(float));
+		memcpy(data + capacity * 2, z, m_size * sizeof(float));
+	}
+
+	AlignedFree(x);
+
+	x = data;
+	y = data + capacity;
+	z = data + capacity * 2;
+	m_capacity = capacity;
+}
+
+void Vector3DSoA::Resize(size_t n)
+{
+	Reserve(n);
+
+	// 缩小时把多出的元素清零，补齐部分保持为零
+
+	if (n < m_size)
+	{
+		memset(x + n, 0, (m_size - n) * sizeof(float));
+		memset(y + n, 0, (m_size - n) * sizeof(float));
+		memset(z + n, 0, (m_size - n) * sizeof(float));
+	}
+
+	m_size = n;
+}
+
+void Vector3DSoA::PushBack(const Vector3D &v)
+{
+	if (m_size == m_capacity)
+	{
+		Reserve(m_capacity == 0 ? KSIMDPADFLOATS : m_capacity * 2);
+	}
+
+	x[m_size] = v.x;
+	y[m_size] = v.y;
+	z[m_size] = v.z;
+	m_size++;
+}
+
+void Vector3DSoA::FromAoS(const Vector3D *src, size_t n)
+{
+	Resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		x[i] = src[i].x;
+		y[i] = src[i].y;
+		z[i] = src[i].z;
+	}
+}
+
+void Vector3DSoA::ToAoS(Vector3D *dst) const
+{
+	for (size_t i = 0; i < m_size; i++)
+	{
+		dst[i].x = x[i];
+		dst[i].y = y[i];
+		dst[i].z = z[i];
+	}
+}
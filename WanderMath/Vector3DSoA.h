@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: Vector3DSoA.h
+// func: 结构数组(SoA)形式的三维向量容器
+// disc: x,y,z 分别存放在三条连续的float流中，每条流按缓存行
+//		 对齐并补齐到 KSIMDPADFLOATS 的整数倍，补齐部分始终为零，
+//		 批量内核可以直接按SIMD宽度处理而无需处理尾部
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_Vector3DSoA_h
+#define Wander_Vector3DSoA_h
+
+#include <cassert>
+#include <cstddef>
+#include "Vector3D.h"
+
+typedef class Vector3DSoA
+{
+public:
+	Vector3DSoA();
+	explicit Vector3DSoA(size_t n);
+	Vector3DSoA(const Vector3DSoA &v);
+	~Vector3DSoA();
+
+	Vector3DSoA &operator = (const Vector3DSoA &v);
+
+	// 改变元素个数，原有数据保留，新增元素置零
+
+	void Resize(size_t n);
+
+	// 预留容量，不改变元素个数
+
+	void Reserve(size_t n);
+
+	// 与 Resize(0) 相同，已有元素清零，之后扩大时不会再读到旧数据
+
+	void Clear()
+	{
+		Resize(0);
+	}
+
+	size_t Size() const
+	{
+		return m_size;
+	}
+
+	// 每条流实际可访问的元素个数（包含补齐部分）
+
+	size_t Capacity() const
+	{
+		return m_capacity;
+	}
+
+	void Set(size_t i, const Vector3D &v)
+	{
+		assert(i < m_size);
+		x[i] = v.x;
+		y[i] = v.y;
+		z[i] = v.z;
+	}
+
+	Vector3D Get(size_t i) const
+	{
+		assert(i < m_size);
+		return Vector3D(x[i], y[i], z[i]);
+	}
+
+	void PushBack(const Vector3D &v);
+
+	// 与数组结构(AoS)之间转换
+
+	void FromAoS(const Vector3D *src, size_t n);
+	void ToAoS(Vector3D *dst) const;
+
+public:
+	float *x;
+	float *y;
+	float *z;
+
+private:
+	size_t m_size;
+	size_t m_capacity;
+}Point3DSoA;
+
+#endif
@@ -11,6 +11,7 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <type_traits>
 
 using namespace std;
 
@@ -18,22 +19,9 @@ typedef class Vector4D
 {
 public:
     
-	Vector4D(){}
+	Vector4D() = default;
     
-	~Vector4D(){}
-    
-	Vector4D(const Vector4D &v):x(v.x), y(v.y), z(v.z), w(v.w){}
-    
-	Vector4D(float nx, float ny, float nz, float nw):x(nx), y(ny), z(nz), w(nw){}
-    
-	Vector4D &operator = (const Vector4D &v)
-	{
-		x = v.x;
-		y = v.y;
-		z = v.z;
-		w = v.w;
-		return *this;
-	}
+	constexpr Vector4D(float nx, float ny, float nz, float nw):x(nx), y(ny), z(nz), w(nw){}
     
 	void Init(float nx, float ny, float nz, float nw)
 	{
@@ -43,32 +31,32 @@ public:
 		w = nw;
 	}
     
-	bool operator == (const Vector4D &v) const
+	constexpr bool operator == (const Vector4D &v) const
 	{
 		return (x == v.x && y == v.y && z == v.z && w == v.w);
 	}
     
-	bool operator != (const Vector4D &v) const
+	constexpr bool operator != (const Vector4D &v) const
 	{
 		return !(*this == v);
 	}
     
-	Vector4D operator - (const Vector4D &v) const
+	constexpr Vector4D operator - (const Vector4D &v) const
 	{
 		return Vector4D(x - v.x, y - v.y, z - v.z, w - v.w);
 	}
     
-	Vector4D operator + (const Vector4D &v) const
+	constexpr Vector4D operator + (const Vector4D &v) const
 	{
 		return Vector4D(x + v.x, y + v.y, z + v.z, w + v.w);
 	}
     
-	Vector4D operator * (float a) const
+	constexpr Vector4D operator * (float a) const
 	{
 		return Vector4D(a * x, a * y, a * z, a * w);
 	}
     
-	Vector4D operator / (float a) const
+	constexpr Vector4D operator / (float a) const
 	{
 		assert(a != 0);
 		float tmp = 1.0f / a;
@@ -76,7 +64,7 @@ public:
 		return Vector4D(x * tmp, y * tmp, z *tmp, w * tmp);
 	}
     
-	Vector4D &operator += (const Vector4D &v)
+	constexpr Vector4D &operator += (const Vector4D &v)
 	{
 		x += v.x;
 		y += v.y;
@@ -85,7 +73,7 @@ public:
 		return *this;
 	}
     
-	Vector4D &operator -= (const Vector4D &v)
+	constexpr Vector4D &operator -= (const Vector4D &v)
 	{
 		x -= v.x;
 		y -= v.y;
@@ -93,7 +81,7 @@ public:
 		return *this;
 	}
     
-	Vector4D &operator *= (float a)
+	constexpr Vector4D &operator *= (float a)
 	{
 		x *= a;
 		y *= a;
@@ -101,7 +89,7 @@ public:
 		return *this;
 	}
     
-	Vector4D &operator /= (float a)
+	constexpr Vector4D &operator /= (float a)
 	{
 		assert( a != 0);
 		float tmp = 1.0f / a;
@@ -113,7 +101,7 @@ public:
     
 	// 两向量点积
     
-	float operator * (const Vector4D &v) const
+	constexpr float operator * (const Vector4D &v) const
 	{
 		return (x*v.x + y*v.y + z*v.z);
 	}
@@ -126,6 +114,9 @@ public:
 	float w;
 }Point4D;
 
+static_assert(std::is_trivially_copyable<Vector4D>::value, "Vector4D must stay trivially copyable");
+static_assert(std::is_standard_layout<Vector4D>::value, "Vector4D must stay standard layout");
+
 
 
 //// 计算两个向量叉乘
@@ -0,0 +1,192 @@
+//////////////////////////////////////////////////////////////////
+//
+//	name:	Vector4DSimd.h
+//	func:	以 __m128 存放的四维向量
+//	disc:	成员名与接口同 Vector4D，按16字节对齐，四个分量在一个寄存器
+//			中同时运算；定义 WANDER_NO_SIMD 或没有SSE时退化为逐分量计算
+//			成员是普通的 float，经 Load/Store 整体进出寄存器，
+//			不依赖匿名结构体或读取联合体的非活动成员
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_Vector4DSimd_h
+#define Wander_Vector4DSimd_h
+
+#include <cassert>
+
+#include "Simd.h"
+#include "Vector4D.h"
+
+typedef class WANDER_ALIGN(16) Vector4DSimd
+{
+public:
+
+	Vector4DSimd(){}
+
+	Vector4DSimd(float nx, float ny, float nz, float nw)
+	{
+		Init(nx, ny, nz, nw);
+	}
+
+	explicit Vector4DSimd(const Vector4D &a)
+	{
+		Init(a.x, a.y, a.z, a.w);
+	}
+
+#if defined(WANDER_SIMD_SSE)
+	explicit Vector4DSimd(__m128 a)
+	{
+		Store(a);
+	}
+
+	// 四个分量按 x, y, z, w 的顺序整体载入或写回
+
+	__m128 Load() const
+	{
+		return _mm_load_ps(&x);
+	}
+
+	void Store(__m128 a)
+	{
+		_mm_store_ps(&x, a);
+	}
+#endif
+
+	Vector4D ToVector4D() const
+	{
+		return Vector4D(x, y, z, w);
+	}
+
+	void Init(float nx, float ny, float nz, float nw)
+	{
+		x = nx;
+		y = ny;
+		z = nz;
+		w = nw;
+	}
+
+	bool operator == (const Vector4DSimd &a) const
+	{
+#if defined(WANDER_SIMD_SSE)
+		return _mm_movemask_ps(_mm_cmpeq_ps(Load(), a.Load())) == 0xF;
+#else
+		return (x == a.x && y == a.y && z == a.z && w == a.w);
+#endif
+	}
+
+	bool operator != (const Vector4DSimd &a) const
+	{
+		return !(*this == a);
+	}
+
+	Vector4DSimd operator - (const Vector4DSimd &a) const
+	{
+#if defined(WANDER_SIMD_SSE)
+		return Vector4DSimd(_mm_sub_ps(Load(), a.Load()));
+#else
+		return Vector4DSimd(x - a.x, y - a.y, z - a.z, w - a.w);
+#endif
+	}
+
+	Vector4DSimd operator + (const Vector4DSimd &a) const
+	{
+#if defined(WANDER_SIMD_SSE)
+		return Vector4DSimd(_mm_add_ps(Load(), a.Load()));
+#else
+		return Vector4DSimd(x + a.x, y + a.y, z + a.z, w + a.w);
+#endif
+	}
+
+	Vector4DSimd operator * (float a) const
+	{
+#if defined(WANDER_SIMD_SSE)
+		return Vector4DSimd(_mm_mul_ps(Load(), _mm_set1_ps(a)));
+#else
+		return Vector4DSimd(a * x, a * y, a * z, a * w);
+#endif
+	}
+
+	Vector4DSimd operator / (float a) const
+	{
+		assert(a != 0);
+		return *this * (1.0f / a);
+	}
+
+	// 复合赋值与 Vector4D 相同：+= 四个分量都参与，-=、*=、/= 只改变 x, y, z，
+	// w 保持不变；四个分量都要参与时用 a = a - b、a = a * k
+
+	Vector4DSimd &operator += (const Vector4DSimd &a)
+	{
+		*this = *this + a;
+		return *this;
+	}
+
+	Vector4DSimd &operator -= (const Vector4DSimd &a)
+	{
+#if defined(WANDER_SIMD_SSE)
+		__m128 xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+		Store(_mm_sub_ps(Load(), _mm_and_ps(a.Load(), xyz)));
+#else
+		x -= a.x;
+		y -= a.y;
+		z -= a.z;
+#endif
+		return *this;
+	}
+
+	Vector4DSimd &operator *= (float a)
+	{
+#if defined(WANDER_SIMD_SSE)
+		Store(_mm_mul_ps(Load(), _mm_setr_ps(a, a, a, 1.0f)));
+#else
+		x *= a;
+		y *= a;
+		z *= a;
+#endif
+		return *this;
+	}
+
+	Vector4DSimd &operator /= (float a)
+	{
+		assert(a != 0);
+		return *this *= 1.0f / a;
+	}
+
+	// 两向量点积，与 Vector4D 一致只用 x, y, z
+
+	float operator * (const Vector4DSimd &a) const
+	{
+#if defined(WANDER_SIMD_SSE)
+		__m128 m = _mm_mul_ps(Load(), a.Load());
+		__m128 t = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 0, 0, 1)));
+		t = _mm_add_ss(t, _mm_movehl_ps(m, m));
+		return _mm_cvtss_f32(t);
+#else
+		return (x*a.x + y*a.y + z*a.z);
+#endif
+	}
+
+public:
+	float x;
+	float y;
+	float z;
+	float w;
+}Point4DSimd;
+
+static_assert(sizeof(Vector4DSimd) == 16, "Vector4DSimd must be four packed floats");
+
+// 四个分量的点积，结果广播到所有通道后取出
+
+inline float DotProduct4(const Vector4DSimd &a, const Vector4DSimd &b)
+{
+#if defined(WANDER_SIMD_SSE)
+	__m128 m = _mm_mul_ps(a.Load(), b.Load());
+	__m128 t = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+	t = _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(t);
+#else
+	return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+#endif
+}
+
+#endif
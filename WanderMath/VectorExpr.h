@@ -0,0 +1,513 @@
+//////////////////////////////////////////////////////////////////
+//
+// name: VectorExpr.h
+// func: Vector2D/Vector3D 的表达式模板，按需启用
+// disc: 用 MakeExpr 包装参与运算的向量后，+ - 与数乘不再立即求值，
+//		 而是组成一棵表达式树，赋给向量时对每个分量一次算完整个表达式，
+//		 中间不产生临时向量：
+//			Vector3D r = MakeExpr(a) + MakeExpr(b) * s - c;
+//		 包装 Vector3DSoA 时表达式作用于整个数组，由 Assign 逐元素求值，
+//		 每次按SIMD宽度处理一组，单个向量参与时广播到每个元素：
+//			Assign(pos, MakeExpr(pos) + MakeExpr(vel) * MakeExpr(dt), n);
+//		 只接受普通的 Vector2D/Vector3D 运算符，不改变它们的行为；
+//		 单个向量按值复制进表达式，数组只保存指针，
+//		 不要用 auto 保存引用了数组的表达式
+//		 性能（BenchVectorExpr，256K 个元素，每个元素）：
+//			单个向量的表达式与普通运算符相当，SSE2 下约 2.1 ns 对 2.1 ns，
+//			没有收益，只在省去临时变量写法更清楚时使用；
+//			数组的 Assign 在 SSE2/AVX2 下约 1.6-1.9 ns，逐个 Vector3D
+//			的循环约 2.2-2.9 ns；WANDER_NO_SIMD 下 Assign 约 2.4-2.9 ns，
+//			反而比逐个循环的 2.3-2.6 ns 慢
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef Wander_VectorExpr_h
+#define Wander_VectorExpr_h
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include "JobPool.h"
+#include "Simd.h"
+#include "Vector2D.h"
+#include "Vector3D.h"
+#include "Vector3DSoA.h"
+
+static_assert(sizeof(Vector2D) == 2 * sizeof(float), "Vector2D must be two packed floats");
+static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D must be three packed floats");
+
+///////////////////////////////////////////////////////////////////
+//
+// 表达式节点
+//
+// 每个节点提供：
+//   KDIM              分量个数
+//   KARRAY            是否引用了数组，为0时可以转换成单个向量
+//   VectorType        求值得到的向量类型
+//   Get(k, i)         第 i 个元素的第 k 个分量，单个向量忽略 i
+//   Load(k, i)        从第 i 个元素起一组 KSIMDWIDTH 个元素的第 k 个分量
+//   Aliases(p)        表达式是否读取以 p 开始的数组
+//
+// Get 与 Load 强制内联，否则整棵树在每个元素上展开成一串函数调用
+//
+///////////////////////////////////////////////////////////////////
+
+template <class E>
+class VecExpr
+{
+public:
+	const E &Self() const
+	{
+		return static_cast<const E &>(*this);
+	}
+
+	// 不含数组的表达式可以直接赋给对应的向量类型
+	// 这里 E 还不完整，经由模板参数 D 推迟到使用时再检查
+
+	template <class V, class D = E, class = typename std::enable_if<std::is_same<V, typename D::VectorType>::value>::type>
+	operator V() const
+	{
+		return Eval(*this);
+	}
+};
+
+// 单个向量，数组表达式中广播到每个元素
+
+template <class V, int N>
+class VecLeaf : public VecExpr<VecLeaf<V, N> >
+{
+public:
+	enum { KDIM = N, KARRAY = 0 };
+	typedef V VectorType;
+
+	explicit VecLeaf(const V &v)
+	{
+		for (int k = 0; k < N; k++)
+		{
+			m_v[k] = (&v.x)[k];
+		}
+	}
+
+	WANDER_FORCEINLINE float Get(int k, size_t) const
+	{
+		return m_v[k];
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(int k, size_t) const
+	{
+		return SimdSet1(m_v[k]);
+	}
+
+	bool Aliases(const float *) const
+	{
+		return false;
+	}
+
+private:
+	float m_v[N];
+};
+
+// Vector3DSoA 中的一个数组
+
+class VecSoALeaf : public VecExpr<VecSoALeaf>
+{
+public:
+	enum { KDIM = 3, KARRAY = 1 };
+	typedef Vector3D VectorType;
+
+	explicit VecSoALeaf(const Vector3DSoA &v)
+	{
+		m_c[0] = v.x;
+		m_c[1] = v.y;
+		m_c[2] = v.z;
+	}
+
+	WANDER_FORCEINLINE float Get(int k, size_t i) const
+	{
+		return m_c[k][i];
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(int k, size_t i) const
+	{
+		return SimdLoad(m_c[k] + i);
+	}
+
+	bool Aliases(const float *p) const
+	{
+		return m_c[0] == p || m_c[1] == p || m_c[2] == p;
+	}
+
+private:
+	const float *m_c[3];
+};
+
+template <class A, class B>
+class VecSum : public VecExpr<VecSum<A, B> >
+{
+public:
+	enum { KDIM = A::KDIM, KARRAY = A::KARRAY | B::KARRAY };
+	typedef typename A::VectorType VectorType;
+
+	static_assert((int)A::KDIM == (int)B::KDIM, "operands must have the same dimension");
+
+	VecSum(const A &a, const B &b) : m_a(a), m_b(b) {}
+
+	WANDER_FORCEINLINE float Get(int k, size_t i) const
+	{
+		return m_a.Get(k, i) + m_b.Get(k, i);
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(int k, size_t i) const
+	{
+		return SimdAdd(m_a.Load(k, i), m_b.Load(k, i));
+	}
+
+	bool Aliases(const float *p) const
+	{
+		return m_a.Aliases(p) || m_b.Aliases(p);
+	}
+
+private:
+	A m_a;
+	B m_b;
+};
+
+template <class A, class B>
+class VecDiff : public VecExpr<VecDiff<A, B> >
+{
+public:
+	enum { KDIM = A::KDIM, KARRAY = A::KARRAY | B::KARRAY };
+	typedef typename A::VectorType VectorType;
+
+	static_assert((int)A::KDIM == (int)B::KDIM, "operands must have the same dimension");
+
+	VecDiff(const A &a, const B &b) : m_a(a), m_b(b) {}
+
+	WANDER_FORCEINLINE float Get(int k, size_t i) const
+	{
+		return m_a.Get(k, i) - m_b.Get(k, i);
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(int k, size_t i) const
+	{
+		return SimdSub(m_a.Load(k, i), m_b.Load(k, i));
+	}
+
+	bool Aliases(const float *p) const
+	{
+		return m_a.Aliases(p) || m_b.Aliases(p);
+	}
+
+private:
+	A m_a;
+	B m_b;
+};
+
+template <class A>
+class VecNeg : public VecExpr<VecNeg<A> >
+{
+public:
+	enum { KDIM = A::KDIM, KARRAY = A::KARRAY };
+	typedef typename A::VectorType VectorType;
+
+	explicit VecNeg(const A &a) : m_a(a) {}
+
+	WANDER_FORCEINLINE float Get(int k, size_t i) const
+	{
+		return -m_a.Get(k, i);
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(int k, size_t i) const
+	{
+		return SimdXor(m_a.Load(k, i), SimdSet1(-0.0f));
+	}
+
+	bool Aliases(const float *p) const
+	{
+		return m_a.Aliases(p);
+	}
+
+private:
+	A m_a;
+};
+
+///////////////////////////////////////////////////////////////////
+//
+// 标量：常数或每个元素一个的float数组
+//
+///////////////////////////////////////////////////////////////////
+
+class ScalarConst
+{
+public:
+	enum { KARRAY = 0 };
+
+	explicit ScalarConst(float s) : m_s(s) {}
+
+	WANDER_FORCEINLINE float Get(size_t) const
+	{
+		return m_s;
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(size_t) const
+	{
+		return SimdSet1(m_s);
+	}
+
+	bool Aliases(const float *) const
+	{
+		return false;
+	}
+
+private:
+	float m_s;
+};
+
+class ScalarStream
+{
+public:
+	enum { KARRAY = 1 };
+
+	explicit ScalarStream(const float *s) : m_s(s) {}
+
+	WANDER_FORCEINLINE float Get(size_t i) const
+	{
+		return m_s[i];
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(size_t i) const
+	{
+		return SimdLoad(m_s + i);
+	}
+
+	bool Aliases(const float *p) const
+	{
+		return m_s == p;
+	}
+
+private:
+	const float *m_s;
+};
+
+// 数乘，与 Vector3D::operator *(float) 相同，每个分量乘同一个标量
+
+template <class A, class S>
+class VecScale : public VecExpr<VecScale<A, S> >
+{
+public:
+	enum { KDIM = A::KDIM, KARRAY = A::KARRAY | S::KARRAY };
+	typedef typename A::VectorType VectorType;
+
+	VecScale(const A &a, const S &s) : m_a(a), m_s(s) {}
+
+	WANDER_FORCEINLINE float Get(int k, size_t i) const
+	{
+		return m_s.Get(i) * m_a.Get(k, i);
+	}
+
+	WANDER_FORCEINLINE SimdFloat Load(int k, size_t i) const
+	{
+		return SimdMul(m_s.Load(i), m_a.Load(k, i));
+	}
+
+	bool Aliases(const float *p) const
+	{
+		return m_a.Aliases(p) || m_s.Aliases(p);
+	}
+
+private:
+	A m_a;
+	S m_s;
+};
+
+///////////////////////////////////////////////////////////////////
+//
+// 包装与运算符
+//
+///////////////////////////////////////////////////////////////////
+
+inline VecLeaf<Vector2D, 2> MakeExpr(const Vector2D &v)
+{
+	return VecLeaf<Vector2D, 2>(v);
+}
+
+inline VecLeaf<Vector3D, 3> MakeExpr(const Vector3D &v)
+{
+	return VecLeaf<Vector3D, 3>(v);
+}
+
+inline VecSoALeaf MakeExpr(const Vector3DSoA &v)
+{
+	return VecSoALeaf(v);
+}
+
+// 每个元素一个的标量，例如各自的时间步长或质量的倒数
+
+inline ScalarStream MakeExpr(const float *s)
+{
+	return ScalarStream(s);
+}
+
+template <class A, class B>
+inline VecSum<A, B> operator + (const VecExpr<A> &a, const VecExpr<B> &b)
+{
+	return VecSum<A, B>(a.Self(), b.Self());
+}
+
+template <class A, class B>
+inline VecDiff<A, B> operator - (const VecExpr<A> &a, const VecExpr<B> &b)
+{
+	return VecDiff<A, B>(a.Self(), b.Self());
+}
+
+template <class A>
+inline VecNeg<A> operator - (const VecExpr<A> &a)
+{
+	return VecNeg<A>(a.Self());
+}
+
+template <class A>
+inline VecScale<A, ScalarConst> operator * (const VecExpr<A> &a, float s)
+{
+	return VecScale<A, ScalarConst>(a.Self(), ScalarConst(s));
+}
+
+template <class A>
+inline VecScale<A, ScalarConst> operator * (float s, const VecExpr<A> &a)
+{
+	return VecScale<A, ScalarConst>(a.Self(), ScalarConst(s));
+}
+
+// 与 Vector3D::operator / 相同，乘以倒数
+
+template <class A>
+inline VecScale<A, ScalarConst> operator / (const VecExpr<A> &a, float s)
+{
+	assert(s != 0);
+	return VecScale<A, ScalarConst>(a.Self(), ScalarConst(1.0f / s));
+}
+
+template <class A>
+inline VecScale<A, ScalarStream> operator * (const VecExpr<A> &a, const ScalarStream &s)
+{
+	return VecScale<A, ScalarStream>(a.Self(), s);
+}
+
+template <class A>
+inline VecScale<A, ScalarStream> operator * (const ScalarStream &s, const VecExpr<A> &a)
+{
+	return VecScale<A, ScalarStream>(a.Self(), s);
+}
+
+// 表达式与未包装的向量混合运算时，向量按单个向量参与
+
+template <class A>
+inline VecSum<A, VecLeaf<typename A::VectorType, A::KDIM> > operator + (const VecExpr<A> &a, const typename A::VectorType &b)
+{
+	return VecSum<A, VecLeaf<typename A::VectorType, A::KDIM> >(a.Self(), VecLeaf<typename A::VectorType, A::KDIM>(b));
+}
+
+template <class A>
+inline VecSum<VecLeaf<typename A::VectorType, A::KDIM>, A> operator + (const typename A::VectorType &a, const VecExpr<A> &b)
+{
+	return VecSum<VecLeaf<typename A::VectorType, A::KDIM>, A>(VecLeaf<typename A::VectorType, A::KDIM>(a), b.Self());
+}
+
+template <class A>
+inline VecDiff<A, VecLeaf<typename A::VectorType, A::KDIM> > operator - (const VecExpr<A> &a, const typename A::VectorType &b)
+{
+	return VecDiff<A, VecLeaf<typename A::VectorType, A::KDIM> >(a.Self(), VecLeaf<typename A::VectorType, A::KDIM>(b));
+}
+
+template <class A>
+inline VecDiff<VecLeaf<typename A::VectorType, A::KDIM>, A> operator - (const typename A::VectorType &a, const VecExpr<A> &b)
+{
+	return VecDiff<VecLeaf<typename A::VectorType, A::KDIM>, A>(VecLeaf<typename A::VectorType, A::KDIM>(a), b.Self());
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// 求值
+//
+///////////////////////////////////////////////////////////////////
+
+template <class A>
+inline Vector2D EvalVector(const VecExpr<A> &e, const Vector2D *)
+{
+	return Vector2D(e.Self().Get(0, 0), e.Self().Get(1, 0));
+}
+
+template <class A>
+inline Vector3D EvalVector(const VecExpr<A> &e, const Vector3D *)
+{
+	return Vector3D(e.Self().Get(0, 0), e.Self().Get(1, 0), e.Self().Get(2, 0));
+}
+
+// Eval
+//
+// 把不含数组的表达式算成一个向量，与直接赋值相同
+
+template <class A>
+inline typename A::VectorType Eval(const VecExpr<A> &e)
+{
+	static_assert(A::KARRAY == 0, "array expressions must be evaluated with Assign");
+	return EvalVector(e, (const typename A::VectorType *)NULL);
+}
+
+// Assign
+//
+// out[i] = e(i)，i 从0到 n - 1，out 的元素个数不足 n 时自动扩充
+// out 可以同时出现在表达式中，每个元素只读取自己的位置，
+// 但这时 out 至少要有 n 个元素，需要扩充时应先 Resize 再组成表达式
+// pool 不为NULL时按 KJOBBATCHGRAIN 分块并行
+
+template <class A>
+inline void Assign(Vector3DSoA &out, const VecExpr<A> &e, size_t n, JobPool *pool = NULL)
+{
+	static_assert(A::KDIM == 3, "Vector3DSoA needs a three component expression");
+
+	const A &expr = e.Self();
+
+	if (out.Size() < n)
+	{
+		// 扩充会重新分配 out 的数组，表达式中保存的指针随之失效，
+		// 此时 out 不能出现在表达式中
+
+		assert(!expr.Aliases(out.x) && !expr.Aliases(out.y) && !expr.Aliases(out.z));
+		out.Resize(n);
+	}
+	float *dst[3] = { out.x, out.y, out.z };
+
+	ParallelFor(pool, 0, n, KJOBBATCHGRAIN, [&](size_t begin, size_t end)
+	{
+		size_t i = begin;
+		size_t simdEnd = begin + (end - begin) / KSIMDWIDTH * KSIMDWIDTH;
+
+		for (; i < simdEnd; i += KSIMDWIDTH)
+		{
+			SimdFloat x = expr.Load(0, i);
+			SimdFloat y = expr.Load(1, i);
+			SimdFloat z = expr.Load(2, i);
+
+			SimdStore(dst[0] + i, x);
+			SimdStore(dst[1] + i, y);
+			SimdStore(dst[2] + i, z);
+		}
+
+		// 尾部逐个处理
+
+		for (; i < end; i++)
+		{
+			float x = expr.Get(0, i);
+			float y = expr.Get(1, i);
+			float z = expr.Get(2, i);
+
+			dst[0][i] = x;
+			dst[1][i] = y;
+			dst[2][i] = z;
+		}
+	});
+}
+
+#endif
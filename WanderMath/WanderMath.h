@@ -9,15 +9,39 @@
 #ifndef Wander_WanderMath_h
 #define Wander_WanderMath_h
 
+#include "AABB3D.h"
+#include "AnimationClip.h"
+#include "Bvh.h"
 #include "CommonMath.h"
+#include "DualQuaternion.h"
+#include "DualQuaternionBatch.h"
 #include "EulerAngles.h"
+#include "EulerAnglesBatch.h"
+#include "Frustum.h"
+#include "IncrementalTransformHierarchy.h"
+#include "JobPool.h"
+#include "KdTree3D.h"
 #include "Matrix4X3.h"
+#include "Matrix4X3Batch.h"
 #include "Matrix4X4.h"
+#include "Matrix4X4Batch.h"
 #include "Plane3D.h"
 #include "Quaternion.h"
+#include "QuaternionBatch.h"
+#include "QuaternionBlend.h"
+#include "QuaternionCompress.h"
+#include "QuaternionSimd.h"
 #include "RotationMatrix.h"
+#include "SinCosTable.h"
+#include "SlerpStepper.h"
+#include "SpatialHash2D.h"
+#include "TransformHierarchy.h"
 #include "Vector2D.h"
 #include "Vector3D.h"
+#include "Vector3DCompress.h"
+#include "Vector3DSoA.h"
+#include "VectorExpr.h"
 #include "Vector4D.h"
+#include "Vector4DSimd.h"
 #include "MathUtils.h"
 #endif